@@ -8,6 +8,7 @@
 #include <eepp/audio/outputsoundfile.hpp>
 #include <eepp/audio/sound.hpp>
 #include <eepp/audio/soundbuffer.hpp>
+#include <eepp/audio/soundbuffercache.hpp>
 #include <eepp/audio/soundbufferrecorder.hpp>
 #include <eepp/audio/soundfilefactory.hpp>
 #include <eepp/audio/soundfilereader.hpp>
@@ -16,5 +17,6 @@
 #include <eepp/audio/soundrecorder.hpp>
 #include <eepp/audio/soundsource.hpp>
 #include <eepp/audio/soundstream.hpp>
+#include <eepp/audio/soundstreamscheduler.hpp>
 
 #endif
@@ -2,6 +2,7 @@
 #define EE_AUDIO_SOUNDBUFFER_HPP
 
 #include <eepp/audio/alresource.hpp>
+#include <eepp/audio/soundbuffercache.hpp>
 #include <eepp/config.hpp>
 #include <eepp/system/time.hpp>
 #include <set>
@@ -200,6 +201,16 @@ class EE_API SoundBuffer : AlResource {
 	////////////////////////////////////////////////////////////
 	bool initialize( InputSoundFile& file );
 
+	////////////////////////////////////////////////////////////
+	/// \brief Initialize the internal state from samples decoded by the SoundBufferCache
+	///
+	/// \param entry Decoded samples to copy
+	///
+	/// \return True on success, false on failure
+	///
+	////////////////////////////////////////////////////////////
+	bool initialize( std::shared_ptr<const SoundBufferCache::Entry> entry );
+
 	////////////////////////////////////////////////////////////
 	/// \brief Update the internal buffer with the cached audio samples
 	///
@@ -0,0 +1,123 @@
+#ifndef EE_AUDIO_SOUNDBUFFERCACHE_HPP
+#define EE_AUDIO_SOUNDBUFFERCACHE_HPP
+
+#include <atomic>
+#include <eepp/config.hpp>
+#include <eepp/system/singleton.hpp>
+#include <eepp/system/threadpool.hpp>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace EE::System;
+
+namespace EE { namespace Audio {
+
+/** @brief Content-hashed cache of decoded PCM samples.
+ *
+ * Sound files are identified by the hash of their encoded content, so the same effect loaded from
+ * different paths, packs or memory is decoded only once. When enabled, SoundBuffer::loadFromFile,
+ * SoundBuffer::loadFromMemory and SoundBuffer::loadFromPack take their samples from the cache.
+ * The decoded samples can also be persisted into a directory ( see setDiskCachePath ), so the next
+ * run of the application skips the decoding completely.
+ * The cache is disabled by default.
+ */
+class EE_API SoundBufferCache {
+	SINGLETON_DECLARE_HEADERS( SoundBufferCache )
+
+  public:
+	struct Entry {
+		std::vector<Int16> samples;
+		unsigned int channelCount{ 0 };
+		unsigned int sampleRate{ 0 };
+	};
+
+	typedef std::shared_ptr<const Entry> EntryPtr;
+
+	typedef std::function<void( const Uint32& decodedCount )> BatchDoneCb;
+
+	/** @return The hash used to identify the encoded sound data */
+	static std::string hash( const void* data, std::size_t sizeInBytes );
+
+	~SoundBufferCache();
+
+	void setEnabled( const bool& enabled );
+
+	bool isEnabled() const;
+
+	/** Sets the maximum memory used by the decoded samples kept in memory. When exceeded the least
+	 * recently used entries are evicted. */
+	void setMaxMemory( const std::size_t& maxMemory );
+
+	std::size_t getMaxMemory() const;
+
+	/** @return The memory used by the decoded samples kept in memory. */
+	std::size_t getMemoryUsage() const;
+
+	/** Sets the directory used to persist the decoded samples. An empty path disables the on-disk
+	 * cache. */
+	void setDiskCachePath( const std::string& path );
+
+	std::string getDiskCachePath() const;
+
+	/** @return The decoded samples of the encoded sound data, decoding it if it's not cached. */
+	EntryPtr decode( const void* data, std::size_t sizeInBytes );
+
+	/** @return The decoded samples of the sound file, decoding it if it's not cached. */
+	EntryPtr decodeFile( const std::string& path );
+
+	/** Decodes a batch of sound files in parallel and stores them in the cache. Blocks until all
+	 * the files are decoded.
+	 * @return The number of files successfully decoded. */
+	Uint32 decodeBatch( const std::vector<std::string>& paths, ThreadPool& pool );
+
+	/** Decodes a batch of sound files in parallel and stores them in the cache. Returns
+	 * immediately, onDone is called from a pool thread once all the files were decoded. */
+	void decodeBatchAsync( const std::vector<std::string>& paths,
+						   std::shared_ptr<ThreadPool> pool, const BatchDoneCb& onDone = nullptr );
+
+	/** @return The cached entry of the hash, or an empty pointer if not cached. */
+	EntryPtr get( const std::string& hash );
+
+	/** Removes all the entries kept in memory ( the on-disk cache is kept ). */
+	void clear();
+
+	Uint64 getHitCount() const;
+
+	Uint64 getMissCount() const;
+
+  protected:
+	SoundBufferCache();
+
+	struct CacheEntry {
+		EntryPtr entry;
+		std::list<std::string>::iterator lru;
+	};
+
+	mutable std::mutex mMutex;
+	std::unordered_map<std::string, CacheEntry> mEntries;
+	std::list<std::string> mLRU;
+	std::string mDiskCachePath;
+	std::size_t mMaxMemory;
+	std::size_t mMemoryUsage;
+	std::atomic<Uint64> mHits;
+	std::atomic<Uint64> mMisses;
+	bool mEnabled;
+
+	EntryPtr lookup( const std::string& hash );
+
+	void insert( const std::string& hash, EntryPtr entry );
+
+	void evict();
+
+	EntryPtr loadFromDisk( const std::string& hash );
+
+	void saveToDisk( const std::string& hash, const Entry& entry );
+};
+
+}} // namespace EE::Audio
+
+#endif
@@ -1,16 +1,24 @@
 #ifndef EE_AUDIO_SOUNDSTREAM_HPP
 #define EE_AUDIO_SOUNDSTREAM_HPP
 
+#include <atomic>
 #include <cstdlib>
 #include <eepp/audio/soundsource.hpp>
 #include <eepp/config.hpp>
 #include <eepp/system/mutex.hpp>
-#include <eepp/system/thread.hpp>
 #include <eepp/system/time.hpp>
+#include <memory>
 using namespace EE::System;
 
 namespace EE { namespace Audio {
 
+class SoundStreamScheduler;
+
+namespace Private {
+struct SoundStreamChunk;
+struct SoundStreamState;
+} // namespace Private
+
 /// \brief Abstract base class for streamed audio sources
 class EE_API SoundStream : public SoundSource {
   public:
@@ -31,8 +39,9 @@ class EE_API SoundStream : public SoundSource {
 	/// This function starts the stream if it was stopped, resumes
 	/// it if it was paused, and restarts it from the beginning if
 	/// it was already playing.
-	/// This function uses its own thread so that it doesn't block
-	/// the rest of the program while the stream is played.
+	/// The stream is serviced by the shared SoundStreamScheduler
+	/// so that it doesn't block the rest of the program while the
+	/// stream is played.
 	///
 	/// \see pause, stop
 	///
@@ -141,6 +150,30 @@ class EE_API SoundStream : public SoundSource {
 	////////////////////////////////////////////////////////////
 	bool getLoop() const;
 
+	////////////////////////////////////////////////////////////
+	/// \brief Get the number of buffer underruns of the stream
+	///
+	/// An underrun happens when the playing queue ran out of
+	/// audio data before it could be refilled, which is audible
+	/// as a gap in the playback.
+	///
+	/// \return Number of underruns since the stream was created
+	///
+	////////////////////////////////////////////////////////////
+	Uint64 getUnderrunCount() const;
+
+	////////////////////////////////////////////////////////////
+	/// \brief Get the number of decode stalls of the stream
+	///
+	/// A decode stall happens when a buffer had to be refilled
+	/// but no audio data was decoded ahead of time, so the data
+	/// had to be decoded synchronously by the streaming scheduler.
+	///
+	/// \return Number of decode stalls since the stream was created
+	///
+	////////////////////////////////////////////////////////////
+	Uint64 getDecodeStallCount() const;
+
   protected:
 	enum {
 		NoLoop = -1 ///< "Invalid" endSeeks value, telling us to continue uninterrupted
@@ -175,12 +208,14 @@ class EE_API SoundStream : public SoundSource {
 	///
 	/// This function must be overridden by derived classes to provide
 	/// the audio samples to play. It is called continuously by the
-	/// streaming loop, in a separate thread.
+	/// streaming scheduler, in a separate thread.
 	/// The source can choose to stop the streaming loop at any time, by
 	/// returning false to the caller.
 	/// If you return true (i.e. continue streaming) it is important that
 	/// the returned array of samples is not empty; this would stop the stream
 	/// due to an internal limitation.
+	/// The returned samples are copied before this function is called again,
+	/// so the derived class can reuse its sample buffer.
 	///
 	/// \param data Chunk of data to fill
 	///
@@ -213,30 +248,87 @@ class EE_API SoundStream : public SoundSource {
 	virtual Int64 onLoop();
 
   private:
+	friend class SoundStreamScheduler;
+
+	////////////////////////////////////////////////////////////
+	/// \brief Register the stream in the streaming scheduler
+	///
+	////////////////////////////////////////////////////////////
+	void startStreaming();
+
+	////////////////////////////////////////////////////////////
+	/// \brief Unregister the stream from the streaming scheduler
+	///		and release the playing queue
+	///
+	/// When this function returns the scheduler is guaranteed to
+	/// not access the stream anymore.
+	///
+	////////////////////////////////////////////////////////////
+	void stopStreaming();
+
+	////////////////////////////////////////////////////////////
+	/// \brief Create the buffers, fill the queue and start playing
+	///
+	/// Called by the scheduler the first time the stream is serviced.
+	///
+	////////////////////////////////////////////////////////////
+	void streamBegin( Private::SoundStreamState& state );
+
+	////////////////////////////////////////////////////////////
+	/// \brief Refill the processed buffers of the playing queue
+	///
+	/// Called by the scheduler every time the stream deadline
+	/// expires.
+	///
+	/// \param state Streaming state of the stream
+	/// \param nextUpdate Time until the stream must be serviced again
+	///
+	/// \return False if the stream has finished, true otherwise
+	///
+	////////////////////////////////////////////////////////////
+	bool streamUpdate( Private::SoundStreamState& state, Time& nextUpdate );
+
+	////////////////////////////////////////////////////////////
+	/// \brief Stop the playback and release the playing queue
+	///
+	////////////////////////////////////////////////////////////
+	void streamEnd();
+
+	////////////////////////////////////////////////////////////
+	/// \brief Decode chunks of audio data ahead of time, until the
+	///		decode-ahead ring is full or the source is exhausted
+	///
+	/// Must be called with the state decode mutex locked.
+	///
+	/// \return True if at least one chunk was decoded
+	///
+	////////////////////////////////////////////////////////////
+	bool decodeAhead( Private::SoundStreamState& state );
+
 	////////////////////////////////////////////////////////////
-	/// \brief Function called as the entry point of the thread
+	/// \brief Acquire a new chunk of audio data from the stream source
 	///
-	/// This function starts the streaming loop, and returns
-	/// only when the sound is stopped.
+	/// \param state Streaming state of the stream
+	/// \param chunk Chunk to fill
 	///
 	////////////////////////////////////////////////////////////
-	void streamData();
+	void decodeChunk( Private::SoundStreamState& state, Private::SoundStreamChunk& chunk );
 
 	////////////////////////////////////////////////////////////
 	/// \brief Fill a new buffer with audio samples, and append
 	///		it to the playing queue
 	///
 	/// This function is called as soon as a buffer has been fully
-	/// consumed; it fills it again and inserts it back into the
-	/// playing queue.
+	/// consumed; it fills it again with the next decoded chunk and
+	/// inserts it back into the playing queue.
 	///
+	/// \param state Streaming state of the stream
 	/// \param bufferNum Number of the buffer to fill (in [0, BufferCount])
-	/// \param immediateLoop Treat empty buffers as spent, and act on loops immediately
 	///
 	/// \return True if the stream source has requested to stop, false otherwise
 	///
 	////////////////////////////////////////////////////////////
-	bool fillAndPushBuffer( unsigned int bufferNum, bool immediateLoop = false );
+	bool fillAndPushBuffer( Private::SoundStreamState& state, unsigned int bufferNum );
 
 	////////////////////////////////////////////////////////////
 	/// \brief Fill the audio buffers and put them all into the playing queue
@@ -247,7 +339,7 @@ class EE_API SoundStream : public SoundSource {
 	/// \return True if the derived class has requested to stop, false otherwise
 	///
 	////////////////////////////////////////////////////////////
-	bool fillQueue();
+	bool fillQueue( Private::SoundStreamState& state );
 
 	////////////////////////////////////////////////////////////
 	/// \brief Clear all the audio buffers and empty the playing queue
@@ -265,10 +357,11 @@ class EE_API SoundStream : public SoundSource {
 	////////////////////////////////////////////////////////////
 	// Member data
 	////////////////////////////////////////////////////////////
-	Thread mThread;						///< Thread running the background tasks
-	mutable Mutex mThreadMutex;			///< Thread mutex
-	Status mThreadStartState;			///< State the thread starts in (Playing, Paused, Stopped)
+	std::shared_ptr<Private::SoundStreamState> mState; ///< State shared with the scheduler
+	mutable Mutex mStreamMutex;			///< Streaming state mutex
+	Status mStreamStartState;			///< State the stream starts in (Playing, Paused, Stopped)
 	bool mIsStreaming;					///< Streaming state (true = playing, false = stopped)
+	bool mRequestStop;					///< The stream source has requested to stop
 	unsigned int mBuffers[BufferCount]; ///< Sound buffers used to store temporary audio data
 	unsigned int mChannelCount;			///< Number of channels (1 = mono, 2 = stereo, ...)
 	unsigned int mSampleRate;			///< Frequency (samples / second)
@@ -277,6 +370,9 @@ class EE_API SoundStream : public SoundSource {
 	Uint64 mSamplesProcessed;		 ///< Number of buffers processed since beginning of the stream
 	Int64 mBufferSeeks[BufferCount]; ///< If buffer is an "end buffer", holds next seek position,
 									 ///< else NoLoop. For play offset calculation.
+	Time mLastChunkDuration;			 ///< Duration of the last queued chunk
+	std::atomic<Uint64> mUnderrunCount;	 ///< Number of times the playing queue ran dry
+	std::atomic<Uint64> mDecodeStallCount; ///< Number of chunks decoded synchronously
 };
 
 }} // namespace EE::Audio
@@ -307,10 +403,10 @@ class EE_API SoundStream : public SoundSource {
 /// \li onGetData fills a new chunk of audio data to be played
 /// \li onSeek changes the current playing position in the source
 ///
-/// It is important to note that each SoundStream is played in its
-/// own separate thread, so that the streaming loop doesn't block the
-/// rest of the program. In particular, the OnGetData and OnSeek
-/// virtual functions may sometimes be called from this separate thread.
+/// It is important to note that the SoundStreams are serviced by the
+/// SoundStreamScheduler worker threads, so that the streaming loop
+/// doesn't block the rest of the program. In particular, the OnGetData
+/// and OnSeek virtual functions may sometimes be called from these threads.
 /// It is important to keep this in mind, because you may have to take
 /// care of synchronization issues if you share data between threads.
 ///
@@ -0,0 +1,90 @@
+#ifndef EE_AUDIO_SOUNDSTREAMSCHEDULER_HPP
+#define EE_AUDIO_SOUNDSTREAMSCHEDULER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <eepp/config.hpp>
+#include <eepp/system/singleton.hpp>
+#include <eepp/system/thread.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+using namespace EE::System;
+
+namespace EE { namespace Audio {
+
+class SoundStream;
+
+namespace Private {
+struct SoundStreamState;
+}
+
+/** @brief Services the playing queues of every active SoundStream.
+ *
+ * Instead of running one thread per stream, all the streams are serviced by two worker threads:
+ * a feeder thread that refills the OpenAL buffers of each stream when its deadline expires ( the
+ * time at which the oldest queued buffer finishes playing ), and a decoder thread that decodes
+ * the stream sources ahead of time into a lock-free ring of chunks, so refilling a buffer is only
+ * a copy.
+ * The worker threads are started when the first stream starts playing and stopped when the
+ * scheduler is destroyed, the number of threads doesn't depend on the number of streams.
+ *
+ * For headless tests the scheduler can be run with the mojoAL backend ( "--with-mojoal" ) and the
+ * SDL dummy audio driver ( SDL_AUDIODRIVER=dummy ) as null output device.
+ */
+class EE_API SoundStreamScheduler {
+	SINGLETON_DECLARE_HEADERS( SoundStreamScheduler )
+
+  public:
+	~SoundStreamScheduler();
+
+	/** @return The number of streams being serviced. */
+	std::size_t getStreamCount() const;
+
+	/** @return The total number of buffer underruns of all the streams serviced. */
+	Uint64 getUnderrunCount() const;
+
+	/** @return The total number of decode stalls of all the streams serviced. */
+	Uint64 getDecodeStallCount() const;
+
+	/** @return The number of worker threads running. */
+	Uint32 getThreadCount() const;
+
+  protected:
+	friend class SoundStream;
+
+	SoundStreamScheduler();
+
+	void add( const std::shared_ptr<Private::SoundStreamState>& state );
+
+	void remove( const std::shared_ptr<Private::SoundStreamState>& state );
+
+	void wakeUp( const std::shared_ptr<Private::SoundStreamState>& state );
+
+	void requestDecode();
+
+	void addUnderrun();
+
+	void addDecodeStall();
+
+	void feederLoop();
+
+	void decoderLoop();
+
+	void launchThreads();
+
+	std::vector<std::shared_ptr<Private::SoundStreamState>> mStreams;
+	std::unique_ptr<Thread> mFeeder;
+	std::unique_ptr<Thread> mDecoder;
+	mutable std::mutex mMutex;
+	std::condition_variable mFeederCond;
+	std::condition_variable mDecoderCond;
+	std::atomic<Uint64> mUnderrunCount;
+	std::atomic<Uint64> mDecodeStallCount;
+	bool mDecodeRequested;
+	bool mShuttingDown;
+};
+
+}} // namespace EE::Audio
+
+#endif
@@ -22,6 +22,7 @@
 #include <eepp/graphics/image.hpp>
 #include <eepp/graphics/ninepatch.hpp>
 #include <eepp/graphics/ninepatchmanager.hpp>
+#include <eepp/graphics/paragraphlayout.hpp>
 #include <eepp/graphics/particle.hpp>
 #include <eepp/graphics/particlesystem.hpp>
 #include <eepp/graphics/pixeldensity.hpp>
@@ -31,6 +32,7 @@
 #include <eepp/graphics/renderer/renderer.hpp>
 #include <eepp/graphics/renderer/renderergl.hpp>
 #include <eepp/graphics/renderer/renderergl3.hpp>
+#include <eepp/graphics/renderer/renderernull.hpp>
 #include <eepp/graphics/rendermode.hpp>
 #include <eepp/graphics/scopedtexture.hpp>
 #include <eepp/graphics/scrollparallax.hpp>
@@ -101,6 +101,10 @@ class EE_API Font {
 
 	virtual Texture* getTexture( unsigned int characterSize ) const = 0;
 
+	/** @return A number that changes every time the glyphs of the character size are moved,
+	 * dropped or replaced. The geometry built with the previous glyphs must be built again. */
+	virtual Uint32 getTextureGeneration( unsigned int characterSize ) const;
+
 	virtual bool loaded() const = 0;
 
 	/** Push a new on resource change callback.
@@ -35,6 +35,13 @@ class EE_API FontManager : public ResourceManager<Font> {
 
 	void setFallbackFont( Font* fallbackFont );
 
+	/** Uploads the glyphs rasterized asynchronously by the fonts. Must be called at the start of
+	 * every frame ( SceneManager::update does it ).
+	 * @param metricsChanged Set to true if the metrics of an uploaded glyph differ from its
+	 * placeholder and the texts must be laid out again.
+	 * @return True if any glyph was uploaded and the texts must be drawn again. */
+	bool update( bool* metricsChanged = nullptr );
+
   protected:
 	Font* mColorEmojiFont{ nullptr };
 	Font* mEmojiFont{ nullptr };
@@ -5,6 +5,8 @@
 #include <eepp/graphics/font.hpp>
 #include <eepp/graphics/texture.hpp>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace EE { namespace System {
 class Pack;
@@ -13,6 +15,8 @@ class IOStream;
 
 namespace EE { namespace Graphics {
 
+class ShaderProgram;
+
 class EE_API FontTrueType : public Font {
   public:
 	static FontTrueType* New( const std::string& FontName );
@@ -53,6 +57,8 @@ class EE_API FontTrueType : public Font {
 
 	Texture* getTexture( unsigned int characterSize ) const;
 
+	Uint32 getTextureGeneration( unsigned int characterSize ) const;
+
 	bool loaded() const;
 
 	FontTrueType& operator=( const FontTrueType& right );
@@ -85,37 +91,161 @@ class EE_API FontTrueType : public Font {
 
 	const Uint32& getFontInternalId() const;
 
+	/** @return The number of bytes used by the glyph textures of every character size. */
+	size_t getAtlasMemoryUsage() const;
+
+	/** @return The maximum number of bytes used by the glyph textures, 0 means no limit. */
+	const size_t& getAtlasMemoryLimit() const;
+
+	/** Sets the maximum number of bytes used by the glyph textures ( 32 MiB by default ).
+	 * When a new character size or a texture growth doesn't fit in the limit the least recently
+	 * used character sizes are released, a warning is logged if the limit can't be met. If the
+	 * texture of the character size being used is full and can't grow its glyphs are dropped and
+	 * rasterized again as they are requested, at most once every PAGE_RESET_INTERVAL. The glyph
+	 * drawables find their glyph again when its texture is released or its glyphs dropped.
+	 * 0 disables the limit. */
+	void setAtlasMemoryLimit( const size_t& atlasMemoryLimit );
+
+	bool isAsyncRasterizationEnabled() const;
+
+	/** Enables rasterizing the missing glyphs in a worker thread that uses its own font face.
+	 * Until a glyph is ready an invisible glyph with the final hinted metrics is returned, the
+	 * finished glyphs are uploaded by updateAsyncGlyphs and the texts using them are built again.
+	 * Only available for fonts loaded from a file or from memory. */
+	void setAsyncRasterization( bool asyncRasterization );
+
+	/** Rasterizes ahead of time the glyphs of a code point range, in the worker thread if the
+	 * asynchronous rasterization is enabled. */
+	void warmUpGlyphs( Uint32 firstCodePoint, Uint32 lastCodePoint, unsigned int characterSize,
+					   bool bold = false, Float outlineThickness = 0 );
+
+	/** Uploads the glyphs finished by the worker thread. FontManager::update calls it at the
+	 * start of every frame.
+	 * @param metricsChanged Set to true if the advance or the hinting deltas of an uploaded glyph
+	 * differ from its placeholder, the texts using it must be laid out again.
+	 * @return True if any glyph was uploaded. */
+	bool updateAsyncGlyphs( bool* metricsChanged = nullptr );
+
 	bool getEnableFallbackFont() const;
 
 	void setEnableFallbackFont( bool enableFallbackFont );
 
+	bool isDistanceFieldEnabled() const;
+
+	/** Enables rendering the glyphs from a signed distance field atlas. The glyphs are rasterized
+	 * once at DISTANCE_FIELD_SIZE and every character size is drawn scaling them, so zooming the
+	 * text doesn't rasterize new glyphs nor create new textures. The text is drawn with the
+	 * distance field shader, that also draws the outlines ( up to DISTANCE_FIELD_SPREAD pixels at
+	 * DISTANCE_FIELD_SIZE ).
+	 * It requires shaders support. The colored glyphs are not supported, and the glyphs are
+	 * always rasterized synchronously. The glyph drawables are drawn without the shader, their
+	 * glyphs are rasterized at their character size in separate bitmap pages.
+	 * Changing it drops the glyphs of the font, it should be set before using the font. */
+	void setDistanceField( bool distanceField );
+
+	/** @return The shader used to draw the glyphs of the distance field fonts, nullptr if shaders
+	 * aren't supported. */
+	static ShaderProgram* getDistanceFieldShader();
+
+	/** Configures the distance field shader to draw glyphs.
+	 * @param characterSize The character size of the glyphs.
+	 * @param scale The scale applied to the glyphs when drawing them.
+	 * @param outlineThickness Pixels added around the glyphs, used to draw the outlines. */
+	static void setDistanceFieldUniforms( ShaderProgram* shader, Float characterSize, Float scale,
+										  Float outlineThickness );
+
+	/** Character size used to rasterize the glyphs of the distance field atlas. */
+	static constexpr unsigned int DISTANCE_FIELD_SIZE = 48;
+
+	/** Maximum distance to the glyph edges stored in the distance field atlas, in pixels. */
+	static constexpr unsigned int DISTANCE_FIELD_SPREAD = 6;
+
+	/** Minimum milliseconds between two drops of the glyphs of a full texture. The glyphs that
+	 * don't fit meanwhile are invisible until the next drop. */
+	static constexpr Uint64 PAGE_RESET_INTERVAL = 500;
+
   protected:
 	explicit FontTrueType( const std::string& FontName );
 
-	struct Row {
-		Row( unsigned int rowTop, unsigned int rowHeight ) :
-			width( 0 ), top( rowTop ), height( rowHeight ) {}
+	typedef std::unordered_map<Uint64, Glyph>
+		GlyphTable; ///< Table mapping a codepoint to its glyph
+	typedef std::unordered_map<Uint64, GlyphDrawable*> GlyphDrawableTable;
 
-		unsigned int width;	 ///< Current width of the row
-		unsigned int top;	 ///< Y position of the row into the texture
-		unsigned int height; ///< Height of the row
-	};
+	/** Number of code points ( ASCII and Latin-1 ) resolved by direct indexing in a page. */
+	static constexpr Uint32 LATIN_GLYPHS_COUNT = 256;
 
-	typedef std::map<Uint64, Glyph> GlyphTable; ///< Table mapping a codepoint to its glyph
-	typedef std::map<Uint64, GlyphDrawable*> GlyphDrawableTable;
+	/** Horizontal segment of the top edge of the used area of a page texture. */
+	struct SkylineNode {
+		unsigned int x;		///< Left position of the segment
+		unsigned int y;		///< Height of the used area below the segment
+		unsigned int width; ///< Width of the segment
+	};
 
 	struct Page {
 		Page( const Uint32 fontInternalId );
 
+		/** Creates a page that scales the glyphs of a distance field atlas page. */
+		Page( const Uint32 fontInternalId, Page* atlas );
+
 		~Page();
 
+		void clearLookupCache();
+
+		/** Drops the packed areas, except the white square reserved for the underlines. */
+		void resetSkyline();
+
+		/** Checks if a rectangle can be placed at the left of a skyline node.
+		 * @param y The top position where the rectangle fits.
+		 * @return True if the rectangle fits inside the texture. */
+		bool fitSkyline( const size_t& index, const unsigned int& width,
+						 const unsigned int& height, unsigned int& y ) const;
+
+		/** Adds a rectangle placed at the left of a skyline node to the skyline. */
+		void addSkylineLevel( const size_t& index, const unsigned int& x, const unsigned int& y,
+							  const unsigned int& width, const unsigned int& height );
+
+		size_t getMemoryUsage() const;
+
 		GlyphTable glyphs; ///< Table mapping code points to their corresponding glyph
-		GlyphDrawableTable
-			drawables;		  ///> Table mapping code points to their corresponding glyph drawables.
-		Texture* texture;	  ///< Texture containing the pixels of the glyphs
-		unsigned int nextRow; ///< Y position of the next new row in the texture
-		std::vector<Row> rows; ///< List containing the position of all the existing rows
+		Texture* texture;  ///< Texture containing the pixels of the glyphs
+		std::vector<SkylineNode> skyline; ///< Top edge of the used area of the texture
 		Uint32 fontInternalId{ 0 };
+		Uint32 generation{ 0 }; ///< Changes every time the glyphs are dropped or replaced
+		Uint64 lastUse{ 0 };	///< Last time the page was requested
+		std::unordered_set<Uint64> pendingGlyphs; ///< Glyphs being rasterized asynchronously
+		/** Glyphs without outline of the first code points by regular and bold style, they point
+		 * to the glyphs stored in the glyph table. */
+		const Glyph* latinGlyphs[2][LATIN_GLYPHS_COUNT];
+		std::unordered_map<Uint64, Float> kernings; ///< Kerning of the code point pairs
+		bool distanceField{ false }; ///< The texture holds distance fields instead of coverage
+		Page* atlas{ nullptr };		 ///< The distance field page whose glyphs are scaled
+		Uint32 atlasGeneration{ 0 }; ///< Generation of the atlas page of the scaled glyphs
+		Uint64 lastReset{ 0 };		 ///< Ticks of the last time the glyphs were dropped
+		bool overflow{ false };		 ///< Glyphs didn't fit since the last time they were dropped
+	};
+
+	/** Pixels of a glyph ready to be placed into a page texture. */
+	struct RasterizedGlyph {
+		Glyph glyph;
+		std::vector<Uint8> pixels;
+		unsigned int rectWidth{ 0 };	///< Width of the texture area, 0 if empty
+		unsigned int rectHeight{ 0 };	///< Height of the texture area
+		unsigned int uploadWidth{ 0 };	///< Width of the pixels
+		unsigned int uploadHeight{ 0 }; ///< Height of the pixels
+		unsigned int uploadOffset{ 0 }; ///< Position of the pixels inside the texture area
+		unsigned int padding{ 0 };		///< Empty space around the glyph inside the texture area
+	};
+
+	struct AsyncRasterizer;
+
+	/** Glyph drawable that resolves its glyph again when its page changes. */
+	struct PageGlyphDrawable;
+
+	/** The font that renders a code point: the font itself, the emoji font or the fallback font.
+	 */
+	struct CodePointFont {
+		const FontTrueType* font{ nullptr };
+		bool isEmoji{ false };
 	};
 
 	void cleanup();
@@ -131,12 +261,68 @@ class EE_API FontTrueType : public Font {
 	Glyph loadGlyph( Uint32 codePoint, unsigned int characterSize, bool bold,
 					 Float outlineThickness, Page& page, const Float& maxWidth = 0.f ) const;
 
+	/** Rasterizes a glyph with the FreeType objects received, it doesn't touch the pages so it
+	 * can run in any thread with its own face. */
+	bool rasterizeGlyph( void* library, void* face, void* stroker, Uint32 index,
+						 unsigned int characterSize, bool bold, Float outlineThickness,
+						 const Float& maxWidth, RasterizedGlyph& raster ) const;
+
+	void placeGlyph( Page& page, RasterizedGlyph& raster ) const;
+
+	/** Replaces the coverage pixels of a glyph by its signed distance field. */
+	static void computeDistanceField( RasterizedGlyph& raster );
+
+	/** @return The glyph of the distance field atlas scaled to the character size of the page. */
+	Glyph getDistanceFieldGlyph( Uint32 index, unsigned int characterSize, bool bold,
+								 Float outlineThickness, Page& page, const Float& maxWidth ) const;
+
+	Page& getDistanceFieldPage() const;
+
+	/** @return An invisible glyph with the advance of the glyph, used while it's being
+	 * rasterized. */
+	Glyph getPlaceholderGlyph( Uint32 index, unsigned int characterSize, bool bold,
+							   Float outlineThickness, const Float& maxWidth ) const;
+
+	/** @return The glyph of a glyph drawable, rasterized into the page. */
+	const Glyph& getDrawableGlyph( Page& page, Uint32 codePoint, unsigned int characterSize,
+								   bool bold, Float outlineThickness, const Float& maxWidth ) const;
+
+	/** @return The area of the texture where the glyph is placed, an empty rect if it doesn't
+	 * fit. */
 	Rect findGlyphRect( Page& page, unsigned int width, unsigned int height ) const;
 
+	bool growPage( Page& page ) const;
+
+	void resetPage( Page& page ) const;
+
+	/** Drops the glyphs of a page that was full if they weren't dropped recently. */
+	void resetOverflowPage( Page& page ) const;
+
+	/** Releases the least recently used pages until the required bytes fit in the memory limit.
+	 * The scaled pages and the keep page are never released.
+	 * @return False if it wasn't possible. */
+	bool evictPages( const size_t& requiredBytes, const Page* keep ) const;
+
 	bool setCurrentSize( unsigned int characterSize ) const;
 
+	bool setCurrentSize( void* face, unsigned int characterSize ) const;
+
 	Page& getPage( unsigned int characterSize ) const;
 
+	/** @return The page that holds the glyph drawables of a character size: the page of the
+	 * character size, or a bitmap page if the glyphs are distance fields. */
+	Page& getDrawablePage( unsigned int characterSize ) const;
+
+	const CodePointFont& getCodePointFont( const Uint32& codePoint ) const;
+
+	Float computeKerning( Uint32 first, Uint32 second, unsigned int characterSize,
+						  bool bold ) const;
+
+	/** Drops the cached glyph lookups if the emoji or fallback fonts changed. */
+	void validateLookupCache() const;
+
+	void clearLookupCache() const;
+
 	typedef std::map<unsigned int, std::unique_ptr<Page>>
 		PageTable; ///< Table mapping a character size to its page (texture)
 
@@ -153,6 +339,11 @@ class EE_API FontTrueType : public Font {
 	Font::Info mInfo;			   ///< Information about the font
 	Uint32 mFontInternalId{ 0 };
 	mutable PageTable mPages; ///< Table containing the glyphs pages by character size
+	mutable std::unique_ptr<Page> mDistanceFieldPage; ///< Atlas of the distance field glyphs
+	mutable PageTable mDrawablePages; ///< Bitmap pages of the glyph drawables of distance fields
+	mutable std::map<unsigned int, GlyphDrawableTable>
+		mGlyphDrawables; ///< Glyph drawables by character size, shared with their users
+	mutable bool mAtlasOverLimit{ false }; ///< The memory limit couldn't be met
 	mutable std::vector<Uint8>
 		mPixelBuffer; ///< Pixel buffer holding a glyph's pixels before being written to the texture
 	bool mBoldAdvanceSameAsRegular;
@@ -161,8 +352,22 @@ class EE_API FontTrueType : public Font {
 	bool mIsMonospace{ false };
 	bool mEnableEmojiFallback{ true };
 	bool mEnableFallbackFont{ true };
+	bool mAsyncRasterization{ false };
+	bool mDistanceField{ false };
 	mutable std::map<unsigned int, unsigned int> mClosestCharacterSize;
-	mutable std::map<Uint32, Uint32> mCodePointIndexCache;
+	mutable std::unordered_map<Uint32, Uint32> mCodePointIndexCache;
+	mutable std::unordered_map<Uint32, CodePointFont> mCodePointFontCache;
+	mutable const Font* mLookupColorEmojiFont{ nullptr };
+	mutable const Font* mLookupEmojiFont{ nullptr };
+	mutable const Font* mLookupFallbackFont{ nullptr };
+	mutable Page* mLastPage{ nullptr };
+	mutable unsigned int mLastPageSize{ 0 };
+	mutable Uint64 mPageUseCounter{ 0 };
+	size_t mAtlasMemoryLimit{ 32 * 1024 * 1024 };
+	std::string mFontPath;			 ///< Path of the font file, if loaded from a file
+	const void* mFontData{ nullptr }; ///< Font file data, if loaded from memory
+	std::size_t mFontDataSize{ 0 };
+	std::unique_ptr<AsyncRasterizer> mAsyncRasterizer;
 
 	Uint64 getIndexKey( Uint32 fontInternalId, Uint32 index, bool bold,
 						Float outlineThickness ) const;
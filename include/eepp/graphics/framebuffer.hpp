@@ -51,6 +51,10 @@ class EE_API FrameBuffer {
 	/** @brief Clears the frame buffer pixels to the default frame buffer clear color. */
 	void clear();
 
+	/** @brief Clears a region of the frame buffer pixels to the default frame buffer clear color.
+	 * The region is in frame buffer coordinates, the frame buffer must be bound. */
+	void clear( const Rect& region );
+
 	/** @brief Recreates the frame buffer ( delete the current and creates a new one ).
 	**	This is needed by the engine to recover any context lost. */
 	virtual void reload() = 0;
@@ -58,6 +58,10 @@ class EE_API GlyphDrawable : public DrawableResource {
 	void setDrawMode( const DrawMode& drawMode );
 
   protected:
+	/** Called before the texture and the texture sector are used, lets the owner of the glyph
+	 * replace them if the glyph was moved. */
+	virtual void validate() {}
+
 	Texture* mTexture;
 	Rectf mSrcRect;
 	Float mPixelDensity;
@@ -0,0 +1,87 @@
+#ifndef EE_GRAPHICS_PARAGRAPHLAYOUT_HPP
+#define EE_GRAPHICS_PARAGRAPHLAYOUT_HPP
+
+#include <eepp/core/string.hpp>
+#include <eepp/graphics/font.hpp>
+#include <vector>
+
+namespace EE { namespace Graphics {
+
+class Text;
+
+/** @brief Word wrapping layout of a string that keeps its measurements.
+ *
+ * The string is split in paragraphs ( by its new lines ) and every paragraph in words, a word
+ * ends after a space, so the spaces are the break opportunities. The width of every word is
+ * measured once with the font, wrapping the text to a new width only fits the measured words in
+ * the lines.
+ * When the string changes only the paragraphs that were edited are measured again, when the font
+ * or its style change everything is measured again.
+ * The lines are broken like Text::wrapText does: the space after the last word that fits in a
+ * line is replaced by a new line.
+ */
+class EE_API ParagraphLayout {
+  public:
+	ParagraphLayout();
+
+	/** Sets the font and style used to measure the string. */
+	void setStyle( Font* font, const unsigned int& characterSize, const Uint32& style,
+				   const Float& outlineThickness, const Uint32& tabWidth );
+
+	/** Sets the font and style of a text ( its real character size ). */
+	void setStyle( const Text& text );
+
+	/** Sets the string to wrap, only the paragraphs that differ from the current string are
+	 * measured again. */
+	void setString( const String& string );
+
+	const String& getString() const;
+
+	/** @return The positions of the spaces that must be replaced by new lines to fit the string in
+	 * a width, sorted. */
+	const std::vector<size_t>& getBreaks( const Float& maxWidth );
+
+	/** @return The string with the line breaks to fit it in a width. */
+	String getWrappedString( const Float& maxWidth );
+
+	/** Drops the measurements. */
+	void invalidate();
+
+  protected:
+	struct Word {
+		Uint32 end;	 ///< Position after the last character of the word, relative to the paragraph
+		Float width; ///< Width of the word, including its trailing space
+	};
+
+	struct Paragraph {
+		size_t start;			 ///< Position of the first character in the string
+		size_t length;			 ///< Number of characters, including the new line
+		std::vector<Word> words; ///< Words of the paragraph, empty until measured
+		bool measured{ false };
+	};
+
+	String mString;
+	Font* mFont{ nullptr };
+	unsigned int mCharacterSize{ 0 };
+	Uint32 mStyle{ 0 };
+	Float mOutlineThickness{ 0 };
+	Uint32 mTabWidth{ 4 };
+	std::vector<Paragraph> mParagraphs;
+	std::vector<size_t> mBreaks;
+	Float mBreaksWidth{ 0 };
+	bool mBreaksValid{ false };
+
+	/** Splits the characters between start and end into paragraphs. */
+	void splitParagraphs( const size_t& start, const size_t& end,
+						  std::vector<Paragraph>& paragraphs ) const;
+
+	void measure( Paragraph& paragraph ) const;
+
+	void fit( Paragraph& paragraph, const Float& maxWidth );
+
+	size_t getParagraphIndex( const size_t& position ) const;
+};
+
+}} // namespace EE::Graphics
+
+#endif
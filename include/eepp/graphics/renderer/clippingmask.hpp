@@ -24,6 +24,11 @@ class EE_API ClippingMask {
 	/** Disable the clip plane area. */
 	void clipPlaneDisable();
 
+	/** Disables the scissor and plane clipping areas and clears their stacks. The previous state
+	 * can be restored with setScissorsClipped and setPlanesClipped. Used before drawing into a
+	 * frame buffer, since the clipping areas are in window coordinates. */
+	void clipDisableAll();
+
 	std::size_t getMaskCount() const;
 
 	const Drawable*& operator[]( std::size_t index );
@@ -17,6 +17,7 @@ class RendererGL;
 class RendererGL3;
 class RendererGL3CP;
 class RendererGLES2;
+class RendererNull;
 
 /** @brief This class is an abstraction of some OpenGL functionality.
  *	eepp has 4 different rendering pipelines: OpenGL 2, OpenGL 3, OpenGL 3 Core Profile and OpenGL
@@ -24,9 +25,21 @@ class RendererGLES2;
  *simulate fixed-pipeline commands with OpenGL 3 and OpenGL ES 2. Most of the commands can be found
  *in the OpenGL documentation. This is only useful for advanced users that want some control of the
  *OpenGL pipeline. It's mostly used internally by the engine.
+ *	The null renderer ( RendererNull ) records the commands instead of executing them, it doesn't
+ *need a graphics context.
  */
 class EE_API Renderer {
   public:
+	/** Draw calls issued and vertex data streamed to the GPU by the renderer since the last reset.
+	 * Only the renderers that stream the client vertex arrays into buffer objects ( OpenGL 3 Core
+	 * Profile ) report uploaded bytes, the others source the client arrays directly. The null
+	 * renderer reports the bytes of the client arrays used by each draw call. */
+	struct Stats {
+		Uint64 drawCalls{ 0 };
+		Uint64 uploads{ 0 };
+		Uint64 bytesUploaded{ 0 };
+	};
+
 	/** @return The graphic library renderer version from a string. */
 	static GraphicsLibraryVersion glVersionFromString( std::string glVersion );
 
@@ -35,6 +48,8 @@ class EE_API Renderer {
 
 	static GraphicsLibraryVersion getDefaultGraphicsLibraryVersion();
 
+	/** @return The renderers that can draw into a window. The null renderer ( GLv_Null ) is not
+	 * listed, it must be requested explicitly. */
 	static std::vector<GraphicsLibraryVersion> getAvailableGraphicsLibraryVersions();
 
 	static Renderer* createSingleton( GraphicsLibraryVersion ver );
@@ -67,7 +82,7 @@ class EE_API Renderer {
 	std::string getShadingLanguageVersion();
 
 	/** @return If the extension passed is supported by the GPU */
-	bool isExtension( const std::string& name );
+	virtual bool isExtension( const std::string& name );
 
 	/** @return If the extension from the EEGL_extensions is present on the GPU. */
 	bool isExtension( GraphicsLibraryExtension name );
@@ -76,41 +91,47 @@ class EE_API Renderer {
 
 	bool shadersSupported();
 
-	void clear( unsigned int mask );
+	virtual void clear( unsigned int mask );
+
+	virtual void clearColor( float red, float green, float blue, float alpha );
 
-	void clearColor( float red, float green, float blue, float alpha );
+	virtual void scissor( int x, int y, int width, int height );
 
-	void scissor( int x, int y, int width, int height );
+	virtual void polygonMode( unsigned int face, unsigned int mode );
 
-	void polygonMode( unsigned int face, unsigned int mode );
+	virtual std::string getExtensions();
 
-	std::string getExtensions();
+	virtual const char* getString( unsigned int name );
 
-	const char* getString( unsigned int name );
+	virtual void drawArrays( unsigned int mode, int first, int count );
 
-	void drawArrays( unsigned int mode, int first, int count );
+	virtual void drawElements( unsigned int mode, int count, unsigned int type,
+							   const void* indices );
 
-	void drawElements( unsigned int mode, int count, unsigned int type, const void* indices );
+	const Stats& getStats() const;
 
-	void bindTexture( unsigned int target, unsigned int texture );
+	virtual void resetStats();
 
-	void activeTexture( unsigned int texture );
+	virtual void bindTexture( unsigned int target, unsigned int texture );
 
-	void blendFunc( unsigned int sfactor, unsigned int dfactor );
+	virtual void activeTexture( unsigned int texture );
 
-	void blendFuncSeparate( unsigned int sfactorRGB, unsigned int dfactorRGB,
-							unsigned int sfactorAlpha, unsigned int dfactorAlpha );
+	virtual void blendFunc( unsigned int sfactor, unsigned int dfactor );
 
-	void blendEquationSeparate( unsigned int modeRGB, unsigned int modeAlpha );
+	virtual void blendFuncSeparate( unsigned int sfactorRGB, unsigned int dfactorRGB,
+									unsigned int sfactorAlpha, unsigned int dfactorAlpha );
 
-	void blitFrameBuffer( int srcX0, int srcY0, int srcX1, int srcY1, int dstX0, int dstY0,
-						  int dstX1, int dstY1, unsigned int mask, unsigned int filter );
+	virtual void blendEquationSeparate( unsigned int modeRGB, unsigned int modeAlpha );
 
-	void viewport( int x, int y, int width, int height );
+	virtual void blitFrameBuffer( int srcX0, int srcY0, int srcX1, int srcY1, int dstX0,
+								  int dstY0, int dstX1, int dstY1, unsigned int mask,
+								  unsigned int filter );
+
+	virtual void viewport( int x, int y, int width, int height );
 
 	void lineSmooth( const bool& enable );
 
-	void lineWidth( float width );
+	virtual void lineWidth( float width );
 
 	/** Reapply the line smooth state */
 	void lineSmooth();
@@ -123,7 +144,7 @@ class EE_API Renderer {
 	/** Reapply the polygon mode */
 	void polygonMode();
 
-	void pixelStorei( unsigned int pname, int param );
+	virtual void pixelStorei( unsigned int pname, int param );
 
 	RendererGL* getRendererGL();
 
@@ -133,6 +154,8 @@ class EE_API Renderer {
 
 	RendererGLES2* getRendererGLES2();
 
+	RendererNull* getRendererNull();
+
 	virtual void pointSize( float size ) = 0;
 
 	virtual float pointSize() = 0;
@@ -202,7 +225,18 @@ class EE_API Renderer {
 
 	virtual unsigned int getCurrentMatrixMode() = 0;
 
-	void getViewport( int* viewport );
+	virtual void getViewport( int* viewport );
+
+	/** Queries an integer state value ( glGetIntegerv ). */
+	virtual void getIntegerv( unsigned int pname, int* params );
+
+	virtual void deleteTextures( int n, const unsigned int* textures );
+
+	virtual void texParameteri( unsigned int target, unsigned int pname, int param );
+
+	virtual void texSubImage2D( unsigned int target, int level, int xoffset, int yoffset,
+								int width, int height, unsigned int format, unsigned int type,
+								const void* pixels );
 
 	virtual int project( float objx, float objy, float objz, const float modelMatrix[16],
 						 const float projMatrix[16], const int viewport[4], float* winx,
@@ -216,19 +250,19 @@ class EE_API Renderer {
 
 	Vector3f unProjectCurrent( const Vector3f& point );
 
-	void stencilFunc( unsigned int func, int ref, unsigned int mask );
+	virtual void stencilFunc( unsigned int func, int ref, unsigned int mask );
 
-	void stencilOp( unsigned int fail, unsigned int zfail, unsigned int zpass );
+	virtual void stencilOp( unsigned int fail, unsigned int zfail, unsigned int zpass );
 
-	void stencilMask( unsigned int mask );
+	virtual void stencilMask( unsigned int mask );
 
-	void colorMask( Uint8 red, Uint8 green, Uint8 blue, Uint8 alpha );
+	virtual void colorMask( Uint8 red, Uint8 green, Uint8 blue, Uint8 alpha );
 
-	void bindVertexArray( unsigned int array );
+	virtual void bindVertexArray( unsigned int array );
 
-	void deleteVertexArrays( int n, const unsigned int* arrays );
+	virtual void deleteVertexArrays( int n, const unsigned int* arrays );
 
-	void genVertexArrays( int n, unsigned int* arrays );
+	virtual void genVertexArrays( int n, unsigned int* arrays );
 
 	const bool& quadsSupported() const;
 
@@ -236,35 +270,36 @@ class EE_API Renderer {
 
 	ClippingMask* getClippingMask() const;
 
-	void genFramebuffers( int n, unsigned int* framebuffers );
+	virtual void genFramebuffers( int n, unsigned int* framebuffers );
 
-	void deleteFramebuffers( int n, const unsigned int* framebuffers );
+	virtual void deleteFramebuffers( int n, const unsigned int* framebuffers );
 
-	void bindFramebuffer( unsigned int target, unsigned int framebuffer );
+	virtual void bindFramebuffer( unsigned int target, unsigned int framebuffer );
 
-	void framebufferTexture2D( unsigned int target, unsigned int attachment, unsigned int textarget,
-							   unsigned int texture, int level );
+	virtual void framebufferTexture2D( unsigned int target, unsigned int attachment,
+									   unsigned int textarget, unsigned int texture, int level );
 
-	void genRenderbuffers( int n, unsigned int* renderbuffers );
+	virtual void genRenderbuffers( int n, unsigned int* renderbuffers );
 
-	void deleteRenderbuffers( int n, const unsigned int* renderbuffers );
+	virtual void deleteRenderbuffers( int n, const unsigned int* renderbuffers );
 
-	void bindRenderbuffer( unsigned int target, unsigned int renderbuffer );
+	virtual void bindRenderbuffer( unsigned int target, unsigned int renderbuffer );
 
-	void renderbufferStorage( unsigned int target, unsigned int internalformat, int width,
-							  int height );
+	virtual void renderbufferStorage( unsigned int target, unsigned int internalformat, int width,
+									  int height );
 
-	void framebufferRenderbuffer( unsigned int target, unsigned int attachment,
-								  unsigned int renderbuffertarget, unsigned int renderbuffer );
+	virtual void framebufferRenderbuffer( unsigned int target, unsigned int attachment,
+										  unsigned int renderbuffertarget,
+										  unsigned int renderbuffer );
 
-	unsigned int checkFramebufferStatus( unsigned int target );
+	virtual unsigned int checkFramebufferStatus( unsigned int target );
 
-	void discardFramebuffer( unsigned int target, int numAttachments,
-							 const unsigned int* attachments );
+	virtual void discardFramebuffer( unsigned int target, int numAttachments,
+									 const unsigned int* attachments );
 
-	void* getProcAddress( std::string proc );
+	virtual void* getProcAddress( std::string proc );
 
-	void readPixels( int x, int y, unsigned int width, unsigned int height, void* pixels );
+	virtual void readPixels( int x, int y, unsigned int width, unsigned int height, void* pixels );
 
 	Color readPixel( int x, int y );
 
@@ -279,10 +314,10 @@ class EE_API Renderer {
 	int mQuadVertexs;
 	float mLineWidth;
 	unsigned int mCurVAO;
+	Stats mStats;
 
 	ClippingMask* mClippingMask;
 
-  private:
 	void writeExtension( Uint8 Pos, Uint32 BitWrite );
 };
 
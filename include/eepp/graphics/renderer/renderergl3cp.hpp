@@ -9,6 +9,9 @@ namespace EE { namespace Graphics {
 
 enum EEGL3CP_SHADERS { EEGL3CP_SHADER_BASE, EEGL3CP_SHADERS_COUNT };
 
+/** Number of segments of the streaming vertex ring buffer, each one guarded by a fence. */
+#define EEGL3CP_RING_SEGMENTS 3
+
 namespace Private {
 class MatrixStack;
 }
@@ -48,6 +51,10 @@ class EE_API RendererGL3CP : public RendererGLShader {
 
 	void clientActiveTexture( unsigned int texture );
 
+	void drawArrays( unsigned int mode, int first, int count );
+
+	void drawElements( unsigned int mode, int count, unsigned int type, const void* indices );
+
 	unsigned int baseShaderId();
 
 	void setShader( ShaderProgram* Shader );
@@ -70,9 +77,27 @@ class EE_API RendererGL3CP : public RendererGLShader {
 	void reloadCurrentShader();
 
   protected:
+	/** Vertex attribute pointer set by the client, uploaded on the next draw call. */
+	struct PendingAttribute {
+		int index;
+		int size;
+		unsigned int type;
+		bool normalized;
+		int stride;
+		const char* pointer;
+		unsigned int allocate;
+	};
+
 	ShaderProgram* mShaders[EEGL3CP_SHADERS_COUNT];
 	unsigned int mVAO;
-	unsigned int mVBO[8];
+	unsigned int mRingBuffer;
+	Uint32 mRingSize;
+	Uint32 mRingOffset;
+	Uint32 mRingSegment;
+	void* mRingFences[EEGL3CP_RING_SEGMENTS];
+	bool mRingSync;
+	PendingAttribute mPendingAttributes[EEGL_ARRAY_STATES_COUNT + EE_MAX_TEXTURE_UNITS];
+	Uint32 mPendingAttributesCount;
 	int mAttribsLoc[EEGL_ARRAY_STATES_COUNT];
 	int mAttribsLocStates[EEGL_ARRAY_STATES_COUNT];
 	int mPlanes[EE_MAX_PLANES];
@@ -85,8 +110,6 @@ class EE_API RendererGL3CP : public RendererGLShader {
 	int mTextureUnits[EE_MAX_TEXTURE_UNITS];
 	int mTextureUnitsStates[EE_MAX_TEXTURE_UNITS];
 	int mCurActiveTex;
-	unsigned int mCurTexCoordArray;
-	Uint32 mVBOSizeAlloc;
 	Uint32 mBiggestAlloc;
 	bool mLoaded;
 	std::string mBaseVertexShader;
@@ -96,6 +119,25 @@ class EE_API RendererGL3CP : public RendererGLShader {
 	void reloadShader( ShaderProgram* Shader );
 
 	void allocateBuffers( const Uint32& size );
+
+	void setAttributePointer( const PendingAttribute& attribute );
+
+	/** Uploads the pending attributes into the ring buffer. The attributes interleaved in the
+	 * same client array are uploaded once. */
+	void uploadPendingAttributes();
+
+	/** Copies the data into the ring buffer.
+	 * @return The offset of the data in the ring buffer. */
+	Uint32 uploadToRing( const char* data, const Uint32& size );
+
+	/** Makes room for size bytes after the ring offset, growing or wrapping the ring. */
+	void reserveRing( const Uint32& size );
+
+	void fenceRingSegment( const Uint32& segment );
+
+	void waitRingSegment( const Uint32& segment );
+
+	void releaseRingFences();
 };
 
 }} // namespace EE::Graphics
@@ -46,6 +46,8 @@ enum GraphicsLibraryVersion {
 	GLv_ES1,
 	/// OpenGL ES 2
 	GLv_ES2,
+	/// Null renderer, records the rendering commands without a graphics context
+	GLv_Null,
 	/// Selects the most appropriate graphics library version for each platform.
 	GLv_default
 };
@@ -0,0 +1,281 @@
+#ifndef EE_GRAPHICS_RENDERERNULL_HPP
+#define EE_GRAPHICS_RENDERERNULL_HPP
+
+#include <eepp/graphics/renderer/rendererglshader.hpp>
+#include <string>
+#include <vector>
+
+namespace EE { namespace Graphics {
+
+/** @brief Renderer that doesn't need a graphics context.
+ *	It keeps the matrix stacks and the state that the engine queries back ( viewport, bindings ),
+ *and records every draw call, state change, texture bind and uploaded data into a command log
+ *instead of executing them. It's intended to measure the CPU side of the rendering ( layout,
+ *batching, vertex generation ) in headless runs, tests and benchmarks. Textures and frame buffers
+ *get valid object ids but no storage, reading back its contents returns zeroed pixels.
+ *	It's selected with the GLv_Null graphics library version.
+ */
+class EE_API RendererNull : public RendererGLShader {
+  public:
+	enum class CommandType : Uint8 {
+		DrawArrays,
+		DrawElements,
+		UploadVertices,
+		Clear,
+		ClearColor,
+		Viewport,
+		Scissor,
+		Enable,
+		Disable,
+		EnableClientState,
+		DisableClientState,
+		BindTexture,
+		ActiveTexture,
+		TexImage,
+		TexSubImage,
+		TexParameter,
+		DeleteTexture,
+		BlendFunc,
+		BlendFuncSeparate,
+		BlendEquationSeparate,
+		SetShader,
+		LineWidth,
+		PointSize,
+		PolygonMode,
+		StencilFunc,
+		StencilOp,
+		StencilMask,
+		ColorMask,
+		Clip2DPlaneEnable,
+		Clip2DPlaneDisable,
+		ClipPlane,
+		BindFramebuffer,
+		BindRenderbuffer,
+		BlitFramebuffer,
+		ReadPixels
+	};
+
+	/** A recorded command. The meaning of the arguments depends on the command type, they follow
+	 * the arguments of the equivalent OpenGL call. */
+	struct Command {
+		CommandType type;
+		Int64 args[4];
+	};
+
+	/** Totals of the commands executed since the last stats reset. The draw calls and uploaded
+	 * vertex data are reported by Renderer::getStats. */
+	struct Counters {
+		Uint64 vertices{ 0 };
+		Uint64 textureBinds{ 0 };
+		Uint64 textureUploads{ 0 };
+		Uint64 textureBytesUploaded{ 0 };
+		Uint64 stateChanges{ 0 };
+	};
+
+	static const char* commandTypeToString( const CommandType& type );
+
+	RendererNull();
+
+	~RendererNull();
+
+	GraphicsLibraryVersion version();
+
+	std::string versionStr();
+
+	void init();
+
+	/** @return The recorded commands. */
+	const std::vector<Command>& getCommands() const;
+
+	/** Removes the recorded commands, usually called once per frame. */
+	void clearCommands();
+
+	/** @return The recorded commands as text, one command per line. */
+	std::string dumpCommands() const;
+
+	/** @return True if the commands are being recorded into the command log. The counters and
+	 * stats are updated even if the recording is disabled. */
+	bool isRecording() const;
+
+	void setRecording( bool recording );
+
+	/** Sets the maximum number of commands kept by the command log. Once the limit is reached the
+	 * new commands are dropped until the log is cleared. */
+	void setMaxCommands( const size_t& maxCommands );
+
+	const size_t& getMaxCommands() const;
+
+	/** @return The number of commands dropped since the log was cleared. */
+	const Uint64& getDroppedCommands() const;
+
+	const Counters& getCounters() const;
+
+	void resetStats();
+
+	/** Creates a texture object, or replaces the contents of an existing one.
+	 * @param texture The texture to replace, or 0 to create a new one.
+	 * @return The texture id. */
+	unsigned int createTexture( int width, int height, int channels, unsigned int texture = 0 );
+
+	bool isExtension( const std::string& name );
+
+	std::string getExtensions();
+
+	const char* getString( unsigned int name );
+
+	void clear( unsigned int mask );
+
+	void clearColor( float red, float green, float blue, float alpha );
+
+	void scissor( int x, int y, int width, int height );
+
+	void polygonMode( unsigned int face, unsigned int mode );
+
+	void drawArrays( unsigned int mode, int first, int count );
+
+	void drawElements( unsigned int mode, int count, unsigned int type, const void* indices );
+
+	void bindTexture( unsigned int target, unsigned int texture );
+
+	void activeTexture( unsigned int texture );
+
+	void blendFunc( unsigned int sfactor, unsigned int dfactor );
+
+	void blendFuncSeparate( unsigned int sfactorRGB, unsigned int dfactorRGB,
+							unsigned int sfactorAlpha, unsigned int dfactorAlpha );
+
+	void blendEquationSeparate( unsigned int modeRGB, unsigned int modeAlpha );
+
+	void blitFrameBuffer( int srcX0, int srcY0, int srcX1, int srcY1, int dstX0, int dstY0,
+						  int dstX1, int dstY1, unsigned int mask, unsigned int filter );
+
+	void viewport( int x, int y, int width, int height );
+
+	void lineWidth( float width );
+
+	void pixelStorei( unsigned int pname, int param );
+
+	void pointSize( float size );
+
+	float pointSize();
+
+	void clientActiveTexture( unsigned int texture );
+
+	void disable( unsigned int cap );
+
+	void enable( unsigned int cap );
+
+	void enableClientState( unsigned int array );
+
+	void disableClientState( unsigned int array );
+
+	void vertexPointer( int size, unsigned int type, int stride, const void* pointer,
+						unsigned int allocate );
+
+	void colorPointer( int size, unsigned int type, int stride, const void* pointer,
+					   unsigned int allocate );
+
+	void texCoordPointer( int size, unsigned int type, int stride, const void* pointer,
+						  unsigned int allocate );
+
+	void setShader( ShaderProgram* Shader );
+
+	void clip2DPlaneEnable( const Int32& x, const Int32& y, const Int32& Width,
+							const Int32& Height );
+
+	void clip2DPlaneDisable();
+
+	void clipPlane( unsigned int plane, const double* equation );
+
+	void getViewport( int* viewport );
+
+	void getIntegerv( unsigned int pname, int* params );
+
+	void deleteTextures( int n, const unsigned int* textures );
+
+	void texParameteri( unsigned int target, unsigned int pname, int param );
+
+	void texSubImage2D( unsigned int target, int level, int xoffset, int yoffset, int width,
+						int height, unsigned int format, unsigned int type, const void* pixels );
+
+	void stencilFunc( unsigned int func, int ref, unsigned int mask );
+
+	void stencilOp( unsigned int fail, unsigned int zfail, unsigned int zpass );
+
+	void stencilMask( unsigned int mask );
+
+	void colorMask( Uint8 red, Uint8 green, Uint8 blue, Uint8 alpha );
+
+	void bindVertexArray( unsigned int array );
+
+	void deleteVertexArrays( int n, const unsigned int* arrays );
+
+	void genVertexArrays( int n, unsigned int* arrays );
+
+	void genFramebuffers( int n, unsigned int* framebuffers );
+
+	void deleteFramebuffers( int n, const unsigned int* framebuffers );
+
+	void bindFramebuffer( unsigned int target, unsigned int framebuffer );
+
+	void framebufferTexture2D( unsigned int target, unsigned int attachment,
+							   unsigned int textarget, unsigned int texture, int level );
+
+	void genRenderbuffers( int n, unsigned int* renderbuffers );
+
+	void deleteRenderbuffers( int n, const unsigned int* renderbuffers );
+
+	void bindRenderbuffer( unsigned int target, unsigned int renderbuffer );
+
+	void renderbufferStorage( unsigned int target, unsigned int internalformat, int width,
+							  int height );
+
+	void framebufferRenderbuffer( unsigned int target, unsigned int attachment,
+								  unsigned int renderbuffertarget, unsigned int renderbuffer );
+
+	unsigned int checkFramebufferStatus( unsigned int target );
+
+	void discardFramebuffer( unsigned int target, int numAttachments,
+							 const unsigned int* attachments );
+
+	void* getProcAddress( std::string proc );
+
+	void readPixels( int x, int y, unsigned int width, unsigned int height, void* pixels );
+
+  protected:
+	/** Client array set since the last draw call. */
+	struct ClientArray {
+		const char* pointer;
+		unsigned int allocate;
+	};
+
+	std::vector<Command> mCommands;
+	size_t mMaxCommands;
+	Uint64 mDroppedCommands;
+	bool mRecording;
+	Counters mCounters;
+	unsigned int mNextId;
+	int mViewport[4];
+	float mPointSize;
+	Uint32 mClientStates;
+	unsigned int mActiveTexture;
+	unsigned int mBoundTextures[EE_MAX_TEXTURE_UNITS];
+	unsigned int mBoundFramebuffer;
+	unsigned int mBoundRenderbuffer;
+	ClientArray mClientArrays[EEGL_ARRAY_STATES_COUNT + 1];
+
+	void record( const CommandType& type, Int64 a = 0, Int64 b = 0, Int64 c = 0, Int64 d = 0 );
+
+	void recordState( const CommandType& type, Int64 a = 0, Int64 b = 0, Int64 c = 0,
+					  Int64 d = 0 );
+
+	/** Accounts the client arrays used by a draw call as uploaded vertex data. The arrays
+	 * interleaved in the same buffer are accounted once. */
+	void uploadClientArrays();
+
+	unsigned int clientStateIndex( unsigned int array ) const;
+};
+
+}} // namespace EE::Graphics
+
+#endif
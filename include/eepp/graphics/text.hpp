@@ -182,6 +182,7 @@ class EE_API Text {
 	mutable bool mColorsNeedUpdate;
 	mutable bool mContainsColorEmoji{ false };
 	bool mDisableCacheWidth{ false };
+	Uint32 mFontTextureGeneration{ 0 }; ///< Font texture generation of the glyphs in the geometry
 
 	Float mCachedWidth;
 	int mNumLines;
@@ -212,7 +213,10 @@ class EE_API Text {
 
 	static void addGlyphQuad( std::vector<VertexCoords>& vertices, Vector2f position,
 							  const EE::Graphics::Glyph& glyph, Float italic,
-							  Float outlineThickness, Int32 centerDiffX );
+							  Float outlineThickness, Int32 centerDiffX, Float padding );
+
+	/** @return True if the font draws its glyphs from a distance field atlas. */
+	bool isDistanceField() const;
 
 	Uint32 getTotalVertices();
 
@@ -9,6 +9,7 @@ using namespace EE::System;
 namespace EE { namespace Scene {
 
 class Node;
+class ActionManager;
 
 class EE_API Action {
   public:
@@ -39,6 +40,11 @@ class EE_API Action {
 	/** The total action time. */
 	virtual Time getTotalTime() = 0;
 
+	/** @return The time the action can wait until its next update without changing its result.
+	 * Time::Zero ( the default ) means that the action must be updated every frame, actions that
+	 * are only waiting return the time left to wait. */
+	virtual Time getIdleTime();
+
 	/** Clones the action. */
 	virtual Action* clone() const;
 
@@ -90,9 +96,11 @@ class EE_API Action {
 
   protected:
 	friend class Node;
+	friend class ActionManager;
 	typedef std::map<ActionType, std::map<Uint32, ActionCallback>> ActionCallbackMap;
 
 	Node* mNode;
+	ActionManager* mActionManager;
 	Uint32 mFlags;
 	String::HashType mTag;
 	Uint32 mNumCallBacks;
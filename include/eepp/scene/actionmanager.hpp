@@ -3,8 +3,10 @@
 
 #include <atomic>
 #include <eepp/config.hpp>
+#include <eepp/core/string.hpp>
 #include <eepp/system/mutex.hpp>
 #include <eepp/system/time.hpp>
+#include <unordered_map>
 #include <vector>
 using namespace EE::System;
 
@@ -13,6 +15,13 @@ namespace EE { namespace Scene {
 class Action;
 class Node;
 
+/** @brief Schedules and updates the actions running in a scene.
+ *
+ * The bookkeeping of each action is kept in a pooled slab of slots, indexed by action, by target
+ * and by tag, so adding, finding and removing actions don't depend on the number of actions
+ * running. Actions are updated in the same order they were added. Actions removed while the
+ * manager is updating are hidden from the queries immediately and released at the end of the
+ * update. */
 class EE_API ActionManager {
   public:
 	static ActionManager* New();
@@ -45,13 +54,68 @@ class EE_API ActionManager {
 
 	bool isEmpty() const;
 
+	/** @return The time until an action needs to be updated ( see Action::getIdleTime ),
+	 * Time::Infinity if there are no actions. */
+	Time getIdleTime() const;
+
 	void clear();
 
   protected:
-	std::vector<Action*> mActions;
+	friend class Action;
+
+	static constexpr Uint32 InvalidSlot = 0xFFFFFFFF;
+
+	struct Link {
+		Uint32 prev{ InvalidSlot };
+		Uint32 next{ InvalidSlot };
+	};
+
+	struct List {
+		Uint32 head{ InvalidSlot };
+		Uint32 tail{ InvalidSlot };
+	};
+
+	struct Slot {
+		Action* action{ NULL };
+		Node* target{ NULL };
+		String::HashType tag{ 0 };
+		Link targetLink;
+		Link tagLink;
+		Uint32 activeIndex{ InvalidSlot };
+		bool pendingRemoval{ false };
+	};
+
+	std::vector<Slot> mSlots;
+	std::vector<Uint32> mFreeSlots;
+	std::vector<Uint32> mActive; // Slots in insertion order, InvalidSlot marks a released slot
+	std::size_t mActiveHoles;
+	std::unordered_map<Action*, Uint32> mActionSlots;
+	std::unordered_map<Node*, List> mTargets;
+	std::unordered_map<String::HashType, List> mTags;
 	std::vector<Action*> mActionsRemoveList;
+	std::vector<Action*> mActionsReleaseList;
 	mutable Mutex mMutex;
 	std::atomic<bool> mUpdating;
+
+	void onActionChanged( Action* action );
+
+	void release( Action* action );
+
+	void releaseSlot( const Uint32& index );
+
+	void compactActive();
+
+	void link( List& list, const Uint32& index, Link Slot::*link );
+
+	void unlink( List& list, const Uint32& index, Link Slot::*link );
+
+	void linkTarget( const Uint32& index );
+
+	void unlinkTarget( const Uint32& index );
+
+	void linkTag( const Uint32& index );
+
+	void unlinkTag( const Uint32& index );
 };
 
 }} // namespace EE::Scene
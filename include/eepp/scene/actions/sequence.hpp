@@ -35,6 +35,8 @@ class EE_API Sequence : public Action {
 
 	Time getTotalTime() override;
 
+	Time getIdleTime() override;
+
 	Action* clone() const override;
 
 	Action* reverse() const override;
@@ -20,6 +20,7 @@ using namespace EE::Graphics;
 using namespace EE::Math;
 
 #include <eepp/system/color.hpp>
+#include <eepp/system/timerwheel.hpp>
 using namespace EE::System;
 
 namespace EE { namespace Scene {
@@ -63,7 +64,9 @@ enum NodeFlags {
 
 	NODE_FLAG_LOADING = ( 1 << 27 ),
 	NODE_FLAG_CLOSING_CHILDREN = ( 1 << 28 ),
-	NODE_FLAG_FREE_USE = ( 1 << 29 )
+	NODE_FLAG_FREE_USE = ( 1 << 29 ),
+	NODE_FLAG_CONTENT_BOUNDS_DIRTY = ( 1 << 30 ),
+	NODE_FLAG_RETAINED_DRAW = ( 1 << 31 )
 };
 
 class EE_API Node : public Transformable {
@@ -130,6 +133,11 @@ class EE_API Node : public Transformable {
 
 	virtual void scheduledUpdate( const Time& time );
 
+	/** @return The time the node can wait until its next scheduled update without missing any
+	 * work. Time::Zero ( the default ) means that the node must be updated every frame. The nodes
+	 * subscribed to the scheduled updates report it, so the scene can sleep while it's idle. */
+	virtual Time getIdleTime();
+
 	Node* getNextNode() const;
 
 	Node* getPrevNode() const;
@@ -175,6 +183,8 @@ class EE_API Node : public Transformable {
 
 	bool isFrameBuffer() const;
 
+	bool isRetainedDraw() const;
+
 	bool isMouseOver() const;
 
 	bool isMouseOverMeOrChilds() const;
@@ -212,6 +222,21 @@ class EE_API Node : public Transformable {
 
 	const Rectf& getWorldBounds();
 
+	/** @return The bounds of the node and its visible descendants, relative to the node screen
+	 * position. The descendants of a clipped node don't extend its bounds. Used to cull the nodes
+	 * that are drawn completely outside the visible area. */
+	const Rectf& getContentBounds();
+
+	/** Marks the content bounds of the node and its parents as dirty. */
+	void invalidateContentBounds();
+
+	/** @return The area covered by the node and its descendants, in world coordinates. */
+	Rectf getDrawBounds();
+
+	/** @return The area covered by the node in the last frame drawn, in world coordinates. Only
+	 * kept if the scene tracks the damaged regions. */
+	const Rectf& getDrawnBounds() const;
+
 	bool isParentOf( const Node* node ) const;
 
 	void sendEvent( const Event* Event );
@@ -391,6 +416,19 @@ class EE_API Node : public Transformable {
 	void runOnMainThread( Actions::Runnable::RunnableFunc runnable,
 						  const Time& delay = Seconds( 0 ), const Uint32& tag = 0 );
 
+	/** Runs the callback in the main thread once the delay elapses. The timer is removed if the
+	 * node is destroyed.
+	 * @return The timer id. */
+	Uint64 setTimeout( const TimerWheel::Callback& callback, const Time& delay );
+
+	/** Runs the callback in the main thread every interval, until it's cleared or the node is
+	 * destroyed.
+	 * @return The timer id. */
+	Uint64 setInterval( const TimerWheel::Callback& callback, const Time& interval );
+
+	/** Removes a timer created with Node::setTimeout or Node::setInterval. */
+	void clearTimer( const Uint64& id );
+
 	bool isChild( Node* child ) const;
 
 	bool inParentTreeOf( Node* child ) const;
@@ -449,6 +487,8 @@ class EE_API Node : public Transformable {
 
 	mutable Polygon2f mPoly;
 	mutable Rectf mWorldBounds;
+	Rectf mContentBounds;
+	Rectf mDrawnBounds;
 	Vector2f mCenter;
 
 	EventsMap mEvents;
@@ -508,6 +548,14 @@ class EE_API Node : public Transformable {
 
 	virtual void drawChilds();
 
+	/** @return True if the node and its descendants are completely outside of the cull rectangle
+	 * ( in world coordinates ). */
+	bool isCulled( const Rectf& cullRect, bool transformed );
+
+	/** Keeps the area covered by the node in the last frame, that's damaged if the node is
+	 * invalidated. Only kept if the scene tracks the damaged regions. */
+	void updateDrawnBounds();
+
 	virtual void onChildCountChange( Node* child, const bool& removed );
 
 	virtual void onAngleChange();
@@ -43,6 +43,11 @@ class EE_API SceneManager {
 
 	Time getElapsed() const;
 
+	/** @return The time the scenes can wait for events until they need to be updated or drawn
+	 * again ( see SceneNode::getIdleTime ). Time::Infinity means that there's nothing scheduled
+	 * and the main loop can wait until the next event or wake up. */
+	Time getIdleTime() const;
+
   protected:
 	Clock mClock;
 	UISceneNode* mUISceneNode;
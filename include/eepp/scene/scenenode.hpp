@@ -109,6 +109,38 @@ class EE_API SceneNode : public Node {
 
 	const Float& getDPI() const;
 
+	/** Enables or disables the culling of the nodes that are drawn completely outside of the
+	 * visible area ( the scene and the clipped area of its parents ). Enabled by default. */
+	void setCulling( bool culling );
+
+	bool isCulling() const;
+
+	/** @return The area where the nodes being drawn are visible, in world coordinates. */
+	const Rectf& getCullRect() const;
+
+	/** Enables or disables the partial redraw. When the scene is drawn into its frame buffer and
+	 * uses draw invalidation, only the regions damaged by the invalidated nodes are redrawn, the
+	 * rest of the frame buffer is kept from the previous frames. Enabled by default. */
+	void setPartialRedraw( bool partialRedraw );
+
+	bool isPartialRedraw() const;
+
+	virtual void invalidate( Node* invalidator );
+
+	/** Lays out again the texts of the scene after the metrics of the glyphs of a font changed.
+	 * SceneManager::update calls it when a glyph rasterized asynchronously doesn't match the
+	 * metrics of its placeholder. */
+	virtual void invalidateFontMetrics();
+
+	/** @return The time the scene can wait for events until it needs to be updated or drawn
+	 * again. It takes into account the pending redraw, the running actions and timers, and the
+	 * idle time reported by the nodes subscribed to the scheduled updates. */
+	virtual Time getIdleTime();
+
+	/** Interrupts the wait for events of the scene window, so the main loop updates the scene.
+	 * It can be called from any thread. */
+	void wakeUp();
+
   protected:
 	friend class Node;
 	typedef std::unordered_set<Node*> CloseList;
@@ -136,6 +168,15 @@ class EE_API SceneNode : public Node {
 	std::unordered_set<Node*> mScheduledUpdateRemove;
 	std::unordered_set<Node*> mMouseOverNodes;
 	Float mDPI;
+	bool mCulling;
+	bool mCullTransformed;
+	Rectf mCullRect;
+	bool mPartialRedraw;
+	bool mDamageFull;
+	std::unordered_set<Node*> mDamagedNodes;
+	std::unordered_set<Node*> mFrameBufferNodes;
+	std::vector<Rectf> mDamageRects;
+	TimerWheel mTimers;
 
 	virtual void onSizeChange();
 
@@ -164,6 +205,16 @@ class EE_API SceneNode : public Node {
 	void drawFrameBuffer();
 
 	Sizei getFrameBufferSize();
+
+	bool isDamageTracking() const;
+
+	/** Computes the damaged regions to redraw from the invalidated nodes.
+	 * @return True if only the damaged regions need to be redrawn. */
+	bool updateDamageRects();
+
+	void addDamageRect( Rectf rect );
+
+	void drawDamageRects();
 };
 
 }} // namespace EE::Scene
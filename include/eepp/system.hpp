@@ -27,6 +27,8 @@
 #include <eepp/system/packmanager.hpp>
 #include <eepp/system/pak.hpp>
 #include <eepp/system/process.hpp>
+#include <eepp/system/processreactor.hpp>
+#include <eepp/system/profiler.hpp>
 #include <eepp/system/rc4.hpp>
 #include <eepp/system/resourceloader.hpp>
 #include <eepp/system/resourcemanager.hpp>
@@ -38,6 +40,7 @@
 #include <eepp/system/threadlocalptr.hpp>
 #include <eepp/system/threadpool.hpp>
 #include <eepp/system/time.hpp>
+#include <eepp/system/timerwheel.hpp>
 #include <eepp/system/translator.hpp>
 #include <eepp/system/virtualfilesystem.hpp>
 #include <eepp/system/zip.hpp>
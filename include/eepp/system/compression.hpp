@@ -3,9 +3,13 @@
 
 #include <eepp/config.hpp>
 #include <eepp/system/iostream.hpp>
+#include <memory>
+#include <vector>
 
 namespace EE { namespace System {
 
+class ThreadPool;
+
 class EE_API Compression {
   public:
 	enum Mode { MODE_DEFLATE, MODE_GZIP };
@@ -28,10 +32,33 @@ class EE_API Compression {
 		int level = -1;
 	};
 
+	/** Configuration of the block-parallel compression ( see compressBlocks ). */
+	struct BlocksConfig {
+		/** Size of the uncompressed blocks, each block is compressed independently. */
+		Uint32 blockSize = 131072;
+		/** Number of threads used to compress the blocks, 0 uses the number of CPUs. */
+		Uint32 threads = 0;
+		/** Thread pool used to compress the blocks, if empty a pool is created for the call. */
+		std::shared_ptr<ThreadPool> threadPool;
+		/** Appends the block index that allows random access to the compressed data. */
+		bool writeIndex = true;
+	};
+
 	struct Config {
 		Config() {}
 		ZlibConfig zlib;
 		GzipConfig gzip;
+		BlocksConfig blocks;
+	};
+
+	/** Index of the blocks of a stream compressed with compressBlocks. */
+	struct BlockIndex {
+		/** Total size of the uncompressed data. */
+		Uint64 uncompressedSize = 0;
+		/** Uncompressed size of every block ( except the last one ). */
+		Uint32 blockSize = 0;
+		/** Offset of each block in the compressed stream. */
+		std::vector<Uint64> offsets;
 	};
 
 	static Status compress( Uint8* dst, Uint64 dstMaxSize, const Uint8* src, Uint64 srcSize,
@@ -40,6 +67,21 @@ class EE_API Compression {
 	static Status compress( IOStream& dst, IOStream& src, Mode mode = MODE_DEFLATE,
 							const Config& config = Config() );
 
+	/** @brief Compresses the source in blocks compressed in parallel.
+	 ** The source is split in blocks of Config::blocks.blockSize bytes that are compressed
+	 ** independently on a thread pool and concatenated in order into a single zlib or gzip stream,
+	 ** so the output can be decompressed by any zlib / gzip implementation. Since the blocks don't
+	 ** reference each other, with the block index appended after the stream ( as an empty gzip
+	 ** member in gzip mode ) any block can be decompressed on its own, see
+	 ** IOStreamInflate::isSeekable. The compression ratio is slightly lower than compress.
+	 ** The destination stream must be empty, the block offsets are relative to its start. */
+	static Status compressBlocks( IOStream& dst, IOStream& src, Mode mode = MODE_GZIP,
+								  const Config& config = Config() );
+
+	/** @brief Reads the block index of a stream compressed with compressBlocks.
+	 ** @return False if the stream doesn't contain a block index. */
+	static bool readBlockIndex( IOStream& src, Mode mode, BlockIndex& index );
+
 	static int getMaxCompressedBufferSize( Uint64 srcSize, Mode mode = MODE_DEFLATE,
 										   const Config& config = Config() );
 
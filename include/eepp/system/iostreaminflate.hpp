@@ -12,14 +12,19 @@ struct LocalStreamData;
 /** @brief Implementation of a inflating stream */
 class EE_API IOStreamInflate : public IOStream {
   public:
-	static IOStreamInflate* New( IOStream& inOutStream, Compression::Mode mode );
+	static IOStreamInflate* New( IOStream& inOutStream, Compression::Mode mode,
+								 bool seekable = false );
 
 	/** @brief Use a stream as a input or output buffer
 	**	@param inOutStream Stream where the results will ve loaded or saved.
 	**	It must be used only for reading or writing, can't mix both calls.
 	**	@param mode Compression/Decompression method used
+	**	@param seekable If the input stream was compressed with Compression::compressBlocks, reads
+	**	the block index and allows random access to the uncompressed data: seek, tell and getSize
+	**	work with uncompressed positions, and a read only decompresses the blocks covering the
+	**	requested range. If the stream doesn't have a block index it's read sequentially.
 	*/
-	IOStreamInflate( IOStream& inOutStream, Compression::Mode mode );
+	IOStreamInflate( IOStream& inOutStream, Compression::Mode mode, bool seekable = false );
 
 	virtual ~IOStreamInflate();
 
@@ -37,11 +42,23 @@ class EE_API IOStreamInflate : public IOStream {
 
 	const Compression::Mode& getMode() const;
 
+	/** @return True if the stream allows random access to the uncompressed data. */
+	bool isSeekable() const;
+
   protected:
 	IOStream& mStream;
 	Compression::Mode mMode;
 	ScopedBuffer mBuffer;
 	LocalStreamData* mLocalStream;
+	Compression::BlockIndex mBlockIndex;
+	bool mSeekable;
+	ios_size mPosition;
+	Int64 mCachedBlock;
+	std::vector<Uint8> mBlockBuffer;
+
+	ios_size readBlocks( char* data, ios_size size );
+
+	bool loadBlock( const Uint64& block );
 };
 
 }} // namespace EE::System
@@ -1,12 +1,26 @@
 #ifndef EECLOG_H
 #define EECLOG_H
 
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
 #include <eepp/system/iostreamfile.hpp>
 #include <eepp/system/mutex.hpp>
 #include <eepp/system/singleton.hpp>
 #include <eepp/system/sys.hpp>
+#include <eepp/system/thread.hpp>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
+
+/** Minimum log level compiled in the Log::debug, Log::info, etc helpers. Messages below this level
+ * are removed at compile time ( 0 = LogLevel::Debug keeps every level ). */
+#ifndef EE_LOG_MIN_LEVEL
+#define EE_LOG_MIN_LEVEL 0
+#endif
 
 namespace EE { namespace System {
 
@@ -28,7 +42,12 @@ enum class LogLevel : int {
 	Assert,	  ///< Asserted critical condition.
 };
 
-/** @brief Global log file. The engine will log everything in this file. */
+/** @brief Global log file. The engine will log everything in this file.
+ * By default the log is asynchronous: the writes only format the message and push it into a
+ * lock-free queue owned by the calling thread, and a background thread drains the queues to the
+ * console, the log file and the log readers ( the readers are called from that thread ). The
+ * messages written in memory are kept in a ring capped by setHistoryLimit. Messages with
+ * LogLevel::Critical or higher are flushed before the write returns. */
 class EE_API Log : protected Mutex {
 	SINGLETON_DECLARE_HEADERS( Log )
 
@@ -48,6 +67,11 @@ class EE_API Log : protected Mutex {
 
 	static Log* create( const LogLevel& level, bool consoleOutput, bool liveWrite );
 
+	/** @return True if the level is not removed at compile time by EE_LOG_MIN_LEVEL. */
+	static constexpr bool isLevelCompiled( const LogLevel& level ) {
+		return static_cast<int>( level ) >= EE_LOG_MIN_LEVEL;
+	}
+
 	virtual ~Log();
 
 	/** @brief Indicates that the log must be writed to a file when the Log instance is closed.
@@ -83,17 +107,34 @@ class EE_API Log : protected Mutex {
 	/** @brief Writes a formated string to the log */
 	void writef( const char* format, ... );
 
-	/** @returns A copy of the current writed log. */
+	/** @returns A copy of the log history kept in memory. */
 	std::string getBuffer() const;
 
+	/** @return The maximum size in bytes of the log history kept in memory. */
+	size_t getHistoryLimit() const;
+
+	/** Sets the maximum size in bytes of the log history kept in memory, the oldest messages are
+	 * discarded once exceeded. */
+	void setHistoryLimit( const size_t& limit );
+
+	/** @returns If the writes are processed by the log background thread. */
+	bool isAsync() const;
+
+	/** @brief Enables or disables the log background thread. When disabled every write is
+	 * processed in the calling thread. */
+	void setAsync( const bool& async );
+
+	/** @brief Blocks until every message written by the calling thread has been processed. */
+	void flush();
+
 	/** @returns If the log Writes are outputed to the terminal. */
-	const bool& isConsoleOutput() const;
+	bool isConsoleOutput() const;
 
 	/** @brief Enabled or disables to output the Writes to the terminal. */
 	void setConsoleOutput( const bool& output );
 
 	/** @returns If the file is forced to flush the data on every Write call. */
-	const bool& isLiveWrite() const;
+	bool isLiveWrite() const;
 
 	/** @brief Activate or deactivate to flush the writed data to the log on every Write call. */
 	void setLiveWrite( const bool& lw );
@@ -107,7 +148,13 @@ class EE_API Log : protected Mutex {
 	void removeLogReader( LogReaderInterface* reader );
 
 	/** @return The log level threshold. */
-	const LogLevel& getLogLevelThreshold() const;
+	LogLevel getLogLevelThreshold() const;
+
+	/** @return True if a message of the level would be logged. Can be used to skip building
+	 * expensive log messages. */
+	bool isLoggable( const LogLevel& level ) const {
+		return isLevelCompiled( level ) && level >= mLogLevelThreshold.load();
+	}
 
 	/** Sets the log level threshold. This is the minimum level that message will actually be
 	 * logged. */
@@ -120,79 +167,141 @@ class EE_API Log : protected Mutex {
 	void setFilePath( const std::string& filePath );
 
 	static void debug( const std::string& text ) {
-		Log::instance()->writel( LogLevel::Debug, text );
+		if ( isLevelCompiled( LogLevel::Debug ) )
+			Log::instance()->writel( LogLevel::Debug, text );
 	}
 
 	static void info( const std::string& text ) {
-		Log::instance()->writel( LogLevel::Info, text );
+		if ( isLevelCompiled( LogLevel::Info ) )
+			Log::instance()->writel( LogLevel::Info, text );
 	}
 
 	static void notice( const std::string& text ) {
-		Log::instance()->writel( LogLevel::Notice, text );
+		if ( isLevelCompiled( LogLevel::Notice ) )
+			Log::instance()->writel( LogLevel::Notice, text );
 	}
 
 	static void warning( const std::string& text ) {
-		Log::instance()->writel( LogLevel::Warning, text );
+		if ( isLevelCompiled( LogLevel::Warning ) )
+			Log::instance()->writel( LogLevel::Warning, text );
 	}
 
 	static void error( const std::string& text ) {
-		Log::instance()->writel( LogLevel::Error, text );
+		if ( isLevelCompiled( LogLevel::Error ) )
+			Log::instance()->writel( LogLevel::Error, text );
 	}
 
 	static void critical( const std::string& text ) {
-		Log::instance()->writel( LogLevel::Critical, text );
+		if ( isLevelCompiled( LogLevel::Critical ) )
+			Log::instance()->writel( LogLevel::Critical, text );
 	}
 
 	static void assertLog( const std::string& text ) {
-		Log::instance()->writel( LogLevel::Assert, text );
+		if ( isLevelCompiled( LogLevel::Assert ) )
+			Log::instance()->writel( LogLevel::Assert, text );
 	}
 
 	template <class... Args> static void debug( const char* format, Args&&... args ) {
-		Log::instance()->writef( LogLevel::Debug, format, std::forward<Args>( args )... );
+		if ( isLevelCompiled( LogLevel::Debug ) )
+			Log::instance()->writef( LogLevel::Debug, format, std::forward<Args>( args )... );
 	}
 
 	template <class... Args> static void info( const char* format, Args&&... args ) {
-		Log::instance()->writef( LogLevel::Info, format, std::forward<Args>( args )... );
+		if ( isLevelCompiled( LogLevel::Info ) )
+			Log::instance()->writef( LogLevel::Info, format, std::forward<Args>( args )... );
 	}
 
 	template <class... Args> static void notice( const char* format, Args&&... args ) {
-		Log::instance()->writef( LogLevel::Notice, format, std::forward<Args>( args )... );
+		if ( isLevelCompiled( LogLevel::Notice ) )
+			Log::instance()->writef( LogLevel::Notice, format, std::forward<Args>( args )... );
 	}
 
 	template <class... Args> static void warning( const char* format, Args&&... args ) {
-		Log::instance()->writef( LogLevel::Warning, format, std::forward<Args>( args )... );
+		if ( isLevelCompiled( LogLevel::Warning ) )
+			Log::instance()->writef( LogLevel::Warning, format, std::forward<Args>( args )... );
 	}
 
 	template <class... Args> static void error( const char* format, Args&&... args ) {
-		Log::instance()->writef( LogLevel::Error, format, std::forward<Args>( args )... );
+		if ( isLevelCompiled( LogLevel::Error ) )
+			Log::instance()->writef( LogLevel::Error, format, std::forward<Args>( args )... );
 	}
 
 	template <class... Args> static void critical( const char* format, Args&&... args ) {
-		Log::instance()->writef( LogLevel::Critical, format, std::forward<Args>( args )... );
+		if ( isLevelCompiled( LogLevel::Critical ) )
+			Log::instance()->writef( LogLevel::Critical, format, std::forward<Args>( args )... );
 	}
 
 	template <class... Args> static void assertLog( const char* format, Args&&... args ) {
-		Log::instance()->writef( LogLevel::Assert, format, std::forward<Args>( args )... );
+		if ( isLevelCompiled( LogLevel::Assert ) )
+			Log::instance()->writef( LogLevel::Assert, format, std::forward<Args>( args )... );
 	}
 
   protected:
+	struct Record {
+		Uint64 sequence{ 0 };
+		std::time_t time{ 0 };
+		LogLevel level{ LogLevel::Info };
+		bool timestamp{ false };
+		std::string text;
+	};
+
+	class RecordQueue;
+
+	struct ThreadQueue;
+
 	Log();
 
 	Log( const std::string& logPath, const LogLevel& level, bool consoleOutput, bool liveWrite );
 
-	std::string mData;
+	std::deque<std::string> mHistory;
+	size_t mHistorySize{ 0 };
+	size_t mHistoryLimit;
 	std::string mFilePath;
 	bool mSave;
-	bool mConsoleOutput;
-	bool mLiveWrite;
-	LogLevel mLogLevelThreshold{ getDefaultLogLevel() };
+	std::atomic<bool> mConsoleOutput;
+	std::atomic<bool> mLiveWrite;
+	std::atomic<LogLevel> mLogLevelThreshold{ getDefaultLogLevel() };
 	IOStreamFile* mFS;
 	std::list<LogReaderInterface*> mReaders;
 
+	Uint64 mId;
+	std::atomic<bool> mAsync;
+	std::atomic<Uint64> mSequence{ 0 };
+	std::mutex mQueuesMutex;
+	std::vector<std::shared_ptr<RecordQueue>> mQueues;
+	std::unique_ptr<Thread> mThread;
+	std::atomic<Uint32> mThreadId{ 0 };
+	std::atomic<bool> mThreadStarted{ false };
+	std::mutex mThreadMutex;
+	std::condition_variable mThreadCond;
+	std::condition_variable mFlushCond;
+	bool mRunning{ false };
+	bool mWakeUp{ false };
+	Uint64 mFlushRequest{ 0 };
+	Uint64 mFlushed{ 0 };
+
 	void openFS();
 
 	void closeFS();
 
+	void push( Record&& record );
+
+	RecordQueue* getThreadQueue();
+
+	void wakeUp();
+
+	void startThread();
+
+	void stopThread();
+
+	void run();
+
+	void drain( std::vector<Record>& records );
+
+	void process( std::vector<Record>& records );
+
+	void writeToConsole( const std::string& text );
+
 	void writeToReaders( const std::string& text );
 };
 
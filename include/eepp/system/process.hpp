@@ -5,11 +5,16 @@
 #include <eepp/system/mutex.hpp>
 #include <functional>
 #include <map>
+#include <memory>
 #include <string>
 #include <thread>
 
 namespace EE { namespace System {
 
+namespace Private {
+struct ProcessIOState;
+}
+
 class EE_API Process {
   public:
 	enum Options {
@@ -62,7 +67,10 @@ class EE_API Process {
 				 const std::map<std::string, std::string>& environment = {},
 				 const std::string& workingDirectory = "" );
 
-	/** @brief Starts a new thread to receive all stdout and stderr data */
+	/** @brief Starts receiving all stdout and stderr data asynchronously.
+	 ** On Linux the pipes are serviced by the shared ProcessReactor thread, and the writes to
+	 ** stdin become non-blocking ( queued and flushed by the reactor ). On other platforms a
+	 ** reader thread is started per process. */
 	void startAsyncRead( ReadFn readStdOut = nullptr, ReadFn readStdErr = nullptr );
 
 	/** @brief Read all standard output from the child process.
@@ -201,6 +209,7 @@ class EE_API Process {
 	Mutex mStdInMutex;
 	ReadFn mReadStdOutFn;
 	ReadFn mReadStdErrFn;
+	std::shared_ptr<Private::ProcessIOState> mIOState;
 };
 
 }} // namespace EE::System
@@ -0,0 +1,118 @@
+#ifndef EE_SYSTEM_PROCESSREACTOR_HPP
+#define EE_SYSTEM_PROCESSREACTOR_HPP
+
+#include <atomic>
+#include <eepp/config.hpp>
+#include <eepp/system/singleton.hpp>
+#include <eepp/system/thread.hpp>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace EE { namespace System {
+
+class Process;
+
+namespace Private {
+struct ProcessIOState;
+}
+
+/** @brief Drives the standard streams of every asynchronous Process from a single thread.
+ *
+ * Instead of running a reader thread per child process, the stdout and stderr pipes of all the
+ * processes started with Process::startAsyncRead are watched by one epoll instance and read into
+ * a reusable buffer. Writes to the stdin of the processes are non-blocking: the data that doesn't
+ * fit in the pipe is queued and flushed by the reactor thread when the child consumes its input.
+ * Once the queue of a process exceeds the write queue limit the writer blocks until the queue
+ * drains ( backpressure ), except when writing from the reactor thread itself ( from a read
+ * callback ) where it only queues.
+ * The reactor thread is started with the first process registered, the number of threads doesn't
+ * depend on the number of processes.
+ *
+ * Only available on Linux, on the other platforms Process keeps its reader threads.
+ */
+class EE_API ProcessReactor {
+	SINGLETON_DECLARE_HEADERS( ProcessReactor )
+
+  public:
+	typedef std::function<void( const char* bytes, size_t n )> ReadFn;
+
+	/** @return True if the platform supports the reactor. */
+	static bool isSupported();
+
+	~ProcessReactor();
+
+	/** @return The number of processes being serviced. */
+	size_t getProcessCount() const;
+
+	/** @return The number of worker threads running ( one or zero ). */
+	Uint32 getThreadCount() const;
+
+	/** Sets the maximum number of bytes queued for the stdin of a process before the writer
+	 * blocks. */
+	void setWriteQueueLimit( const size_t& limit );
+
+	size_t getWriteQueueLimit() const;
+
+  protected:
+	friend class Process;
+
+	ProcessReactor();
+
+	/** Registers the pipes of a process.
+	 * @param stdOutFd The stdout file descriptor.
+	 * @param stdErrFd The stderr file descriptor, -1 if it's combined with stdout.
+	 * @param stdInFd The stdin file descriptor, -1 if not available.
+	 * @return The process state, or nullptr if the pipes couldn't be registered. */
+	std::shared_ptr<Private::ProcessIOState> add( int stdOutFd, int stdErrFd, int stdInFd,
+												  const ReadFn& readStdOut,
+												  const ReadFn& readStdErr,
+												  const size_t& bufferSize );
+
+	/** Unregisters the pipes of a process. Once it returns no callback of the process is running
+	 * or will be called. */
+	void remove( const std::shared_ptr<Private::ProcessIOState>& state );
+
+	/** Stops delivering the output of a process and wakes up its blocked writers. */
+	void close( const std::shared_ptr<Private::ProcessIOState>& state );
+
+	size_t write( const std::shared_ptr<Private::ProcessIOState>& state, const char* buffer,
+				  const size_t& size );
+
+	void reactorLoop();
+
+	void unregisterFd( int fd );
+
+	void dispatchRead( const std::shared_ptr<Private::ProcessIOState>& state, int fd,
+					   bool isStdOut );
+
+	void dispatchWrite( const std::shared_ptr<Private::ProcessIOState>& state, bool hangUp );
+
+	void armWrite( const std::shared_ptr<Private::ProcessIOState>& state );
+
+	bool isReactorThread() const;
+
+	struct Channel {
+		std::shared_ptr<Private::ProcessIOState> state;
+		bool isStdOut;
+		bool isStdIn;
+	};
+
+	int mEpollFd;
+	int mWakeUpFd;
+	std::unique_ptr<Thread> mThread;
+	mutable std::mutex mMutex;
+	std::unordered_map<int, Channel> mChannels;
+	std::string mBuffer;
+	size_t mBufferSize;
+	std::atomic<size_t> mWriteQueueLimit;
+	std::atomic<Uint32> mThreadId;
+	size_t mProcessCount;
+	bool mShuttingDown;
+};
+
+}} // namespace EE::System
+
+#endif
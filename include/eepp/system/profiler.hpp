@@ -0,0 +1,168 @@
+#ifndef EE_SYSTEM_PROFILER_HPP
+#define EE_SYSTEM_PROFILER_HPP
+
+#include <atomic>
+#include <eepp/config.hpp>
+#include <eepp/system/mutex.hpp>
+#include <eepp/system/singleton.hpp>
+#include <eepp/system/time.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** The profiling macros are only compiled in debug builds or when EE_PROFILER is defined
+ * ( premake option "--with-profiler" ). */
+#if defined( EE_PROFILER ) || defined( EE_DEBUG )
+#define EE_PROFILER_ENABLED
+#endif
+
+#define EE_PROFILER_CONCAT_IMPL( a, b ) a##b
+#define EE_PROFILER_CONCAT( a, b ) EE_PROFILER_CONCAT_IMPL( a, b )
+
+#ifdef EE_PROFILER_ENABLED
+/** Profiles the current scope. The name must be a string literal ( or any string that outlives the
+ * profiler ). */
+#define eePROFILE_SCOPE( name ) \
+	EE::System::ProfilerZone EE_PROFILER_CONCAT( eeProfilerZone, __LINE__ )( name )
+/** Profiles the current function. */
+#define eePROFILE_FUNCTION() eePROFILE_SCOPE( __FUNCTION__ )
+/** Marks the end of a frame of the calling thread. */
+#define eePROFILE_FRAME_MARK() EE::System::Profiler::frameMark()
+/** Sets the name displayed in the trace for the calling thread. */
+#define eePROFILE_THREAD_NAME( name ) EE::System::Profiler::setThreadName( name )
+#else
+#define eePROFILE_SCOPE( name )
+#define eePROFILE_FUNCTION()
+#define eePROFILE_FRAME_MARK()
+#define eePROFILE_THREAD_NAME( name )
+#endif
+
+namespace EE { namespace System {
+
+/** @brief Hierarchical scoped zones profiler.
+ * The zones are recorded with the eePROFILE_* macros into a ring buffer owned by each thread, so
+ * recording a zone never locks a shared mutex. The zones are only recorded while the profiler is
+ * running, otherwise a zone costs an atomic load.
+ * The recorded zones can be exported as a Chrome trace ( JSON Trace Event Format ) loadable by
+ * chrome://tracing or https://ui.perfetto.dev.
+ * Setting the environment variable EEPP_PROFILER_TRACE to a file path starts the profiler when
+ * the engine is created and exports the trace to that path when it's destroyed, which also works
+ * for headless runs. */
+class EE_API Profiler {
+	SINGLETON_DECLARE_HEADERS( Profiler )
+
+  public:
+	/** Time spent on a zone during the last frame. */
+	struct ZoneStats {
+		const char* name;
+		Time time;
+		Uint32 count;
+	};
+
+	static constexpr bool isCompiledIn() {
+#ifdef EE_PROFILER_ENABLED
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/** @return True if the zones are being recorded. */
+	static bool isRunning() { return sRunning.load( std::memory_order_relaxed ); }
+
+	/** @return The profiler clock time in nanoseconds. */
+	static Int64 now();
+
+	/** Opens a zone of the calling thread.
+	 * @return The nesting depth of the zone. */
+	static Uint32 enterZone();
+
+	/** Closes and records a zone of the calling thread. */
+	static void leaveZone( const char* name, const Int64& start, const Uint32& depth );
+
+	/** Marks the end of a frame of the calling thread, computing the zone stats of the frame. */
+	static void frameMark();
+
+	/** Sets the name of the calling thread. */
+	static void setThreadName( const std::string& name );
+
+	~Profiler();
+
+	/** Starts recording zones. */
+	void start();
+
+	/** Stops recording zones, the recorded zones are kept until cleared. */
+	void stop();
+
+	/** Removes all the recorded zones. */
+	void clear();
+
+	/** @return The number of zones that each thread ring buffer can keep. */
+	size_t getRingCapacity() const;
+
+	/** Sets the number of zones that each thread ring buffer can keep. Only applies to the rings
+	 * created after the call. */
+	void setRingCapacity( const size_t& capacity );
+
+	/** @return The zones stats of the last frame marked, sorted by time. */
+	std::vector<ZoneStats> getLastFrameStats() const;
+
+	/** @return The time of the last frame marked. */
+	Time getLastFrameTime() const;
+
+	/** @return The recorded zones as a Chrome trace. */
+	std::string toChromeTrace() const;
+
+	/** Writes the recorded zones as a Chrome trace to the path. */
+	bool exportChromeTrace( const std::string& path ) const;
+
+	/** @return The path where the trace will be exported when the profiler is destroyed. */
+	const std::string& getTracePath() const;
+
+	/** Sets the path where the trace will be exported when the profiler is destroyed. An empty
+	 * path disables the export. */
+	void setTracePath( const std::string& path );
+
+  protected:
+	struct ThreadRing;
+
+	static std::atomic<bool> sRunning;
+
+	Profiler();
+
+	mutable Mutex mMutex;
+	std::vector<std::shared_ptr<ThreadRing>> mRings;
+	size_t mRingCapacity;
+	std::vector<ZoneStats> mLastFrameStats;
+	Time mLastFrameTime;
+	std::string mTracePath;
+	Uint64 mId;
+
+	static ThreadRing* getThreadRing( const bool& create = true );
+};
+
+/** @brief Records the scope as a profiler zone. Use eePROFILE_SCOPE instead of this class. */
+class EE_API ProfilerZone {
+  public:
+	explicit ProfilerZone( const char* name ) :
+		mName( Profiler::isRunning() ? name : nullptr ) {
+		if ( mName ) {
+			mDepth = Profiler::enterZone();
+			mStart = Profiler::now();
+		}
+	}
+
+	~ProfilerZone() {
+		if ( mName )
+			Profiler::leaveZone( mName, mStart, mDepth );
+	}
+
+  protected:
+	const char* mName;
+	Int64 mStart{ 0 };
+	Uint32 mDepth{ 0 };
+};
+
+}} // namespace EE::System
+
+#endif
@@ -38,6 +38,8 @@ class EE_API Time {
 
 	static const Time Zero; ///< Predefined "zero" time value
 
+	static const Time Infinity; ///< Predefined "infinite" time value ( the maximum time value )
+
 	/** Converts the time into a human readable string. */
 	std::string toString() const;
 
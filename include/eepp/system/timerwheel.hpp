@@ -0,0 +1,86 @@
+#ifndef EE_SYSTEM_TIMERWHEEL_HPP
+#define EE_SYSTEM_TIMERWHEEL_HPP
+
+#include <eepp/config.hpp>
+#include <eepp/core/noncopyable.hpp>
+#include <eepp/system/clock.hpp>
+#include <eepp/system/mutex.hpp>
+#include <eepp/system/time.hpp>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace EE { namespace System {
+
+/** @brief Schedules callbacks to be run after a delay or periodically.
+ *
+ * Timers are hashed into a fixed number of slots by its expiration tick ( a hashed timing wheel ),
+ * so adding, removing and expiring timers don't depend on the number of timers scheduled. Timers
+ * that expire after more than one revolution of the wheel are checked every time their slot is
+ * visited. The timers are only expired when TimerWheel::update is called, the callbacks are run
+ * in the thread that calls it and outside of the wheel lock, so they can add and remove timers.
+ * Timers can be added and removed from any thread. */
+class EE_API TimerWheel : NonCopyable {
+  public:
+	typedef std::function<void()> Callback;
+
+	/** @param resolution The duration of a wheel tick, timers expire in the first tick after its
+	 * delay.
+	 * @param slots Number of slots of the wheel. */
+	explicit TimerWheel( const Time& resolution = Milliseconds( 4 ), const Uint32& slots = 256 );
+
+	/** Schedules a timer.
+	 * @param callback The callback to run once the timer expires.
+	 * @param delay The time to wait until the timer expires.
+	 * @param repeat If true the timer is scheduled again every time it expires, until it's removed.
+	 * @param owner An optional owner of the timer, used to remove all the timers of an owner.
+	 * @return The timer id, never 0. */
+	Uint64 add( const Callback& callback, const Time& delay, bool repeat = false,
+				void* owner = NULL );
+
+	/** Removes a timer. @return True if the timer was scheduled. */
+	bool remove( const Uint64& id );
+
+	/** Removes all the timers of an owner. */
+	void removeOwner( void* owner );
+
+	/** @return True if the timer is scheduled. */
+	bool exists( const Uint64& id ) const;
+
+	/** Expires the timers due and runs its callbacks. */
+	void update();
+
+	/** @return The time until the next timer expires, Time::Zero if a timer is due and
+	 * Time::Infinity if there are no timers scheduled. */
+	Time getTimeUntilNext() const;
+
+	std::size_t count() const;
+
+	bool isEmpty() const;
+
+	void clear();
+
+  protected:
+	struct Timer {
+		Callback callback;
+		Uint64 expiration;
+		Uint64 interval;
+		void* owner;
+	};
+
+	Clock mClock;
+	Int64 mResolution;
+	Uint64 mTick;
+	Uint64 mLastId;
+	std::vector<std::vector<Uint64>> mSlots;
+	std::unordered_map<Uint64, Timer> mTimers;
+	mutable Mutex mMutex;
+
+	Uint64 getCurrentTick() const;
+
+	void schedule( const Uint64& id, const Uint64& expiration );
+};
+
+}} // namespace EE::System
+
+#endif
@@ -70,6 +70,8 @@
 
 #include <eepp/ui/doc/syntaxdefinitionmanager.hpp>
 #include <eepp/ui/doc/textdocument.hpp>
+#include <eepp/ui/doc/textsearchindex.hpp>
+#include <eepp/ui/doc/visuallineindex.hpp>
 
 #include <eepp/ui/tools/textureatlaseditor.hpp>
 #include <eepp/ui/tools/uicodeeditorsplitter.hpp>
@@ -132,10 +132,24 @@ class EE_API MediaQuery {
 
 	MediaQuery( const MediaQuery& val );
 
+	/** Creates a media query from its parsed parts ( used to restore a cached style sheet ). */
+	MediaQuery( bool negated, MediaType mediaType,
+				const MediaQueryExpression::vector& expressions );
+
 	static MediaQuery::ptr parse( const std::string& str );
 
+	/** @return The DPI of the current display, the lengths of the media queries are converted to
+	 * pixels with it when they're parsed. */
+	static Float getDisplayDPI();
+
 	bool check( const MediaFeatures& features ) const;
 
+	bool isNegated() const { return mNot; }
+
+	const MediaType& getMediaType() const { return mMediaType; }
+
+	const MediaQueryExpression::vector& getExpressions() const { return mExpressions; }
+
   private:
 	MediaQueryExpression::vector mExpressions;
 	bool mNot;
@@ -151,8 +165,14 @@ class EE_API MediaQueryList {
 
 	MediaQueryList( const MediaQueryList& val );
 
+	/** Creates a media query list from its parsed queries ( used to restore a cached style
+	 * sheet ). */
+	MediaQueryList( const std::string& queryStr, const MediaQuery::vector& queries );
+
 	static MediaQueryList::ptr parse( const std::string& str );
 
+	const MediaQuery::vector& getQueries() const { return mQueries; }
+
 	bool isUsed() const;
 
 	bool applyMediaFeatures( const MediaFeatures& features ); // returns true if the isUsed changed
@@ -38,14 +38,28 @@ class EE_API StyleSheetParser {
 
 	const bool& isLoaded() const;
 
+	/** Sets the directory where the parsed style sheets are cached in a compact binary form. The
+	 * cache entries are indexed by the path, size and modification time of the style sheet file
+	 * ( or the hash of the CSS loaded from memory ), and the imported files are validated by size
+	 * and modification time. Loading a style sheet that didn't change ( including its imported
+	 * files ) since it was cached skips reading and parsing the CSS, the selectors and media
+	 * queries are restored already parsed. The entries older than 30 days are evicted when the
+	 * path is set, and so are the oldest ones while the cache exceeds 16 MiB. An empty path
+	 * disables the cache ( the default ). */
+	static void setCachePath( const std::string& path );
+
+	static const std::string& getCachePath();
+
   protected:
 	enum ReadState { ReadingSelector, ReadingProperty, ReadingComment };
 
 	std::string mCSS;
 	StyleSheet mStyleSheet;
 	std::vector<std::string> mComments;
+	std::vector<std::string> mMissingImports;
 	MediaQueryList::ptr mMediaQueryList;
 	bool mLoaded;
+	bool mUseCache;
 
 	bool parse( std::string& css, std::vector<std::string>& importedList );
 
@@ -64,6 +78,17 @@ class EE_API StyleSheetParser {
 					  std::vector<std::string>& importedList );
 
 	void keyframesParse( std::string& css, ReadState& rs, std::size_t& pos, std::string& buffer );
+
+	/** @param cacheKey Empty to identify the style sheet by the hash of its CSS. */
+	bool loadFromStream( IOStream& stream, std::string cacheKey );
+
+	bool isCacheEnabled( const Uint64& size ) const;
+
+	std::string getCacheFilePath( const std::string& cacheKey ) const;
+
+	bool loadFromCache( const std::string& cacheFile );
+
+	bool saveToCache( const std::string& cacheFile, const std::vector<std::string>& importedList );
 };
 
 }}} // namespace EE::UI::CSS
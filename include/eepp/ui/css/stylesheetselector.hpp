@@ -15,6 +15,10 @@ class EE_API StyleSheetSelector {
 
 	explicit StyleSheetSelector( const std::string& selectorName );
 
+	/** Creates a selector from its parsed rules ( used to restore a cached style sheet ). */
+	StyleSheetSelector( const std::string& selectorName,
+						const std::vector<StyleSheetSelectorRule>& rules );
+
 	const std::string& getName() const;
 
 	const Uint32& getSpecificity() const;
@@ -32,6 +36,8 @@ class EE_API StyleSheetSelector {
 
 	const StyleSheetSelectorRule& getRule( const Uint32& index );
 
+	const std::vector<StyleSheetSelectorRule>& getRules() const;
+
 	const std::string& getSelectorId() const;
 
 	const std::string& getSelectorTagName() const;
@@ -48,6 +54,8 @@ class EE_API StyleSheetSelector {
 						  const StyleSheetSelectorRule::PatternMatch& newPatternMatch );
 
 	void parseSelector( std::string selector );
+
+	void updateCacheable();
 };
 
 }}} // namespace EE::UI::CSS
@@ -50,6 +50,13 @@ class EE_API StyleSheetSelectorRule {
 
 	StyleSheetSelectorRule( const std::string& selectorFragment, PatternMatch mPatternMatch );
 
+	/** Creates a rule from its parsed parts ( used to restore a cached style sheet ). */
+	StyleSheetSelectorRule( PatternMatch patternMatch, const int& specificity,
+							const std::string& tagName, const std::string& id,
+							const std::vector<std::string>& classes,
+							const std::vector<std::string>& pseudoClasses,
+							const std::vector<std::string>& structuralPseudoClasses );
+
 	void pushSelectorTypeIdentifier( TypeIdentifier selectorTypeIdentifier, std::string name );
 
 	void parseFragment( const std::string& selectorFragment );
@@ -78,6 +85,8 @@ class EE_API StyleSheetSelectorRule {
 
 	const std::string& getId() const;
 
+	const std::vector<std::string>& getClasses() const;
+
   protected:
 	int mSpecificity;
 	PatternMatch mPatternMatch;
@@ -88,6 +97,10 @@ class EE_API StyleSheetSelectorRule {
 	std::vector<std::string> mStructuralPseudoClasses;
 	std::vector<StructuralSelector> mStructuralSelectors;
 	Uint32 mRequirementFlags;
+
+	void addStructuralPseudoClass( const std::string& pseudoClass );
+
+	void updateRequirementFlags();
 };
 
 }}} // namespace EE::UI::CSS
@@ -19,6 +19,11 @@ class EE_API StyleSheetStyle {
 							  const StyleSheetVariables& variables,
 							  MediaQueryList::ptr mediaQueryList );
 
+	explicit StyleSheetStyle( const StyleSheetSelector& selector,
+							  const StyleSheetProperties& properties,
+							  const StyleSheetVariables& variables,
+							  MediaQueryList::ptr mediaQueryList );
+
 	std::string build( bool emmitMediaQueryStart = true, bool emmitMediaQueryEnd = true );
 
 	const StyleSheetSelector& getSelector() const;
@@ -26,6 +26,8 @@ class EE_API SyntaxHighlighter {
 
 	const std::vector<SyntaxToken>& getLine( const size_t& index );
 
+	const TokenizedLine& getTokenizedLine( const size_t& index );
+
 	Int64 getFirstInvalidLine() const;
 
 	Int64 getMaxWantedLine() const;
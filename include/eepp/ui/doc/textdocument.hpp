@@ -18,6 +18,7 @@
 #include <eepp/ui/doc/undostack.hpp>
 #include <functional>
 #include <map>
+#include <memory>
 #include <unordered_set>
 #include <vector>
 
@@ -31,6 +32,8 @@ struct DocumentContentChange {
 	String text;
 };
 
+class TextSearchIndex;
+
 class EE_API TextDocument {
   public:
 	typedef std::function<void()> DocumentCommand;
@@ -335,6 +338,10 @@ class EE_API TextDocument {
 
 	TextPosition replaceSelection( const String& replace );
 
+	/** @return The match engine of the document, used by the find and replace functions and
+	 * to highlight the matches of a text. */
+	TextSearchIndex& getSearchIndex();
+
 	TextPosition replace( String search, const String& replace, TextPosition from = { 0, 0 },
 						  const bool& caseSensitive = true, const bool& wholeWord = false,
 						  const FindReplaceType& type = FindReplaceType::Normal,
@@ -486,6 +493,7 @@ class EE_API TextDocument {
 	Client* mActiveClient{ nullptr };
 	mutable Mutex mLoadingMutex;
 	mutable Mutex mLoadingFilePathMutex;
+	std::unique_ptr<TextSearchIndex> mSearchIndex;
 
 	void initializeCommands();
 
@@ -0,0 +1,126 @@
+#ifndef EE_UI_DOC_TEXTSEARCHINDEX_HPP
+#define EE_UI_DOC_TEXTSEARCHINDEX_HPP
+
+#include <eepp/core/string.hpp>
+#include <eepp/ui/doc/textdocument.hpp>
+#include <eepp/ui/doc/textrange.hpp>
+#include <vector>
+
+namespace EE { namespace UI { namespace Doc {
+
+/** @brief Match engine attached to a TextDocument.
+ *
+ * Keeps a case folded shadow of the document lines, built on demand and updated only for the
+ * lines touched by each DocumentContentChange, so the case insensitive searches don't need to
+ * fold every line they visit.
+ * It also caches the matches of the last queries ( text and search options ). Every query keeps
+ * the window of lines already scanned, the window grows as new lines are requested ( the visible
+ * lines, the minimap lines or the whole document for find all ) and when the document changes
+ * only the edited lines are scanned again, the matches after them are just moved.
+ * Queries that span several lines are not indexed.
+ */
+class EE_API TextSearchIndex {
+  public:
+	struct Query {
+		String text;
+		bool caseSensitive{ true };
+		bool wholeWord{ false };
+		TextDocument::FindReplaceType type{ TextDocument::FindReplaceType::Normal };
+
+		bool operator==( const Query& other ) const {
+			return caseSensitive == other.caseSensitive && wholeWord == other.wholeWord &&
+				   type == other.type && text == other.text;
+		}
+	};
+
+	/** @return True if the query can be resolved line by line. */
+	static bool isIndexable( const Query& query );
+
+	explicit TextSearchIndex( TextDocument* doc );
+
+	/** @return The matches of the query that start in the lines between fromLine and toLine,
+	 * sorted by position. A negative toLine means the last line of the document. */
+	std::vector<TextRange> getMatches( Query query, Int64 fromLine = 0, Int64 toLine = -1 );
+
+	/** Finds the first match of a query in a line.
+	 * @param startCol The first column where the match can start.
+	 * @param endCol The column where the match must end at most.
+	 * @return The start and end columns of the match, or npos if not found. */
+	std::pair<size_t, size_t> findInLine( const Query& query, const Int64& line, size_t startCol,
+										  size_t endCol = String::StringType::npos );
+
+	/** Finds the last match of a query in a line.
+	 * @param startCol The first column where the match can start.
+	 * @param endCol The column where the match must end at most.
+	 * @return The start and end columns of the match, or npos if not found. */
+	std::pair<size_t, size_t> findLastInLine( const Query& query, const Int64& line,
+											  size_t startCol,
+											  size_t endCol = String::StringType::npos );
+
+	/** @return The text of the line folded to lower case. */
+	const String& getFoldedLine( const Int64& index );
+
+	/** Must be called after each change of the document text. */
+	void onTextChanged( const DocumentContentChange& change );
+
+	/** Drops the cached matches and the folded lines. */
+	void invalidate();
+
+	/** Sets the maximum number of queries kept in the cache ( 8 by default ). */
+	void setMaxCachedQueries( const size_t& maxCachedQueries );
+
+	const size_t& getMaxCachedQueries() const;
+
+	/** @return The number of queries being cached. */
+	size_t getCachedQueriesCount() const;
+
+  protected:
+	struct FoldedLine {
+		String text;
+		String::HashType hash{ 0 };
+		bool valid{ false };
+
+		FoldedLine() {}
+
+		// String can only be copied, swap it so inserting or removing lines doesn't copy the
+		// folded text of every following line.
+		FoldedLine( FoldedLine&& other ) noexcept : hash( other.hash ), valid( other.valid ) {
+			text.swap( other.text );
+		}
+
+		FoldedLine& operator=( FoldedLine&& other ) noexcept {
+			text.swap( other.text );
+			hash = other.hash;
+			valid = other.valid;
+			return *this;
+		}
+	};
+
+	struct Entry {
+		Query query;
+		Int64 fromLine{ 0 };
+		Int64 toLine{ -1 };
+		std::vector<TextRange> matches;
+		Uint64 lastUse{ 0 };
+	};
+
+	TextDocument* mDoc;
+	std::vector<FoldedLine> mFoldedLines;
+	std::vector<Entry> mEntries;
+	Int64 mLineCount;
+	Uint64 mUseCount{ 0 };
+	size_t mMaxCachedQueries{ 8 };
+
+	Entry& getEntry( const Query& query );
+
+	const String& getLineText( const Query& query, const Int64& line );
+
+	void scanLines( const Query& query, Int64 fromLine, Int64 toLine,
+					std::vector<TextRange>& matches );
+
+	void scanWindow( Entry& entry, Int64 fromLine, Int64 toLine );
+};
+
+}}} // namespace EE::UI::Doc
+
+#endif
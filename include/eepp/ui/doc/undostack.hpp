@@ -1,12 +1,14 @@
 #ifndef EE_UI_DOC_UNDOSTACK_HPP
 #define EE_UI_DOC_UNDOSTACK_HPP
 
-#include <deque>
 #include <eepp/config.hpp>
 #include <eepp/core/string.hpp>
+#include <eepp/system/iostreamfile.hpp>
 #include <eepp/system/time.hpp>
+#include <atomic>
 #include <eepp/ui/doc/textrange.hpp>
 #include <memory>
+#include <vector>
 
 using namespace EE::System;
 
@@ -16,63 +18,115 @@ class TextDocument;
 
 enum class TextUndoCommandType { Insert, Remove, Selection };
 
-class EE_API TextUndoCommand {
-  public:
-	TextUndoCommand( const Uint64& id, const TextUndoCommandType& type, const Time& timestamp );
+/** A decoded undo journal record.
+ * - Insert: inserts text at range.start().
+ * - Remove: removes the range.
+ * - Selection: restores the selection stored in range. */
+struct EE_API TextUndoCommand {
+	Uint64 id{ 0 };
+	TextUndoCommandType type{ TextUndoCommandType::Selection };
+	/** Time of the last edit merged into the record. */
+	Time timestamp;
+	/** Time of the first edit merged into the record. */
+	Time startTimestamp;
+	TextRange range;
+	/** UTF-8 text of the insert records. */
+	std::string text;
+};
 
-	virtual ~TextUndoCommand();
+/** @brief Stack of undo records stored as a contiguous byte journal.
+ * Every record is serialized as a fixed header followed by its UTF-8 text and its total size, so
+ * the journal can be walked backwards from the top. The memory used is bounded, once exceeded
+ * the oldest records are discarded or, if a spill file is set, moved to disk and loaded back
+ * when the stack reaches them. */
+class EE_API TextUndoJournal {
+  public:
+	TextUndoJournal( const size_t& maxMemory );
 
-	const Uint64& getId() const;
+	~TextUndoJournal();
 
-	const TextUndoCommandType& getType() const;
+	bool empty() const;
 
-	const Time& getTimestamp() const;
+	/** @return The number of records in the journal ( including the spilled ones ). */
+	size_t size() const;
 
-  protected:
-	Uint64 mId;
-	TextUndoCommandType mType;
-	Time mTimestamp;
-};
+	/** @return The memory used by the records kept in memory. */
+	size_t getMemoryUsage() const;
 
-class EE_API TextUndoCommandInsert : public TextUndoCommand {
-  public:
-	TextUndoCommandInsert( const Uint64& id, const String& text, const TextPosition& position,
-						   const Time& timestamp );
+	const size_t& getMaxMemory() const;
 
-	const String& getText() const;
+	void setMaxMemory( const size_t& maxMemory );
 
-	const TextPosition& getPosition() const;
+	/** Sets the file used to spill the oldest records. An empty path disables spilling. */
+	void setSpillPath( const std::string& path );
 
-  protected:
-	String mText;
-	TextPosition mPosition;
-};
+	const std::string& getSpillPath() const;
 
-class EE_API TextUndoCommandRemove : public TextUndoCommand {
-  public:
-	TextUndoCommandRemove( const Uint64& id, const TextRange& range, const Time& timestamp );
+	void push( const TextUndoCommand& cmd );
 
-	const TextRange& getRange() const;
+	/** Decodes the top record.
+	 * @return False if the journal is empty. */
+	bool back( TextUndoCommand& cmd );
 
-  protected:
-	TextRange mRange;
-};
+	/** @return The id of the top record, 0 if empty. It's kept up to date on every change, so
+	 * it never loads the spilled records and it can be read from any thread. */
+	Uint64 backId() const;
 
-class EE_API TextUndoCommandSelection : public TextUndoCommand {
-  public:
-	TextUndoCommandSelection( const Uint64& id, const TextRange& selection, const Time& timestamp );
+	void pop();
 
-	const TextRange& getSelection() const;
+	void clear();
 
   protected:
-	TextRange mSelection;
+	friend class UndoStack;
+
+	struct Header {
+		Uint64 id;
+		Int64 timestamp;
+		Int64 startTimestamp;
+		Int64 startLine;
+		Int64 startColumn;
+		Int64 endLine;
+		Int64 endColumn;
+		Uint32 textSize;
+		Uint32 type;
+	};
+
+	struct SpillChunk {
+		Uint64 size;
+		size_t count;
+		/** The id of the last record of the chunk. */
+		Uint64 backId;
+	};
+
+	std::vector<Uint8> mData;
+	size_t mBegin{ 0 };
+	size_t mCount{ 0 };
+	size_t mMaxMemory;
+	std::string mSpillPath;
+	std::unique_ptr<IOStreamFile> mSpillFile;
+	std::vector<SpillChunk> mSpillChunks;
+	Uint64 mSpillSize{ 0 };
+	size_t mSpillCount{ 0 };
+	std::atomic<Uint64> mBackId{ 0 };
+
+	bool backHeader( Header& header, size_t& offset );
+
+	void trim();
+
+	bool spill( const size_t& bytes );
+
+	bool unspill();
+
+	void closeSpillFile();
+
+	void updateBackId();
 };
 
-using UndoStackContainer = std::deque<TextUndoCommand*>;
+using UndoStackContainer = TextUndoJournal;
 
 class EE_API UndoStack {
   public:
-	UndoStack( TextDocument* owner, const Uint32& maxStackSize = 10000 );
+	UndoStack( TextDocument* owner, const size_t& maxMemory = 64 * 1024 * 1024 );
 
 	~UndoStack();
 
@@ -90,7 +144,19 @@ class EE_API UndoStack {
 
 	bool hasRedo() const;
 
-	const Uint32& getMaxStackSize() const;
+	/** @return The maximum memory used by the undo and redo stacks, each one. */
+	const size_t& getMaxMemory() const;
+
+	void setMaxMemory( const size_t& maxMemory );
+
+	/** @return The memory used by the undo and redo stacks. */
+	size_t getMemoryUsage() const;
+
+	/** Sets the file used to spill the oldest undo history once the memory limit is reached. An
+	 * empty path disables spilling and the oldest history is discarded. */
+	void setSpillPath( const std::string& path );
+
+	const std::string& getSpillPath() const;
 
 	const Time& getMergeTimeout() const;
 
@@ -102,14 +168,13 @@ class EE_API UndoStack {
 	friend class TextDocument;
 
 	TextDocument* mDoc;
-	Uint32 mMaxStackSize;
+	size_t mMaxMemory;
 	Uint64 mChangeIdCounter;
+	Uint64 mMergeBarrierId;
 	UndoStackContainer mUndoStack;
 	UndoStackContainer mRedoStack;
 	Time mMergeTimeout;
 
-	void pushUndo( UndoStackContainer& undoStack, TextUndoCommand* cmd );
-
 	void pushInsert( UndoStackContainer& undoStack, const String& string,
 					 const TextPosition& position, const Time& time );
 
@@ -118,6 +183,11 @@ class EE_API UndoStack {
 	void pushSelection( UndoStackContainer& undoStack, const TextRange& selection,
 						const Time& time );
 
+	bool tryMerge( UndoStackContainer& undoStack, const TextUndoCommand& cmd );
+
+	/** Prevents the current top record from being extended by the next edits. */
+	void setMergeBarrier();
+
 	UndoStackContainer& getUndoStackContainer();
 
 	UndoStackContainer& getRedoStackContainer();
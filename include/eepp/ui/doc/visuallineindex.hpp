@@ -0,0 +1,95 @@
+#ifndef EE_UI_DOC_VISUALLINEINDEX_HPP
+#define EE_UI_DOC_VISUALLINEINDEX_HPP
+
+#include <cstddef>
+#include <eepp/config.hpp>
+#include <vector>
+
+namespace EE { namespace UI { namespace Doc {
+
+/** @brief Maps the lines of a document to the visual rows they use once soft wrapped.
+ *
+ * The lines are stored in blocks of a few hundred lines, and the number of lines and rows of
+ * every block are kept in Fenwick trees ( binary indexed trees ). Resolving the first row of a
+ * line, the line that contains a row, and wrapping a line again costs O(log n) plus a scan of a
+ * single block. Inserting or removing lines only moves the lines of the blocks touched.
+ *
+ * A line is unmeasured until its number of rows is set, an unmeasured line uses one row. A new
+ * index and the inserted lines are unmeasured, and invalidate() marks every line as unmeasured
+ * in O(number of blocks), so the lines can be measured lazily as they are displayed.
+ */
+class EE_API VisualLineIndex {
+  public:
+	/** Resets the index to lineCount unmeasured lines. */
+	void reset( const Int64& lineCount );
+
+	/** Marks every line as unmeasured. */
+	void invalidate();
+
+	const Int64& getLineCount() const;
+
+	/** @return The number of rows of all the lines. */
+	const Int64& getRowCount() const;
+
+	/** @return The number of lines not measured yet. */
+	const Int64& getUnmeasuredCount() const;
+
+	bool isLineMeasured( const Int64& line ) const;
+
+	Int64 getLineRows( const Int64& line ) const;
+
+	/** Sets the number of rows of a line and marks it as measured. */
+	void setLineRows( const Int64& line, const Int64& rows );
+
+	/** Marks a line as unmeasured. */
+	void invalidateLine( const Int64& line );
+
+	/** Inserts count unmeasured lines before line. */
+	void insertLines( const Int64& line, const Int64& count );
+
+	void removeLines( const Int64& line, const Int64& count );
+
+	/** @return The first row of a line ( the number of rows of the lines before it ). */
+	Int64 getLineFirstRow( const Int64& line ) const;
+
+	/** @return The line that contains a row, clamped to the document lines. */
+	Int64 getRowLine( const Int64& row ) const;
+
+	/** @return The first unmeasured line starting from line ( wrapping around to the first
+	 * line ), or -1 if every line is measured. */
+	Int64 findUnmeasuredLine( const Int64& line ) const;
+
+  protected:
+	struct Block {
+		Int64 lines{ 0 };
+		Int64 rows{ 0 };
+		Int64 unmeasured{ 0 };
+		// The rows of every line, 0 for the unmeasured lines. Empty if no line is measured.
+		std::vector<Uint32> lineRows;
+	};
+
+	std::vector<Block> mBlocks;
+	std::vector<Int64> mLineTree;
+	std::vector<Int64> mRowTree;
+	Int64 mLineCount{ 0 };
+	Int64 mRowCount{ 0 };
+	Int64 mUnmeasuredCount{ 0 };
+	size_t mHighBit{ 0 };
+
+	/** @return The block that contains a line, and the line offset in the block. */
+	size_t findBlock( const Int64& line, Int64& offset ) const;
+
+	void updateBlock( const size_t& block, const Int64& lines, const Int64& rows );
+
+	/** Splits a block that grew too large, the trees must be rebuilt. */
+	void splitBlock( const size_t& block );
+
+	/** Merges a block that shrank too much with its neighbor, the trees must be rebuilt. */
+	bool mergeBlock( const size_t& block );
+
+	void build();
+};
+
+}}} // namespace EE::UI::Doc
+
+#endif
@@ -5,6 +5,7 @@
 #include <eepp/ui/doc/syntaxcolorscheme.hpp>
 #include <eepp/ui/doc/syntaxhighlighter.hpp>
 #include <eepp/ui/doc/textdocument.hpp>
+#include <eepp/ui/doc/visuallineindex.hpp>
 #include <eepp/ui/keyboardshortcut.hpp>
 #include <eepp/ui/uifontstyleconfig.hpp>
 #include <eepp/ui/uiwidget.hpp>
@@ -14,6 +15,8 @@ using namespace EE::UI::Doc;
 
 namespace EE { namespace Graphics {
 class Font;
+class FrameBuffer;
+class Primitives;
 }} // namespace EE::Graphics
 
 namespace EE { namespace UI {
@@ -49,6 +52,8 @@ class UICodeEditorPlugin {
 	virtual bool onKeyUp( UICodeEditor*, const KeyEvent& ) { return false; }
 	virtual bool onTextInput( UICodeEditor*, const TextInputEvent& ) { return false; }
 	virtual void update( UICodeEditor* ) {}
+	/** @return The time the plugin can wait until its next update ( see Node::getIdleTime ). */
+	virtual Time getIdleTime( UICodeEditor* ) { return Time::Zero; }
 	virtual void preDraw( UICodeEditor*, const Vector2f& /*startScroll*/,
 						  const Float& /*lineHeight*/, const TextPosition& /*cursor*/ ) {}
 	virtual void postDraw( UICodeEditor*, const Vector2f& /*startScroll*/,
@@ -68,6 +73,9 @@ class UICodeEditorPlugin {
 									  const Vector2i& /*position*/, const Uint32& /*flags*/ ) {
 		return false;
 	}
+	/** The position passed to drawBeforeLineText and drawAfterLineText is the start of the first
+	 * visual row of the line, UICodeEditor::getTextPositionOffset gives the row of a column when
+	 * the line is soft wrapped. */
 	virtual void drawBeforeLineText( UICodeEditor*, const Int64&, Vector2f, const Float&,
 									 const Float& ){};
 	virtual void drawAfterLineText( UICodeEditor* /*editor*/, const Int64& /*index*/,
@@ -164,6 +172,8 @@ class EE_API UICodeEditor : public UIWidget, public TextDocument::Client {
 
 	virtual void scheduledUpdate( const Time& time );
 
+	virtual Time getIdleTime();
+
 	void reset();
 
 	TextDocument::LoadStatus loadFromFile( const std::string& path );
@@ -336,6 +346,12 @@ class EE_API UICodeEditor : public UIWidget, public TextDocument::Client {
 	/** Set to 0 to hide. */
 	void setLineBreakingColumn( const Uint32& lineBreakingColumn );
 
+	bool isSoftWrap() const;
+
+	/** Wraps the lines wider than the viewport in several visual rows. The horizontal scroll is
+	 * disabled while soft wrap is enabled. */
+	void setSoftWrap( bool softWrap );
+
 	void addUnlockedCommand( const std::string& command );
 
 	void addUnlockedCommands( const std::vector<std::string>& commands );
@@ -524,6 +540,24 @@ class EE_API UICodeEditor : public UIWidget, public TextDocument::Client {
 
 	int getVisibleLinesCount() const;
 
+	/** @return The number of visual rows of the document ( its number of lines if soft wrap is
+	 * disabled ). */
+	Int64 getVisualRowCount() const;
+
+	/** @return The visual row where a position is displayed. */
+	Int64 getVisualRow( const TextPosition& position ) const;
+
+	/** @return The position of the first character displayed in a visual row. */
+	TextPosition getVisualRowStart( const Int64& row ) const;
+
+	/** @return The offset of a position from the start of the scrolled text, the row of the
+	 * position times the line height and its offset in the row. */
+	Vector2f getTextPositionOffset( const TextPosition& position ) const;
+
+	/** @return The columns where the rows of a line start, excluding the first row ( empty if
+	 * soft wrap is disabled ). */
+	const std::vector<Int64>& getLineWrapColumns( const Int64& line ) const;
+
 	const StyleSheetLength& getLineSpacing() const;
 
 	void setLineSpacing( const StyleSheetLength& lineSpace );
@@ -640,6 +674,16 @@ class EE_API UICodeEditor : public UIWidget, public TextDocument::Client {
 	UIPopUpMenu* mCurrentMenu{ nullptr };
 	MinimapConfig mMinimapConfig;
 	Int64 mMinimapScrollOffset{ 0 };
+	struct MinimapRow {
+		Int64 line{ -1 };
+		Uint64 signature{ 0 };
+	};
+	// The minimap text is painted in a ring of rows, the line N is painted in the row
+	// N % mMinimapRows.size().
+	FrameBuffer* mMinimapBuffer{ nullptr };
+	std::vector<MinimapRow> mMinimapRows;
+	Uint64 mMinimapBufferKey{ 0 };
+	bool mMinimapBufferFailed{ false };
 	struct TextLine {
 		Text text;
 		String::HashType hash;
@@ -656,6 +700,17 @@ class EE_API UICodeEditor : public UIWidget, public TextDocument::Client {
 	std::vector<PluginRequestedSpace> mPluginTopSpaces;
 	Float mPluginsTopSpace{ 0 };
 	Uint64 mLastExecuteEventId{ 0 };
+	bool mSoftWrap{ false };
+	// The visual lines are invalidated lazily by the const getters, and the lines are measured
+	// as they are displayed or while the editor is idle.
+	mutable bool mVisualLinesDirty{ true };
+	mutable Float mVisualLinesWidth{ 0 };
+	mutable VisualLineIndex mVisualLines;
+	struct WrappedLine {
+		String::HashType hash;
+		std::vector<Int64> columns;
+	};
+	mutable std::map<Int64, WrappedLine> mWrapCache;
 
 	UICodeEditor( const std::string& elementTag, const bool& autoRegisterBaseCommands = true,
 				  const bool& autoRegisterBaseKeybindings = true );
@@ -752,6 +807,9 @@ class EE_API UICodeEditor : public UIWidget, public TextDocument::Client {
 	virtual void drawLineText( const Int64& line, Vector2f position, const Float& fontSize,
 							   const Float& lineHeight );
 
+	virtual void drawWrappedLineText( const Int64& line, Vector2f position, const Float& fontSize,
+									  const Float& lineHeight );
+
 	virtual void drawSelectionMatch( const std::pair<int, int>& lineRange,
 									 const Vector2f& startScroll, const Float& lineHeight );
 
@@ -809,6 +867,19 @@ class EE_API UICodeEditor : public UIWidget, public TextDocument::Client {
 
 	void drawMinimap( const Vector2f& start, const std::pair<Uint64, Uint64>& lineRange );
 
+	void drawMinimapLineText( Primitives& primitives, const Int64& index,
+							  const Vector2f& position, const Float& cutoffX,
+							  const Float& charHeight, const Float& charSpacing,
+							  const Uint8& alpha );
+
+	/** Repaints the rows of the minimap buffer whose line changed.
+	 * @return False if the minimap buffer is not available. */
+	bool updateMinimapBuffer( const Rectf& rect, const Int64& startLine, const Int64& endLine,
+							  const Float& charHeight, const Float& charSpacing,
+							  const Float& gutterWidth );
+
+	Uint64 getMinimapLineSignature( const Int64& index );
+
 	Vector2f getScreenStart() const;
 
 	Float getMinimapLineSpacing() const;
@@ -830,6 +901,29 @@ class EE_API UICodeEditor : public UIWidget, public TextDocument::Client {
 	bool gutterSpaceExists( UICodeEditorPlugin* plugin ) const;
 
 	bool topSpaceExists( UICodeEditorPlugin* plugin ) const;
+
+	void invalidateVisualLines();
+
+	/** Marks every line as unmeasured if the document, the font or the wrap width changed. */
+	void updateVisualLines() const;
+
+	/** Moves the visual lines of a change of the document, the lines touched are wrapped again. */
+	void updateVisualLines( const DocumentContentChange& change );
+
+	/** Measures the lines in the viewport, the page of lines around aroundLine ( if any ), and
+	 * the unmeasured lines until the budget expires, keeping the text at the top of the viewport
+	 * in place. */
+	void measureVisualLines( const Int64& aroundLine = -1, const Time& budget = Time::Zero );
+
+	Float getSoftWrapWidth() const;
+
+	void computeLineWrapColumns( const Int64& line, std::vector<Int64>& columns ) const;
+
+	/** @return The first and last visual rows in the viewport. */
+	std::pair<Int64, Int64> getVisibleRowRange() const;
+
+	/** @return The position displayed in a visual row at an offset from the row start. */
+	TextPosition getVisualRowPosition( const Int64& row, const Float& x ) const;
 };
 
 }} // namespace EE::UI
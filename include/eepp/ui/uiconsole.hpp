@@ -88,6 +88,13 @@ class EE_API UIConsole : public UIWidget,
 	/** Activate/Deactive fps rendering */
 	void showFps( const bool& show );
 
+	/** @return If the console is rendering the profiler zones of the last frame below the FPS
+	 * count. */
+	const bool& isShowingProfiler() const;
+
+	/** Activate/Deactive the profiler zones rendering. Starts the profiler if not running. */
+	void showProfiler( const bool& show );
+
 	bool getEscapePastedText() const;
 
 	void setEscapePastedText( bool escapePastedText );
@@ -120,6 +127,8 @@ class EE_API UIConsole : public UIWidget,
 
 	virtual void scheduledUpdate( const Time& time );
 
+	virtual Time getIdleTime();
+
 	const Time& getBlinkTime() const;
 
 	void setBlinkTime( const Time& blinkTime );
@@ -151,6 +160,7 @@ class EE_API UIConsole : public UIWidget,
 	sCon mCon;
 
 	bool mShowFps{ false };
+	bool mShowProfiler{ false };
 	bool mEscapePastedText{ false };
 	bool mMouseDown{ false };
 	bool mQuakeMode{ false };
@@ -265,6 +275,10 @@ class EE_API UIConsole : public UIWidget,
 	/** Internal Callback for default command ( showfps ) */
 	void cmdShowFps( const std::vector<String>& params );
 
+	void cmdShowProfiler( const std::vector<String>& params );
+
+	String getProfilerText() const;
+
 	/** Internal Callback for default command ( gettexturememory ) */
 	void cmdGetTextureMemory();
 
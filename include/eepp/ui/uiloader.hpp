@@ -23,6 +23,8 @@ class EE_API UILoader : public UIWidget {
 
 	virtual void scheduledUpdate( const Time& time );
 
+	virtual Time getIdleTime();
+
 	UILoader* setOutlineThickness( const Float& thickness );
 
 	const Float& getOutlineThickness() const;
@@ -155,6 +155,8 @@ class EE_API UIMenu : public UIWidget {
 
 	virtual void scheduledUpdate( const Time& time );
 
+	virtual Time getIdleTime();
+
 	bool isChildOfMeOrSubMenu( Node* node );
 
 	void unselectSelected();
@@ -14,6 +14,7 @@
 
 namespace EE { namespace Graphics {
 class Drawable;
+class FrameBuffer;
 }} // namespace EE::Graphics
 
 namespace EE { namespace Scene {
@@ -316,6 +317,18 @@ class EE_API UINode : public Node {
 
 	Sizef fitMinMaxSizePx( const Sizef& size ) const;
 
+	/** Enables the retained draw mode. The node and its descendants are drawn once into a frame
+	 * buffer, and the frame buffer is drawn in the following frames until the node or any of its
+	 * descendants invalidates the draw. Useful for complex subtrees that rarely change.
+	 * Windows use their own frame buffer instead ( UI_WIN_FRAME_BUFFER ). */
+	UINode* setRetainedDraw( bool retained );
+
+	FrameBuffer* getRetainedFrameBuffer() const;
+
+	virtual bool isDrawInvalidator() const;
+
+	virtual void invalidate( Node* invalidator );
+
   protected:
 	Vector2f mDpPos;
 	Sizef mDpSize;
@@ -337,6 +350,7 @@ class EE_API UINode : public Node {
 	std::string mMinHeightEq;
 	std::string mMaxWidthEq;
 	std::string mMaxHeightEq;
+	FrameBuffer* mRetainedFrameBuffer;
 
 	virtual Uint32 onMouseDown( const Vector2i& position, const Uint32& flags );
 
@@ -418,6 +432,13 @@ class EE_API UINode : public Node {
 	void smartClipStart( const ClipType& reqClipType );
 
 	void smartClipEnd( const ClipType& reqClipType );
+
+	/** Draws the node and its childs, except the node transformation.
+	 * @param visible False if the node is outside of the visible area, only its unclipped childs
+	 * are drawn. */
+	void drawNode( bool visible );
+
+	void drawRetained();
 };
 
 }} // namespace EE::UI
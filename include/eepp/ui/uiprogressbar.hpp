@@ -40,6 +40,8 @@ class EE_API UIProgressBar : public UIWidget {
 
 	virtual void scheduledUpdate( const Time& time );
 
+	virtual Time getIdleTime();
+
 	void setMovementSpeed( const Vector2f& Speed );
 
 	const Vector2f& getMovementSpeed() const;
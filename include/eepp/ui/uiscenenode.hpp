@@ -44,6 +44,8 @@ class EE_API UISceneNode : public SceneNode {
 
 	virtual void update( const Time& elapsed );
 
+	virtual Time getIdleTime();
+
 	void setTranslator( Translator translator );
 
 	const Translator& getTranslator() const;
@@ -109,6 +111,8 @@ class EE_API UISceneNode : public SceneNode {
 
 	void updateDirtyLayouts();
 
+	virtual void invalidateFontMetrics();
+
 	void updateDirtyStyles();
 
 	void updateDirtyStyleStates();
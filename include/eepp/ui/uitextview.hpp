@@ -1,6 +1,7 @@
 #ifndef EE_UI_UITEXTVIEW_HPP
 #define EE_UI_UITEXTVIEW_HPP
 
+#include <eepp/graphics/paragraphlayout.hpp>
 #include <eepp/graphics/text.hpp>
 #include <eepp/ui/uifontstyleconfig.hpp>
 #include <eepp/ui/uiwidget.hpp>
@@ -121,6 +122,7 @@ class EE_API UITextView : public UIWidget {
 	Int32 mFontLineCenter;
 	bool mSelecting;
 	TextTransform::Value mTextTransform{ TextTransform::None };
+	ParagraphLayout mWrapLayout; ///< Measured words of the text, used by the word wrap
 
 	virtual void drawSelection( Text* textCache );
 
@@ -138,6 +140,8 @@ class EE_API UITextView : public UIWidget {
 
 	virtual void onFontStyleChanged();
 
+	virtual void onFontMetricsChange();
+
 	virtual void onAlphaChange();
 
 	virtual Uint32 onFocusLoss();
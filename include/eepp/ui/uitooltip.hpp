@@ -132,6 +132,8 @@ class EE_API UITooltip : public UIWidget {
 
 	virtual void onAutoSize();
 
+	virtual void onFontMetricsChange();
+
 	virtual void autoAlign();
 
 	virtual void autoPadding();
@@ -49,6 +49,8 @@ class EE_API UITouchDraggableWidget : public UIWidget {
 
 	virtual void scheduledUpdate( const Time& time );
 
+	virtual Time getIdleTime();
+
 	virtual Uint32 onMessage( const NodeMessage* msg );
 };
 
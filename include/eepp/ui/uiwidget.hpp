@@ -292,6 +292,9 @@ class EE_API UIWidget : public UINode {
 
 	virtual void onTabPress();
 
+	/** Called when the metrics of the font glyphs changed, the texts must be measured again. */
+	virtual void onFontMetricsChange();
+
 	virtual Uint32 onFocus();
 
 	virtual Uint32 onFocusLoss();
@@ -324,6 +327,8 @@ class EE_API UIWidget : public UINode {
 
 	void reloadFontFamily();
 
+	void reloadFontMetrics();
+
 	UIWidget* getNextWidget() const;
 
 	String getTranslatorString( const std::string& str );
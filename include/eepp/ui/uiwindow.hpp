@@ -100,6 +100,8 @@ class EE_API UIWindow : public UIWidget {
 
 	virtual void scheduledUpdate( const Time& time );
 
+	virtual Time getIdleTime();
+
 	virtual void closeWindow();
 
 	virtual void close();
@@ -28,6 +28,11 @@ class EE_API Input {
 	 */
 	virtual void waitEvent( const Time& timeout = Time::Zero ) = 0;
 
+	/** Interrupts a Input::waitEvent call that is waiting for events, or makes the next call
+	 * return immediately. It can be called from any thread, consecutive calls before the wait
+	 * returns are coalesced into a single wake up. */
+	virtual void wakeUp() = 0;
+
 	/** @return If the mouse and keyboard are grabed. */
 	virtual bool grabInput() = 0;
 
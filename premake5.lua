@@ -12,6 +12,7 @@ newoption { trigger = "with-emscripten-pthreads", description = "Enables emscrip
 newoption { trigger = "with-mold-linker", description = "Tries to use the mold linker instead of the default linker of the toolchain" }
 newoption { trigger = "with-debug-symbols", description = "Release builds are built with debug symbols." }
 newoption { trigger = "thread-sanitizer", description ="Compile with ThreadSanitizer." }
+newoption { trigger = "with-profiler", description = "Compiles the profiler zones in release builds ( always compiled in debug builds )." }
 newoption {
 	trigger = "with-backend",
 	description = "Select the backend to use for window and input handling.\n\t\t\tIf no backend is selected or if the selected is not installed the script will search for a backend present in the system, and will use it.",
@@ -373,6 +374,10 @@ function parse_args()
 		defines { "EE_GLES1", "SOIL_GLES1" }
 	end
 
+	if _OPTIONS["with-profiler"] then
+		defines { "EE_PROFILER" }
+	end
+
 	if _OPTIONS["thread-sanitizer"] then
 		buildoptions { "-fsanitize=thread" }
 		linkoptions { "-fsanitize=thread" }
@@ -1044,6 +1049,32 @@ workspace "eepp"
 		includedirs { "src/thirdparty" }
 		build_link_configuration( "eepp-ui-perf-test", true )
 
+	project "eepp-lights-perf-test"
+		set_kind()
+		language "C++"
+		files { "src/tests/lights_perf_test/*.cpp" }
+		eepp_module_maps_add()
+		build_link_configuration( "eepp-lights-perf-test", true )
+
+	project "eepp-sound-decode-perf-test"
+		set_kind()
+		language "C++"
+		files { "src/tests/sound_decode_perf_test/*.cpp" }
+		build_link_configuration( "eepp-sound-decode-perf-test", true )
+
+	project "eepp-sound-stream-test"
+		set_kind()
+		language "C++"
+		files { "src/tests/sound_stream_test/*.cpp" }
+		build_link_configuration( "eepp-sound-stream-test", true )
+
+	project "eepp-bench"
+		kind "ConsoleApp"
+		language "C++"
+		files { "src/tests/bench/*.cpp" }
+		incdirs { "src/thirdparty" }
+		build_link_configuration( "eepp-bench", true )
+
 if os.isfile("external_projects.lua") then
 	dofile("external_projects.lua")
 end
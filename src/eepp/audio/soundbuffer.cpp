@@ -4,6 +4,7 @@
 #include <eepp/audio/outputsoundfile.hpp>
 #include <eepp/audio/sound.hpp>
 #include <eepp/audio/soundbuffer.hpp>
+#include <eepp/audio/soundbuffercache.hpp>
 #include <eepp/core/debug.hpp>
 #include <eepp/system/filesystem.hpp>
 #include <eepp/system/log.hpp>
@@ -63,6 +64,9 @@ bool SoundBuffer::loadFromFile( const std::string& filename ) {
 		return false;
 	}
 
+	if ( SoundBufferCache::instance()->isEnabled() )
+		return initialize( SoundBufferCache::instance()->decodeFile( filename ) );
+
 	InputSoundFile file;
 	if ( file.openFromFile( filename ) )
 		return initialize( file );
@@ -71,6 +75,9 @@ bool SoundBuffer::loadFromFile( const std::string& filename ) {
 }
 
 bool SoundBuffer::loadFromMemory( const void* data, std::size_t sizeInBytes ) {
+	if ( SoundBufferCache::instance()->isEnabled() )
+		return initialize( SoundBufferCache::instance()->decode( data, sizeInBytes ) );
+
 	InputSoundFile file;
 	if ( file.openFromMemory( data, sizeInBytes ) )
 		return initialize( file );
@@ -178,6 +185,16 @@ bool SoundBuffer::initialize( InputSoundFile& file ) {
 	}
 }
 
+bool SoundBuffer::initialize( std::shared_ptr<const SoundBufferCache::Entry> entry ) {
+	if ( !entry )
+		return false;
+
+	mSamples = entry->samples;
+
+	// Update the internal buffer with the new samples
+	return update( entry->channelCount, entry->sampleRate );
+}
+
 bool SoundBuffer::update( unsigned int channelCount, unsigned int sampleRate ) {
 	// Check parameters
 	if ( !channelCount || !sampleRate || mSamples.empty() )
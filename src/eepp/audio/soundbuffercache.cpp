@@ -0,0 +1,329 @@
+#include <condition_variable>
+#include <cstdio>
+#include <eepp/audio/inputsoundfile.hpp>
+#include <eepp/audio/soundbuffercache.hpp>
+#include <eepp/core/string.hpp>
+#include <eepp/system/filesystem.hpp>
+#include <eepp/system/iostreamfile.hpp>
+#include <eepp/system/md5.hpp>
+#include <eepp/system/pack.hpp>
+#include <eepp/system/packmanager.hpp>
+#include <eepp/system/scopedbuffer.hpp>
+#include <eepp/system/thread.hpp>
+
+namespace EE { namespace Audio {
+
+SINGLETON_DECLARE_IMPLEMENTATION( SoundBufferCache )
+
+#define EE_PCM_CACHE_MAGIC ( ( 'E' << 0 ) | ( 'P' << 8 ) | ( 'C' << 16 ) | ( 'M' << 24 ) )
+#define EE_PCM_CACHE_VERSION 1
+
+struct PCMCacheHeader {
+	Uint32 magic;
+	Uint32 version;
+	Uint32 channelCount;
+	Uint32 sampleRate;
+	Uint64 sampleCount;
+};
+
+static bool readEncodedFile( const std::string& path, ScopedBuffer& buffer ) {
+	if ( FileSystem::fileExists( path ) )
+		return FileSystem::fileGet( path, buffer );
+
+	if ( PackManager::instance()->isFallbackToPacksActive() ) {
+		std::string packPath( path );
+		Pack* pack = PackManager::instance()->exists( packPath );
+
+		if ( NULL != pack && pack->isOpen() )
+			return pack->extractFileToMemory( packPath, buffer );
+	}
+
+	return false;
+}
+
+std::string SoundBufferCache::hash( const void* data, std::size_t sizeInBytes ) {
+	return MD5::fromMemory( reinterpret_cast<const Uint8*>( data ), sizeInBytes ).toHexString();
+}
+
+SoundBufferCache::SoundBufferCache() :
+	mMaxMemory( 64 * 1024 * 1024 ),
+	mMemoryUsage( 0 ),
+	mHits( 0 ),
+	mMisses( 0 ),
+	mEnabled( false ) {}
+
+SoundBufferCache::~SoundBufferCache() {
+	clear();
+}
+
+void SoundBufferCache::setEnabled( const bool& enabled ) {
+	std::unique_lock<std::mutex> lock( mMutex );
+	mEnabled = enabled;
+}
+
+bool SoundBufferCache::isEnabled() const {
+	std::unique_lock<std::mutex> lock( mMutex );
+	return mEnabled;
+}
+
+void SoundBufferCache::setMaxMemory( const std::size_t& maxMemory ) {
+	std::unique_lock<std::mutex> lock( mMutex );
+	mMaxMemory = maxMemory;
+	evict();
+}
+
+std::size_t SoundBufferCache::getMaxMemory() const {
+	std::unique_lock<std::mutex> lock( mMutex );
+	return mMaxMemory;
+}
+
+std::size_t SoundBufferCache::getMemoryUsage() const {
+	std::unique_lock<std::mutex> lock( mMutex );
+	return mMemoryUsage;
+}
+
+void SoundBufferCache::setDiskCachePath( const std::string& path ) {
+	std::string cachePath( path );
+
+	if ( !cachePath.empty() ) {
+		FileSystem::dirAddSlashAtEnd( cachePath );
+
+		if ( !FileSystem::isDirectory( cachePath ) )
+			FileSystem::makeDir( cachePath );
+	}
+
+	std::unique_lock<std::mutex> lock( mMutex );
+	mDiskCachePath = cachePath;
+}
+
+std::string SoundBufferCache::getDiskCachePath() const {
+	std::unique_lock<std::mutex> lock( mMutex );
+	return mDiskCachePath;
+}
+
+Uint64 SoundBufferCache::getHitCount() const {
+	return mHits;
+}
+
+Uint64 SoundBufferCache::getMissCount() const {
+	return mMisses;
+}
+
+SoundBufferCache::EntryPtr SoundBufferCache::get( const std::string& hash ) {
+	std::unique_lock<std::mutex> lock( mMutex );
+	return lookup( hash );
+}
+
+SoundBufferCache::EntryPtr SoundBufferCache::decode( const void* data, std::size_t sizeInBytes ) {
+	std::string dataHash( hash( data, sizeInBytes ) );
+	EntryPtr entry = get( dataHash );
+
+	if ( entry ) {
+		mHits++;
+		return entry;
+	}
+
+	mMisses++;
+
+	entry = loadFromDisk( dataHash );
+
+	if ( !entry ) {
+		InputSoundFile file;
+
+		if ( !file.openFromMemory( data, sizeInBytes ) || !file.getSampleCount() )
+			return EntryPtr();
+
+		std::shared_ptr<Entry> decoded( std::make_shared<Entry>() );
+		decoded->channelCount = file.getChannelCount();
+		decoded->sampleRate = file.getSampleRate();
+		decoded->samples.resize( static_cast<std::size_t>( file.getSampleCount() ) );
+
+		if ( file.read( &decoded->samples[0], file.getSampleCount() ) != file.getSampleCount() )
+			return EntryPtr();
+
+		saveToDisk( dataHash, *decoded );
+
+		entry = decoded;
+	}
+
+	std::unique_lock<std::mutex> lock( mMutex );
+	insert( dataHash, entry );
+	return entry;
+}
+
+SoundBufferCache::EntryPtr SoundBufferCache::decodeFile( const std::string& path ) {
+	ScopedBuffer buffer;
+
+	if ( !readEncodedFile( path, buffer ) || !buffer.length() )
+		return EntryPtr();
+
+	return decode( buffer.get(), buffer.length() );
+}
+
+Uint32 SoundBufferCache::decodeBatch( const std::vector<std::string>& paths, ThreadPool& pool ) {
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::size_t pending = paths.size();
+	Uint32 decoded = 0;
+
+	for ( const auto& path : paths ) {
+		pool.run(
+			[this, &path, &mutex, &decoded] {
+				if ( decodeFile( path ) ) {
+					std::unique_lock<std::mutex> lock( mutex );
+					decoded++;
+				}
+			},
+			[&mutex, &cv, &pending] {
+				std::unique_lock<std::mutex> lock( mutex );
+				pending--;
+				cv.notify_one();
+			} );
+	}
+
+	std::unique_lock<std::mutex> lock( mutex );
+	cv.wait( lock, [&pending] { return pending == 0; } );
+	return decoded;
+}
+
+void SoundBufferCache::decodeBatchAsync( const std::vector<std::string>& paths,
+										 std::shared_ptr<ThreadPool> pool,
+										 const BatchDoneCb& onDone ) {
+	struct BatchState {
+		std::atomic<std::size_t> pending;
+		std::atomic<Uint32> decoded;
+		BatchDoneCb onDone;
+	};
+
+	if ( paths.empty() ) {
+		if ( onDone )
+			onDone( 0 );
+		return;
+	}
+
+	std::shared_ptr<BatchState> batch( std::make_shared<BatchState>() );
+	batch->pending = paths.size();
+	batch->decoded = 0;
+	batch->onDone = onDone;
+
+	for ( const auto& path : paths ) {
+		pool->run(
+			[this, path, batch] {
+				if ( decodeFile( path ) )
+					batch->decoded++;
+			},
+			[batch] {
+				if ( --batch->pending == 0 && batch->onDone )
+					batch->onDone( batch->decoded );
+			} );
+	}
+}
+
+void SoundBufferCache::clear() {
+	std::unique_lock<std::mutex> lock( mMutex );
+	mEntries.clear();
+	mLRU.clear();
+	mMemoryUsage = 0;
+}
+
+SoundBufferCache::EntryPtr SoundBufferCache::lookup( const std::string& hash ) {
+	auto it = mEntries.find( hash );
+
+	if ( it == mEntries.end() )
+		return EntryPtr();
+
+	mLRU.splice( mLRU.begin(), mLRU, it->second.lru );
+
+	return it->second.entry;
+}
+
+void SoundBufferCache::insert( const std::string& hash, EntryPtr entry ) {
+	if ( mEntries.find( hash ) != mEntries.end() )
+		return;
+
+	mLRU.push_front( hash );
+	mEntries[hash] = { entry, mLRU.begin() };
+	mMemoryUsage += entry->samples.size() * sizeof( Int16 );
+
+	evict();
+}
+
+void SoundBufferCache::evict() {
+	// Always keep the most recently used entry
+	while ( mMemoryUsage > mMaxMemory && mLRU.size() > 1 ) {
+		auto it = mEntries.find( mLRU.back() );
+		mMemoryUsage -= it->second.entry->samples.size() * sizeof( Int16 );
+		mEntries.erase( it );
+		mLRU.pop_back();
+	}
+}
+
+SoundBufferCache::EntryPtr SoundBufferCache::loadFromDisk( const std::string& hash ) {
+	std::string path( getDiskCachePath() );
+
+	if ( path.empty() )
+		return EntryPtr();
+
+	path += hash + ".pcm";
+
+	if ( !FileSystem::fileExists( path ) )
+		return EntryPtr();
+
+	IOStreamFile file( path );
+	PCMCacheHeader header;
+
+	if ( !file.isOpen() ||
+		 file.read( (char*)&header, sizeof( PCMCacheHeader ) ) != sizeof( PCMCacheHeader ) ||
+		 header.magic != EE_PCM_CACHE_MAGIC || header.version != EE_PCM_CACHE_VERSION ||
+		 !header.sampleCount ||
+		 static_cast<ios_size>( header.sampleCount * sizeof( Int16 ) + sizeof( PCMCacheHeader ) ) !=
+			 file.getSize() )
+		return EntryPtr();
+
+	std::shared_ptr<Entry> entry( std::make_shared<Entry>() );
+	entry->channelCount = header.channelCount;
+	entry->sampleRate = header.sampleRate;
+	entry->samples.resize( static_cast<std::size_t>( header.sampleCount ) );
+
+	ios_size size = static_cast<ios_size>( header.sampleCount * sizeof( Int16 ) );
+
+	if ( file.read( (char*)&entry->samples[0], size ) != size )
+		return EntryPtr();
+
+	return entry;
+}
+
+void SoundBufferCache::saveToDisk( const std::string& hash, const Entry& entry ) {
+	std::string path( getDiskCachePath() );
+
+	if ( path.empty() )
+		return;
+
+	// Write to a temporary file first so a concurrent reader never sees a partial file
+	std::string tmpPath( path + hash + "." + String::toString( Thread::getCurrentThreadId() ) +
+						 ".tmp" );
+	path += hash + ".pcm";
+
+	{
+		IOStreamFile file( tmpPath, "wb" );
+
+		if ( !file.isOpen() )
+			return;
+
+		PCMCacheHeader header;
+		header.magic = EE_PCM_CACHE_MAGIC;
+		header.version = EE_PCM_CACHE_VERSION;
+		header.channelCount = entry.channelCount;
+		header.sampleRate = entry.sampleRate;
+		header.sampleCount = entry.samples.size();
+
+		file.write( (const char*)&header, sizeof( PCMCacheHeader ) );
+		file.write( (const char*)&entry.samples[0],
+					static_cast<ios_size>( entry.samples.size() * sizeof( Int16 ) ) );
+	}
+
+	FileSystem::fileRemove( path );
+	std::rename( tmpPath.c_str(), path.c_str() );
+}
+
+}} // namespace EE::Audio
@@ -1,41 +1,41 @@
 #include <eepp/audio/alcheck.hpp>
 #include <eepp/audio/audiodevice.hpp>
 #include <eepp/audio/soundstream.hpp>
+#include <eepp/audio/soundstreamscheduler.hpp>
+#include <eepp/audio/soundstreamstate.hpp>
 #include <eepp/core/debug.hpp>
 #include <eepp/system/lock.hpp>
 #include <eepp/system/log.hpp>
 #include <eepp/system/sys.hpp>
 
-#ifdef _MSC_VER
-#pragma warning( disable : 4355 ) // 'this' used in base member initializer list
-#endif
-
 namespace EE { namespace Audio {
 
 SoundStream::SoundStream() :
-	mThread( &SoundStream::streamData, this ),
-	mThreadMutex(),
-	mThreadStartState( Stopped ),
+	mStreamMutex(),
+	mStreamStartState( Stopped ),
 	mIsStreaming( false ),
+	mRequestStop( false ),
 	mBuffers(),
 	mChannelCount( 0 ),
 	mSampleRate( 0 ),
 	mFormat( 0 ),
 	mLoop( false ),
 	mSamplesProcessed( 0 ),
-	mBufferSeeks() {}
+	mBufferSeeks(),
+	mUnderrunCount( 0 ),
+	mDecodeStallCount( 0 ) {}
 
 SoundStream::~SoundStream() {
 	// Stop the sound if it was playing
 
-	// Request the thread to terminate
+	// Request the streaming to terminate
 	{
-		Lock lock( mThreadMutex );
+		Lock lock( mStreamMutex );
 		mIsStreaming = false;
 	}
 
-	// Wait for the thread to terminate
-	mThread.wait();
+	// Wait for the scheduler to release the stream
+	stopStreaming();
 }
 
 void SoundStream::initialize( unsigned int channelCount, unsigned int sampleRate ) {
@@ -64,55 +64,65 @@ void SoundStream::play() {
 	}
 
 	bool isStreaming = false;
-	Status threadStartState = Stopped;
+	Status streamStartState = Stopped;
 
 	{
-		Lock lock( mThreadMutex );
+		Lock lock( mStreamMutex );
 
 		isStreaming = mIsStreaming;
-		threadStartState = mThreadStartState;
+		streamStartState = mStreamStartState;
 	}
 
-	if ( isStreaming && ( threadStartState == Paused ) ) {
+	if ( isStreaming && ( streamStartState == Paused ) ) {
 		// If the sound is paused, resume it
-		Lock lock( mThreadMutex );
-		mThreadStartState = Playing;
-		alCheck( alSourcePlay( mSource ) );
+		std::shared_ptr<Private::SoundStreamState> state;
+
+		{
+			Lock lock( mStreamMutex );
+			mStreamStartState = Playing;
+			alCheck( alSourcePlay( mSource ) );
+			state = mState;
+		}
+
+		// The deadline of a paused stream is not accurate, service it as soon as possible
+		if ( state )
+			SoundStreamScheduler::instance()->wakeUp( state );
+
 		return;
-	} else if ( isStreaming && ( threadStartState == Playing ) ) {
+	} else if ( isStreaming && ( streamStartState == Playing ) ) {
 		// If the sound is playing, stop it and continue as if it was stopped
 		stop();
 	}
 
-	// Start updating the stream in a separate thread to avoid blocking the application
+	// Start updating the stream in the streaming scheduler to avoid blocking the application
 	mIsStreaming = true;
-	mThreadStartState = Playing;
-	mThread.launch();
+	mStreamStartState = Playing;
+	startStreaming();
 }
 
 void SoundStream::pause() {
-	// Handle pause() being called before the thread has started
+	// Handle pause() being called before the stream has started
 	{
-		Lock lock( mThreadMutex );
+		Lock lock( mStreamMutex );
 
 		if ( !mIsStreaming )
 			return;
 
-		mThreadStartState = Paused;
+		mStreamStartState = Paused;
 	}
 
 	alCheck( alSourcePause( mSource ) );
 }
 
 void SoundStream::stop() {
-	// Request the thread to terminate
+	// Request the streaming to terminate
 	{
-		Lock lock( mThreadMutex );
+		Lock lock( mStreamMutex );
 		mIsStreaming = false;
 	}
 
-	// Wait for the thread to terminate
-	mThread.wait();
+	// Wait for the scheduler to release the stream
+	stopStreaming();
 
 	// Move to the beginning
 	onSeek( Time::Zero );
@@ -131,10 +141,10 @@ SoundStream::Status SoundStream::getStatus() const {
 
 	// To compensate for the lag between play() and alSourceplay()
 	if ( status == Stopped ) {
-		Lock lock( mThreadMutex );
+		Lock lock( mStreamMutex );
 
 		if ( mIsStreaming )
-			status = mThreadStartState;
+			status = mStreamStartState;
 	}
 
 	return status;
@@ -157,8 +167,8 @@ void SoundStream::setPlayingOffset( Time timeOffset ) {
 		return;
 
 	mIsStreaming = true;
-	mThreadStartState = oldStatus;
-	mThread.launch();
+	mStreamStartState = oldStatus;
+	startStreaming();
 }
 
 Time SoundStream::getPlayingOffset() const {
@@ -181,19 +191,59 @@ bool SoundStream::getLoop() const {
 	return mLoop;
 }
 
+Uint64 SoundStream::getUnderrunCount() const {
+	return mUnderrunCount;
+}
+
+Uint64 SoundStream::getDecodeStallCount() const {
+	return mDecodeStallCount;
+}
+
 Int64 SoundStream::onLoop() {
 	onSeek( Time::Zero );
 	return 0;
 }
 
-void SoundStream::streamData() {
-	bool requestStop = false;
+void SoundStream::startStreaming() {
+	stopStreaming();
+
+	mState = std::make_shared<Private::SoundStreamState>( this );
+	mRequestStop = false;
+
+	SoundStreamScheduler::instance()->add( mState );
+}
+
+void SoundStream::stopStreaming() {
+	if ( !mState )
+		return;
+
+	std::shared_ptr<Private::SoundStreamState> state( mState );
 
 	{
-		Lock lock( mThreadMutex );
+		// Wait until the scheduler finishes any work in progress on the stream
+		std::unique_lock<std::mutex> serviceLock( state->serviceMutex );
+		std::unique_lock<std::mutex> decodeLock( state->decodeMutex );
+
+		if ( state->active ) {
+			state->active = false;
+
+			if ( state->started )
+				streamEnd();
+		}
+	}
+
+	mState.reset();
+
+	if ( SoundStreamScheduler::existsSingleton() )
+		SoundStreamScheduler::existsSingleton()->remove( state );
+}
 
-		// Check if the thread was launched Stopped
-		if ( mThreadStartState == Stopped ) {
+void SoundStream::streamBegin( Private::SoundStreamState& state ) {
+	{
+		Lock lock( mStreamMutex );
+
+		// Check if the stream was started Stopped
+		if ( mStreamStartState == Stopped ) {
 			mIsStreaming = false;
 			return;
 		}
@@ -205,91 +255,108 @@ void SoundStream::streamData() {
 		mBufferSeeks[i] = NoLoop;
 
 	// Fill the queue
-	requestStop = fillQueue();
+	mRequestStop = fillQueue( state );
 
 	// Play the sound
 	alCheck( alSourcePlay( mSource ) );
 
 	{
-		Lock lock( mThreadMutex );
+		Lock lock( mStreamMutex );
 
-		// Check if the thread was launched Paused
-		if ( mThreadStartState == Paused )
+		// Check if the stream was started Paused
+		if ( mStreamStartState == Paused )
 			alCheck( alSourcePause( mSource ) );
 	}
+}
 
-	for ( ;; ) {
-		{
-			Lock lock( mThreadMutex );
-			if ( !mIsStreaming )
-				break;
+bool SoundStream::streamUpdate( Private::SoundStreamState& state, Time& nextUpdate ) {
+	{
+		Lock lock( mStreamMutex );
+		if ( !mIsStreaming )
+			return false;
+	}
+
+	// The stream has been interrupted!
+	if ( SoundSource::getStatus() == Stopped ) {
+		if ( !mRequestStop ) {
+			// The queue ran dry before it could be refilled, just continue
+			mUnderrunCount++;
+			SoundStreamScheduler::instance()->addUnderrun();
+			alCheck( alSourcePlay( mSource ) );
+		} else {
+			// End streaming
+			Lock lock( mStreamMutex );
+			mIsStreaming = false;
+			return false;
 		}
+	}
 
-		// The stream has been interrupted!
-		if ( SoundSource::getStatus() == Stopped ) {
-			if ( !requestStop ) {
-				// Just continue
-				alCheck( alSourcePlay( mSource ) );
-			} else {
-				// End streaming
-				Lock lock( mThreadMutex );
-				mIsStreaming = false;
+	// Get the number of buffers that have been processed (i.e. ready for reuse)
+	ALint nbProcessed = 0;
+	alCheck( alGetSourcei( mSource, AL_BUFFERS_PROCESSED, &nbProcessed ) );
+
+	while ( nbProcessed-- ) {
+		// Pop the first unused buffer from the queue
+		ALuint buffer;
+		alCheck( alSourceUnqueueBuffers( mSource, 1, &buffer ) );
+
+		// Find its number
+		unsigned int bufferNum = 0;
+		for ( int i = 0; i < BufferCount; ++i )
+			if ( mBuffers[i] == buffer ) {
+				bufferNum = i;
+				break;
 			}
-		}
 
-		// Get the number of buffers that have been processed (i.e. ready for reuse)
-		ALint nbProcessed = 0;
-		alCheck( alGetSourcei( mSource, AL_BUFFERS_PROCESSED, &nbProcessed ) );
-
-		while ( nbProcessed-- ) {
-			// Pop the first unused buffer from the queue
-			ALuint buffer;
-			alCheck( alSourceUnqueueBuffers( mSource, 1, &buffer ) );
-
-			// Find its number
-			unsigned int bufferNum = 0;
-			for ( int i = 0; i < BufferCount; ++i )
-				if ( mBuffers[i] == buffer ) {
-					bufferNum = i;
-					break;
-				}
-
-			// Retrieve its size and add it to the samples count
-			if ( mBufferSeeks[bufferNum] != NoLoop ) {
-				// This was the last buffer before EOF or Loop End: reset the sample count
-				mSamplesProcessed = mBufferSeeks[bufferNum];
-				mBufferSeeks[bufferNum] = NoLoop;
+		// Retrieve its size and add it to the samples count
+		if ( mBufferSeeks[bufferNum] != NoLoop ) {
+			// This was the last buffer before EOF or Loop End: reset the sample count
+			mSamplesProcessed = mBufferSeeks[bufferNum];
+			mBufferSeeks[bufferNum] = NoLoop;
+		} else {
+			ALint size, bits;
+			alCheck( alGetBufferi( buffer, AL_SIZE, &size ) );
+			alCheck( alGetBufferi( buffer, AL_BITS, &bits ) );
+
+			// Bits can be 0 if the format or parameters are corrupt, avoid division by zero
+			if ( bits == 0 ) {
+				Log::warning(
+					"SoundStream: Bits in sound stream are 0: make sure that the "
+					"audio format is not corrupt and initialize() has been called correctly." );
+
+				// Abort streaming
+				Lock lock( mStreamMutex );
+				mIsStreaming = false;
+				mRequestStop = true;
+				return false;
 			} else {
-				ALint size, bits;
-				alCheck( alGetBufferi( buffer, AL_SIZE, &size ) );
-				alCheck( alGetBufferi( buffer, AL_BITS, &bits ) );
-
-				// Bits can be 0 if the format or parameters are corrupt, avoid division by zero
-				if ( bits == 0 ) {
-					Log::warning(
-						"SoundStream: Bits in sound stream are 0: make sure that the "
-						"audio format is not corrupt and initialize() has been called correctly." );
-
-					// Abort streaming (exit main loop)
-					Lock lock( mThreadMutex );
-					mIsStreaming = false;
-					requestStop = true;
-					break;
-				} else {
-					mSamplesProcessed += size / ( bits / 8 );
-				}
+				mSamplesProcessed += size / ( bits / 8 );
 			}
+		}
 
-			// Fill it and push it back into the playing queue
-			if ( !requestStop ) {
-				if ( fillAndPushBuffer( bufferNum ) )
-					requestStop = true;
-			}
+		// Fill it and push it back into the playing queue
+		if ( !mRequestStop ) {
+			if ( fillAndPushBuffer( state, bufferNum ) )
+				mRequestStop = true;
 		}
+	}
+
+	// Schedule the next refill when the oldest queued buffer is expected to finish playing
+	if ( SoundSource::getStatus() == Playing ) {
+		ALfloat secs = 0.f;
+		alCheck( alGetSourcef( mSource, AL_SEC_OFFSET, &secs ) );
+		nextUpdate = eemax( mLastChunkDuration - Seconds( secs ), Milliseconds( 2 ) );
+	} else {
+		nextUpdate = Milliseconds( 100 );
+	}
 
-		// Leave some time for the other threads if the stream is still playing
-		if ( SoundSource::getStatus() != Stopped )
-			Sys::sleep( Milliseconds( 10 ) );
+	return true;
+}
+
+void SoundStream::streamEnd() {
+	{
+		Lock lock( mStreamMutex );
+		mIsStreaming = false;
 	}
 
 	// Stop the playback
@@ -306,66 +373,142 @@ void SoundStream::streamData() {
 	alCheck( alDeleteBuffers( BufferCount, mBuffers ) );
 }
 
-bool SoundStream::fillAndPushBuffer( unsigned int bufferNum, bool immediateLoop ) {
-	bool requestStop = false;
+bool SoundStream::decodeAhead( Private::SoundStreamState& state ) {
+	bool decoded = false;
+	Private::SoundStreamChunk* chunk;
+
+	while ( !state.decodeFinished && ( chunk = state.ring.acquire() ) != NULL ) {
+		decodeChunk( state, *chunk );
+		state.ring.commit();
+		decoded = true;
+	}
+
+	return decoded;
+}
+
+void SoundStream::decodeChunk( Private::SoundStreamState& state,
+							   Private::SoundStreamChunk& chunk ) {
+	// Since no sound has been loaded yet, we can't schedule loop seeks preemptively,
+	// So if we start on EOF or Loop End, we adjust the sample count before queueing the chunk
+	bool immediateLoop = state.decodedChunks == 0;
+
+	chunk.samples.clear();
+	chunk.seek = NoLoop;
+	chunk.resetBefore = NoLoop;
+	chunk.last = false;
+
+	state.decodedChunks++;
 
 	// Acquire audio data, also address EOF and error cases if they occur
-	Chunk data = {NULL, 0};
+	Chunk data = { NULL, 0 };
 	for ( Uint32 retryCount = 0; !onGetData( data ) && ( retryCount < BufferRetries );
 		  ++retryCount ) {
 		// Check if the stream must loop or stop
 		if ( !mLoop ) {
 			// Not looping: Mark this buffer as ending with 0 and request stop
 			if ( data.samples != NULL && data.sampleCount != 0 )
-				mBufferSeeks[bufferNum] = 0;
-			requestStop = true;
+				chunk.seek = 0;
+			chunk.last = true;
 			break;
 		}
 
 		// Return to the beginning or loop-start of the stream source using onLoop(), and store the
-		// result in the buffer seek array This marks the buffer as the "last" one (so that we know
+		// result in the chunk seek. This marks the buffer as the "last" one (so that we know
 		// where to reset the playing position)
-		mBufferSeeks[bufferNum] = onLoop();
+		chunk.seek = onLoop();
 
 		// If we got data, break and process it, else try to fill the buffer once again
 		if ( data.samples != NULL && data.sampleCount != 0 )
 			break;
 
 		// If immediateLoop is specified, we have to immediately adjust the sample count
-		if ( immediateLoop && ( mBufferSeeks[bufferNum] != NoLoop ) ) {
+		if ( immediateLoop && ( chunk.seek != NoLoop ) ) {
 			// We just tried to begin preloading at EOF or Loop End: reset the sample count
-			mSamplesProcessed = mBufferSeeks[bufferNum];
-			mBufferSeeks[bufferNum] = NoLoop;
+			chunk.resetBefore = chunk.seek;
+			chunk.seek = NoLoop;
 		}
 
 		// We're a looping sound that got no data, so we retry onGetData()
 	}
 
-	// Fill the buffer if some data was returned
 	if ( data.samples && data.sampleCount ) {
+		chunk.samples.assign( data.samples, data.samples + data.sampleCount );
+	} else {
+		// If we get here, we most likely ran out of retries
+		chunk.last = true;
+	}
+
+	if ( chunk.last )
+		state.decodeFinished = true;
+}
+
+bool SoundStream::fillAndPushBuffer( Private::SoundStreamState& state, unsigned int bufferNum ) {
+	Private::SoundStreamChunk* chunk = state.ring.front();
+
+	if ( NULL == chunk ) {
+		// Nothing was decoded ahead of time, decode it now
+		std::unique_lock<std::mutex> decodeLock( state.decodeMutex );
+
+		// The scheduler could have committed the last chunk ( and finished decoding ) before the
+		// lock was taken, the stream only ends once that chunk was consumed
+		chunk = state.ring.front();
+
+		if ( NULL == chunk ) {
+			if ( state.decodeFinished )
+				return true;
+
+			if ( state.started ) {
+				mDecodeStallCount++;
+				SoundStreamScheduler::instance()->addDecodeStall();
+			}
+
+			if ( ( chunk = state.ring.acquire() ) != NULL ) {
+				decodeChunk( state, *chunk );
+				state.ring.commit();
+			}
+
+			chunk = state.ring.front();
+
+			if ( NULL == chunk )
+				return true;
+		}
+	}
+
+	bool requestStop = chunk->last;
+
+	if ( chunk->resetBefore != NoLoop )
+		mSamplesProcessed = chunk->resetBefore;
+
+	mBufferSeeks[bufferNum] = chunk->seek;
+
+	// Fill the buffer if some data was returned
+	if ( !chunk->samples.empty() ) {
 		unsigned int buffer = mBuffers[bufferNum];
 
 		// Fill the buffer
-		ALsizei size = static_cast<ALsizei>( data.sampleCount ) * sizeof( Int16 );
-		alCheck( alBufferData( buffer, mFormat, data.samples, size, mSampleRate ) );
+		ALsizei size = static_cast<ALsizei>( chunk->samples.size() ) * sizeof( Int16 );
+		alCheck( alBufferData( buffer, mFormat, chunk->samples.data(), size, mSampleRate ) );
 
 		// Push it into the sound queue
 		alCheck( alSourceQueueBuffers( mSource, 1, &buffer ) );
+
+		mLastChunkDuration = Seconds( static_cast<float>( chunk->samples.size() ) / mSampleRate /
+									  mChannelCount );
 	} else {
 		// If we get here, we most likely ran out of retries
 		requestStop = true;
 	}
 
+	state.ring.pop();
+
 	return requestStop;
 }
 
-bool SoundStream::fillQueue() {
+bool SoundStream::fillQueue( Private::SoundStreamState& state ) {
 	// Fill and enqueue all the available buffers
 	bool requestStop = false;
 	for ( int i = 0; ( i < BufferCount ) && !requestStop; ++i ) {
-		// Since no sound has been loaded yet, we can't schedule loop seeks preemptively,
-		// So if we start on EOF or Loop End, we let fillAndPushBuffer() adjust the sample count
-		if ( fillAndPushBuffer( i, ( i == 0 ) ) )
+		if ( fillAndPushBuffer( state, i ) )
 			requestStop = true;
 	}
 
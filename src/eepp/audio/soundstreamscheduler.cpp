@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <chrono>
+#include <eepp/audio/soundstreamscheduler.hpp>
+#include <eepp/audio/soundstreamstate.hpp>
+
+namespace EE { namespace Audio {
+
+SINGLETON_DECLARE_IMPLEMENTATION( SoundStreamScheduler )
+
+// Maximum time the feeder sleeps between two refills of the same stream
+static constexpr Int64 MAX_WAIT_MICROSECONDS = 250000;
+
+static Int64 nowMicroseconds() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			   std::chrono::steady_clock::now().time_since_epoch() )
+		.count();
+}
+
+SoundStreamScheduler::SoundStreamScheduler() :
+	mUnderrunCount( 0 ),
+	mDecodeStallCount( 0 ),
+	mDecodeRequested( false ),
+	mShuttingDown( false ) {}
+
+SoundStreamScheduler::~SoundStreamScheduler() {
+	{
+		std::unique_lock<std::mutex> lock( mMutex );
+		mShuttingDown = true;
+	}
+
+	mFeederCond.notify_all();
+	mDecoderCond.notify_all();
+
+	if ( mFeeder )
+		mFeeder->wait();
+
+	if ( mDecoder )
+		mDecoder->wait();
+}
+
+std::size_t SoundStreamScheduler::getStreamCount() const {
+	std::unique_lock<std::mutex> lock( mMutex );
+	return mStreams.size();
+}
+
+Uint64 SoundStreamScheduler::getUnderrunCount() const {
+	return mUnderrunCount;
+}
+
+Uint64 SoundStreamScheduler::getDecodeStallCount() const {
+	return mDecodeStallCount;
+}
+
+Uint32 SoundStreamScheduler::getThreadCount() const {
+	std::unique_lock<std::mutex> lock( mMutex );
+	return ( mFeeder ? 1 : 0 ) + ( mDecoder ? 1 : 0 );
+}
+
+void SoundStreamScheduler::launchThreads() {
+	if ( !mFeeder ) {
+		mFeeder = std::make_unique<Thread>( &SoundStreamScheduler::feederLoop, this );
+		mFeeder->launch();
+	}
+
+	if ( !mDecoder ) {
+		mDecoder = std::make_unique<Thread>( &SoundStreamScheduler::decoderLoop, this );
+		mDecoder->launch();
+	}
+}
+
+void SoundStreamScheduler::add( const std::shared_ptr<Private::SoundStreamState>& state ) {
+	{
+		std::unique_lock<std::mutex> lock( mMutex );
+		state->deadline = nowMicroseconds();
+		mStreams.push_back( state );
+		launchThreads();
+	}
+
+	mFeederCond.notify_one();
+}
+
+void SoundStreamScheduler::remove( const std::shared_ptr<Private::SoundStreamState>& state ) {
+	std::unique_lock<std::mutex> lock( mMutex );
+	auto it = std::find( mStreams.begin(), mStreams.end(), state );
+
+	if ( it != mStreams.end() )
+		mStreams.erase( it );
+}
+
+void SoundStreamScheduler::wakeUp( const std::shared_ptr<Private::SoundStreamState>& state ) {
+	{
+		std::unique_lock<std::mutex> lock( mMutex );
+		state->deadline = nowMicroseconds();
+	}
+
+	mFeederCond.notify_one();
+}
+
+void SoundStreamScheduler::requestDecode() {
+	{
+		std::unique_lock<std::mutex> lock( mMutex );
+		mDecodeRequested = true;
+	}
+
+	mDecoderCond.notify_one();
+}
+
+void SoundStreamScheduler::addUnderrun() {
+	mUnderrunCount++;
+}
+
+void SoundStreamScheduler::addDecodeStall() {
+	mDecodeStallCount++;
+}
+
+void SoundStreamScheduler::feederLoop() {
+	std::vector<std::shared_ptr<Private::SoundStreamState>> due;
+	std::unique_lock<std::mutex> lock( mMutex );
+
+	while ( !mShuttingDown ) {
+		Int64 now = nowMicroseconds();
+		Int64 nextDeadline = now + MAX_WAIT_MICROSECONDS;
+
+		due.clear();
+
+		for ( auto& state : mStreams ) {
+			Int64 deadline = state->deadline;
+
+			if ( deadline <= now ) {
+				due.push_back( state );
+			} else if ( deadline < nextDeadline ) {
+				nextDeadline = deadline;
+			}
+		}
+
+		if ( due.empty() ) {
+			mFeederCond.wait_for( lock, std::chrono::microseconds( nextDeadline - now ) );
+			continue;
+		}
+
+		lock.unlock();
+
+		bool finished = false;
+
+		for ( auto& state : due ) {
+			std::unique_lock<std::mutex> serviceLock( state->serviceMutex );
+
+			if ( !state->active ) {
+				finished = true;
+				continue;
+			}
+
+			Time nextUpdate( Time::Zero );
+
+			if ( !state->started ) {
+				state->stream->streamBegin( *state );
+				state->started = true;
+			}
+
+			if ( state->stream->streamUpdate( *state, nextUpdate ) ) {
+				state->deadline = nowMicroseconds() + eemin<Int64>( nextUpdate.asMicroseconds(),
+																   MAX_WAIT_MICROSECONDS );
+			} else {
+				state->stream->streamEnd();
+				state->active = false;
+				finished = true;
+			}
+		}
+
+		due.clear();
+
+		requestDecode();
+
+		lock.lock();
+
+		if ( finished ) {
+			mStreams.erase( std::remove_if( mStreams.begin(), mStreams.end(),
+											[]( const std::shared_ptr<Private::SoundStreamState>&
+													state ) { return !state->active; } ),
+							mStreams.end() );
+		}
+	}
+}
+
+void SoundStreamScheduler::decoderLoop() {
+	std::vector<std::shared_ptr<Private::SoundStreamState>> streams;
+	std::unique_lock<std::mutex> lock( mMutex );
+
+	while ( !mShuttingDown ) {
+		mDecoderCond.wait( lock, [this] { return mDecodeRequested || mShuttingDown; } );
+
+		if ( mShuttingDown )
+			break;
+
+		mDecodeRequested = false;
+		streams = mStreams;
+
+		lock.unlock();
+
+		for ( auto& state : streams ) {
+			std::unique_lock<std::mutex> decodeLock( state->decodeMutex );
+
+			if ( state->active && !state->decodeFinished )
+				state->stream->decodeAhead( *state );
+		}
+
+		streams.clear();
+
+		lock.lock();
+	}
+}
+
+}} // namespace EE::Audio
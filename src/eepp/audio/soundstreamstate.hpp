@@ -0,0 +1,100 @@
+#ifndef EE_AUDIO_SOUNDSTREAMSTATE_HPP
+#define EE_AUDIO_SOUNDSTREAMSTATE_HPP
+
+#include <array>
+#include <atomic>
+#include <eepp/audio/soundstream.hpp>
+#include <mutex>
+#include <vector>
+
+namespace EE { namespace Audio { namespace Private {
+
+////////////////////////////////////////////////////////////
+/// \brief Single producer / single consumer lock-free ring
+///		of fixed size slots
+///
+/// The producer acquires a free slot, fills it and commits it.
+/// The consumer peeks the oldest committed slot and pops it when
+/// it is done with it. Slots are reused, so once they warmed up
+/// no allocation happens while streaming.
+///
+////////////////////////////////////////////////////////////
+template <typename T, std::size_t N> class SPSCRing {
+  public:
+	SPSCRing() : mHead( 0 ), mTail( 0 ) {}
+
+	T* acquire() {
+		std::size_t head = mHead.load( std::memory_order_relaxed );
+
+		if ( head - mTail.load( std::memory_order_acquire ) == N )
+			return NULL;
+
+		return &mSlots[head % N];
+	}
+
+	void commit() {
+		mHead.store( mHead.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+	}
+
+	T* front() {
+		std::size_t tail = mTail.load( std::memory_order_relaxed );
+
+		if ( tail == mHead.load( std::memory_order_acquire ) )
+			return NULL;
+
+		return &mSlots[tail % N];
+	}
+
+	void pop() {
+		mTail.store( mTail.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+	}
+
+  protected:
+	std::array<T, N> mSlots;
+	std::atomic<std::size_t> mHead;
+	std::atomic<std::size_t> mTail;
+};
+
+////////////////////////////////////////////////////////////
+/// \brief A chunk of audio samples decoded ahead of time
+///
+////////////////////////////////////////////////////////////
+struct SoundStreamChunk {
+	std::vector<Int16> samples; ///< Decoded samples
+	Int64 seek;					///< Next seek position if this is an "end buffer", else NoLoop
+	Int64 resetBefore;			///< Sample count to set before queueing it, else NoLoop
+	bool last;					///< The stream source requested to stop after this chunk
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Streaming state of a playing SoundStream, shared
+///		between the stream and the SoundStreamScheduler
+///
+////////////////////////////////////////////////////////////
+struct SoundStreamState {
+	enum {
+		DecodeAheadChunks = 2 ///< Number of chunks decoded ahead of the OpenAL queue
+	};
+
+	explicit SoundStreamState( SoundStream* stream ) :
+		stream( stream ),
+		active( true ),
+		started( false ),
+		decodeFinished( false ),
+		decodedChunks( 0 ),
+		deadline( 0 ) {}
+
+	SoundStream* stream;
+	std::mutex serviceMutex; ///< Held while the OpenAL queue of the stream is serviced
+	std::mutex decodeMutex;	 ///< Held while the stream source is being decoded
+	std::atomic<bool> active;
+	bool started;
+	bool decodeFinished;
+	Uint64 decodedChunks;
+	std::atomic<Int64> deadline; ///< Time of the next refill, in microseconds
+	SPSCRing<SoundStreamChunk, DecodeAheadChunks> ring;
+};
+
+}}} // namespace EE::Audio::Private
+
+#endif
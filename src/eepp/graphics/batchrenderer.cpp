@@ -3,6 +3,7 @@
 #include <eepp/graphics/renderer/openglext.hpp>
 #include <eepp/graphics/renderer/renderer.hpp>
 #include <eepp/graphics/texture.hpp>
+#include <eepp/system/profiler.hpp>
 
 namespace EE { namespace Graphics {
 
@@ -90,6 +91,8 @@ void BatchRenderer::flush() {
 	if ( mNumVertex == 0 )
 		return;
 
+	eePROFILE_SCOPE( "BatchRenderer::flush" );
+
 	if ( GlobalBatchRenderer::instance() != this )
 		GlobalBatchRenderer::instance()->draw();
 
@@ -852,7 +855,8 @@ Float BatchRenderer::getLineWidth() {
 	float lw = 1;
 
 #if EE_PLATFORM != EE_PLATFORM_EMSCRIPTEN
-	glGetFloatv( GL_LINE_WIDTH, &lw );
+	if ( GLv_Null != GLi->version() )
+		glGetFloatv( GL_LINE_WIDTH, &lw );
 #endif
 
 	return lw;
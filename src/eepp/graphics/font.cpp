@@ -62,6 +62,10 @@ const String::HashType& Font::getId() {
 	return mFontHash;
 }
 
+Uint32 Font::getTextureGeneration( unsigned int ) const {
+	return 0;
+}
+
 Uint32 Font::pushFontEventCallback( const FontEventCallback& cb ) {
 	mNumCallBacks++;
 	mCallbacks[mNumCallBacks] = cb;
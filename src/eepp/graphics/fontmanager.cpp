@@ -1,4 +1,5 @@
 #include <eepp/graphics/fontmanager.hpp>
+#include <eepp/graphics/fonttruetype.hpp>
 
 namespace EE { namespace Graphics {
 
@@ -37,4 +38,14 @@ void FontManager::setFallbackFont( Font* fallbackFont ) {
 	mFallbackFont = fallbackFont;
 }
 
+bool FontManager::update( bool* metricsChanged ) {
+	bool updated = false;
+	for ( auto& font : getResources() ) {
+		if ( font.second->getType() == FontType::TTF &&
+			 static_cast<FontTrueType*>( font.second )->updateAsyncGlyphs( metricsChanged ) )
+			updated = true;
+	}
+	return updated;
+}
+
 }} // namespace EE::Graphics
@@ -1,11 +1,20 @@
 #include <eepp/graphics/fontmanager.hpp>
 #include <eepp/graphics/fonttruetype.hpp>
+#include <eepp/graphics/renderer/renderer.hpp>
+#include <eepp/graphics/shader.hpp>
+#include <eepp/graphics/shaderprogram.hpp>
+#include <eepp/graphics/shaderprogrammanager.hpp>
 #include <eepp/graphics/texturefactory.hpp>
 #include <eepp/system/filesystem.hpp>
 #include <eepp/system/iostream.hpp>
 #include <eepp/system/log.hpp>
 #include <eepp/system/pack.hpp>
 #include <eepp/system/packmanager.hpp>
+#include <eepp/system/sys.hpp>
+#include <eepp/system/thread.hpp>
+#include <eepp/window/engine.hpp>
+#include <eepp/window/input.hpp>
+#include <eepp/window/window.hpp>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -14,9 +23,17 @@
 #include FT_BITMAP_H
 #include FT_STROKER_H
 #include FT_TRUETYPE_TABLES_H
+#include FT_ADVANCES_H
 #include <atomic>
+#include <cmath>
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+
+using namespace EE::Window;
 
 namespace {
 
@@ -51,6 +68,89 @@ EE::Uint64 combine( float outlineThickness, bool bold, EE::Uint32 index,
 		   ( static_cast<EE::Uint64>( bold ) << 32 ) | index;
 }
 
+// The page generations are unique across the fonts: the emoji and fallback fonts place their
+// glyphs in the pages of other fonts, and the texts cache the generation of every page they use
+std::atomic<EE::Uint32> sPageGeneration{ 0 };
+
+EE::Uint32 nextPageGeneration() {
+	return ++sPageGeneration;
+}
+
+// Squared euclidean distance transform of a row or column ( Felzenszwalb & Huttenlocher )
+void distanceTransform1D( float* grid, const int& offset, const int& stride, const int& length,
+						  float* f, float* z, int* v ) {
+	for ( int q = 0; q < length; ++q )
+		f[q] = grid[offset + q * stride];
+
+	// Intersection of the parabolas rooted at q and r
+	auto intersection = [f]( const int& q, const int& r ) {
+		return ( f[q] - f[r] + static_cast<float>( q * q - r * r ) ) /
+			   static_cast<float>( 2 * ( q - r ) );
+	};
+
+	int k = 0;
+	v[0] = 0;
+	z[0] = -std::numeric_limits<float>::infinity();
+	z[1] = std::numeric_limits<float>::infinity();
+
+	for ( int q = 1; q < length; ++q ) {
+		float s = intersection( q, v[k] );
+		while ( s <= z[k] ) {
+			--k;
+			s = intersection( q, v[k] );
+		}
+		++k;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = std::numeric_limits<float>::infinity();
+	}
+
+	k = 0;
+	for ( int q = 0; q < length; ++q ) {
+		while ( z[k + 1] < q )
+			++k;
+		int r = v[k];
+		grid[offset + q * stride] = f[r] + static_cast<float>( ( q - r ) * ( q - r ) );
+	}
+}
+
+void distanceTransform2D( std::vector<float>& grid, const int& width, const int& height ) {
+	int length = EE::eemax( width, height );
+	std::vector<float> f( length );
+	std::vector<float> z( length + 1 );
+	std::vector<int> v( length );
+
+	for ( int x = 0; x < width; ++x )
+		distanceTransform1D( grid.data(), x, width, height, f.data(), z.data(), v.data() );
+
+	for ( int y = 0; y < height; ++y )
+		distanceTransform1D( grid.data(), y * width, 1, width, f.data(), z.data(), v.data() );
+}
+
+const char* DISTANCE_FIELD_VS = R"(
+void main(void)
+{
+	gl_FrontColor	= gl_Color;
+	gl_TexCoord[0]	= gl_TextureMatrix[0] * gl_MultiTexCoord0;
+	gl_Position		= ftransform();
+}
+)";
+
+const char* DISTANCE_FIELD_FS = R"(
+uniform sampler2D	textureUnit0;
+uniform float		distanceFieldEdge;
+uniform float		distanceFieldSmoothing;
+void main(void)
+{
+	float distance	= texture2D( textureUnit0, gl_TexCoord[0].xy ).a;
+	float alpha		= smoothstep( distanceFieldEdge - distanceFieldSmoothing,
+								  distanceFieldEdge + distanceFieldSmoothing, distance );
+	gl_FragColor	= vec4( gl_Color.rgb, gl_Color.a * alpha );
+}
+)";
+
+const char* DISTANCE_FIELD_SHADER_NAME = "eepp_font_distance_field";
+
 } // namespace
 
 namespace EE { namespace Graphics {
@@ -58,6 +158,131 @@ namespace EE { namespace Graphics {
 static std::map<std::string, Uint32> fontsInternalIds;
 static std::atomic<Uint32> fontInternalIdCounter{ 0 };
 
+// Rasterizes the glyphs requested by a font with its own FreeType face, FreeType objects can't be
+// shared between threads
+struct FontTrueType::AsyncRasterizer {
+	struct Request {
+		Uint64 key;
+		Uint32 index;
+		unsigned int characterSize;
+		bool bold;
+		Float outlineThickness;
+		Float maxWidth;
+	};
+
+	struct Result {
+		Request request;
+		RasterizedGlyph raster;
+		bool rasterized{ false };
+	};
+
+	explicit AsyncRasterizer( const FontTrueType* font ) : mFont( font ) {
+		mThread = std::make_unique<Thread>( &AsyncRasterizer::run, this );
+		mThread->launch();
+	}
+
+	~AsyncRasterizer() {
+		{
+			Lock l( mMutex );
+			mRunning = false;
+		}
+		mCondition.notify_all();
+		mThread->wait();
+	}
+
+	void request( const Request& request ) {
+		{
+			Lock l( mMutex );
+			mRequests.push_back( request );
+		}
+		mCondition.notify_one();
+	}
+
+	std::vector<Result> takeResults() {
+		std::vector<Result> results;
+		Lock l( mMutex );
+		results.swap( mResults );
+		return results;
+	}
+
+  protected:
+	typedef std::unique_lock<std::mutex> Lock;
+
+	const FontTrueType* mFont;
+	std::unique_ptr<Thread> mThread;
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	std::deque<Request> mRequests;
+	std::vector<Result> mResults;
+	bool mRunning{ true };
+
+	void run() {
+		FT_Library library = nullptr;
+		FT_Face face = nullptr;
+		FT_Stroker stroker = nullptr;
+
+		if ( FT_Init_FreeType( &library ) == 0 ) {
+			FT_Error err =
+				!mFont->mFontPath.empty()
+					? FT_New_Face( library, mFont->mFontPath.c_str(), 0, &face )
+					: FT_New_Memory_Face( library,
+										  reinterpret_cast<const FT_Byte*>( mFont->mFontData ),
+										  static_cast<FT_Long>( mFont->mFontDataSize ), 0, &face );
+			if ( err != 0 || FT_Select_Charmap( face, FT_ENCODING_UNICODE ) != 0 ) {
+				Log::error( "Failed to open the rasterizer face of the font %s",
+							mFont->mFontName.c_str() );
+				if ( err == 0 )
+					FT_Done_Face( face );
+				face = nullptr;
+			} else if ( !mFont->mIsColorEmojiFont ) {
+				FT_Stroker_New( library, &stroker );
+			}
+		}
+
+		while ( true ) {
+			Request request;
+
+			{
+				Lock l( mMutex );
+				mCondition.wait( l, [this] { return !mRunning || !mRequests.empty(); } );
+				if ( !mRunning )
+					break;
+				request = mRequests.front();
+				mRequests.pop_front();
+			}
+
+			// A failed glyph is rasterized again by the font in the main thread
+			Result result;
+			result.request = request;
+			result.rasterized =
+				nullptr != face &&
+				mFont->rasterizeGlyph( library, face, stroker, request.index,
+									   request.characterSize, request.bold,
+									   request.outlineThickness, request.maxWidth, result.raster );
+
+			bool wakeUp;
+
+			{
+				Lock l( mMutex );
+				wakeUp = mResults.empty();
+				mResults.emplace_back( std::move( result ) );
+			}
+
+			// Let a main loop waiting for events upload the glyphs
+			if ( wakeUp && Engine::existsSingleton() &&
+				 nullptr != Engine::instance()->getCurrentWindow() )
+				Engine::instance()->getCurrentWindow()->getInput()->wakeUp();
+		}
+
+		if ( stroker )
+			FT_Stroker_Done( stroker );
+		if ( face )
+			FT_Done_Face( face );
+		if ( library )
+			FT_Done_FreeType( library );
+	}
+};
+
 FontTrueType* FontTrueType::New( const std::string& FontName ) {
 	return eeNew( FontTrueType, ( FontName ) );
 }
@@ -165,6 +390,9 @@ bool FontTrueType::loadFromFile( const std::string& filename ) {
 
 	updateFontInternalId();
 
+	mFontPath = filename;
+	setAsyncRasterization( mAsyncRasterization );
+
 	sendEvent( Event::Load );
 
 	return true;
@@ -238,6 +466,10 @@ bool FontTrueType::loadFromMemory( const void* data, std::size_t sizeInBytes, bo
 
 	updateFontInternalId();
 
+	mFontData = ptr;
+	mFontDataSize = sizeInBytes;
+	setAsyncRasterization( mAsyncRasterization );
+
 	sendEvent( Event::Load );
 
 	return true;
@@ -379,49 +611,95 @@ Uint32 FontTrueType::getGlyphIndex( const Uint32& codePoint ) const {
 	return index;
 }
 
-const Glyph& FontTrueType::getGlyph( Uint32 codePoint, unsigned int characterSize, bool bold,
-									 Float outlineThickness, Float maxWidth ) const {
+const FontTrueType::CodePointFont& FontTrueType::getCodePointFont( const Uint32& codePoint ) const {
+	auto it = mCodePointFontCache.find( codePoint );
+	if ( it != mCodePointFontCache.end() )
+		return it->second;
+
+	CodePointFont codePointFont;
+	codePointFont.font = this;
+
 	if ( mEnableEmojiFallback && Font::isEmojiCodePoint( codePoint ) && !mIsColorEmojiFont &&
 		 !mIsEmojiFont ) {
-		if ( !mIsColorEmojiFont && FontManager::instance()->getColorEmojiFont() != nullptr &&
+		if ( FontManager::instance()->getColorEmojiFont() != nullptr &&
 			 FontManager::instance()->getColorEmojiFont()->getType() == FontType::TTF ) {
-
-			if ( isMonospace() && maxWidth == 0.f ) {
-				Glyph monospaceGlyph = getGlyph( ' ', characterSize, bold, outlineThickness );
-				maxWidth = monospaceGlyph.advance;
-			}
-
 			FontTrueType* fontEmoji =
 				static_cast<FontTrueType*>( FontManager::instance()->getColorEmojiFont() );
-			if ( 0 != fontEmoji->getGlyphIndex( codePoint ) )
-				return fontEmoji->getGlyph( codePoint, characterSize, bold, outlineThickness,
-											getPage( characterSize ), maxWidth );
-		} else if ( !mIsEmojiFont && FontManager::instance()->getEmojiFont() != nullptr &&
-					FontManager::instance()->getEmojiFont()->getType() == FontType::TTF ) {
-
-			if ( isMonospace() && maxWidth == 0.f ) {
-				Glyph monospaceGlyph = getGlyph( ' ', characterSize, bold, outlineThickness );
-				maxWidth = monospaceGlyph.advance;
+			if ( 0 != fontEmoji->getGlyphIndex( codePoint ) ) {
+				codePointFont.font = fontEmoji;
+				codePointFont.isEmoji = true;
 			}
-
+		} else if ( FontManager::instance()->getEmojiFont() != nullptr &&
+					FontManager::instance()->getEmojiFont()->getType() == FontType::TTF ) {
 			FontTrueType* fontEmoji =
 				static_cast<FontTrueType*>( FontManager::instance()->getEmojiFont() );
-			if ( 0 != fontEmoji->getGlyphIndex( codePoint ) )
-				return fontEmoji->getGlyph( codePoint, characterSize, bold, outlineThickness,
-											getPage( characterSize ), maxWidth );
+			if ( 0 != fontEmoji->getGlyphIndex( codePoint ) ) {
+				codePointFont.font = fontEmoji;
+				codePointFont.isEmoji = true;
+			}
 		}
 	}
 
-	Uint32 glyphIndex = getGlyphIndex( codePoint );
-	if ( 0 == glyphIndex && mEnableFallbackFont && FontManager::instance()->getFallbackFont() &&
+	if ( !codePointFont.isEmoji && 0 == getGlyphIndex( codePoint ) && mEnableFallbackFont &&
+		 FontManager::instance()->getFallbackFont() &&
 		 FontManager::instance()->getFallbackFont()->getType() == FontType::TTF ) {
-		FontTrueType* fallbackFont =
+		codePointFont.font =
 			static_cast<FontTrueType*>( FontManager::instance()->getFallbackFont() );
-		return fallbackFont->getGlyph( codePoint, characterSize, bold, outlineThickness,
-									   getPage( characterSize ), maxWidth );
 	}
 
-	return getGlyphByIndex( glyphIndex, characterSize, bold, outlineThickness );
+	return mCodePointFontCache.insert( std::make_pair( codePoint, codePointFont ) ).first->second;
+}
+
+void FontTrueType::validateLookupCache() const {
+	const Font* colorEmojiFont = FontManager::instance()->getColorEmojiFont();
+	const Font* emojiFont = FontManager::instance()->getEmojiFont();
+	const Font* fallbackFont = FontManager::instance()->getFallbackFont();
+
+	if ( colorEmojiFont != mLookupColorEmojiFont || emojiFont != mLookupEmojiFont ||
+		 fallbackFont != mLookupFallbackFont ) {
+		mLookupColorEmojiFont = colorEmojiFont;
+		mLookupEmojiFont = emojiFont;
+		mLookupFallbackFont = fallbackFont;
+		clearLookupCache();
+	}
+}
+
+void FontTrueType::clearLookupCache() const {
+	mCodePointFontCache.clear();
+	for ( auto& page : mPages )
+		page.second->clearLookupCache();
+}
+
+const Glyph& FontTrueType::getGlyph( Uint32 codePoint, unsigned int characterSize, bool bold,
+									 Float outlineThickness, Float maxWidth ) const {
+	validateLookupCache();
+
+	Page& page = getPage( characterSize );
+	bool isLatin = codePoint < LATIN_GLYPHS_COUNT && outlineThickness == 0.f && maxWidth == 0.f;
+
+	if ( isLatin && nullptr != page.latinGlyphs[bold][codePoint] )
+		return *page.latinGlyphs[bold][codePoint];
+
+	const CodePointFont& codePointFont = getCodePointFont( codePoint );
+	const Glyph* glyph;
+
+	if ( codePointFont.font == this ) {
+		glyph = &getGlyphByIndex( getGlyphIndex( codePoint ), characterSize, bold,
+								  outlineThickness, page, 0.f );
+	} else {
+		if ( codePointFont.isEmoji && isMonospace() && maxWidth == 0.f ) {
+			Glyph monospaceGlyph = getGlyph( ' ', characterSize, bold, outlineThickness );
+			maxWidth = monospaceGlyph.advance;
+		}
+
+		glyph = &codePointFont.font->getGlyph( codePoint, characterSize, bold, outlineThickness,
+											   page, maxWidth );
+	}
+
+	if ( isLatin )
+		page.latinGlyphs[bold][codePoint] = glyph;
+
+	return *glyph;
 }
 
 const Glyph& FontTrueType::getGlyph( Uint32 codePoint, unsigned int characterSize, bool bold,
@@ -445,8 +723,28 @@ const Glyph& FontTrueType::getGlyphByIndex( Uint32 index, unsigned int character
 	if ( it != glyphs.end() ) {
 		// Found: just return it
 		return it->second;
+	} else if ( nullptr != page.atlas ) {
+		// The glyph is scaled from the distance field atlas
+		Glyph glyph = getDistanceFieldGlyph( index, characterSize, bold, outlineThickness, page,
+											 maxWidth );
+
+		return glyphs.insert( std::make_pair( key, glyph ) ).first->second;
 	} else {
-		// Not found: we have to load it
+		// Not found: we have to load it, or request it to the worker if the page is owned by the
+		// font ( the emoji and fallback glyphs are stored in the pages of the other fonts )
+		if ( mAsyncRasterizer && Engine::instance()->isMainThread() ) {
+			auto pageIt = mPages.find( characterSize );
+
+			if ( pageIt != mPages.end() && pageIt->second.get() == &page ) {
+				mAsyncRasterizer->request(
+					{ key, index, characterSize, bold, outlineThickness, maxWidth } );
+				page.pendingGlyphs.insert( key );
+				Glyph glyph =
+					getPlaceholderGlyph( index, characterSize, bold, outlineThickness, maxWidth );
+				return glyphs.insert( std::make_pair( key, glyph ) ).first->second;
+			}
+		}
+
 		Glyph glyph = loadGlyph( index, characterSize, bold, outlineThickness, page, maxWidth );
 
 		return glyphs.insert( std::make_pair( key, glyph ) ).first->second;
@@ -459,84 +757,125 @@ const Glyph& FontTrueType::getGlyphByIndex( Uint32 index, unsigned int character
 							0.f );
 }
 
+struct FontTrueType::PageGlyphDrawable : public GlyphDrawable {
+	PageGlyphDrawable( const FontTrueType* font, Uint32 codePoint, unsigned int characterSize,
+					   bool bold, Float outlineThickness, const Float& maxWidth ) :
+		GlyphDrawable( nullptr, Rect(),
+					   String::format( "%s_%d_%u", font->getName().c_str(), characterSize,
+									   codePoint ) ),
+		font( font ),
+		codePoint( codePoint ),
+		characterSize( characterSize ),
+		bold( bold ),
+		outlineThickness( outlineThickness ),
+		maxWidth( maxWidth ) {
+		validate();
+	}
+
+	// The page can be released or its glyphs dropped at any time, the glyph is looked up again
+	// every time the page changes
+	void validate() override {
+		Page& page = font->getDrawablePage( characterSize );
+		if ( page.generation == generation && page.texture == mTexture )
+			return;
+
+		const Glyph& glyph = font->getDrawableGlyph( page, codePoint, characterSize, bold,
+													 outlineThickness, maxWidth );
+		mTexture = page.texture;
+		mSrcRect = glyph.textureRect.asFloat();
+		setGlyphOffset( { glyph.bounds.Left - outlineThickness,
+						  characterSize + glyph.bounds.Top - outlineThickness } );
+		generation = page.generation;
+	}
+
+	const FontTrueType* font;
+	Uint32 codePoint;
+	unsigned int characterSize;
+	bool bold;
+	Float outlineThickness;
+	Float maxWidth;
+	Uint32 generation{ 0 };
+};
+
 GlyphDrawable* FontTrueType::getGlyphDrawable( Uint32 codePoint, unsigned int characterSize,
 											   bool bold, Float outlineThickness,
 											   const Float& maxWidth ) const {
-	Page& page = getPage( characterSize );
-	GlyphDrawableTable& drawables = page.drawables;
-
-	Uint32 glyphIndex = 0;
-	Uint32 tGlyphIndex = 0;
-	Uint32 fontInternalId = mFontInternalId;
-
-	if ( mEnableEmojiFallback && Font::isEmojiCodePoint( codePoint ) && !mIsColorEmojiFont &&
-		 !mIsEmojiFont ) {
-		if ( !mIsColorEmojiFont && FontManager::instance()->getColorEmojiFont() != nullptr &&
-			 FontManager::instance()->getColorEmojiFont()->getType() == FontType::TTF ) {
-			FontTrueType* fontEmoji =
-				static_cast<FontTrueType*>( FontManager::instance()->getColorEmojiFont() );
-			tGlyphIndex = fontEmoji->getGlyphIndex( codePoint );
-			if ( 0 != tGlyphIndex ) {
-				glyphIndex = tGlyphIndex;
-				fontInternalId = fontEmoji->getFontInternalId();
-			} else {
-				glyphIndex = getGlyphIndex( codePoint );
-			}
-		} else if ( !mIsEmojiFont && FontManager::instance()->getEmojiFont() != nullptr &&
-					FontManager::instance()->getEmojiFont()->getType() == FontType::TTF ) {
-			FontTrueType* fontEmoji =
-				static_cast<FontTrueType*>( FontManager::instance()->getEmojiFont() );
-			tGlyphIndex = fontEmoji->getGlyphIndex( codePoint );
-			if ( 0 != tGlyphIndex ) {
-				glyphIndex = tGlyphIndex;
-				fontInternalId = fontEmoji->getFontInternalId();
-			} else {
-				glyphIndex = getGlyphIndex( codePoint );
-			}
-		} else {
-			glyphIndex = getGlyphIndex( codePoint );
-		}
-	} else {
-		glyphIndex = getGlyphIndex( codePoint );
-	}
+	validateLookupCache();
 
-	if ( 0 == glyphIndex && mEnableFallbackFont &&
-		 FontManager::instance()->getFallbackFont() != nullptr &&
-		 FontManager::instance()->getFallbackFont()->getType() == FontType::TTF ) {
-		FontTrueType* fontFallback =
-			static_cast<FontTrueType*>( FontManager::instance()->getFallbackFont() );
-		tGlyphIndex = fontFallback->getGlyphIndex( codePoint );
-		if ( 0 != tGlyphIndex ) {
-			glyphIndex = tGlyphIndex;
-			fontInternalId = fontFallback->getFontInternalId();
-		} else {
-			glyphIndex = getGlyphIndex( codePoint );
-		}
-	}
+	const CodePointFont& codePointFont = getCodePointFont( codePoint );
+	Uint32 glyphIndex = codePointFont.font->getGlyphIndex( codePoint );
+	Uint32 fontInternalId = codePointFont.font->getFontInternalId();
 
 	Uint64 key = getIndexKey( fontInternalId, glyphIndex, bold, outlineThickness );
 
+	// The drawables are owned by the font, the pages can be released while they're being used
+	GlyphDrawableTable& drawables = mGlyphDrawables[characterSize];
 	auto it = drawables.find( key );
-	if ( it != drawables.end() ) {
+	if ( it != drawables.end() )
 		return it->second;
-	} else {
-		const Glyph& glyph = getGlyph( codePoint, characterSize, bold, outlineThickness, maxWidth );
-		GlyphDrawable* region = GlyphDrawable::New(
-			page.texture, glyph.textureRect,
-			String::format( "%s_%d_%u", mFontName.c_str(), characterSize, codePoint ) );
-		region->setGlyphOffset( { glyph.bounds.Left - outlineThickness,
-								  characterSize + glyph.bounds.Top - outlineThickness } );
-		drawables[key] = region;
-		return region;
+
+	GlyphDrawable* region = eeNew( PageGlyphDrawable, ( this, codePoint, characterSize, bold,
+														outlineThickness, maxWidth ) );
+	drawables[key] = region;
+	return region;
+}
+
+const Glyph& FontTrueType::getDrawableGlyph( Page& page, Uint32 codePoint,
+											 unsigned int characterSize, bool bold,
+											 Float outlineThickness,
+											 const Float& maxWidth ) const {
+	// The drawables are drawn without the distance field shader, they need bitmap glyphs
+	if ( mDistanceField )
+		return getCodePointFont( codePoint ).font->getGlyph( codePoint, characterSize, bold,
+															 outlineThickness, page, maxWidth );
+
+	const Glyph& glyph = getGlyph( codePoint, characterSize, bold, outlineThickness, maxWidth );
+
+	// The drawable keeps the texture rect of the glyph, it can't be built from a placeholder, so
+	// a glyph requested to the worker is rasterized right away ( the worker result will be
+	// discarded )
+	const CodePointFont& codePointFont = getCodePointFont( codePoint );
+	Uint32 glyphIndex = codePointFont.font->getGlyphIndex( codePoint );
+	Uint64 key =
+		getIndexKey( codePointFont.font->getFontInternalId(), glyphIndex, bold, outlineThickness );
+
+	if ( page.pendingGlyphs.erase( key ) > 0 ) {
+		Glyph loaded =
+			loadGlyph( glyphIndex, characterSize, bold, outlineThickness, page, maxWidth );
+		page.clearLookupCache();
+		page.generation = nextPageGeneration();
+		return page.glyphs[key] = loaded;
 	}
+
+	return glyph;
 }
 
 Float FontTrueType::getKerning( Uint32 first, Uint32 second, unsigned int characterSize,
 								bool bold ) const {
 	// Special case where first or second is 0 (null character)
-	if ( first == 0 || second == 0 || isMonospace() )
+	if ( first == 0 || second == 0 || isMonospace() || !mFace )
 		return 0.f;
 
+	validateLookupCache();
+
+	// Code points are 21 bits long, the pair and the style fit in the key
+	Uint64 key = ( static_cast<Uint64>( bold ) << 63 ) | ( static_cast<Uint64>( first ) << 32 ) |
+				 second;
+	Page& page = getPage( characterSize );
+	auto it = page.kernings.find( key );
+	if ( it != page.kernings.end() )
+		return it->second;
+
+	// The distance field glyphs are scaled from the atlas glyphs, and so is their kerning
+	Float kerning = mDistanceField ? computeKerning( first, second, DISTANCE_FIELD_SIZE, bold ) *
+										 characterSize / DISTANCE_FIELD_SIZE
+								   : computeKerning( first, second, characterSize, bold );
+	page.kernings[key] = kerning;
+	return kerning;
+}
+
+Float FontTrueType::computeKerning( Uint32 first, Uint32 second, unsigned int characterSize,
+									bool bold ) const {
 	FT_Face face = static_cast<FT_Face>( mFace );
 
 	if ( face && setCurrentSize( characterSize ) ) {
@@ -645,6 +984,9 @@ bool FontTrueType::loaded() const {
 FontTrueType& FontTrueType::operator=( const FontTrueType& right ) {
 	FontTrueType temp( right.getName() );
 
+	// The worker reads the font face source
+	mAsyncRasterizer.reset();
+
 	temp.mMemCopy.swap( right.mMemCopy );
 	std::swap( mLibrary, temp.mLibrary );
 	std::swap( mFace, temp.mFace );
@@ -653,13 +995,29 @@ FontTrueType& FontTrueType::operator=( const FontTrueType& right ) {
 	std::swap( mRefCount, temp.mRefCount );
 	std::swap( mInfo, temp.mInfo );
 	std::swap( mPages, temp.mPages );
+	std::swap( mDistanceFieldPage, temp.mDistanceFieldPage );
+	std::swap( mDrawablePages, temp.mDrawablePages );
+	std::swap( mGlyphDrawables, temp.mGlyphDrawables );
 	std::swap( mPixelBuffer, temp.mPixelBuffer );
+	std::swap( mFontPath, temp.mFontPath );
+	std::swap( mFontData, temp.mFontData );
+	std::swap( mFontDataSize, temp.mFontDataSize );
+	mLastPage = nullptr;
+	mCodePointIndexCache.clear();
+	mCodePointFontCache.clear();
+	setAsyncRasterization( mAsyncRasterization );
 	return *this;
 }
 
 void FontTrueType::cleanup() {
 	sendEvent( Event::Unload );
 
+	// Stop the worker before releasing anything it could be reading
+	mAsyncRasterizer.reset();
+	mFontPath.clear();
+	mFontData = nullptr;
+	mFontDataSize = 0;
+
 	if ( FontManager::existsSingleton() && FontManager::instance()->getColorEmojiFont() == this )
 		FontManager::instance()->setColorEmojiFont( nullptr );
 
@@ -700,29 +1058,60 @@ void FontTrueType::cleanup() {
 	mStroker = NULL;
 	mStreamRec = NULL;
 	mRefCount = NULL;
+	mLastPage = nullptr;
 	mPages.clear();
+	mDistanceFieldPage.reset();
+	mDrawablePages.clear();
+	for ( auto& drawables : mGlyphDrawables )
+		for ( auto& drawable : drawables.second )
+			eeDelete( drawable.second );
+	mGlyphDrawables.clear();
+	mCodePointIndexCache.clear();
+	mCodePointFontCache.clear();
 	std::vector<Uint8>().swap( mPixelBuffer );
 }
 
 Glyph FontTrueType::loadGlyph( Uint32 index, unsigned int characterSize, bool bold,
 							   Float outlineThickness, Page& page, const Float& maxWidth ) const {
+	// Reuse the pixel buffer between glyphs
+	RasterizedGlyph raster;
+	raster.pixels.swap( mPixelBuffer );
+
+	if ( rasterizeGlyph( mLibrary, mFace, mStroker, index, characterSize, bold, outlineThickness,
+						 maxWidth, raster ) ) {
+		if ( page.distanceField )
+			computeDistanceField( raster );
+
+		placeGlyph( page, raster );
+	}
+
+	raster.pixels.swap( mPixelBuffer );
+
+	return raster.glyph;
+}
+
+bool FontTrueType::rasterizeGlyph( void* library, void* ftFace, void* ftStroker, Uint32 index,
+								   unsigned int characterSize, bool bold, Float outlineThickness,
+								   const Float& maxWidth, RasterizedGlyph& raster ) const {
 	// The glyph to return
-	Glyph glyph;
+	Glyph& glyph = raster.glyph;
+	glyph = Glyph();
+	raster.rectWidth = raster.rectHeight = 0;
 
 	// First, transform our ugly void* to a FT_Face
-	FT_Face face = static_cast<FT_Face>( mFace );
+	FT_Face face = static_cast<FT_Face>( ftFace );
 	if ( !face ) {
 		Log::error( "FT_Face failed for: codePoint %d characterSize: %d font %s", index,
 					characterSize, mFontName.c_str() );
-		return glyph;
+		return false;
 	}
 
 	// Set the character size
-	if ( !setCurrentSize( characterSize ) ) {
+	if ( !setCurrentSize( face, characterSize ) ) {
 		Log::error(
 			"FontTrueType::setCurrentSize failed for: codePoint %d characterSize: %d font %s",
 			index, characterSize, mFontName.c_str() );
-		return glyph;
+		return false;
 	}
 
 	FT_Error err = 0;
@@ -734,7 +1123,7 @@ Glyph FontTrueType::loadGlyph( Uint32 index, unsigned int characterSize, bool bo
 	if ( ( err = FT_Load_Glyph( face, index, flags ) ) != 0 ) {
 		Log::error( "FT_Load_Char failed for: codePoint %d characterSize: %d font: %s error: %d",
 					index, characterSize, mFontName.c_str(), err );
-		return glyph;
+		return false;
 	}
 
 	// Retrieve the glyph
@@ -742,7 +1131,7 @@ Glyph FontTrueType::loadGlyph( Uint32 index, unsigned int characterSize, bool bo
 	if ( FT_Get_Glyph( face->glyph, &glyphDesc ) != 0 ) {
 		Log::error( "FT_Get_Glyph failed for: codePoint %d characterSize: %d font: %s", index,
 					characterSize, mFontName.c_str() );
-		return glyph;
+		return false;
 	}
 
 	// Apply bold and outline (there is no fallback for outline) if necessary -- first technique
@@ -756,7 +1145,7 @@ Glyph FontTrueType::loadGlyph( Uint32 index, unsigned int characterSize, bool bo
 		}
 
 		if ( outlineThickness != 0 && !mIsColorEmojiFont ) {
-			FT_Stroker stroker = static_cast<FT_Stroker>( mStroker );
+			FT_Stroker stroker = static_cast<FT_Stroker>( ftStroker );
 
 			FT_Stroker_Set(
 				stroker, static_cast<FT_Fixed>( outlineThickness * static_cast<Float>( 1 << 6 ) ),
@@ -772,7 +1161,7 @@ Glyph FontTrueType::loadGlyph( Uint32 index, unsigned int characterSize, bool bo
 	// Apply bold if necessary -- fallback technique using bitmap (lower quality)
 	if ( !outline ) {
 		if ( bold )
-			FT_Bitmap_Embolden( static_cast<FT_Library>( mLibrary ), &bitmap, weight, weight );
+			FT_Bitmap_Embolden( static_cast<FT_Library>( library ), &bitmap, weight, weight );
 
 		if ( outlineThickness != 0 && !mIsColorEmojiFont )
 			Log::error( "Failed to outline glyph (no fallback available)" );
@@ -835,9 +1224,9 @@ Glyph FontTrueType::loadGlyph( Uint32 index, unsigned int characterSize, bool bo
 
 		// Resize the pixel buffer to the new size and fill it with transparent white pixels
 		const Uint32 bufferSize = width * height * 4;
-		mPixelBuffer.resize( bufferSize );
+		raster.pixels.resize( bufferSize );
 
-		Uint8* pixelPtr = &mPixelBuffer[0];
+		Uint8* pixelPtr = &raster.pixels[0];
 		Uint8* current = pixelPtr;
 		Uint8* end = current + bufferSize;
 
@@ -858,7 +1247,7 @@ Glyph FontTrueType::loadGlyph( Uint32 index, unsigned int characterSize, bool bo
 				{
 					// The color channels remain white, just fill the alpha channel
 					std::size_t index = x + y * width;
-					mPixelBuffer[index * 4 + 3] = ( ( pixels[( x - padding ) / 8] ) &
+					raster.pixels[index * 4 + 3] = ( ( pixels[( x - padding ) / 8] ) &
 													( 1 << ( 7 - ( ( x - padding ) % 8 ) ) ) )
 													  ? 255
 													  : 0;
@@ -867,7 +1256,7 @@ Glyph FontTrueType::loadGlyph( Uint32 index, unsigned int characterSize, bool bo
 			}
 		} else if ( bitmap.pixel_mode == FT_PIXEL_MODE_BGRA ) {
 			Image source( (Uint8*)pixels, bitmap.width, bitmap.rows, 4 );
-			Image dest( &mPixelBuffer[0], width, height, 4 );
+			Image dest( &raster.pixels[0], width, height, 4 );
 			source.avoidFreeImage( true );
 			dest.avoidFreeImage( true );
 			for ( size_t y = 0; y < bitmap.rows; ++y ) {
@@ -895,12 +1284,12 @@ Glyph FontTrueType::loadGlyph( Uint32 index, unsigned int characterSize, bool bo
 					for ( int x = 0; x < width; ++x ) {
 						// The color channels remain white, just fill the alpha channel
 						std::size_t index = x + y * width;
-						mPixelBuffer[index * 4 + 3] = pixels[x];
+						raster.pixels[index * 4 + 3] = pixels[x];
 					}
 					pixels += bitmap.pitch;
 				}
 
-				Image dest( &mPixelBuffer[0], bitmap.width, bitmap.rows, 4 );
+				Image dest( &raster.pixels[0], bitmap.width, bitmap.rows, 4 );
 				dest.avoidFreeImage( true );
 				dest.scale( scale );
 				dest.avoidFreeImage( true );
@@ -917,118 +1306,226 @@ Glyph FontTrueType::loadGlyph( Uint32 index, unsigned int characterSize, bool bo
 					for ( int x = padding; x < width - padding; ++x ) {
 						// The color channels remain white, just fill the alpha channel
 						std::size_t index = x + y * width;
-						mPixelBuffer[index * 4 + 3] = pixels[x - padding];
+						raster.pixels[index * 4 + 3] = pixels[x - padding];
 					}
 					pixels += bitmap.pitch;
 				}
 			}
 		}
 
-		// Find a good position for the new glyph into the texture
-		glyph.textureRect = findGlyphRect( page, destWidth, destHeight );
-
-		// Write the pixels to the texture
-		unsigned int x = glyph.textureRect.Left;
-		unsigned int y = glyph.textureRect.Top;
-		unsigned int w = glyph.textureRect.Right;
-		unsigned int h = glyph.textureRect.Bottom;
+		raster.rectWidth = destWidth;
+		raster.rectHeight = destHeight;
+		raster.padding = padding;
 
 		if ( scale < 1.f ) {
-			w = destWidth - 2 * padding;
-			h = destHeight - 2 * padding;
-			x += padding;
-			y += padding;
-		}
-
-		// Make sure the texture data is positioned in the center
-		// of the allocated texture rectangle
-		glyph.textureRect.Left += padding;
-		glyph.textureRect.Top += padding;
-		glyph.textureRect.Right -= 2 * padding;
-		glyph.textureRect.Bottom -= 2 * padding;
-
-		page.texture->update( pixelPtr, w, h, x, y );
-
-		if ( scale < 1.f )
+			// The scaled pixels don't include the padding
+			raster.uploadOffset = padding;
+			raster.uploadWidth = destWidth - 2 * padding;
+			raster.uploadHeight = destHeight - 2 * padding;
+			raster.pixels.assign( pixelPtr,
+								  pixelPtr + raster.uploadWidth * raster.uploadHeight * 4 );
 			eeFree( pixelPtr );
+		} else {
+			raster.uploadOffset = 0;
+			raster.uploadWidth = destWidth;
+			raster.uploadHeight = destHeight;
+		}
 	}
 
 	// Delete the FT glyph
 	FT_Done_Glyph( glyphDesc );
 
 	// Done :)
-	return glyph;
+	return true;
+}
+
+void FontTrueType::placeGlyph( Page& page, RasterizedGlyph& raster ) const {
+	Glyph& glyph = raster.glyph;
+
+	if ( 0 == raster.rectWidth || 0 == raster.rectHeight )
+		return;
+
+	// Find a good position for the new glyph into the texture
+	glyph.textureRect = findGlyphRect( page, raster.rectWidth, raster.rectHeight );
+
+	// The glyph is invisible until the page glyphs are dropped
+	if ( 0 == glyph.textureRect.Right ) {
+		glyph.textureRect = Rect( 5, 1, 0, 0 );
+		return;
+	}
+
+	// Write the pixels to the texture
+	unsigned int x = glyph.textureRect.Left + raster.uploadOffset;
+	unsigned int y = glyph.textureRect.Top + raster.uploadOffset;
+
+	// Make sure the texture data is positioned in the center
+	// of the allocated texture rectangle
+	glyph.textureRect.Left += raster.padding;
+	glyph.textureRect.Top += raster.padding;
+	glyph.textureRect.Right -= 2 * raster.padding;
+	glyph.textureRect.Bottom -= 2 * raster.padding;
+
+	page.texture->update( &raster.pixels[0], raster.uploadWidth, raster.uploadHeight, x, y );
 }
 
 Rect FontTrueType::findGlyphRect( Page& page, unsigned int width, unsigned int height ) const {
-	// Find the line that fits well the glyph
-	Row* row = NULL;
-	Float bestRatio = 0;
-	for ( std::vector<Row>::iterator it = page.rows.begin(); it != page.rows.end() && !row; ++it ) {
-		Float ratio = static_cast<Float>( height ) / it->height;
-
-		// Ignore rows that are either too small or too high
-		if ( ( ratio < 0.7f ) || ( ratio > 1.f ) )
-			continue;
+	bool pageReset = false;
+
+	while ( true ) {
+		// Bottom-left skyline packing: place the glyph where its bottom edge is the lowest, on ties
+		// prefer the narrowest segment to waste less space
+		size_t bestIndex = page.skyline.size();
+		unsigned int bestY = 0;
+		unsigned int bestBottom = std::numeric_limits<unsigned int>::max();
+		unsigned int bestWidth = std::numeric_limits<unsigned int>::max();
+
+		for ( size_t i = 0; i < page.skyline.size(); ++i ) {
+			unsigned int y;
+
+			if ( !page.fitSkyline( i, width, height, y ) )
+				continue;
+
+			if ( y + height < bestBottom ||
+				 ( y + height == bestBottom && page.skyline[i].width < bestWidth ) ) {
+				bestIndex = i;
+				bestY = y;
+				bestBottom = y + height;
+				bestWidth = page.skyline[i].width;
+			}
+		}
 
-		// Check if there's enough horizontal space left in the row
-		if ( width > page.texture->getPixelsSize().x - it->width )
+		if ( bestIndex != page.skyline.size() ) {
+			unsigned int x = page.skyline[bestIndex].x;
+			page.addSkylineLevel( bestIndex, x, bestY, width, height );
+			return Rect( x, bestY, width, height );
+		}
+
+		// Not enough space: resize the texture if possible, otherwise drop the glyphs of the page
+		// to make room for the glyphs being used
+		if ( growPage( page ) )
 			continue;
 
-		// Make sure that this new row is the best found so far
-		if ( ratio < bestRatio )
+		// A working set larger than the texture would drop the glyphs every time a glyph is
+		// requested, they're dropped at most once every PAGE_RESET_INTERVAL
+		if ( !pageReset && ( 0 == page.lastReset ||
+							 Sys::getTicks() - page.lastReset >= PAGE_RESET_INTERVAL ) ) {
+			resetPage( page );
+			pageReset = true;
 			continue;
+		}
 
-		// The current row passed all the tests: we can select it
-		row = &*it;
-		bestRatio = ratio;
-	}
-
-	// If we didn't find a matching row, create a new one (10% taller than the glyph)
-	if ( !row ) {
-		int rowHeight = height + height / 10;
-		while ( ( page.nextRow + rowHeight >= (Uint32)page.texture->getPixelsSize().y ) ||
-				( width >= (Uint32)page.texture->getPixelsSize().x ) ) {
-			// Not enough space: resize the texture if possible
-			unsigned int textureWidth = page.texture->getPixelsSize().x;
-			unsigned int textureHeight = page.texture->getPixelsSize().y;
-			if ( ( textureWidth * 2 <= Texture::getMaximumSize() ) &&
-				 ( textureHeight * 2 <= Texture::getMaximumSize() ) ) {
-				// Make the texture 2 times bigger
-				Image newImage;
-				newImage.create( textureWidth * 2, textureHeight * 2, 4 );
-				newImage.copyImage( page.texture );
-
-				page.texture->replace( &newImage );
-			} else {
-				// Oops, we've reached the maximum texture size...
-				Log::error(
-					"Failed to add a new character to the font: the maximum texture size has "
-					"been reached" );
-				return Rect( 0, 0, 2, 2 );
+		// Oops, we've reached the maximum texture size...
+		if ( !page.overflow ) {
+			Log::error( "Failed to add a new character to the font %s: the maximum texture size "
+						"has been reached",
+						mFontName.c_str() );
+		}
+		page.overflow = true;
+		return Rect();
+	}
+}
+
+bool FontTrueType::growPage( Page& page ) const {
+	unsigned int textureWidth = page.texture->getPixelsSize().x;
+	unsigned int textureHeight = page.texture->getPixelsSize().y;
+
+	if ( textureWidth * 2 > Texture::getMaximumSize() ||
+		 textureHeight * 2 > Texture::getMaximumSize() )
+		return false;
+
+	// The texture will use four times its current memory
+	if ( !evictPages( page.getMemoryUsage() * 3, &page ) )
+		return false;
+
+	// Make the texture 2 times bigger
+	Image newImage;
+	newImage.create( textureWidth * 2, textureHeight * 2, 4 );
+	newImage.copyImage( page.texture );
+
+	page.texture->replace( &newImage );
+
+	// The right half is empty, the bottom half is below the current skyline
+	page.skyline.push_back( { textureWidth, 0, textureWidth } );
+
+	return true;
+}
+
+void FontTrueType::resetPage( Page& page ) const {
+	unsigned int textureWidth = page.texture->getPixelsSize().x;
+	unsigned int textureHeight = page.texture->getPixelsSize().y;
+
+	// Clear the old glyphs so they don't bleed into the padding of the new ones
+	Image image;
+	image.create( textureWidth, textureHeight, 4 );
+	for ( int x = 0; x < 2; ++x )
+		for ( int y = 0; y < 2; ++y )
+			image.setPixel( x, y, Color( 255, 255, 255, 255 ) );
+	page.texture->update( &image, 0, 0 );
+
+	page.glyphs.clear();
+	page.pendingGlyphs.clear();
+	page.clearLookupCache();
+	page.resetSkyline();
+	page.generation = nextPageGeneration();
+	page.lastReset = Sys::getTicks();
+	page.overflow = false;
+}
+
+void FontTrueType::resetOverflowPage( Page& page ) const {
+	if ( page.overflow && Sys::getTicks() - page.lastReset >= PAGE_RESET_INTERVAL )
+		resetPage( page );
+}
+
+bool FontTrueType::evictPages( const size_t& requiredBytes, const Page* keep ) const {
+	if ( 0 == mAtlasMemoryLimit )
+		return true;
+
+	while ( getAtlasMemoryUsage() + requiredBytes > mAtlasMemoryLimit ) {
+		PageTable* lruTable = nullptr;
+		PageTable::iterator lru;
+
+		// The glyph drawables look up their glyphs again, only the scaled pages ( that use the
+		// atlas texture ) are kept
+		for ( PageTable* table : { &mPages, &mDrawablePages } ) {
+			for ( auto it = table->begin(); it != table->end(); ++it ) {
+				if ( it->second.get() != keep && nullptr == it->second->atlas &&
+					 ( nullptr == lruTable || it->second->lastUse < lru->second->lastUse ) ) {
+					lruTable = table;
+					lru = it;
+				}
 			}
 		}
 
-		// We can now create the new row
-		page.rows.push_back( Row( page.nextRow, rowHeight ) );
-		page.nextRow += rowHeight;
-		row = &page.rows.back();
-	}
+		if ( nullptr == lruTable ) {
+			if ( !mAtlasOverLimit ) {
+				Log::warning( "FontTrueType: font %s needs %zu bytes of glyph textures, its limit "
+							  "is %zu bytes",
+							  mFontName.c_str(), getAtlasMemoryUsage() + requiredBytes,
+							  mAtlasMemoryLimit );
+				mAtlasOverLimit = true;
+			}
+			return false;
+		}
 
-	// Find the glyph's rectangle on the selected row
-	Rect rect( row->width, row->top, width, height );
+		if ( mLastPage == lru->second.get() )
+			mLastPage = nullptr;
 
-	// Update the row informations
-	row->width += width;
+		lruTable->erase( lru );
+	}
 
-	return rect;
+	mAtlasOverLimit = false;
+	return true;
 }
 
 bool FontTrueType::setCurrentSize( unsigned int characterSize ) const {
+	return setCurrentSize( mFace, characterSize );
+}
+
+bool FontTrueType::setCurrentSize( void* ftFace, unsigned int characterSize ) const {
 	// FT_Set_Pixel_Sizes is an expensive function, so we must call it
 	// only when necessary to avoid killing performances
 
-	FT_Face face = static_cast<FT_Face>( mFace );
+	FT_Face face = static_cast<FT_Face>( ftFace );
 	FT_UShort currentSize = face->size->metrics.x_ppem;
 
 	if ( currentSize != characterSize ) {
@@ -1051,7 +1548,9 @@ bool FontTrueType::setCurrentSize( unsigned int characterSize ) const {
 		if ( result == FT_Err_Invalid_Pixel_Size ) {
 			// In the case of bitmap fonts, resizing can
 			// fail if the requested size is not available
-			if ( !FT_IS_SCALABLE( face ) ) {
+			// The closest sizes are only resolved with the face of the font, the faces of the
+			// rasterizer threads give up
+			if ( !FT_IS_SCALABLE( face ) && face == mFace ) {
 				auto it = mClosestCharacterSize.find( characterSize );
 
 				if ( it == mClosestCharacterSize.end() ) {
@@ -1074,7 +1573,7 @@ bool FontTrueType::setCurrentSize( unsigned int characterSize ) const {
 						Log::warning( "Setting closest bitmap font size available: ",
 									  selectedHeight );
 						mClosestCharacterSize[characterSize] = selectedHeight;
-						return setCurrentSize( selectedHeight );
+						return setCurrentSize( face, selectedHeight );
 					} else {
 						return false;
 					}
@@ -1092,20 +1591,373 @@ bool FontTrueType::setCurrentSize( unsigned int characterSize ) const {
 }
 
 FontTrueType::Page& FontTrueType::getPage( unsigned int characterSize ) const {
-	auto pageIt = mPages.find( characterSize );
-	if ( pageIt == mPages.end() ) {
-		mPages.insert( std::make_pair( characterSize, std::make_unique<Page>( mFontInternalId ) ) );
-		pageIt = mPages.find( characterSize );
+	// Text is usually laid out with a single size, skip the table lookup
+	if ( nullptr == mLastPage || mLastPageSize != characterSize ) {
+		auto pageIt = mPages.find( characterSize );
+		if ( pageIt == mPages.end() ) {
+			std::unique_ptr<Page> page(
+				mDistanceField ? std::make_unique<Page>( mFontInternalId, &getDistanceFieldPage() )
+							   : std::make_unique<Page>( mFontInternalId ) );
+			page->generation = nextPageGeneration();
+			// The new page is created anyway, release the old ones to make room
+			evictPages( page->getMemoryUsage(), nullptr );
+			pageIt = mPages.insert( std::make_pair( characterSize, std::move( page ) ) ).first;
+		}
+		mLastPage = pageIt->second.get();
+		mLastPageSize = characterSize;
+	}
+
+	Page& page = *mLastPage;
+	page.lastUse = ++mPageUseCounter;
+
+	if ( page.overflow )
+		resetOverflowPage( page );
+
+	if ( nullptr != page.atlas && page.atlas->overflow )
+		resetOverflowPage( *page.atlas );
+
+	// The atlas dropped the glyphs scaled by the page
+	if ( nullptr != page.atlas && page.atlasGeneration != page.atlas->generation ) {
+		page.glyphs.clear();
+		page.clearLookupCache();
+		page.atlasGeneration = page.atlas->generation;
+		page.generation = nextPageGeneration();
+	}
+
+	return page;
+}
+
+FontTrueType::Page& FontTrueType::getDrawablePage( unsigned int characterSize ) const {
+	if ( !mDistanceField )
+		return getPage( characterSize );
+
+	auto pageIt = mDrawablePages.find( characterSize );
+	if ( pageIt == mDrawablePages.end() ) {
+		std::unique_ptr<Page> page( std::make_unique<Page>( mFontInternalId ) );
+		page->generation = nextPageGeneration();
+		evictPages( page->getMemoryUsage(), nullptr );
+		pageIt = mDrawablePages.insert( std::make_pair( characterSize, std::move( page ) ) ).first;
 	}
+
+	pageIt->second->lastUse = ++mPageUseCounter;
+
+	if ( pageIt->second->overflow )
+		resetOverflowPage( *pageIt->second );
+
 	return *pageIt->second;
 }
 
+FontTrueType::Page& FontTrueType::getDistanceFieldPage() const {
+	if ( !mDistanceFieldPage ) {
+		mDistanceFieldPage = std::make_unique<Page>( mFontInternalId );
+		mDistanceFieldPage->distanceField = true;
+		mDistanceFieldPage->generation = nextPageGeneration();
+	}
+	return *mDistanceFieldPage;
+}
+
+Glyph FontTrueType::getDistanceFieldGlyph( Uint32 index, unsigned int characterSize, bool bold,
+										   Float outlineThickness, Page& page,
+										   const Float& maxWidth ) const {
+	Page& atlas = *page.atlas;
+	Float scale = characterSize / static_cast<Float>( DISTANCE_FIELD_SIZE );
+
+	// The atlas keeps a single glyph without outline, the outline is drawn by the shader
+	Uint64 key = getIndexKey( mFontInternalId, index, bold, 0 );
+	auto it = atlas.glyphs.find( key );
+	if ( it == atlas.glyphs.end() ) {
+		Glyph atlasGlyph = loadGlyph( index, DISTANCE_FIELD_SIZE, bold, 0, atlas,
+									  maxWidth > 0.f ? maxWidth / scale : 0.f );
+		it = atlas.glyphs.insert( std::make_pair( key, atlasGlyph ) ).first;
+	}
+
+	Glyph glyph = it->second;
+	glyph.advance *= scale;
+	glyph.lsbDelta = static_cast<int>( glyph.lsbDelta * scale );
+	glyph.rsbDelta = static_cast<int>( glyph.rsbDelta * scale );
+	glyph.bounds.Left *= scale;
+	glyph.bounds.Top *= scale;
+	glyph.bounds.Right *= scale;
+	glyph.bounds.Bottom *= scale;
+
+	// The distance field margin already covers the outline, its quad is the glyph quad
+	if ( outlineThickness != 0 ) {
+		glyph.bounds.Left += outlineThickness;
+		glyph.bounds.Top += outlineThickness;
+	}
+
+	return glyph;
+}
+
+void FontTrueType::computeDistanceField( RasterizedGlyph& raster ) {
+	if ( 0 == raster.rectWidth || 0 == raster.rectHeight )
+		return;
+
+	const float inf = 1e20f;
+	const int spread = DISTANCE_FIELD_SPREAD;
+	// The empty space around the glyph already present in the pixels
+	int margin = eemin<int>( spread, raster.padding - raster.uploadOffset );
+	int border = spread - margin;
+	int srcWidth = raster.uploadWidth;
+	int srcHeight = raster.uploadHeight;
+	int width = srcWidth + 2 * border;
+	int height = srcHeight + 2 * border;
+	size_t size = static_cast<size_t>( width ) * height;
+
+	// Squared distances to the closest pixel inside ( outer ) and outside ( inner ) the glyph, the
+	// partially covered pixels start with the distance to the edge estimated from the coverage
+	std::vector<float> outer( size, inf );
+	std::vector<float> inner( size, 0.f );
+
+	for ( int y = 0; y < srcHeight; ++y ) {
+		for ( int x = 0; x < srcWidth; ++x ) {
+			float coverage = raster.pixels[( x + y * srcWidth ) * 4 + 3] / 255.f;
+			size_t i = ( x + border ) + ( y + border ) * width;
+
+			if ( coverage >= 1.f ) {
+				outer[i] = 0.f;
+				inner[i] = inf;
+			} else if ( coverage > 0.f ) {
+				float out = eemax( 0.f, 0.5f - coverage );
+				float in = eemax( 0.f, coverage - 0.5f );
+				outer[i] = out * out;
+				inner[i] = in * in;
+			}
+		}
+	}
+
+	distanceTransform2D( outer, width, height );
+	distanceTransform2D( inner, width, height );
+
+	// The edge is stored at 0.5, the inside grows to 1 and the outside decreases to 0
+	raster.pixels.resize( size * 4 );
+
+	for ( size_t i = 0; i < size; ++i ) {
+		float distance = std::sqrt( outer[i] ) - std::sqrt( inner[i] );
+		float value = eemin( 1.f, eemax( 0.f, 0.5f - distance / ( 2.f * spread ) ) );
+		raster.pixels[i * 4] = 255;
+		raster.pixels[i * 4 + 1] = 255;
+		raster.pixels[i * 4 + 2] = 255;
+		raster.pixels[i * 4 + 3] = static_cast<Uint8>( value * 255.f + 0.5f );
+	}
+
+	// The quad of the glyph covers the whole distance field, keeping one pixel between glyphs
+	Glyph& glyph = raster.glyph;
+	glyph.bounds.Left -= spread;
+	glyph.bounds.Top -= spread;
+	glyph.bounds.Right = width;
+	glyph.bounds.Bottom = height;
+
+	raster.padding = 1;
+	raster.uploadOffset = 1;
+	raster.uploadWidth = width;
+	raster.uploadHeight = height;
+	raster.rectWidth = width + 2;
+	raster.rectHeight = height + 2;
+}
+
+bool FontTrueType::isDistanceFieldEnabled() const {
+	return mDistanceField;
+}
+
+void FontTrueType::setDistanceField( bool distanceField ) {
+	if ( distanceField == mDistanceField )
+		return;
+
+	if ( distanceField && nullptr == getDistanceFieldShader() ) {
+		Log::warning( "FontTrueType::setDistanceField: shaders not supported, font %s keeps "
+					  "rendering bitmap glyphs",
+					  mFontName.c_str() );
+		return;
+	}
+
+	mDistanceField = distanceField;
+
+	// The pages of the character sizes become scaled pages of the atlas, or the other way around.
+	// The glyph drawables look up their glyphs again in the new pages.
+	mLastPage = nullptr;
+	mPages.clear();
+	mDistanceFieldPage.reset();
+	mDrawablePages.clear();
+}
+
+ShaderProgram* FontTrueType::getDistanceFieldShader() {
+	if ( nullptr == GLi || !GLi->shadersSupported() )
+		return nullptr;
+
+	ShaderProgram* shader =
+		ShaderProgramManager::instance()->getByName( DISTANCE_FIELD_SHADER_NAME );
+
+	if ( nullptr == shader ) {
+		// The shader is written for the fixed pipeline, it's converted to the programmable one
+		// when needed
+		bool ensure = Shader::ensure();
+		Shader::ensure( true );
+		shader = ShaderProgram::New( DISTANCE_FIELD_VS, std::strlen( DISTANCE_FIELD_VS ),
+									 DISTANCE_FIELD_FS, std::strlen( DISTANCE_FIELD_FS ),
+									 DISTANCE_FIELD_SHADER_NAME );
+		Shader::ensure( ensure );
+	}
+
+	return shader->isValid() ? shader : nullptr;
+}
+
+void FontTrueType::setDistanceFieldUniforms( ShaderProgram* shader, Float characterSize,
+											 Float scale, Float outlineThickness ) {
+	// Distance field units per pixel drawn
+	Float pixelSize = DISTANCE_FIELD_SIZE /
+					  ( 2.f * DISTANCE_FIELD_SPREAD * eemax( 0.01f, characterSize * scale ) );
+	shader->setUniform( "distanceFieldEdge",
+						eemax( 0.f, 0.5f - outlineThickness * scale * pixelSize ) );
+	shader->setUniform( "distanceFieldSmoothing", 0.5f * pixelSize );
+}
+
+Uint32 FontTrueType::getTextureGeneration( unsigned int characterSize ) const {
+	return getPage( characterSize ).generation;
+}
+
+size_t FontTrueType::getAtlasMemoryUsage() const {
+	size_t memoryUsage = mDistanceFieldPage ? mDistanceFieldPage->getMemoryUsage() : 0;
+	for ( const auto& page : mPages )
+		memoryUsage += page.second->getMemoryUsage();
+	for ( const auto& page : mDrawablePages )
+		memoryUsage += page.second->getMemoryUsage();
+	return memoryUsage;
+}
+
+const size_t& FontTrueType::getAtlasMemoryLimit() const {
+	return mAtlasMemoryLimit;
+}
+
+void FontTrueType::setAtlasMemoryLimit( const size_t& atlasMemoryLimit ) {
+	mAtlasMemoryLimit = atlasMemoryLimit;
+	evictPages( 0, mLastPage );
+}
+
+bool FontTrueType::isAsyncRasterizationEnabled() const {
+	return mAsyncRasterization;
+}
+
+void FontTrueType::setAsyncRasterization( bool asyncRasterization ) {
+	mAsyncRasterization = asyncRasterization;
+
+	if ( asyncRasterization ) {
+		if ( !mAsyncRasterizer && loaded() && ( !mFontPath.empty() || nullptr != mFontData ) )
+			mAsyncRasterizer = std::make_unique<AsyncRasterizer>( this );
+	} else if ( mAsyncRasterizer ) {
+		mAsyncRasterizer.reset();
+
+		// Drop the placeholders, the glyphs will be rasterized again when requested
+		for ( auto& page : mPages ) {
+			if ( page.second->pendingGlyphs.empty() )
+				continue;
+			for ( const auto& key : page.second->pendingGlyphs )
+				page.second->glyphs.erase( key );
+			page.second->pendingGlyphs.clear();
+			page.second->clearLookupCache();
+			page.second->generation = nextPageGeneration();
+		}
+	}
+}
+
+void FontTrueType::warmUpGlyphs( Uint32 firstCodePoint, Uint32 lastCodePoint,
+								 unsigned int characterSize, bool bold,
+								 Float outlineThickness ) {
+	for ( Uint32 codePoint = firstCodePoint; codePoint <= lastCodePoint; ++codePoint ) {
+		if ( 0 != getGlyphIndex( codePoint ) )
+			getGlyph( codePoint, characterSize, bold, outlineThickness );
+		if ( codePoint == std::numeric_limits<Uint32>::max() )
+			break;
+	}
+}
+
+bool FontTrueType::updateAsyncGlyphs( bool* metricsChanged ) {
+	if ( !mAsyncRasterizer )
+		return false;
+
+	std::vector<AsyncRasterizer::Result> results( mAsyncRasterizer->takeResults() );
+	bool uploaded = false;
+
+	for ( auto& result : results ) {
+		const AsyncRasterizer::Request& request = result.request;
+		auto pageIt = mPages.find( request.characterSize );
+
+		// The page was released or its glyphs dropped since the request
+		if ( pageIt == mPages.end() || pageIt->second->pendingGlyphs.erase( request.key ) == 0 )
+			continue;
+
+		Page& page = *pageIt->second;
+
+		if ( result.rasterized ) {
+			placeGlyph( page, result.raster );
+		} else {
+			result.raster.glyph = loadGlyph( request.index, request.characterSize, request.bold,
+											 request.outlineThickness, page, request.maxWidth );
+		}
+
+		// Replace the placeholder, placing the glyph could have dropped the page glyphs
+		Glyph& glyph = page.glyphs[request.key];
+
+		if ( nullptr != metricsChanged && ( glyph.advance != result.raster.glyph.advance ||
+											glyph.lsbDelta != result.raster.glyph.lsbDelta ||
+											glyph.rsbDelta != result.raster.glyph.rsbDelta ) )
+			*metricsChanged = true;
+
+		glyph = result.raster.glyph;
+		page.clearLookupCache();
+		page.generation = nextPageGeneration();
+		uploaded = true;
+	}
+
+	return uploaded;
+}
+
+Glyph FontTrueType::getPlaceholderGlyph( Uint32 index, unsigned int characterSize, bool bold,
+										 Float outlineThickness, const Float& maxWidth ) const {
+	Glyph glyph;
+	// Transparent texels next to the white square
+	glyph.textureRect = Rect( 5, 1, 0, 0 );
+
+	FT_Face face = static_cast<FT_Face>( mFace );
+
+	// The glyph is loaded ( hinted but not rendered ) with the same flags used to rasterize it,
+	// so the advance and the hinting deltas used for kerning are the final ones
+	FT_Int32 flags = FT_LOAD_TARGET_NORMAL | FT_LOAD_FORCE_AUTOHINT | FT_LOAD_COLOR;
+	if ( outlineThickness != 0 && !mIsColorEmojiFont )
+		flags |= FT_LOAD_NO_BITMAP;
+
+	if ( !face || !setCurrentSize( characterSize ) || FT_Load_Glyph( face, index, flags ) != 0 )
+		return glyph;
+
+	const FT_Glyph_Metrics& metrics = face->glyph->metrics;
+	glyph.advance = static_cast<Float>( metrics.horiAdvance ) / static_cast<Float>( 1 << 6 );
+
+	if ( maxWidth > 0.f )
+		glyph.advance = maxWidth;
+
+	if ( bold && !mBoldAdvanceSameAsRegular )
+		glyph.advance += 1.f;
+
+	glyph.lsbDelta = static_cast<int>( face->glyph->lsb_delta );
+	glyph.rsbDelta = static_cast<int>( face->glyph->rsb_delta );
+
+	// The emojis are scaled to the character size ( see rasterizeGlyph )
+	int width = static_cast<int>( metrics.width >> 6 );
+	int height = static_cast<int>( metrics.height >> 6 );
+
+	if ( ( mIsColorEmojiFont || mIsEmojiFont ) && maxWidth <= 0.f && width > 0 && height > 0 )
+		glyph.advance *= eemin( 1.f, (Float)characterSize / (Float)height );
+
+	return glyph;
+}
+
 bool FontTrueType::getEnableFallbackFont() const {
 	return mEnableFallbackFont;
 }
 
 void FontTrueType::setEnableFallbackFont( bool enableFallbackFont ) {
 	mEnableFallbackFont = enableFallbackFont;
+	clearLookupCache();
 }
 
 bool FontTrueType::isEmojiFallbackEnabled() const {
@@ -1114,6 +1966,7 @@ bool FontTrueType::isEmojiFallbackEnabled() const {
 
 void FontTrueType::setEnableEmojiFallback( bool enableEmojiFallback ) {
 	mEnableEmojiFallback = enableEmojiFallback;
+	clearLookupCache();
 }
 
 const Uint32& FontTrueType::getFontInternalId() const {
@@ -1122,14 +1975,17 @@ const Uint32& FontTrueType::getFontInternalId() const {
 
 void FontTrueType::setIsEmojiFont( bool isEmojiFont ) {
 	mIsEmojiFont = isEmojiFont;
+	clearLookupCache();
 }
 
 void FontTrueType::setForceIsMonospace( bool isMonospace ) {
 	mIsMonospace = isMonospace;
+	clearLookupCache();
 }
 
 void FontTrueType::setIsColorEmojiFont( bool isColorEmojiFont ) {
 	mIsColorEmojiFont = isColorEmojiFont;
+	clearLookupCache();
 }
 
 bool FontTrueType::isColorEmojiFont() const {
@@ -1157,7 +2013,7 @@ void FontTrueType::setBoldAdvanceSameAsRegular( bool boldAdvanceSameAsRegular )
 }
 
 FontTrueType::Page::Page( const Uint32 fontInternalId ) :
-	texture( NULL ), nextRow( 3 ), fontInternalId( fontInternalId ) {
+	texture( NULL ), fontInternalId( fontInternalId ) {
 	// Make sure that the texture is initialized by default
 	Image image;
 	image.create( 128, 128, 4 );
@@ -1173,13 +2029,92 @@ FontTrueType::Page::Page( const Uint32 fontInternalId ) :
 		Texture::ClampMode::ClampToEdge, false, true );
 	texture = TextureFactory::instance()->getTexture( texId );
 	texture->setCoordinateType( Texture::CoordinateType::Pixels );
+
+	resetSkyline();
+	clearLookupCache();
 }
 
-FontTrueType::Page::~Page() {
-	for ( auto drawable : drawables )
-		eeDelete( drawable.second );
+FontTrueType::Page::Page( const Uint32 fontInternalId, Page* atlas ) :
+	texture( atlas->texture ),
+	fontInternalId( fontInternalId ),
+	atlas( atlas ),
+	atlasGeneration( atlas->generation ) {
+	clearLookupCache();
+}
+
+void FontTrueType::Page::clearLookupCache() {
+	std::memset( latinGlyphs, 0, sizeof( latinGlyphs ) );
+	kernings.clear();
+}
+
+void FontTrueType::Page::resetSkyline() {
+	skyline.clear();
+	// The first rows hold the white square
+	skyline.push_back( { 0, 3, static_cast<unsigned int>( texture->getPixelsSize().x ) } );
+}
+
+bool FontTrueType::Page::fitSkyline( const size_t& index, const unsigned int& width,
+									 const unsigned int& height, unsigned int& y ) const {
+	unsigned int textureWidth = texture->getPixelsSize().x;
+	unsigned int textureHeight = texture->getPixelsSize().y;
+
+	if ( skyline[index].x + width > textureWidth )
+		return false;
+
+	// The rectangle rests on the highest segment it spans
+	int widthLeft = width;
+	y = skyline[index].y;
+	for ( size_t i = index; widthLeft > 0 && i < skyline.size(); ++i ) {
+		y = eemax( y, skyline[i].y );
+		if ( y + height > textureHeight )
+			return false;
+		widthLeft -= skyline[i].width;
+	}
+
+	return widthLeft <= 0;
+}
+
+void FontTrueType::Page::addSkylineLevel( const size_t& index, const unsigned int& x,
+										  const unsigned int& y, const unsigned int& width,
+										  const unsigned int& height ) {
+	skyline.insert( skyline.begin() + index, { x, y + height, width } );
+
+	// Shrink or remove the segments covered by the new one
+	for ( size_t i = index + 1; i < skyline.size(); ) {
+		const SkylineNode& prev = skyline[i - 1];
+		if ( skyline[i].x >= prev.x + prev.width )
+			break;
+
+		unsigned int shrink = prev.x + prev.width - skyline[i].x;
+		if ( skyline[i].width > shrink ) {
+			skyline[i].x += shrink;
+			skyline[i].width -= shrink;
+			break;
+		}
 
-	if ( NULL != texture && TextureFactory::existsSingleton() )
+		skyline.erase( skyline.begin() + i );
+	}
+
+	// Merge the neighbour segments at the same height
+	for ( size_t i = 0; i + 1 < skyline.size(); ) {
+		if ( skyline[i].y == skyline[i + 1].y ) {
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase( skyline.begin() + i + 1 );
+		} else {
+			++i;
+		}
+	}
+}
+
+size_t FontTrueType::Page::getMemoryUsage() const {
+	// The scaled pages use the texture of the atlas
+	if ( nullptr != atlas )
+		return 0;
+	return static_cast<size_t>( texture->getPixelsSize().x ) * texture->getPixelsSize().y * 4;
+}
+
+FontTrueType::Page::~Page() {
+	if ( NULL != texture && nullptr == atlas && TextureFactory::existsSingleton() )
 		TextureFactory::instance()->remove( texture->getTextureId() );
 }
 
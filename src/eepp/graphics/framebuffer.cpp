@@ -63,6 +63,23 @@ void FrameBuffer::clear() {
 	mWindow->setClearColor( mWindow->getClearColor() );
 }
 
+void FrameBuffer::clear( const Rect& region ) {
+	GlobalBatchRenderer::instance()->draw();
+
+	// The frame buffer view is not flipped, the region is already in scissor coordinates
+	GLi->scissor( region.Left, region.Top, region.getWidth(), region.getHeight() );
+	GLi->enable( GL_SCISSOR_TEST );
+
+	clear();
+
+	GLi->disable( GL_SCISSOR_TEST );
+
+	std::list<Rectf> scissors( GLi->getClippingMask()->getScissorsClipped() );
+
+	if ( !scissors.empty() )
+		GLi->getClippingMask()->setScissorsClipped( scissors );
+}
+
 void FrameBuffer::setBufferView() {
 	// Get the user projection and modelview matrix
 	GLi->getCurrentMatrix( GL_PROJECTION_MATRIX, mProjMat );
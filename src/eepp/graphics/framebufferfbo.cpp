@@ -43,7 +43,7 @@ FrameBufferFBO::~FrameBufferFBO() {
 		return;
 
 	int curFB;
-	glGetIntegerv( GL_FRAMEBUFFER_BINDING, &curFB );
+	GLi->getIntegerv( GL_FRAMEBUFFER_BINDING, &curFB );
 
 	if ( curFB == mFrameBuffer )
 		unbind();
@@ -304,7 +304,7 @@ const Int32& FrameBufferFBO::getFrameBufferId() const {
 void FrameBufferFBO::bindFrameBuffer() {
 	int curFB;
 
-	glGetIntegerv( GL_FRAMEBUFFER_BINDING, &curFB );
+	GLi->getIntegerv( GL_FRAMEBUFFER_BINDING, &curFB );
 
 	mLastFB = (Int32)curFB;
 
@@ -325,7 +325,7 @@ void FrameBufferFBO::bindFrameBuffer() {
 void FrameBufferFBO::bindDepthBuffer() {
 	if ( mDepthBuffer ) {
 		int curDB;
-		glGetIntegerv( GL_RENDERBUFFER_BINDING, &curDB );
+		GLi->getIntegerv( GL_RENDERBUFFER_BINDING, &curDB );
 
 		mLastDB = (Int32)curDB;
 
@@ -336,7 +336,7 @@ void FrameBufferFBO::bindDepthBuffer() {
 void FrameBufferFBO::bindStencilBuffer() {
 	if ( mStencilBuffer ) {
 		int curSB;
-		glGetIntegerv( GL_RENDERBUFFER_BINDING, &curSB );
+		GLi->getIntegerv( GL_RENDERBUFFER_BINDING, &curSB );
 
 		mLastSB = (Int32)curSB;
 
@@ -347,7 +347,7 @@ void FrameBufferFBO::bindStencilBuffer() {
 void FrameBufferFBO::bindColorBuffer() {
 	if ( mColorBuffer ) {
 		int curCB;
-		glGetIntegerv( GL_RENDERBUFFER_BINDING, &curCB );
+		GLi->getIntegerv( GL_RENDERBUFFER_BINDING, &curCB );
 
 		mLastCB = (Int32)curCB;
 
@@ -1,5 +1,6 @@
 #include <eepp/graphics/framebuffermanager.hpp>
 #include <eepp/graphics/renderer/openglext.hpp>
+#include <eepp/graphics/renderer/renderer.hpp>
 
 namespace EE { namespace Graphics { namespace Private {
 
@@ -17,7 +18,7 @@ void FrameBufferManager::reload() {
 FrameBuffer* FrameBufferManager::getCurrentlyBound() {
 	int curFB;
 
-	glGetIntegerv( GL_FRAMEBUFFER_BINDING, &curFB );
+	GLi->getIntegerv( GL_FRAMEBUFFER_BINDING, &curFB );
 
 	if ( 0 != curFB ) {
 		for ( auto& fb : mResources ) {
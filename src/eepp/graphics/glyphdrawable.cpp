@@ -23,10 +23,13 @@ void GlyphDrawable::draw() {
 }
 
 void GlyphDrawable::draw( const Vector2f& position ) {
+	validate();
 	draw( position, Sizef( mSrcRect.Right, mSrcRect.Bottom ) );
 }
 
 void GlyphDrawable::draw( const Vector2f& position, const Sizef& size ) {
+	validate();
+
 	if ( position != mPosition )
 		mPosition = position;
 
@@ -54,6 +57,7 @@ void GlyphDrawable::draw( const Vector2f& position, const Sizef& size ) {
 
 void GlyphDrawable::drawIntoVertexBuffer( VertexBuffer* vbo, const Vector2u& gridPos,
 										  const Vector2f& pos, const Uint32& textureLevel ) {
+	validate();
 	vbo->setQuadTexCoords( gridPos,
 						   Rectf( mSrcRect.Left, mSrcRect.Top, mSrcRect.Left + mSrcRect.Right,
 								  mSrcRect.Top + mSrcRect.Bottom ),
@@ -78,14 +82,17 @@ bool GlyphDrawable::isStateful() {
 }
 
 Texture* GlyphDrawable::getTexture() {
+	validate();
 	return mTexture;
 }
 
 Sizef GlyphDrawable::getSize() {
+	validate();
 	return Sizef( mSrcRect.Right / mPixelDensity, mSrcRect.Bottom / mPixelDensity );
 }
 
 Sizef GlyphDrawable::getPixelsSize() {
+	validate();
 	return Sizef( mSrcRect.Right, mSrcRect.Bottom );
 }
 
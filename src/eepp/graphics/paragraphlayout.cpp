@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <eepp/graphics/paragraphlayout.hpp>
+#include <eepp/graphics/text.hpp>
+#include <iterator>
+
+namespace EE { namespace Graphics {
+
+ParagraphLayout::ParagraphLayout() {}
+
+void ParagraphLayout::setStyle( Font* font, const unsigned int& characterSize,
+								const Uint32& style, const Float& outlineThickness,
+								const Uint32& tabWidth ) {
+	// Only the bold style changes the glyph advances
+	Uint32 bold = style & Text::Bold;
+
+	if ( font != mFont || characterSize != mCharacterSize || bold != mStyle ||
+		 outlineThickness != mOutlineThickness || tabWidth != mTabWidth ) {
+		mFont = font;
+		mCharacterSize = characterSize;
+		mStyle = bold;
+		mOutlineThickness = outlineThickness;
+		mTabWidth = tabWidth;
+		invalidate();
+	}
+}
+
+void ParagraphLayout::setStyle( const Text& text ) {
+	setStyle( text.getFont(), text.getCharacterSizePx(), text.getStyle(),
+			  text.getOutlineThickness(), text.getTabWidth() );
+}
+
+void ParagraphLayout::setString( const String& string ) {
+	if ( string == mString )
+		return;
+
+	size_t oldSize = mString.size();
+	size_t newSize = string.size();
+	size_t minSize = eemin( oldSize, newSize );
+
+	// Find the changed range
+	size_t prefix = 0;
+	while ( prefix < minSize && mString[prefix] == string[prefix] )
+		prefix++;
+
+	size_t suffix = 0;
+	while ( suffix < minSize - prefix &&
+			mString[oldSize - 1 - suffix] == string[newSize - 1 - suffix] )
+		suffix++;
+
+	mString = string;
+	mBreaksValid = false;
+
+	if ( mParagraphs.empty() ) {
+		splitParagraphs( 0, newSize, mParagraphs );
+		return;
+	}
+
+	// Replace the paragraphs that contain the changed range, including the paragraph of the first
+	// character after it in case the new line between them was removed
+	size_t first = getParagraphIndex( prefix );
+	size_t last = getParagraphIndex( oldSize - suffix );
+	size_t start = mParagraphs[first].start;
+	size_t oldEnd = mParagraphs[last].start + mParagraphs[last].length;
+	size_t newEnd = oldEnd + newSize - oldSize;
+
+	std::vector<Paragraph> paragraphs;
+	splitParagraphs( start, newEnd, paragraphs );
+
+	for ( size_t i = last + 1; i < mParagraphs.size(); ++i )
+		mParagraphs[i].start = mParagraphs[i].start + newSize - oldSize;
+
+	mParagraphs.erase( mParagraphs.begin() + first, mParagraphs.begin() + last + 1 );
+	mParagraphs.insert( mParagraphs.begin() + first, std::make_move_iterator( paragraphs.begin() ),
+						std::make_move_iterator( paragraphs.end() ) );
+}
+
+const String& ParagraphLayout::getString() const {
+	return mString;
+}
+
+const std::vector<size_t>& ParagraphLayout::getBreaks( const Float& maxWidth ) {
+	if ( mBreaksValid && maxWidth == mBreaksWidth )
+		return mBreaks;
+
+	mBreaks.clear();
+	mBreaksWidth = maxWidth;
+	mBreaksValid = true;
+
+	if ( nullptr == mFont )
+		return mBreaks;
+
+	for ( auto& paragraph : mParagraphs )
+		fit( paragraph, maxWidth );
+
+	return mBreaks;
+}
+
+String ParagraphLayout::getWrappedString( const Float& maxWidth ) {
+	String wrapped( mString );
+	for ( const auto& pos : getBreaks( maxWidth ) )
+		wrapped[pos] = '\n';
+	return wrapped;
+}
+
+void ParagraphLayout::invalidate() {
+	for ( auto& paragraph : mParagraphs ) {
+		paragraph.words.clear();
+		paragraph.measured = false;
+	}
+	mBreaksValid = false;
+}
+
+void ParagraphLayout::splitParagraphs( const size_t& start, const size_t& end,
+									   std::vector<Paragraph>& paragraphs ) const {
+	size_t paragraphStart = start;
+
+	for ( size_t i = start; i < end; ++i ) {
+		if ( '\n' == mString[i] || i + 1 == end ) {
+			Paragraph paragraph;
+			paragraph.start = paragraphStart;
+			paragraph.length = i + 1 - paragraphStart;
+			paragraphs.emplace_back( std::move( paragraph ) );
+			paragraphStart = i + 1;
+		}
+	}
+}
+
+void ParagraphLayout::measure( Paragraph& paragraph ) const {
+	paragraph.words.clear();
+	paragraph.measured = true;
+
+	bool bold = ( mStyle & Text::Bold ) != 0;
+	Float hspace = static_cast<Float>( mFont->getGlyph( L' ', mCharacterSize, bold ).advance );
+	Uint32 prevChar = paragraph.start > 0 ? mString[paragraph.start - 1] : 0;
+	Float width = 0.f;
+
+	for ( size_t i = 0; i < paragraph.length; ++i ) {
+		String::StringBaseType curChar = mString[paragraph.start + i];
+		Float charWidth = 0.f;
+
+		// The new line only ends the paragraph
+		if ( '\n' != curChar && '\r' != curChar ) {
+			charWidth =
+				mFont->getGlyph( curChar, mCharacterSize, bold, mOutlineThickness ).advance;
+
+			if ( '\t' == curChar )
+				charWidth += hspace * mTabWidth;
+		}
+
+		if ( '\r' != curChar ) {
+			charWidth += mFont->getKerning( prevChar, curChar, mCharacterSize, bold );
+			prevChar = curChar;
+		}
+
+		width += charWidth;
+
+		if ( ' ' == curChar || i + 1 == paragraph.length ) {
+			paragraph.words.push_back( { static_cast<Uint32>( i + 1 ), width } );
+			width = 0.f;
+		}
+	}
+}
+
+void ParagraphLayout::fit( Paragraph& paragraph, const Float& maxWidth ) {
+	if ( !paragraph.measured )
+		measure( paragraph );
+
+	Float curWidth = 0.f;
+	size_t lastSpace = String::InvalidPos;
+
+	for ( size_t i = 0; i < paragraph.words.size(); ) {
+		const Word& word = paragraph.words[i];
+		size_t wordLast = paragraph.start + word.end - 1;
+		bool endsWithSpace = ' ' == mString[wordLast];
+
+		if ( curWidth + word.width < maxWidth ) {
+			// The word fits in the line
+			curWidth += word.width;
+			if ( endsWithSpace )
+				lastSpace = wordLast;
+			i++;
+		} else if ( String::InvalidPos != lastSpace ) {
+			// Break the line before the word and fit it again in the new line
+			mBreaks.push_back( lastSpace );
+			lastSpace = String::InvalidPos;
+			curWidth = 0.f;
+		} else {
+			// The word is larger than the line, break after it
+			if ( endsWithSpace ) {
+				mBreaks.push_back( wordLast );
+				curWidth = 0.f;
+			} else {
+				curWidth += word.width;
+			}
+			i++;
+		}
+	}
+}
+
+size_t ParagraphLayout::getParagraphIndex( const size_t& position ) const {
+	auto it = std::upper_bound(
+		mParagraphs.begin(), mParagraphs.end(), position,
+		[]( const size_t& pos, const Paragraph& paragraph ) { return pos < paragraph.start; } );
+	return it == mParagraphs.begin() ? 0 : std::distance( mParagraphs.begin(), it ) - 1;
+}
+
+}} // namespace EE::Graphics
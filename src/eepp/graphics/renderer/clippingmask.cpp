@@ -82,6 +82,20 @@ void ClippingMask::clipPlaneDisable() {
 	}
 }
 
+void ClippingMask::clipDisableAll() {
+	GlobalBatchRenderer::instance()->draw();
+
+	if ( !mScissorsClipped.empty() ) {
+		mScissorsClipped.clear();
+		GLi->disable( GL_SCISSOR_TEST );
+	}
+
+	if ( !mPlanesClipped.empty() ) {
+		mPlanesClipped.clear();
+		GLi->clip2DPlaneDisable();
+	}
+}
+
 ClippingMask::ClippingMask() : mPushScissorClip( true ), mPushClip( true ), mMode( Inclusive ) {}
 
 std::size_t ClippingMask::getMaskCount() const {
@@ -5,6 +5,7 @@
 #include <eepp/graphics/renderer/renderergl3.hpp>
 #include <eepp/graphics/renderer/renderergl3cp.hpp>
 #include <eepp/graphics/renderer/renderergles2.hpp>
+#include <eepp/graphics/renderer/renderernull.hpp>
 #include <eepp/system/sys.hpp>
 
 namespace EE { namespace Graphics {
@@ -61,6 +62,8 @@ GraphicsLibraryVersion Renderer::glVersionFromString( std::string glVersion ) {
 	else if ( "2" == glVersion || "opengl 2" == glVersion || "gl2" == glVersion ||
 			  "gl 2" == glVersion )
 		GLVer = GLv_2;
+	else if ( "null" == glVersion || "headless" == glVersion || "none" == glVersion )
+		GLVer = GLv_Null;
 	else
 		GLVer = GLv_default;
 	return GLVer;
@@ -78,6 +81,8 @@ std::string Renderer::graphicsLibraryVersionToString( const GraphicsLibraryVersi
 			return "OpenGL ES 1";
 		case GLv_ES2:
 			return "OpenGL ES 2";
+		case GLv_Null:
+			return "Null";
 		case GLv_default:
 		default:
 			return graphicsLibraryVersionToString( getDefaultGraphicsLibraryVersion() );
@@ -130,6 +135,10 @@ Renderer* Renderer::createSingleton( GraphicsLibraryVersion ver ) {
 		ver = getDefaultGraphicsLibraryVersion();
 
 	switch ( ver ) {
+		case GLv_Null: {
+			sSingleton = eeNew( RendererNull, () );
+			break;
+		}
 		case GLv_ES2: {
 #if defined( EE_GL3_ENABLED ) || defined( EE_GLES2 )
 			sSingleton = eeNew( RendererGLES2, () );
@@ -224,6 +233,10 @@ RendererGLES2* Renderer::getRendererGLES2() {
 	return reinterpret_cast<RendererGLES2*>( this );
 }
 
+RendererNull* Renderer::getRendererNull() {
+	return reinterpret_cast<RendererNull*>( this );
+}
+
 void Renderer::writeExtension( Uint8 Pos, Uint32 BitWrite ) {
 	BitOp::writeBitKey( &mExtensions, Pos, BitWrite );
 }
@@ -451,11 +464,21 @@ void Renderer::polygonMode( unsigned int face, unsigned int mode ) {
 
 void Renderer::drawArrays( unsigned int mode, int first, int count ) {
 	glDrawArrays( mode, first, count );
+	mStats.drawCalls++;
 }
 
 void Renderer::drawElements( unsigned int mode, int count, unsigned int type,
 							 const void* indices ) {
 	glDrawElements( mode, count, type, indices );
+	mStats.drawCalls++;
+}
+
+const Renderer::Stats& Renderer::getStats() const {
+	return mStats;
+}
+
+void Renderer::resetStats() {
+	mStats = Stats();
 }
 
 void Renderer::bindTexture( unsigned int target, unsigned int texture ) {
@@ -611,7 +634,25 @@ std::string Renderer::getShadingLanguageVersion() {
 }
 
 void Renderer::getViewport( int* viewport ) {
-	glGetIntegerv( GL_VIEWPORT, viewport );
+	getIntegerv( GL_VIEWPORT, viewport );
+}
+
+void Renderer::getIntegerv( unsigned int pname, int* params ) {
+	glGetIntegerv( pname, params );
+}
+
+void Renderer::deleteTextures( int n, const unsigned int* textures ) {
+	glDeleteTextures( n, textures );
+}
+
+void Renderer::texParameteri( unsigned int target, unsigned int pname, int param ) {
+	glTexParameteri( target, pname, param );
+}
+
+void Renderer::texSubImage2D( unsigned int target, int level, int xoffset, int yoffset, int width,
+							  int height, unsigned int format, unsigned int type,
+							  const void* pixels ) {
+	glTexSubImage2D( target, level, xoffset, yoffset, width, height, format, type, pixels );
 }
 
 Vector3f Renderer::projectCurrent( const Vector3f& point ) {
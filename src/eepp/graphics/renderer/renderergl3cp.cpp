@@ -3,7 +3,10 @@
 
 #ifdef EE_GL3_ENABLED
 
+#include <algorithm>
+#include <cstring>
 #include <eepp/graphics/renderer/rendererstackhelper.hpp>
+#include <eepp/math/math.hpp>
 #include <eepp/system/filesystem.hpp>
 #include <eepp/system/log.hpp>
 
@@ -41,6 +44,9 @@ const GLchar* GL3CP_SHADER_HEAD = "#version 330\n";
 
 #endif
 
+// Initial size of the streaming vertex ring buffer
+static constexpr Uint32 RING_BUFFER_DEFAULT_SIZE = 4 * 1024 * 1024;
+
 RendererGL3CP::RendererGL3CP() :
 	RendererGLShader(),
 	mTexActive( 1 ),
@@ -48,25 +54,32 @@ RendererGL3CP::RendererGL3CP() :
 	mPointSpriteLoc( -1 ),
 	mPointSize( 1.f ),
 	mCurActiveTex( 0 ),
-	mCurTexCoordArray( 0 ),
-	mVBOSizeAlloc( 1024 * 1024 ),
 	mBiggestAlloc( 0 ),
 	mLoaded( false ) {
 	mQuadsSupported = false;
 	mQuadVertexs = 6;
+	mVAO = 0;
+	mRingBuffer = 0;
+	mRingSize = RING_BUFFER_DEFAULT_SIZE;
+	mRingOffset = 0;
+	mRingSegment = 0;
+	mRingSync = false;
+	mPendingAttributesCount = 0;
+
+	for ( Uint32 i = 0; i < EEGL3CP_RING_SEGMENTS; i++ )
+		mRingFences[i] = NULL;
 }
 
 RendererGL3CP::~RendererGL3CP() {
-	for ( Uint32 i = 0; i < eeARRAY_SIZE( mVBO ); i++ ) {
-		if ( 0 != mVBO[i] ) {
-			glDeleteBuffersARB( 1, &mVBO[i] );
-		}
-	}
+	releaseRingFences();
+
+	if ( 0 != mRingBuffer )
+		glDeleteBuffersARB( 1, &mRingBuffer );
 
 	deleteVertexArrays( 1, &mVAO );
 
 #ifdef EE_DEBUG
-	Log::instance()->writel( "Biggest VBO allocation on GL3 Renderer: " +
+	Log::instance()->writel( "Biggest vertex upload on GL3 Renderer: " +
 							 FileSystem::sizeToString( mBiggestAlloc ) );
 #endif
 }
@@ -98,9 +111,6 @@ void RendererGL3CP::init() {
 			mAttribsLocStates[i] = 0;
 		}
 
-		for ( i = 0; i < eeARRAY_SIZE( mVBO ); i++ )
-			mVBO[i] = 0;
-
 		for ( i = 0; i < EE_MAX_PLANES; i++ ) {
 			mPlanes[i] = -1;
 			mPlanesStates[i] = 0;
@@ -128,9 +138,23 @@ void RendererGL3CP::init() {
 	genVertexArrays( 1, &mVAO );
 	bindVertexArray( mVAO );
 
-	glGenBuffersARB( EEGL_ARRAY_STATES_COUNT + 5, &mVBO[0] );
+	// The fences of a lost context are no longer valid, and neither is the ring buffer
+	for ( Uint32 i = 0; i < EEGL3CP_RING_SEGMENTS; i++ )
+		mRingFences[i] = NULL;
+
+	mPendingAttributesCount = 0;
+
+#if !defined( EE_GLES )
+#ifdef EE_GLEW_AVAILABLE
+	mRingSync = NULL != glMapBufferRange && NULL != glFenceSync && NULL != glClientWaitSync;
+#else
+	mRingSync = true;
+#endif
+#endif
+
+	glGenBuffersARB( 1, &mRingBuffer );
 
-	allocateBuffers( mVBOSizeAlloc );
+	allocateBuffers( mRingSize );
 
 	clientActiveTexture( GL_TEXTURE0 );
 
@@ -354,31 +378,17 @@ void RendererGL3CP::vertexPointer( int size, unsigned int type, int stride, cons
 								   unsigned int allocate ) {
 	const int index = mAttribsLoc[EEGL_VERTEX_ARRAY];
 
-#ifdef EE_DEBUG
-	mBiggestAlloc = eemax( mBiggestAlloc, allocate );
-#endif
-
 	if ( -1 != index ) {
 		bindVertexArray( mVAO );
 
-		if ( allocate > mVBOSizeAlloc ) {
-			allocateBuffers( allocate );
-		}
-
-		glBindBufferARB( GL_ARRAY_BUFFER, mVBO[EEGL_VERTEX_ARRAY] );
-		glBufferSubDataARB( GL_ARRAY_BUFFER, 0, allocate, pointer );
-
 		if ( 0 == mAttribsLocStates[EEGL_VERTEX_ARRAY] ) {
 			mAttribsLocStates[EEGL_VERTEX_ARRAY] = 1;
 
 			glEnableVertexAttribArray( index );
 		}
 
-		if ( type == GL_UNSIGNED_BYTE ) {
-			glVertexAttribPointerARB( index, size, type, GL_TRUE, stride, 0 );
-		} else {
-			glVertexAttribPointerARB( index, size, type, GL_FALSE, stride, 0 );
-		}
+		setAttributePointer( { index, size, type, type == GL_UNSIGNED_BYTE, stride,
+							   static_cast<const char*>( pointer ), allocate } );
 	}
 }
 
@@ -386,31 +396,17 @@ void RendererGL3CP::colorPointer( int size, unsigned int type, int stride, const
 								  unsigned int allocate ) {
 	const int index = mAttribsLoc[EEGL_COLOR_ARRAY];
 
-#ifdef EE_DEBUG
-	mBiggestAlloc = eemax( mBiggestAlloc, allocate );
-#endif
-
 	if ( -1 != index ) {
 		bindVertexArray( mVAO );
 
-		if ( allocate > mVBOSizeAlloc ) {
-			allocateBuffers( allocate );
-		}
-
-		glBindBufferARB( GL_ARRAY_BUFFER, mVBO[EEGL_COLOR_ARRAY] );
-		glBufferSubDataARB( GL_ARRAY_BUFFER, 0, allocate, pointer );
-
 		if ( 0 == mAttribsLocStates[EEGL_COLOR_ARRAY] ) {
 			mAttribsLocStates[EEGL_COLOR_ARRAY] = 1;
 
 			glEnableVertexAttribArray( index );
 		}
 
-		if ( type == GL_UNSIGNED_BYTE ) {
-			glVertexAttribPointerARB( index, size, type, GL_TRUE, stride, 0 );
-		} else {
-			glVertexAttribPointerARB( index, size, type, GL_FALSE, stride, 0 );
-		}
+		setAttributePointer( { index, size, type, type == GL_UNSIGNED_BYTE, stride,
+							   static_cast<const char*>( pointer ), allocate } );
 	}
 }
 
@@ -418,30 +414,238 @@ void RendererGL3CP::texCoordPointer( int size, unsigned int type, int stride, co
 									 unsigned int allocate ) {
 	const int index = mTextureUnits[mCurActiveTex];
 
+	if ( -1 != index ) {
+		bindVertexArray( mVAO );
+
+		if ( 0 == mTextureUnitsStates[mCurActiveTex] ) {
+			mTextureUnitsStates[mCurActiveTex] = 1;
+
+			glEnableVertexAttribArray( index );
+		}
+
+		setAttributePointer(
+			{ index, size, type, false, stride, static_cast<const char*>( pointer ), allocate } );
+	}
+}
+
+void RendererGL3CP::setAttributePointer( const PendingAttribute& attribute ) {
+	Uint32 i = 0;
+
+	while ( i < mPendingAttributesCount && mPendingAttributes[i].index != attribute.index )
+		i++;
+
+	if ( NULL == attribute.pointer || 0 == attribute.allocate ) {
+		// The pointer is an offset into the buffer object bound by the caller
+		if ( i < mPendingAttributesCount )
+			mPendingAttributes[i] = mPendingAttributes[--mPendingAttributesCount];
+
+		glVertexAttribPointerARB( attribute.index, attribute.size, attribute.type,
+								  attribute.normalized ? GL_TRUE : GL_FALSE, attribute.stride,
+								  attribute.pointer );
+		return;
+	}
+
+	if ( i == mPendingAttributesCount ) {
+		if ( mPendingAttributesCount == eeARRAY_SIZE( mPendingAttributes ) )
+			uploadPendingAttributes();
+
+		i = mPendingAttributesCount++;
+	}
+
+	mPendingAttributes[i] = attribute;
+}
+
+void RendererGL3CP::uploadPendingAttributes() {
+	if ( 0 == mPendingAttributesCount )
+		return;
+
+	unsigned int prevVAO = mCurVAO;
+
+	bindVertexArray( mVAO );
+
+	glBindBufferARB( GL_ARRAY_BUFFER, mRingBuffer );
+
+	std::sort( mPendingAttributes, mPendingAttributes + mPendingAttributesCount,
+			   []( const PendingAttribute& a, const PendingAttribute& b ) {
+				   return a.pointer < b.pointer;
+			   } );
+
+	// Attributes of the same client array overlap, their whole range is uploaded once
+	auto getGroupEnd = [&]( const Uint32& first, const char*& end ) {
+		end = mPendingAttributes[first].pointer + mPendingAttributes[first].allocate;
+		Uint32 last = first + 1;
+		while ( last < mPendingAttributesCount && mPendingAttributes[last].pointer <= end ) {
+			const PendingAttribute& attribute = mPendingAttributes[last];
+			end = eemax( end, attribute.pointer + attribute.allocate );
+			last++;
+		}
+		return last;
+	};
+
+	// Reserve the space of every group before uploading any of them, growing or wrapping the ring
+	// in the middle of the draw would discard the groups already uploaded
+	Uint32 totalSize = 0;
+	const char* end;
+	for ( Uint32 first = 0; first < mPendingAttributesCount; ) {
+		Uint32 last = getGroupEnd( first, end );
+		totalSize += static_cast<Uint32>( end - mPendingAttributes[first].pointer ) + 30;
+		first = last;
+	}
+	reserveRing( totalSize );
+
+	Uint32 first = 0;
+
+	while ( first < mPendingAttributesCount ) {
+		const char* start = mPendingAttributes[first].pointer;
+		Uint32 last = getGroupEnd( first, end );
+
+		Uint32 offset = uploadToRing( start, static_cast<Uint32>( end - start ) );
+
+		for ( Uint32 i = first; i < last; i++ ) {
+			const PendingAttribute& attribute = mPendingAttributes[i];
+			uintptr_t attributeOffset = offset + ( attribute.pointer - start );
+
+			glVertexAttribPointerARB( attribute.index, attribute.size, attribute.type,
+									  attribute.normalized ? GL_TRUE : GL_FALSE, attribute.stride,
+									  reinterpret_cast<const void*>( attributeOffset ) );
+		}
+
+		first = last;
+	}
+
+	mPendingAttributesCount = 0;
+
+	if ( prevVAO != mVAO )
+		bindVertexArray( prevVAO );
+}
+
+Uint32 RendererGL3CP::uploadToRing( const char* data, const Uint32& size ) {
 #ifdef EE_DEBUG
-	mBiggestAlloc = eemax( mBiggestAlloc, allocate );
+	mBiggestAlloc = eemax( mBiggestAlloc, size );
 #endif
 
-	if ( -1 != index ) {
-		bindVertexArray( mVAO );
+	// Up to 15 bytes to align the offset to 16 bytes and 15 to keep the client array alignment
+	reserveRing( size + 30 );
 
-		if ( allocate > mVBOSizeAlloc ) {
-			allocateBuffers( allocate );
+	// Keep the alignment of the client array, so the attributes offsets keep their alignment
+	Uint32 alignment = static_cast<Uint32>( reinterpret_cast<uintptr_t>( data ) & 15 );
+	Uint32 offset = ( ( mRingOffset + 15 ) & ~15 ) + alignment;
+
+	if ( mRingSync ) {
+		// The ring size is not a multiple of the segments, the remainder belongs to the last one
+		Uint32 segment = eemin<Uint32>( ( offset + size - 1 ) /
+											( mRingSize / EEGL3CP_RING_SEGMENTS ),
+										EEGL3CP_RING_SEGMENTS - 1 );
+
+		while ( mRingSegment < segment ) {
+			fenceRingSegment( mRingSegment );
+			mRingSegment++;
+			waitRingSegment( mRingSegment );
 		}
+	}
 
-		glBindBufferARB( GL_ARRAY_BUFFER, mCurTexCoordArray );
-		glBufferSubDataARB( GL_ARRAY_BUFFER, 0, allocate, pointer );
+	bool uploaded = false;
 
-		if ( 0 == mTextureUnitsStates[mCurActiveTex] ) {
-			mTextureUnitsStates[mCurActiveTex] = 1;
+#if !defined( EE_GLES )
+	if ( mRingSync ) {
+		// The fences guarantee that the GPU is not reading this range anymore
+		void* ptr = glMapBufferRange( GL_ARRAY_BUFFER, offset, size,
+									  GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+										  GL_MAP_INVALIDATE_RANGE_BIT );
 
-			glEnableVertexAttribArray( index );
+		if ( NULL != ptr ) {
+			memcpy( ptr, data, size );
+			glUnmapBuffer( GL_ARRAY_BUFFER );
+			uploaded = true;
 		}
+	}
+#endif
 
-		glVertexAttribPointerARB( index, size, type, GL_FALSE, stride, 0 );
+	if ( !uploaded )
+		glBufferSubDataARB( GL_ARRAY_BUFFER, offset, size, data );
+
+	mRingOffset = offset + size;
+	mStats.uploads++;
+	mStats.bytesUploaded += size;
+
+	return offset;
+}
+
+void RendererGL3CP::reserveRing( const Uint32& size ) {
+	// Every upload must fit in a segment, so a single upload never waits for itself
+	if ( size * EEGL3CP_RING_SEGMENTS > mRingSize )
+		allocateBuffers( Math::nextPowOfTwo( size * EEGL3CP_RING_SEGMENTS ) );
+
+	if ( ( ( mRingOffset + 15 ) & ~15 ) + size <= mRingSize )
+		return;
+
+	mRingOffset = 0;
+
+	if ( mRingSync ) {
+		fenceRingSegment( mRingSegment );
+		mRingSegment = 0;
+		waitRingSegment( mRingSegment );
+	} else {
+		// Orphan the buffer storage, the driver keeps the old one alive while it's in use
+		glBufferDataARB( GL_ARRAY_BUFFER, mRingSize, NULL, GL_STREAM_DRAW );
 	}
 }
 
+void RendererGL3CP::fenceRingSegment( const Uint32& segment ) {
+#if !defined( EE_GLES )
+	if ( NULL != mRingFences[segment] )
+		glDeleteSync( static_cast<GLsync>( mRingFences[segment] ) );
+
+	mRingFences[segment] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+#endif
+}
+
+void RendererGL3CP::waitRingSegment( const Uint32& segment ) {
+#if !defined( EE_GLES )
+	if ( NULL == mRingFences[segment] )
+		return;
+
+	GLsync fence = static_cast<GLsync>( mRingFences[segment] );
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+
+	while ( true ) {
+		GLenum res = glClientWaitSync( fence, flags, 1000000 );
+
+		if ( GL_ALREADY_SIGNALED == res || GL_CONDITION_SATISFIED == res || GL_WAIT_FAILED == res )
+			break;
+
+		flags = 0;
+	}
+
+	glDeleteSync( fence );
+	mRingFences[segment] = NULL;
+#endif
+}
+
+void RendererGL3CP::releaseRingFences() {
+#if !defined( EE_GLES )
+	for ( Uint32 i = 0; i < EEGL3CP_RING_SEGMENTS; i++ ) {
+		if ( NULL != mRingFences[i] ) {
+			glDeleteSync( static_cast<GLsync>( mRingFences[i] ) );
+			mRingFences[i] = NULL;
+		}
+	}
+#endif
+}
+
+void RendererGL3CP::drawArrays( unsigned int mode, int first, int count ) {
+	uploadPendingAttributes();
+
+	Renderer::drawArrays( mode, first, count );
+}
+
+void RendererGL3CP::drawElements( unsigned int mode, int count, unsigned int type,
+								  const void* indices ) {
+	uploadPendingAttributes();
+
+	Renderer::drawElements( mode, count, type, indices );
+}
+
 int RendererGL3CP::getStateIndex( const Uint32& State ) {
 	eeASSERT( State < EEGL_ARRAY_STATES_COUNT );
 
@@ -542,21 +746,6 @@ void RendererGL3CP::clientActiveTexture( unsigned int texture ) {
 
 	if ( mCurActiveTex >= EE_MAX_TEXTURE_UNITS )
 		mCurActiveTex = 0;
-
-	switch ( mCurActiveTex ) {
-		case 0:
-			mCurTexCoordArray = mVBO[EEGL_TEXTURE_COORD_ARRAY];
-			break;
-		case 1:
-			mCurTexCoordArray = mVBO[EEGL_TEXTURE_COORD_ARRAY + 1];
-			break;
-		case 2:
-			mCurTexCoordArray = mVBO[EEGL_TEXTURE_COORD_ARRAY + 2];
-			break;
-		case 3:
-			mCurTexCoordArray = mVBO[EEGL_TEXTURE_COORD_ARRAY + 3];
-			break;
-	}
 }
 
 std::string RendererGL3CP::getBaseVertexShader() {
@@ -568,28 +757,19 @@ void RendererGL3CP::bindGlobalVAO() {
 }
 
 void RendererGL3CP::allocateBuffers( const Uint32& size ) {
-	if ( mVBOSizeAlloc != size )
-		Log::instance()->writel( "Allocating new VBO buffers size: " + String::toString( size ) );
-
-	mVBOSizeAlloc = size;
-
-	glBindBufferARB( GL_ARRAY_BUFFER, mVBO[EEGL_VERTEX_ARRAY] );
-	glBufferDataARB( GL_ARRAY_BUFFER, mVBOSizeAlloc, NULL, GL_STREAM_DRAW );
-
-	glBindBufferARB( GL_ARRAY_BUFFER, mVBO[EEGL_COLOR_ARRAY] );
-	glBufferDataARB( GL_ARRAY_BUFFER, mVBOSizeAlloc, NULL, GL_STREAM_DRAW );
-
-	glBindBufferARB( GL_ARRAY_BUFFER, mVBO[EEGL_TEXTURE_COORD_ARRAY] );
-	glBufferDataARB( GL_ARRAY_BUFFER, mVBOSizeAlloc, NULL, GL_STREAM_DRAW );
+	if ( mRingSize != size )
+		Log::instance()->writel( "Allocating new VBO ring buffer size: " +
+								 String::toString( size ) );
 
-	glBindBufferARB( GL_ARRAY_BUFFER, mVBO[EEGL_TEXTURE_COORD_ARRAY + 1] );
-	glBufferDataARB( GL_ARRAY_BUFFER, mVBOSizeAlloc, NULL, GL_STREAM_DRAW );
+	// The new storage is not used by the GPU yet, the old one is orphaned
+	releaseRingFences();
 
-	glBindBufferARB( GL_ARRAY_BUFFER, mVBO[EEGL_TEXTURE_COORD_ARRAY + 2] );
-	glBufferDataARB( GL_ARRAY_BUFFER, mVBOSizeAlloc, NULL, GL_STREAM_DRAW );
+	mRingSize = size;
+	mRingOffset = 0;
+	mRingSegment = 0;
 
-	glBindBufferARB( GL_ARRAY_BUFFER, mVBO[EEGL_TEXTURE_COORD_ARRAY + 3] );
-	glBufferDataARB( GL_ARRAY_BUFFER, mVBOSizeAlloc, NULL, GL_STREAM_DRAW );
+	glBindBufferARB( GL_ARRAY_BUFFER, mRingBuffer );
+	glBufferDataARB( GL_ARRAY_BUFFER, mRingSize, NULL, GL_STREAM_DRAW );
 }
 
 }} // namespace EE::Graphics
@@ -0,0 +1,547 @@
+#include <algorithm>
+#include <cstring>
+#include <eepp/graphics/renderer/openglext.hpp>
+#include <eepp/graphics/renderer/renderernull.hpp>
+#include <eepp/graphics/shaderprogram.hpp>
+
+namespace EE { namespace Graphics {
+
+// Maximum texture size reported to the engine
+static constexpr int MAX_TEXTURE_SIZE = 16384;
+
+// Default number of commands kept by the command log
+static constexpr size_t DEFAULT_MAX_COMMANDS = 1 << 20;
+
+static const char* COMMAND_TYPE_NAMES[] = { "DrawArrays", "DrawElements", "UploadVertices", "Clear",
+	"ClearColor", "Viewport", "Scissor", "Enable", "Disable", "EnableClientState",
+	"DisableClientState", "BindTexture", "ActiveTexture", "TexImage", "TexSubImage", "TexParameter",
+	"DeleteTexture", "BlendFunc", "BlendFuncSeparate", "BlendEquationSeparate", "SetShader",
+	"LineWidth", "PointSize", "PolygonMode", "StencilFunc", "StencilOp", "StencilMask", "ColorMask",
+	"Clip2DPlaneEnable", "Clip2DPlaneDisable", "ClipPlane", "BindFramebuffer", "BindRenderbuffer",
+	"BlitFramebuffer", "ReadPixels" };
+
+static int formatChannels( unsigned int format ) {
+	switch ( format ) {
+		case GL_RGBA:
+		case 0x80E1: // GL_BGRA
+			return 4;
+		case GL_RGB:
+		case 0x80E0: // GL_BGR
+			return 3;
+		case GL_LUMINANCE_ALPHA:
+		case 0x8227: // GL_RG
+			return 2;
+		default:
+			return 1;
+	}
+}
+
+const char* RendererNull::commandTypeToString( const CommandType& type ) {
+	size_t index = static_cast<size_t>( type );
+	return index < eeARRAY_SIZE( COMMAND_TYPE_NAMES ) ? COMMAND_TYPE_NAMES[index] : "Unknown";
+}
+
+RendererNull::RendererNull() :
+	mMaxCommands( DEFAULT_MAX_COMMANDS ),
+	mDroppedCommands( 0 ),
+	mRecording( true ),
+	mNextId( 1 ),
+	mPointSize( 1.f ),
+	mClientStates( 0 ),
+	mActiveTexture( 0 ),
+	mBoundFramebuffer( 0 ),
+	mBoundRenderbuffer( 0 ) {
+	// There are no shaders, the matrices only live in the matrix stacks
+	mProjectionMatrix_id = -1;
+	mModelViewMatrix_id = -1;
+	mTextureMatrix_id = -1;
+	mQuadsSupported = true;
+	mQuadVertexs = 4;
+
+	memset( mViewport, 0, sizeof( mViewport ) );
+	memset( mBoundTextures, 0, sizeof( mBoundTextures ) );
+	memset( mClientArrays, 0, sizeof( mClientArrays ) );
+}
+
+RendererNull::~RendererNull() {}
+
+GraphicsLibraryVersion RendererNull::version() {
+	return GLv_Null;
+}
+
+std::string RendererNull::versionStr() {
+	return "Null";
+}
+
+void RendererNull::init() {
+	// Report the extensions that the engine can emulate without a context, the vertex buffer
+	// objects and shaders are not available so the engine falls back to the client arrays.
+	writeExtension( EEGL_ARB_texture_non_power_of_two, 1 );
+	writeExtension( EEGL_ARB_point_sprite, 1 );
+	writeExtension( EEGL_ARB_multitexture, 1 );
+	writeExtension( EEGL_EXT_framebuffer_object, 1 );
+	writeExtension( EEGL_EXT_blend_func_separate, 1 );
+	writeExtension( EEGL_EXT_blend_minmax, 1 );
+	writeExtension( EEGL_EXT_blend_subtract, 1 );
+
+	mClientStates = ( 1 << EEGL_VERTEX_ARRAY ) | ( 1 << EEGL_COLOR_ARRAY ) |
+					( 1 << EEGL_ARRAY_STATES_COUNT );
+}
+
+const std::vector<RendererNull::Command>& RendererNull::getCommands() const {
+	return mCommands;
+}
+
+void RendererNull::clearCommands() {
+	mCommands.clear();
+	mDroppedCommands = 0;
+}
+
+std::string RendererNull::dumpCommands() const {
+	std::string dump;
+
+	for ( const auto& command : mCommands ) {
+		dump += String::format( "%s %lld %lld %lld %lld\n", commandTypeToString( command.type ),
+								static_cast<long long>( command.args[0] ),
+								static_cast<long long>( command.args[1] ),
+								static_cast<long long>( command.args[2] ),
+								static_cast<long long>( command.args[3] ) );
+	}
+
+	return dump;
+}
+
+bool RendererNull::isRecording() const {
+	return mRecording;
+}
+
+void RendererNull::setRecording( bool recording ) {
+	mRecording = recording;
+}
+
+void RendererNull::setMaxCommands( const size_t& maxCommands ) {
+	mMaxCommands = maxCommands;
+}
+
+const size_t& RendererNull::getMaxCommands() const {
+	return mMaxCommands;
+}
+
+const Uint64& RendererNull::getDroppedCommands() const {
+	return mDroppedCommands;
+}
+
+const RendererNull::Counters& RendererNull::getCounters() const {
+	return mCounters;
+}
+
+void RendererNull::resetStats() {
+	Renderer::resetStats();
+	mCounters = Counters();
+}
+
+void RendererNull::record( const CommandType& type, Int64 a, Int64 b, Int64 c, Int64 d ) {
+	if ( !mRecording )
+		return;
+
+	if ( mCommands.size() >= mMaxCommands ) {
+		mDroppedCommands++;
+		return;
+	}
+
+	mCommands.push_back( { type, { a, b, c, d } } );
+}
+
+void RendererNull::recordState( const CommandType& type, Int64 a, Int64 b, Int64 c, Int64 d ) {
+	mCounters.stateChanges++;
+	record( type, a, b, c, d );
+}
+
+unsigned int RendererNull::createTexture( int width, int height, int channels,
+										  unsigned int texture ) {
+	if ( 0 == texture )
+		texture = mNextId++;
+
+	Uint64 bytes = static_cast<Uint64>( width ) * height * channels;
+
+	mCounters.textureUploads++;
+	mCounters.textureBytesUploaded += bytes;
+
+	record( CommandType::TexImage, texture, width, height, bytes );
+
+	return texture;
+}
+
+bool RendererNull::isExtension( const std::string& ) {
+	return false;
+}
+
+std::string RendererNull::getExtensions() {
+	return "";
+}
+
+const char* RendererNull::getString( unsigned int name ) {
+	switch ( name ) {
+		case GL_VENDOR:
+			return "eepp";
+		case GL_RENDERER:
+			return "Null Renderer";
+		case GL_VERSION:
+			return "Null";
+		case GL_EXTENSIONS:
+			return "";
+	}
+
+	return NULL;
+}
+
+void RendererNull::clear( unsigned int mask ) {
+	record( CommandType::Clear, mask );
+}
+
+void RendererNull::clearColor( float red, float green, float blue, float alpha ) {
+	recordState( CommandType::ClearColor, red * 255, green * 255, blue * 255, alpha * 255 );
+}
+
+void RendererNull::scissor( int x, int y, int width, int height ) {
+	recordState( CommandType::Scissor, x, y, width, height );
+}
+
+void RendererNull::polygonMode( unsigned int face, unsigned int mode ) {
+	recordState( CommandType::PolygonMode, face, mode );
+}
+
+void RendererNull::uploadClientArrays() {
+	ClientArray arrays[EEGL_ARRAY_STATES_COUNT + 1];
+	size_t count = 0;
+
+	for ( unsigned int i = 0; i < eeARRAY_SIZE( mClientArrays ); i++ ) {
+		if ( NULL != mClientArrays[i].pointer && mClientArrays[i].allocate > 0 &&
+			 ( mClientStates & ( 1 << i ) ) )
+			arrays[count++] = mClientArrays[i];
+
+		mClientArrays[i] = { NULL, 0 };
+	}
+
+	if ( 0 == count )
+		return;
+
+	std::sort( arrays, arrays + count, []( const ClientArray& a, const ClientArray& b ) {
+		return a.pointer < b.pointer;
+	} );
+
+	const char* start = arrays[0].pointer;
+	const char* end = start + arrays[0].allocate;
+	Uint64 bytes = 0;
+
+	for ( size_t i = 1; i < count; i++ ) {
+		if ( arrays[i].pointer < end ) {
+			end = eemax( end, arrays[i].pointer + arrays[i].allocate );
+		} else {
+			bytes += end - start;
+			start = arrays[i].pointer;
+			end = start + arrays[i].allocate;
+		}
+	}
+
+	bytes += end - start;
+
+	mStats.uploads++;
+	mStats.bytesUploaded += bytes;
+
+	record( CommandType::UploadVertices, bytes );
+}
+
+void RendererNull::drawArrays( unsigned int mode, int first, int count ) {
+	uploadClientArrays();
+
+	mStats.drawCalls++;
+	mCounters.vertices += count;
+
+	record( CommandType::DrawArrays, mode, first, count, mBoundTextures[mActiveTexture] );
+}
+
+void RendererNull::drawElements( unsigned int mode, int count, unsigned int type,
+								 const void* ) {
+	uploadClientArrays();
+
+	mStats.drawCalls++;
+	mCounters.vertices += count;
+
+	record( CommandType::DrawElements, mode, count, type, mBoundTextures[mActiveTexture] );
+}
+
+void RendererNull::bindTexture( unsigned int target, unsigned int texture ) {
+	mBoundTextures[mActiveTexture] = texture;
+	mCounters.textureBinds++;
+
+	record( CommandType::BindTexture, target, texture, mActiveTexture );
+}
+
+void RendererNull::activeTexture( unsigned int texture ) {
+	unsigned int unit = texture - GL_TEXTURE0;
+
+	if ( unit < EE_MAX_TEXTURE_UNITS )
+		mActiveTexture = unit;
+
+	recordState( CommandType::ActiveTexture, texture );
+}
+
+void RendererNull::blendFunc( unsigned int sfactor, unsigned int dfactor ) {
+	recordState( CommandType::BlendFunc, sfactor, dfactor );
+}
+
+void RendererNull::blendFuncSeparate( unsigned int sfactorRGB, unsigned int dfactorRGB,
+									  unsigned int sfactorAlpha, unsigned int dfactorAlpha ) {
+	recordState( CommandType::BlendFuncSeparate, sfactorRGB, dfactorRGB, sfactorAlpha,
+				 dfactorAlpha );
+}
+
+void RendererNull::blendEquationSeparate( unsigned int modeRGB, unsigned int modeAlpha ) {
+	recordState( CommandType::BlendEquationSeparate, modeRGB, modeAlpha );
+}
+
+void RendererNull::blitFrameBuffer( int srcX0, int srcY0, int srcX1, int srcY1, int, int, int,
+									int, unsigned int, unsigned int ) {
+	record( CommandType::BlitFramebuffer, srcX0, srcY0, srcX1, srcY1 );
+}
+
+void RendererNull::viewport( int x, int y, int width, int height ) {
+	mViewport[0] = x;
+	mViewport[1] = y;
+	mViewport[2] = width;
+	mViewport[3] = height;
+
+	recordState( CommandType::Viewport, x, y, width, height );
+}
+
+void RendererNull::lineWidth( float width ) {
+	if ( width != mLineWidth ) {
+		mLineWidth = width;
+		recordState( CommandType::LineWidth, width );
+	}
+}
+
+void RendererNull::pixelStorei( unsigned int, int ) {}
+
+void RendererNull::pointSize( float size ) {
+	mPointSize = size;
+	recordState( CommandType::PointSize, size );
+}
+
+float RendererNull::pointSize() {
+	return mPointSize;
+}
+
+void RendererNull::clientActiveTexture( unsigned int ) {}
+
+void RendererNull::disable( unsigned int cap ) {
+	recordState( CommandType::Disable, cap );
+}
+
+void RendererNull::enable( unsigned int cap ) {
+	recordState( CommandType::Enable, cap );
+}
+
+unsigned int RendererNull::clientStateIndex( unsigned int array ) const {
+	switch ( array ) {
+		case GL_VERTEX_ARRAY:
+			return EEGL_VERTEX_ARRAY;
+		case GL_NORMAL_ARRAY:
+			return EEGL_NORMAL_ARRAY;
+		case GL_COLOR_ARRAY:
+			return EEGL_COLOR_ARRAY;
+		case GL_TEXTURE_COORD_ARRAY:
+			return EEGL_ARRAY_STATES_COUNT;
+	}
+
+	return eeARRAY_SIZE( mClientArrays );
+}
+
+void RendererNull::enableClientState( unsigned int array ) {
+	unsigned int index = clientStateIndex( array );
+
+	if ( index < eeARRAY_SIZE( mClientArrays ) )
+		mClientStates |= 1 << index;
+
+	recordState( CommandType::EnableClientState, array );
+}
+
+void RendererNull::disableClientState( unsigned int array ) {
+	unsigned int index = clientStateIndex( array );
+
+	if ( index < eeARRAY_SIZE( mClientArrays ) )
+		mClientStates &= ~( 1 << index );
+
+	recordState( CommandType::DisableClientState, array );
+}
+
+void RendererNull::vertexPointer( int, unsigned int, int, const void* pointer,
+								  unsigned int allocate ) {
+	mClientArrays[EEGL_VERTEX_ARRAY] = { static_cast<const char*>( pointer ), allocate };
+}
+
+void RendererNull::colorPointer( int, unsigned int, int, const void* pointer,
+								 unsigned int allocate ) {
+	mClientArrays[EEGL_COLOR_ARRAY] = { static_cast<const char*>( pointer ), allocate };
+}
+
+void RendererNull::texCoordPointer( int, unsigned int, int, const void* pointer,
+									unsigned int allocate ) {
+	mClientArrays[EEGL_ARRAY_STATES_COUNT] = { static_cast<const char*>( pointer ), allocate };
+}
+
+void RendererNull::setShader( ShaderProgram* Shader ) {
+	recordState( CommandType::SetShader, NULL != Shader ? Shader->getHandler() : 0 );
+}
+
+void RendererNull::clip2DPlaneEnable( const Int32& x, const Int32& y, const Int32& Width,
+									  const Int32& Height ) {
+	recordState( CommandType::Clip2DPlaneEnable, x, y, Width, Height );
+}
+
+void RendererNull::clip2DPlaneDisable() {
+	recordState( CommandType::Clip2DPlaneDisable );
+}
+
+void RendererNull::clipPlane( unsigned int plane, const double* ) {
+	recordState( CommandType::ClipPlane, plane );
+}
+
+void RendererNull::getViewport( int* viewport ) {
+	memcpy( viewport, mViewport, sizeof( mViewport ) );
+}
+
+void RendererNull::getIntegerv( unsigned int pname, int* params ) {
+	switch ( pname ) {
+		case GL_VIEWPORT:
+			getViewport( params );
+			break;
+		case GL_TEXTURE_BINDING_2D:
+			*params = mBoundTextures[mActiveTexture];
+			break;
+		case GL_FRAMEBUFFER_BINDING:
+			*params = mBoundFramebuffer;
+			break;
+		case GL_RENDERBUFFER_BINDING:
+			*params = mBoundRenderbuffer;
+			break;
+		case GL_MAX_TEXTURE_SIZE:
+			*params = MAX_TEXTURE_SIZE;
+			break;
+		default:
+			*params = 0;
+	}
+}
+
+void RendererNull::deleteTextures( int n, const unsigned int* textures ) {
+	for ( int i = 0; i < n; i++ ) {
+		for ( unsigned int unit = 0; unit < EE_MAX_TEXTURE_UNITS; unit++ ) {
+			if ( mBoundTextures[unit] == textures[i] )
+				mBoundTextures[unit] = 0;
+		}
+
+		record( CommandType::DeleteTexture, textures[i] );
+	}
+}
+
+void RendererNull::texParameteri( unsigned int target, unsigned int pname, int param ) {
+	recordState( CommandType::TexParameter, target, pname, param );
+}
+
+void RendererNull::texSubImage2D( unsigned int, int, int xoffset, int yoffset, int width,
+								  int height, unsigned int format, unsigned int, const void* ) {
+	Uint64 bytes = static_cast<Uint64>( width ) * height * formatChannels( format );
+
+	mCounters.textureUploads++;
+	mCounters.textureBytesUploaded += bytes;
+
+	record( CommandType::TexSubImage, mBoundTextures[mActiveTexture], xoffset, yoffset, bytes );
+}
+
+void RendererNull::stencilFunc( unsigned int func, int ref, unsigned int mask ) {
+	recordState( CommandType::StencilFunc, func, ref, mask );
+}
+
+void RendererNull::stencilOp( unsigned int fail, unsigned int zfail, unsigned int zpass ) {
+	recordState( CommandType::StencilOp, fail, zfail, zpass );
+}
+
+void RendererNull::stencilMask( unsigned int mask ) {
+	recordState( CommandType::StencilMask, mask );
+}
+
+void RendererNull::colorMask( Uint8 red, Uint8 green, Uint8 blue, Uint8 alpha ) {
+	recordState( CommandType::ColorMask, red, green, blue, alpha );
+}
+
+void RendererNull::bindVertexArray( unsigned int array ) {
+	mCurVAO = array;
+}
+
+void RendererNull::deleteVertexArrays( int, const unsigned int* ) {}
+
+void RendererNull::genVertexArrays( int n, unsigned int* arrays ) {
+	for ( int i = 0; i < n; i++ )
+		arrays[i] = mNextId++;
+}
+
+void RendererNull::genFramebuffers( int n, unsigned int* framebuffers ) {
+	for ( int i = 0; i < n; i++ )
+		framebuffers[i] = mNextId++;
+}
+
+void RendererNull::deleteFramebuffers( int n, const unsigned int* framebuffers ) {
+	for ( int i = 0; i < n; i++ ) {
+		if ( mBoundFramebuffer == framebuffers[i] )
+			mBoundFramebuffer = 0;
+	}
+}
+
+void RendererNull::bindFramebuffer( unsigned int target, unsigned int framebuffer ) {
+	mBoundFramebuffer = framebuffer;
+	recordState( CommandType::BindFramebuffer, target, framebuffer );
+}
+
+void RendererNull::framebufferTexture2D( unsigned int, unsigned int, unsigned int, unsigned int,
+										 int ) {}
+
+void RendererNull::genRenderbuffers( int n, unsigned int* renderbuffers ) {
+	for ( int i = 0; i < n; i++ )
+		renderbuffers[i] = mNextId++;
+}
+
+void RendererNull::deleteRenderbuffers( int n, const unsigned int* renderbuffers ) {
+	for ( int i = 0; i < n; i++ ) {
+		if ( mBoundRenderbuffer == renderbuffers[i] )
+			mBoundRenderbuffer = 0;
+	}
+}
+
+void RendererNull::bindRenderbuffer( unsigned int target, unsigned int renderbuffer ) {
+	mBoundRenderbuffer = renderbuffer;
+	recordState( CommandType::BindRenderbuffer, target, renderbuffer );
+}
+
+void RendererNull::renderbufferStorage( unsigned int, unsigned int, int, int ) {}
+
+void RendererNull::framebufferRenderbuffer( unsigned int, unsigned int, unsigned int,
+											unsigned int ) {}
+
+unsigned int RendererNull::checkFramebufferStatus( unsigned int ) {
+	return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void RendererNull::discardFramebuffer( unsigned int, int, const unsigned int* ) {}
+
+void* RendererNull::getProcAddress( std::string ) {
+	return NULL;
+}
+
+void RendererNull::readPixels( int x, int y, unsigned int width, unsigned int height,
+							   void* pixels ) {
+	memset( pixels, 0, width * height * 4 );
+	record( CommandType::ReadPixels, x, y, width, height );
+}
+
+}} // namespace EE::Graphics
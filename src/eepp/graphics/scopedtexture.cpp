@@ -6,7 +6,7 @@ namespace EE { namespace Graphics { namespace Private {
 
 ScopedTexture::ScopedTexture( int textureBind ) :
 	mTextureBinded( 0 ), mTextureToBind( textureBind ) {
-	glGetIntegerv( GL_TEXTURE_BINDING_2D, &mTextureBinded );
+	GLi->getIntegerv( GL_TEXTURE_BINDING_2D, &mTextureBinded );
 
 	if ( mTextureToBind > 0 && mTextureBinded != mTextureToBind )
 		GLi->bindTexture( GL_TEXTURE_2D, mTextureToBind );
@@ -3,10 +3,12 @@
 #include <eepp/graphics/fontmanager.hpp>
 #include <eepp/graphics/fonttruetype.hpp>
 #include <eepp/graphics/globalbatchrenderer.hpp>
+#include <eepp/graphics/paragraphlayout.hpp>
 #include <eepp/graphics/pixeldensity.hpp>
 #include <eepp/graphics/primitives.hpp>
 #include <eepp/graphics/renderer/opengl.hpp>
 #include <eepp/graphics/renderer/renderer.hpp>
+#include <eepp/graphics/shaderprogram.hpp>
 #include <eepp/graphics/text.hpp>
 #include <eepp/graphics/texture.hpp>
 #include <eepp/graphics/texturefactory.hpp>
@@ -470,73 +472,12 @@ void Text::wrapText( const Uint32& maxWidth ) {
 	if ( !mString.size() || NULL == mFont )
 		return;
 
-	Float tCurWidth = 0.f;
-	Float tWordWidth = 0.f;
-	Float tMaxWidth = (Float)maxWidth;
-	String::StringBaseType* tChar = &mString[0];
-	String::StringBaseType* tLastSpace = NULL;
-	Uint32 prevChar = 0;
-	bool bold = ( mStyle & Bold ) != 0;
-
-	Float hspace = static_cast<Float>( mFont->getGlyph( L' ', mRealFontSize, bold ).advance );
-
-	while ( *tChar ) {
-		Glyph pChar = mFont->getGlyph( *tChar, mRealFontSize, bold, mOutlineThickness );
+	ParagraphLayout layout;
+	layout.setStyle( *this );
+	layout.setString( mString );
 
-		Float fCharWidth = (Float)pChar.advance;
-
-		if ( ( *tChar ) == '\t' )
-			fCharWidth += hspace * mTabWidth;
-		else if ( ( *tChar ) == '\r' )
-			fCharWidth = 0;
-
-		// Add the new char width to the current word width
-		tWordWidth += fCharWidth;
-
-		if ( *tChar != '\r' ) {
-			tWordWidth += mFont->getKerning( prevChar, *tChar, mRealFontSize, bold );
-			prevChar = *tChar;
-		}
-
-		if ( ' ' == *tChar || '\0' == *( tChar + 1 ) ) {
-
-			// If current width plus word width is minor to the max width, continue adding
-			if ( tCurWidth + tWordWidth < tMaxWidth ) {
-				tCurWidth += tWordWidth;
-				tLastSpace = tChar;
-
-				tChar++;
-			} else {
-				// If it was an space before, replace that space for an new line
-				// Start counting from the new line first character
-				if ( NULL != tLastSpace ) {
-					*tLastSpace = '\n';
-					tChar = tLastSpace + 1;
-				} else { // The word is larger than the current possible width
-					*tChar = '\n';
-				}
-
-				if ( '\0' == *( tChar + 1 ) )
-					tChar++;
-
-				// Set the last spaces as null, because is a new line
-				tLastSpace = NULL;
-
-				// New line, new current width
-				tCurWidth = 0.f;
-			}
-
-			// New word, so we reset the current word width
-			tWordWidth = 0.f;
-		} else if ( '\n' == *tChar ) {
-			tWordWidth = 0.f;
-			tCurWidth = 0.f;
-			tLastSpace = NULL;
-			tChar++;
-		} else {
-			tChar++;
-		}
-	}
+	for ( const auto& pos : layout.getBreaks( maxWidth ) )
+		mString[pos] = '\n';
 
 	invalidate();
 }
@@ -611,6 +552,14 @@ void Text::draw( const Float& X, const Float& Y, const Vector2f& scale, const Fl
 		ensureColorUpdate();
 		ensureGeometryUpdate();
 
+		// The font dropped or replaced the glyphs used by the geometry
+		if ( !mVertices.empty() &&
+			 mFont->getTextureGeneration( mRealFontSize ) != mFontTextureGeneration ) {
+			mGeometryNeedUpdate = true;
+			mCachedWidthNeedUpdate = true;
+			ensureGeometryUpdate();
+		}
+
 		unsigned int numvert = mVertices.size();
 
 		if ( 0 == numvert )
@@ -688,6 +637,15 @@ void Text::draw( const Float& X, const Float& Y, const Vector2f& scale, const Fl
 		Texture* texture = mFont->getTexture( mRealFontSize );
 		if ( !texture )
 			return;
+
+		// The distance field glyphs are scaled and outlined by the shader
+		ShaderProgram* distanceFieldShader =
+			isDistanceField() ? FontTrueType::getDistanceFieldShader() : nullptr;
+		Float distanceFieldScale = ( eeabs( scale.x ) + eeabs( scale.y ) ) * 0.5f;
+
+		if ( nullptr != distanceFieldShader )
+			distanceFieldShader->bind();
+
 		texture->bind();
 		BlendMode::setMode( effect );
 
@@ -695,6 +653,10 @@ void Text::draw( const Float& X, const Float& Y, const Vector2f& scale, const Fl
 		Uint32 allocC = numvert * GLi->quadVertexs();
 
 		if ( 0 != mOutlineThickness ) {
+			if ( nullptr != distanceFieldShader )
+				FontTrueType::setDistanceFieldUniforms( distanceFieldShader, mRealFontSize,
+														distanceFieldScale, mOutlineThickness );
+
 			GLi->colorPointer( 4, GL_UNSIGNED_BYTE, 0,
 							   reinterpret_cast<char*>( &mOutlineColors[0] ), allocC );
 			GLi->texCoordPointer( 2, GL_FP, sizeof( VertexCoords ),
@@ -710,6 +672,10 @@ void Text::draw( const Float& X, const Float& Y, const Vector2f& scale, const Fl
 			}
 		}
 
+		if ( nullptr != distanceFieldShader )
+			FontTrueType::setDistanceFieldUniforms( distanceFieldShader, mRealFontSize,
+													distanceFieldScale, 0 );
+
 		GLi->colorPointer( 4, GL_UNSIGNED_BYTE, 0, reinterpret_cast<char*>( &mColors[0] ), allocC );
 		GLi->texCoordPointer( 2, GL_FP, sizeof( VertexCoords ),
 							  reinterpret_cast<char*>( &mVertices[0] ), alloc );
@@ -722,6 +688,9 @@ void Text::draw( const Float& X, const Float& Y, const Vector2f& scale, const Fl
 			GLi->drawArrays( GL_TRIANGLES, 0, numvert );
 		}
 
+		if ( nullptr != distanceFieldShader )
+			distanceFieldShader->unbind();
+
 		if ( rotation != 0.0f || scale != 1.0f ) {
 			GLi->popMatrix();
 		} else {
@@ -751,6 +720,9 @@ void Text::ensureGeometryUpdate() {
 	if ( !mFont || mString.empty() )
 		return;
 
+	// If the glyphs are dropped while building the geometry the next draw will build it again
+	mFontTextureGeneration = mFont->getTextureGeneration( mRealFontSize );
+
 	// Compute values related to the text style
 	bool bold = ( mStyle & Bold ) != 0;
 	bool underlined = ( mStyle & Underlined ) != 0;
@@ -758,6 +730,8 @@ void Text::ensureGeometryUpdate() {
 	Float italic = ( mStyle & Italic ) ? 0.208f : 0.f; // 12 degrees
 	Float underlineOffset = mFont->getUnderlinePosition( mRealFontSize );
 	Float underlineThickness = mFont->getUnderlineThickness( mRealFontSize );
+	// The distance field glyphs already include their margin in the texture area
+	Float glyphPadding = isDistanceField() ? 0.f : 1.f;
 
 	// Compute the location of the strike through dynamically
 	// We use the center point of the lowercase 'x' glyph as the reference
@@ -881,7 +855,7 @@ void Text::ensureGeometryUpdate() {
 
 			// Add the outline glyph to the vertices
 			addGlyphQuad( mOutlineVertices, Vector2f( x, y ), glyph, italic, mOutlineThickness,
-						  centerDiffX );
+						  centerDiffX, glyphPadding );
 
 			// Update the current bounds with the outlined glyph bounds
 			minX = std::min( minX, x + left - italic * bottom - mOutlineThickness );
@@ -894,7 +868,7 @@ void Text::ensureGeometryUpdate() {
 		const Glyph& glyph = mFont->getGlyph( curChar, mRealFontSize, bold );
 
 		// Add the glyph to the vertices
-		addGlyphQuad( mVertices, Vector2f( x, y ), glyph, italic, 0, centerDiffX );
+		addGlyphQuad( mVertices, Vector2f( x, y ), glyph, italic, 0, centerDiffX, glyphPadding );
 
 		// Update the current bounds with the non outlined glyph bounds
 		if ( mOutlineThickness == 0 ) {
@@ -1197,8 +1171,7 @@ void Text::addLine( std::vector<VertexCoords>& vertices, Float lineLength, Float
 // Add a glyph quad to the vertex array
 void Text::addGlyphQuad( std::vector<VertexCoords>& vertices, Vector2f position,
 						 const EE::Graphics::Glyph& glyph, Float italic, Float outlineThickness,
-						 Int32 centerDiffX ) {
-	Float padding = 1.0;
+						 Int32 centerDiffX, Float padding ) {
 	Float left = glyph.bounds.Left - padding;
 	Float top = glyph.bounds.Top - padding;
 	Float right = glyph.bounds.Left + glyph.bounds.Right + padding;
@@ -1273,6 +1246,11 @@ void Text::addGlyphQuad( std::vector<VertexCoords>& vertices, Vector2f position,
 	}
 }
 
+bool Text::isDistanceField() const {
+	return NULL != mFont && mFont->getType() == FontType::TTF &&
+		   static_cast<FontTrueType*>( mFont )->isDistanceFieldEnabled();
+}
+
 Uint32 Text::getTotalVertices() {
 	bool underlined = ( mStyle & Underlined ) != 0;
 	bool strikeThrough = ( mStyle & StrikeThrough ) != 0;
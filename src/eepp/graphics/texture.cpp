@@ -3,6 +3,7 @@
 #include <eepp/graphics/pixeldensity.hpp>
 #include <eepp/graphics/renderer/openglext.hpp>
 #include <eepp/graphics/renderer/renderer.hpp>
+#include <eepp/graphics/renderer/renderernull.hpp>
 #include <eepp/graphics/scopedtexture.hpp>
 #include <eepp/graphics/texture.hpp>
 #include <eepp/graphics/texturefactory.hpp>
@@ -17,13 +18,22 @@ namespace EE { namespace Graphics {
 
 static BatchRenderer* sBR = NULL;
 
+static unsigned int createGLTexture( const unsigned char* pixels, int* width, int* height,
+									 int channels, unsigned int reuseTexture,
+									 unsigned int flags ) {
+	if ( GLv_Null == GLi->version() )
+		return GLi->getRendererNull()->createTexture( *width, *height, channels, reuseTexture );
+
+	return SOIL_create_OGL_texture( pixels, width, height, channels, reuseTexture, flags );
+}
+
 Uint32 Texture::getMaximumSize() {
 	static bool checked = false;
 	static GLint size = 0;
 
 	if ( !checked ) {
 		checked = true;
-		glGetIntegerv( GL_MAX_TEXTURE_SIZE, &size );
+		GLi->getIntegerv( GL_MAX_TEXTURE_SIZE, &size );
 	}
 
 	return static_cast<Uint32>( size );
@@ -90,7 +100,7 @@ void Texture::deleteTexture() {
 		if ( threaded )
 			Engine::instance()->getCurrentWindow()->setGLContextThread();
 
-		glDeleteTextures( 1, &Texture );
+		GLi->deleteTextures( 1, &Texture );
 
 		if ( threaded )
 			Engine::instance()->getCurrentWindow()->unsetGLContextThread();
@@ -142,6 +152,22 @@ Uint8* Texture::iLock( const bool& ForceRGBA, const bool& KeepFormat ) {
 	bool threaded =
 		Engine::instance()->isSharedGLContextEnabled() && !Engine::instance()->isMainThread();
 
+	if ( GLv_Null == GLi->version() ) {
+		// There is no texture storage to read back from, only the local copy is kept
+		if ( !( mFlags & TEX_FLAG_LOCKED ) ) {
+			if ( !hasLocalCopy() ) {
+				if ( ForceRGBA )
+					mChannels = 4;
+
+				allocate( mWidth * mHeight * mChannels );
+			}
+
+			mFlags |= TEX_FLAG_LOCKED;
+		}
+
+		return &mPixels[0];
+	}
+
 #ifndef EE_GLES
 	if ( !( mFlags & TEX_FLAG_LOCKED ) ) {
 		if ( threaded )
@@ -206,7 +232,7 @@ Uint8* Texture::iLock( const bool& ForceRGBA, const bool& KeepFormat ) {
 				allocate( mWidth * mHeight * 4 );
 
 				GLint previousFrameBuffer;
-				glGetIntegerv( GL_FRAMEBUFFER_BINDING, &previousFrameBuffer );
+				GLi->getIntegerv( GL_FRAMEBUFFER_BINDING, &previousFrameBuffer );
 				GLi->bindFramebuffer( GL_FRAMEBUFFER, frameBuffer );
 				GLi->framebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
 										   mTexture, 0 );
@@ -245,8 +271,8 @@ bool Texture::unlock( const bool& KeepData, const bool& Modified ) {
 			flags = ( mClampMode == ClampMode::ClampRepeat ) ? ( flags | SOIL_FLAG_TEXTURE_REPEATS )
 															 : flags;
 
-			NTexId = SOIL_create_OGL_texture( reinterpret_cast<Uint8*>( &mPixels[0] ), &width,
-											  &height, mChannels, mTexture, flags );
+			NTexId = createGLTexture( reinterpret_cast<Uint8*>( &mPixels[0] ), &width, &height,
+									  mChannels, mTexture, flags );
 
 			iTextureFilter( mFilter );
 
@@ -331,15 +357,16 @@ void Texture::iTextureFilter( const Filter& filter ) {
 
 		ScopedTexture saver( mTexture );
 
-		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-						 ( mFilter == Filter::Linear ) ? GL_LINEAR : GL_NEAREST );
+		GLi->texParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+							( mFilter == Filter::Linear ) ? GL_LINEAR : GL_NEAREST );
 
 		if ( mFlags & TEX_FLAG_MIPMAP )
-			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-							 ( mFilter == Filter::Linear ) ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST );
+			GLi->texParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+								( mFilter == Filter::Linear ) ? GL_LINEAR_MIPMAP_LINEAR
+															  : GL_NEAREST );
 		else
-			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-							 ( mFilter == Filter::Linear ) ? GL_LINEAR : GL_NEAREST );
+			GLi->texParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+								( mFilter == Filter::Linear ) ? GL_LINEAR : GL_NEAREST );
 
 		if ( threaded )
 			Engine::instance()->getCurrentWindow()->unsetGLContextThread();
@@ -437,12 +464,12 @@ void Texture::applyClampMode() {
 		ScopedTexture saver( mTexture );
 
 		if ( mClampMode == ClampMode::ClampRepeat ) {
-			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
-			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
+			GLi->texParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
+			GLi->texParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
 		} else {
 			unsigned int clamp_mode = 0x812F; // GL_CLAMP_TO_EDGE
-			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, clamp_mode );
-			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, clamp_mode );
+			GLi->texParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, clamp_mode );
+			GLi->texParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, clamp_mode );
 		}
 	}
 }
@@ -474,16 +501,16 @@ void Texture::reload() {
 															 : flags;
 
 			if ( ( mFlags & TEX_FLAG_COMPRESSED ) ) {
-				if ( isGrabed() )
-					mTexture = SOIL_create_OGL_texture( reinterpret_cast<Uint8*>( &mPixels[0] ),
-														&width, &height, mChannels, mTexture,
-														flags | SOIL_FLAG_COMPRESS_TO_DXT );
+				if ( isGrabed() || GLv_Null == GLi->version() )
+					mTexture = createGLTexture( reinterpret_cast<Uint8*>( &mPixels[0] ), &width,
+												&height, mChannels, mTexture,
+												flags | SOIL_FLAG_COMPRESS_TO_DXT );
 				else
 					glCompressedTexImage2D( mTexture, 0, mInternalFormat, width, height, 0, mSize,
 											&mPixels[0] );
 			} else {
-				mTexture = SOIL_create_OGL_texture( reinterpret_cast<Uint8*>( &mPixels[0] ), &width,
-													&height, mChannels, mTexture, flags );
+				mTexture = createGLTexture( reinterpret_cast<Uint8*>( &mPixels[0] ), &width,
+											&height, mChannels, mTexture, flags );
 
 				TextureFactory::instance()->mMemSize -= mSize;
 
@@ -548,9 +575,9 @@ void Texture::update( const Uint8* pixels, Uint32 width, Uint32 height, Uint32 x
 		{
 			ScopedTexture saver( mTexture );
 
-			glTexSubImage2D( GL_TEXTURE_2D, 0, x, y, width, height,
-							 (unsigned int)convertPixelFormatToGLFormat( pf ), GL_UNSIGNED_BYTE,
-							 pixels );
+			GLi->texSubImage2D( GL_TEXTURE_2D, 0, x, y, width, height,
+								(unsigned int)convertPixelFormatToGLFormat( pf ), GL_UNSIGNED_BYTE,
+								pixels );
 
 			if ( hasLocalCopy() ) {
 				Image image( pixels, width, height, mChannels );
@@ -591,8 +618,8 @@ void Texture::replace( Image* image ) {
 
 		Int32 width = (Int32)image->getWidth();
 		Int32 height = (Int32)image->getHeight();
-		mTexture = SOIL_create_OGL_texture( image->getPixelsPtr(), &width, &height,
-											image->getChannels(), mTexture, flags );
+		mTexture = createGLTexture( image->getPixelsPtr(), &width, &height, image->getChannels(),
+									mTexture, flags );
 		mWidth = mImgWidth = width;
 		mHeight = mImgHeight = height;
 		mChannels = image->getChannels();
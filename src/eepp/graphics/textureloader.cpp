@@ -2,6 +2,7 @@
 #include <SOIL2/src/SOIL2/stb_image.h>
 #include <eepp/graphics/renderer/opengl.hpp>
 #include <eepp/graphics/renderer/renderer.hpp>
+#include <eepp/graphics/renderer/renderernull.hpp>
 #include <eepp/graphics/scopedtexture.hpp>
 #include <eepp/graphics/stbi_iocb.hpp>
 #include <eepp/graphics/texture.hpp>
@@ -365,7 +366,9 @@ void TextureLoader::loadFromPixels() {
 				ScopedTexture scopedTexture;
 
 				if ( mDirectUpload ) {
-					if ( STBI_dds == mImgType ) {
+					if ( GLv_Null == GLi->version() ) {
+						tTexId = GLi->getRendererNull()->createTexture( width, height, mChannels );
+					} else if ( STBI_dds == mImgType ) {
 						tTexId = SOIL_direct_load_DDS_from_memory( mPixels, mSize,
 																   SOIL_CREATE_NEW_ID, flags, 0 );
 					} else if ( STBI_pvr == mImgType ) {
@@ -389,8 +392,12 @@ void TextureLoader::loadFromPixels() {
 						eeSAFE_DELETE( tImg );
 					}
 
-					tTexId = SOIL_create_OGL_texture( mPixels, &width, &height, mChannels,
-													  SOIL_CREATE_NEW_ID, flags );
+					if ( GLv_Null == GLi->version() ) {
+						tTexId = GLi->getRendererNull()->createTexture( width, height, mChannels );
+					} else {
+						tTexId = SOIL_create_OGL_texture( mPixels, &width, &height, mChannels,
+														  SOIL_CREATE_NEW_ID, flags );
+					}
 				}
 			}
 
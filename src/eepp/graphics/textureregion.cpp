@@ -355,9 +355,10 @@ bool TextureRegion::unlock( const bool& KeepData, const bool& Modified ) {
 			else if ( 1 == Channels )
 				Channel = GL_ALPHA;
 
-			glTexSubImage2D( GL_TEXTURE_2D, 0, mSrcRect.Left, mSrcRect.Top,
-							 mSrcRect.getSize().getWidth(), mSrcRect.getSize().getHeight(), Channel,
-							 GL_UNSIGNED_BYTE, reinterpret_cast<const void*>( &mPixels[0] ) );
+			GLi->texSubImage2D( GL_TEXTURE_2D, 0, mSrcRect.Left, mSrcRect.Top,
+								mSrcRect.getSize().getWidth(), mSrcRect.getSize().getHeight(),
+								Channel, GL_UNSIGNED_BYTE,
+								reinterpret_cast<const void*>( &mPixels[0] ) );
 
 			onResourceChange();
 		}
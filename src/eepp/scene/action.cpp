@@ -1,9 +1,11 @@
 #include <eepp/scene/action.hpp>
+#include <eepp/scene/actionmanager.hpp>
 #include <eepp/scene/node.hpp>
 
 namespace EE { namespace Scene {
 
-Action::Action() : mNode( NULL ), mFlags( 0 ), mTag( 0 ), mNumCallBacks( 0 ), mId( 0 ) {}
+Action::Action() :
+	mNode( NULL ), mActionManager( NULL ), mFlags( 0 ), mTag( 0 ), mNumCallBacks( 0 ), mId( 0 ) {}
 
 Action::~Action() {
 	sendEvent( ActionType::OnDelete );
@@ -22,12 +24,21 @@ String::HashType Action::getTag() const {
 }
 
 void Action::setTag( const Uint32& tag ) {
-	mTag = tag;
+	if ( mTag != tag ) {
+		mTag = tag;
+
+		if ( NULL != mActionManager )
+			mActionManager->onActionChanged( this );
+	}
 }
 
 void Action::setTarget( Node* target ) {
 	if ( mNode != target ) {
 		mNode = target;
+
+		if ( NULL != mActionManager )
+			mActionManager->onActionChanged( this );
+
 		onTargetChange();
 	}
 }
@@ -48,6 +59,10 @@ Action* Action::clone() const {
 	return NULL;
 }
 
+Time Action::getIdleTime() {
+	return Time::Zero;
+}
+
 Action* Action::reverse() const {
 	return NULL;
 }
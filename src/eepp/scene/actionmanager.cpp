@@ -1,4 +1,3 @@
-#include <algorithm>
 #include <eepp/core.hpp>
 #include <eepp/scene/action.hpp>
 #include <eepp/scene/actionmanager.hpp>
@@ -10,29 +9,59 @@ ActionManager* ActionManager::New() {
 	return eeNew( ActionManager, () );
 }
 
-ActionManager::ActionManager() : mUpdating( false ) {}
+ActionManager::ActionManager() : mActiveHoles( 0 ), mUpdating( false ) {}
 
 ActionManager::~ActionManager() {
 	clear();
 }
 
 void ActionManager::addAction( Action* action ) {
+	if ( NULL == action )
+		return;
+
 	Lock l( mMutex );
 
-	bool found = ( std::find( mActions.begin(), mActions.end(), action ) != mActions.end() );
+	if ( mActionSlots.find( action ) != mActionSlots.end() )
+		return;
+
+	Uint32 index;
+
+	if ( !mFreeSlots.empty() ) {
+		index = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	} else {
+		index = static_cast<Uint32>( mSlots.size() );
+		mSlots.emplace_back();
+	}
+
+	Slot& slot = mSlots[index];
+	slot.action = action;
+	slot.target = action->getTarget();
+	slot.tag = action->getTag();
+	slot.pendingRemoval = false;
+	slot.activeIndex = static_cast<Uint32>( mActive.size() );
 
-	if ( !found )
-		mActions.emplace_back( action );
+	mActive.emplace_back( index );
+	mActionSlots[action] = index;
+
+	linkTarget( index );
+	linkTag( index );
+
+	action->mActionManager = this;
 }
 
 Action* ActionManager::getActionByTag( const Uint32& tag ) {
 	Lock l( mMutex );
 
-	for ( auto it = mActions.begin(); it != mActions.end(); ++it ) {
-		Action* action = *it;
+	auto it = mTags.find( tag );
 
-		if ( action->getTag() == tag )
-			return action;
+	if ( it == mTags.end() )
+		return NULL;
+
+	for ( Uint32 index = it->second.head; index != InvalidSlot;
+		  index = mSlots[index].tagLink.next ) {
+		if ( !mSlots[index].pendingRemoval )
+			return mSlots[index].action;
 	}
 
 	return NULL;
@@ -42,12 +71,15 @@ std::vector<Action*> ActionManager::getActionsFromTarget( Node* target ) {
 	Lock l( mMutex );
 
 	std::vector<Action*> actions;
+	auto it = mTargets.find( target );
 
-	for ( auto it = mActions.begin(); it != mActions.end(); ++it ) {
-		Action* action = *it;
+	if ( it == mTargets.end() )
+		return actions;
 
-		if ( action->getTarget() == target )
-			actions.emplace_back( action );
+	for ( Uint32 index = it->second.head; index != InvalidSlot;
+		  index = mSlots[index].targetLink.next ) {
+		if ( !mSlots[index].pendingRemoval )
+			actions.emplace_back( mSlots[index].action );
 	}
 
 	return actions;
@@ -56,13 +88,19 @@ std::vector<Action*> ActionManager::getActionsFromTarget( Node* target ) {
 std::vector<Action*> ActionManager::getActionsByTagFromTarget( Node* target,
 															   const String::HashType& tag ) {
 	Lock l( mMutex );
+
 	std::vector<Action*> actions;
+	auto it = mTargets.find( target );
 
-	for ( auto it = mActions.begin(); it != mActions.end(); ++it ) {
-		Action* action = *it;
+	if ( it == mTargets.end() )
+		return actions;
 
-		if ( action->getTarget() == target && action->getTag() == tag )
-			actions.emplace_back( action );
+	for ( Uint32 index = it->second.head; index != InvalidSlot;
+		  index = mSlots[index].targetLink.next ) {
+		const Slot& slot = mSlots[index];
+
+		if ( !slot.pendingRemoval && slot.tag == tag )
+			actions.emplace_back( slot.action );
 	}
 
 	return actions;
@@ -73,98 +111,135 @@ void ActionManager::removeActionByTag( const Uint32& tag ) {
 }
 
 void ActionManager::removeActionsByTagFromTarget( Node* target, const String::HashType& tag ) {
-	std::vector<Action*> removeList;
-
-	{
-		Lock l( mMutex );
-		for ( auto it = mActions.begin(); it != mActions.end(); ++it ) {
-			Action* action = *it;
-
-			if ( action->getTarget() == target && action->getTag() == tag ) {
-				removeList.emplace_back( *it );
-			}
-		}
-	}
-
-	for ( auto it = removeList.begin(); it != removeList.end(); ++it )
-		removeAction( *it );
+	removeActions( getActionsByTagFromTarget( target, tag ) );
 }
 
 void ActionManager::update( const Time& time ) {
 	if ( isEmpty() )
 		return;
 
-	std::vector<Action*> removeList;
+	Lock l( mMutex );
+
+	if ( mActiveHoles > 0 )
+		compactActive();
 
-	{
-		mUpdating = true;
+	mUpdating = true;
 
-		Lock l( mMutex );
+	// Actions can be added during action updates, we need to only iterate the current actions.
+	// New actions are appended to mActive and released slots are only marked, so the indices of
+	// the current actions are stable during the whole update.
+	std::size_t count = mActive.size();
+
+	for ( std::size_t i = 0; i < count; ++i ) {
+		Uint32 index = mActive[i];
 
-		// Actions can be added during action updates, we need to only iterate the current actions
-		auto actions = mActions;
+		if ( InvalidSlot == index || mSlots[index].pendingRemoval )
+			continue;
 
-		for ( auto it = actions.begin(); it != actions.end(); ++it ) {
-			Action* action = *it;
+		Action* action = mSlots[index].action;
 
-			action->update( time );
+		action->update( time );
 
-			if ( action->isDone() ) {
-				action->sendEvent( Action::ActionType::OnDone );
+		if ( action->isDone() ) {
+			action->sendEvent( Action::ActionType::OnDone );
 
-				removeList.emplace_back( action );
+			if ( !mSlots[index].pendingRemoval ) {
+				mSlots[index].pendingRemoval = true;
+				mActionsRemoveList.emplace_back( action );
 			}
 		}
-
-		mUpdating = false;
 	}
 
-	for ( auto it = mActionsRemoveList.begin(); it != mActionsRemoveList.end(); ++it )
-		removeAction( *it );
+	mUpdating = false;
+
+	// Releasing an action can trigger callbacks that remove more actions, so the remove list is
+	// swapped with a second buffer. Both keep their capacity to avoid per frame allocations.
+	mActionsReleaseList.swap( mActionsRemoveList );
 
-	mActionsRemoveList.clear();
+	for ( auto& action : mActionsReleaseList )
+		release( action );
 
-	for ( auto it = removeList.begin(); it != removeList.end(); ++it )
-		removeAction( *it );
+	mActionsReleaseList.clear();
 }
 
 std::size_t ActionManager::count() const {
 	Lock l( mMutex );
-	return mActions.size();
+	return mActionSlots.size();
 }
 
 bool ActionManager::isEmpty() const {
 	Lock l( mMutex );
-	return mActions.empty();
+	return mActionSlots.empty();
 }
 
-void ActionManager::clear() {
+Time ActionManager::getIdleTime() const {
 	Lock l( mMutex );
 
-	for ( auto it = mActions.begin(); it != mActions.end(); ++it ) {
-		Action* action = *it;
+	Time idle( Time::Infinity );
 
-		eeSAFE_DELETE( action );
+	for ( const auto& index : mActive ) {
+		if ( InvalidSlot == index || mSlots[index].pendingRemoval )
+			continue;
+
+		idle = eemin( idle, mSlots[index].action->getIdleTime() );
+
+		if ( idle == Time::Zero )
+			break;
+	}
+
+	return idle;
+}
+
+void ActionManager::clear() {
+	std::vector<Action*> actions;
+
+	{
+		Lock l( mMutex );
+
+		actions.reserve( mActionSlots.size() );
+
+		for ( auto& index : mActive ) {
+			if ( InvalidSlot != index )
+				actions.emplace_back( mSlots[index].action );
+		}
+
+		mSlots.clear();
+		mFreeSlots.clear();
+		mActive.clear();
+		mActiveHoles = 0;
+		mActionSlots.clear();
+		mTargets.clear();
+		mTags.clear();
+		mActionsRemoveList.clear();
 	}
 
-	mActions.clear();
+	// Delete the actions once the manager state is reset, the delete callbacks can use the manager
+	for ( auto& action : actions ) {
+		action->mActionManager = NULL;
+		eeSAFE_DELETE( action );
+	}
 }
 
 void ActionManager::removeAction( Action* action ) {
-	if ( NULL != action ) {
-		if ( !mUpdating ) {
-			Lock l( mMutex );
+	if ( NULL == action )
+		return;
+
+	Lock l( mMutex );
+
+	auto it = mActionSlots.find( action );
 
-			auto actionIt = std::find( mActions.begin(), mActions.end(), action );
+	if ( it == mActionSlots.end() )
+		return;
 
-			if ( actionIt != mActions.end() ) {
-				mActions.erase( actionIt );
+	if ( mUpdating ) {
+		Slot& slot = mSlots[it->second];
 
-				eeSAFE_DELETE( action );
-			}
-		} else {
+		if ( !slot.pendingRemoval ) {
+			slot.pendingRemoval = true;
 			mActionsRemoveList.emplace_back( action );
 		}
+	} else {
+		release( action );
 	}
 }
 
@@ -175,21 +250,143 @@ void ActionManager::removeActions( const std::vector<Action*>& actions ) {
 }
 
 void ActionManager::removeAllActionsFromTarget( Node* target ) {
-	std::vector<Action*> removeList;
+	removeActions( getActionsFromTarget( target ) );
+}
 
-	{
-		Lock l( mMutex );
-		for ( auto it = mActions.begin(); it != mActions.end(); ++it ) {
-			Action* action = *it;
+void ActionManager::onActionChanged( Action* action ) {
+	Lock l( mMutex );
 
-			if ( action->getTarget() == target ) {
-				removeList.emplace_back( *it );
-			}
+	auto it = mActionSlots.find( action );
+
+	if ( it == mActionSlots.end() )
+		return;
+
+	Uint32 index = it->second;
+
+	if ( mSlots[index].target != action->getTarget() ) {
+		unlinkTarget( index );
+		mSlots[index].target = action->getTarget();
+		linkTarget( index );
+	}
+
+	if ( mSlots[index].tag != action->getTag() ) {
+		unlinkTag( index );
+		mSlots[index].tag = action->getTag();
+		linkTag( index );
+	}
+}
+
+void ActionManager::release( Action* action ) {
+	auto it = mActionSlots.find( action );
+
+	if ( it == mActionSlots.end() )
+		return;
+
+	Uint32 index = it->second;
+
+	mActionSlots.erase( it );
+
+	releaseSlot( index );
+
+	action->mActionManager = NULL;
+
+	eeSAFE_DELETE( action );
+}
+
+void ActionManager::releaseSlot( const Uint32& index ) {
+	unlinkTarget( index );
+	unlinkTag( index );
+
+	mActive[mSlots[index].activeIndex] = InvalidSlot;
+	mActiveHoles++;
+
+	mSlots[index] = Slot();
+	mFreeSlots.emplace_back( index );
+
+	if ( mActionSlots.empty() ) {
+		mActive.clear();
+		mActiveHoles = 0;
+	}
+}
+
+void ActionManager::compactActive() {
+	std::size_t count = 0;
+
+	for ( std::size_t i = 0; i < mActive.size(); ++i ) {
+		Uint32 index = mActive[i];
+
+		if ( InvalidSlot != index ) {
+			mSlots[index].activeIndex = static_cast<Uint32>( count );
+			mActive[count++] = index;
 		}
 	}
 
-	for ( auto it = removeList.begin(); it != removeList.end(); ++it )
-		removeAction( *it );
+	mActive.resize( count );
+	mActiveHoles = 0;
+}
+
+void ActionManager::link( List& list, const Uint32& index, Link Slot::*link ) {
+	Link& node = mSlots[index].*link;
+	node.prev = list.tail;
+	node.next = InvalidSlot;
+
+	if ( InvalidSlot != list.tail ) {
+		( mSlots[list.tail].*link ).next = index;
+	} else {
+		list.head = index;
+	}
+
+	list.tail = index;
+}
+
+void ActionManager::unlink( List& list, const Uint32& index, Link Slot::*link ) {
+	Link& node = mSlots[index].*link;
+
+	if ( InvalidSlot != node.prev ) {
+		( mSlots[node.prev].*link ).next = node.next;
+	} else {
+		list.head = node.next;
+	}
+
+	if ( InvalidSlot != node.next ) {
+		( mSlots[node.next].*link ).prev = node.prev;
+	} else {
+		list.tail = node.prev;
+	}
+
+	node = Link();
+}
+
+void ActionManager::linkTarget( const Uint32& index ) {
+	link( mTargets[mSlots[index].target], index, &Slot::targetLink );
+}
+
+void ActionManager::unlinkTarget( const Uint32& index ) {
+	auto it = mTargets.find( mSlots[index].target );
+
+	if ( it == mTargets.end() )
+		return;
+
+	unlink( it->second, index, &Slot::targetLink );
+
+	if ( InvalidSlot == it->second.head )
+		mTargets.erase( it );
+}
+
+void ActionManager::linkTag( const Uint32& index ) {
+	link( mTags[mSlots[index].tag], index, &Slot::tagLink );
+}
+
+void ActionManager::unlinkTag( const Uint32& index ) {
+	auto it = mTags.find( mSlots[index].tag );
+
+	if ( it == mTags.end() )
+		return;
+
+	unlink( it->second, index, &Slot::tagLink );
+
+	if ( InvalidSlot == it->second.head )
+		mTags.erase( it );
 }
 
 }} // namespace EE::Scene
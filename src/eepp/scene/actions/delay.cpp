@@ -35,6 +35,11 @@ Time Delay::getTotalTime() {
 	return mTime;
 }
 
+Time Delay::getIdleTime() {
+	Time elapsed( mClock.getElapsedTime() );
+	return elapsed < mTime ? mTime - elapsed : Time::Zero;
+}
+
 Action* Delay::clone() const {
 	return New( mTime );
 }
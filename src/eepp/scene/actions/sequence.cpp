@@ -101,6 +101,10 @@ Time Sequence::getTotalTime() {
 	return mDuration;
 }
 
+Time Sequence::getIdleTime() {
+	return isDone() ? Time::Zero : mSequence[mCurPos]->getIdleTime();
+}
+
 Action* Sequence::clone() const {
 	return Sequence::New( mSequence );
 }
@@ -101,6 +101,17 @@ Time Spawn::getTotalTime() {
 	return Microseconds( max );
 }
 
+Time Spawn::getIdleTime() {
+	Time idle( Time::Infinity );
+
+	for ( auto& spawn : mSpawn ) {
+		if ( !spawn->isDone() )
+			idle = eemin( idle, spawn->getIdleTime() );
+	}
+
+	return idle == Time::Infinity ? Time::Zero : idle;
+}
+
 Action* Spawn::clone() const {
 	return Spawn::New( mSpawn );
 }
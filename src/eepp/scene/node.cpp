@@ -6,6 +6,9 @@
 #include <eepp/scene/node.hpp>
 #include <eepp/scene/scenemanager.hpp>
 #include <eepp/scene/scenenode.hpp>
+#include <eepp/system/profiler.hpp>
+#include <eepp/window/engine.hpp>
+#include <limits>
 
 namespace EE { namespace Scene {
 
@@ -24,7 +27,8 @@ Node::Node() :
 	mChildLast( NULL ),
 	mNext( NULL ),
 	mPrev( NULL ),
-	mNodeFlags( NODE_FLAG_POSITION_DIRTY | NODE_FLAG_POLYGON_DIRTY ),
+	mNodeFlags( NODE_FLAG_POSITION_DIRTY | NODE_FLAG_POLYGON_DIRTY |
+				NODE_FLAG_CONTENT_BOUNDS_DIRTY ),
 	mBlend( BlendMode::Alpha() ),
 	mNumCallBacks( 0 ),
 	mVisible( true ),
@@ -39,6 +43,9 @@ Node::~Node() {
 		if ( mNodeFlags & NODE_FLAG_SCHEDULED_UPDATE )
 			mSceneNode->unsubscribeScheduledUpdate( this );
 
+		if ( mSceneNode != this )
+			mSceneNode->mTimers.removeOwner( this );
+
 		if ( isMouseOverMeOrChilds() )
 			mSceneNode->removeMouseOverNode( this );
 	}
@@ -63,6 +70,12 @@ Node::~Node() {
 			eventDispatcher->resetMouseDownNode();
 		}
 	}
+
+	// Deleting the childs invalidates the node, it must be removed after that
+	if ( !SceneManager::instance()->isShootingDown() && NULL != mSceneNode && mSceneNode != this ) {
+		mSceneNode->mDamagedNodes.erase( this );
+		mSceneNode->mFrameBufferNodes.erase( this );
+	}
 }
 
 void Node::worldToNodeTranslation( Vector2f& Pos ) const {
@@ -115,6 +128,9 @@ Uint32 Node::onMessage( const NodeMessage* ) {
 void Node::setInternalPosition( const Vector2f& Pos ) {
 	Transformable::setPosition( Vector2f( Pos.x, Pos.y ) );
 	setDirty();
+
+	if ( NULL != mParentNode )
+		mParentNode->invalidateContentBounds();
 }
 
 void Node::setPosition( const Vector2f& Pos ) {
@@ -132,6 +148,10 @@ Node* Node::setPosition( const Float& x, const Float& y ) {
 void Node::setInternalSize( const Sizef& size ) {
 	mSize = size;
 	mNodeFlags |= NODE_FLAG_POLYGON_DIRTY;
+	invalidateContentBounds();
+	// A clipped node may stay dirty while its parent is clean, the parent reads its local bounds
+	if ( NULL != mParentNode )
+		mParentNode->invalidateContentBounds();
 	updateCenter();
 	sendCommonEvent( Event::OnSizeChange );
 	invalidateDraw();
@@ -139,6 +159,10 @@ void Node::setInternalSize( const Sizef& size ) {
 
 void Node::scheduledUpdate( const Time& ) {}
 
+Time Node::getIdleTime() {
+	return Time::Zero;
+}
+
 Node* Node::setSize( const Sizef& Size ) {
 	if ( Size != mSize ) {
 		setInternalSize( Size );
@@ -172,6 +196,10 @@ const Sizef& Node::getPixelsSize() const {
 Node* Node::setVisible( const bool& visible ) {
 	if ( mVisible != visible ) {
 		mVisible = visible;
+
+		if ( NULL != mParentNode )
+			mParentNode->invalidateContentBounds();
+
 		onVisibilityChange();
 	}
 	return this;
@@ -492,11 +520,32 @@ void Node::setNodeFlags( const Uint32& flags ) {
 }
 
 void Node::drawChilds() {
+	SceneNode* sceneNode = NULL != mSceneNode && mSceneNode->mCulling ? mSceneNode : NULL;
+	Rectf cullRect;
+	bool cullTransformed = false;
+
+	if ( NULL != sceneNode ) {
+		cullRect = sceneNode->mCullRect;
+		cullTransformed = sceneNode->mCullTransformed;
+
+		if ( isFrameBuffer() ) {
+			// The frame buffer is drawn later in any position, it must keep all the node content.
+			sceneNode->mCullRect = getWorldBounds();
+		} else if ( isClipped() ) {
+			sceneNode->mCullRect.shrink( getWorldBounds() );
+		}
+
+		if ( isScaled() || isRotated() )
+			sceneNode->mCullTransformed = true;
+	}
+
 	if ( isReverseDraw() ) {
 		Node* child = mChildLast;
 
 		while ( NULL != child ) {
-			if ( child->mVisible ) {
+			if ( child->mVisible &&
+				 ( NULL == sceneNode ||
+				   !child->isCulled( sceneNode->mCullRect, sceneNode->mCullTransformed ) ) ) {
 				child->nodeDraw();
 			}
 
@@ -506,20 +555,128 @@ void Node::drawChilds() {
 		Node* child = mChild;
 
 		while ( NULL != child ) {
-			if ( child->mVisible ) {
+			if ( child->mVisible &&
+				 ( NULL == sceneNode ||
+				   !child->isCulled( sceneNode->mCullRect, sceneNode->mCullTransformed ) ) ) {
 				child->nodeDraw();
 			}
 
 			child = child->mNext;
 		}
 	}
+
+	if ( NULL != sceneNode ) {
+		sceneNode->mCullRect = cullRect;
+		sceneNode->mCullTransformed = cullTransformed;
+	}
+}
+
+bool Node::isCulled( const Rectf& cullRect, bool transformed ) {
+	// Windows draw its shadow and decorations outside of its bounds
+	if ( isWindow() )
+		return false;
+
+	if ( isClipped() || NULL == mChild )
+		return !getWorldBounds().overlap( cullRect );
+
+	// The content bounds are not transformed, only the world bounds are
+	if ( transformed || isScaled() || isRotated() )
+		return false;
+
+	if ( mNodeFlags & NODE_FLAG_POSITION_DIRTY )
+		updateScreenPos();
+
+	const Rectf& bounds = getContentBounds();
+
+	return !Rectf( mScreenPos.x + bounds.Left, mScreenPos.y + bounds.Top,
+				   mScreenPos.x + bounds.Right, mScreenPos.y + bounds.Bottom )
+				.overlap( cullRect );
+}
+
+const Rectf& Node::getContentBounds() {
+	if ( !( mNodeFlags & NODE_FLAG_CONTENT_BOUNDS_DIRTY ) )
+		return mContentBounds;
+
+	mContentBounds = Rectf( 0, 0, mSize.getWidth(), mSize.getHeight() );
+
+	Node* child = mChild;
+
+	while ( NULL != child ) {
+		if ( child->mVisible ) {
+			if ( child->isScaled() || child->isRotated() ) {
+				mContentBounds = Rectf( std::numeric_limits<Float>::lowest(),
+										std::numeric_limits<Float>::lowest(),
+										std::numeric_limits<Float>::max(),
+										std::numeric_limits<Float>::max() );
+				break;
+			}
+
+			Rectf bounds( child->isClipped() ? child->getLocalBounds()
+											 : child->getContentBounds() );
+			const Vector2f& pos = child->mPosition;
+
+			mContentBounds.Left = eemin( mContentBounds.Left, pos.x + bounds.Left );
+			mContentBounds.Top = eemin( mContentBounds.Top, pos.y + bounds.Top );
+			mContentBounds.Right = eemax( mContentBounds.Right, pos.x + bounds.Right );
+			mContentBounds.Bottom = eemax( mContentBounds.Bottom, pos.y + bounds.Bottom );
+		}
+
+		child = child->mNext;
+	}
+
+	mNodeFlags &= ~NODE_FLAG_CONTENT_BOUNDS_DIRTY;
+
+	return mContentBounds;
+}
+
+Rectf Node::getDrawBounds() {
+	if ( mNodeFlags & NODE_FLAG_POSITION_DIRTY )
+		updateScreenPos();
+
+	if ( isClipped() )
+		return Rectf( mScreenPos.x, mScreenPos.y, mScreenPos.x + mSize.getWidth(),
+					  mScreenPos.y + mSize.getHeight() );
+
+	const Rectf& bounds = getContentBounds();
+
+	return Rectf( mScreenPos.x + bounds.Left, mScreenPos.y + bounds.Top,
+				  mScreenPos.x + bounds.Right, mScreenPos.y + bounds.Bottom );
+}
+
+const Rectf& Node::getDrawnBounds() const {
+	return mDrawnBounds;
+}
+
+void Node::updateDrawnBounds() {
+	if ( NULL != mSceneNode && mSceneNode->isDamageTracking() ) {
+		mDrawnBounds = getDrawBounds();
+
+		if ( isFrameBuffer() && mSceneNode != this )
+			mSceneNode->mFrameBufferNodes.insert( this );
+	}
+}
+
+void Node::invalidateContentBounds() {
+	Node* node = this;
+
+	// A clean node always has clean descendants, so it's enough to stop at the first dirty node.
+	// The flag of a clipped node is not cleaned by its parent ( it only reads its local bounds ),
+	// that's why the size and position changes invalidate the parent explicitly.
+	while ( NULL != node && !( node->mNodeFlags & NODE_FLAG_CONTENT_BOUNDS_DIRTY ) ) {
+		node->mNodeFlags |= NODE_FLAG_CONTENT_BOUNDS_DIRTY;
+		node = node->mParentNode;
+	}
 }
 
 void Node::nodeDraw() {
 	if ( mVisible ) {
+		eePROFILE_SCOPE( "Node::nodeDraw" );
+
 		if ( mNodeFlags & NODE_FLAG_POSITION_DIRTY )
 			updateScreenPos();
 
+		updateDrawnBounds();
+
 		matrixSet();
 
 		clipStart();
@@ -613,6 +770,8 @@ void Node::childAdd( Node* node ) {
 
 	eeASSERT( !( NULL == mChildLast && NULL != mChild ) );
 
+	invalidateContentBounds();
+
 	onChildCountChange( node, false );
 }
 
@@ -668,6 +827,8 @@ void Node::childAddAt( Node* node, Uint32 index ) {
 
 	eeASSERT( !( NULL == mChildLast && NULL != mChild ) );
 
+	invalidateContentBounds();
+
 	onChildCountChange( node, false );
 }
 
@@ -700,6 +861,8 @@ void Node::childRemove( Node* node ) {
 
 	eeASSERT( !( NULL == mChildLast && NULL != mChild ) );
 
+	invalidateContentBounds();
+
 	onChildCountChange( node, true );
 }
 
@@ -1008,6 +1171,10 @@ bool Node::isFrameBuffer() const {
 	return 0 != ( mNodeFlags & NODE_FLAG_FRAME_BUFFER );
 }
 
+bool Node::isRetainedDraw() const {
+	return 0 != ( mNodeFlags & NODE_FLAG_RETAINED_DRAW );
+}
+
 bool Node::isSceneNode() const {
 	return 0 != ( mNodeFlags & NODE_FLAG_SCENENODE );
 }
@@ -1228,7 +1395,9 @@ void Node::setReverseDraw( bool reverseDraw ) {
 }
 
 void Node::invalidateDraw() {
-	if ( NULL != mNodeDrawInvalidator ) {
+	if ( mNodeFlags & NODE_FLAG_RETAINED_DRAW ) {
+		invalidate( this );
+	} else if ( NULL != mNodeDrawInvalidator ) {
 		mNodeDrawInvalidator->invalidate( this );
 	}
 }
@@ -1366,6 +1535,9 @@ void Node::setRotation( float angle ) {
 
 	setDirty();
 
+	if ( NULL != mParentNode )
+		mParentNode->invalidateContentBounds();
+
 	onAngleChange();
 }
 
@@ -1390,6 +1562,9 @@ void Node::setScale( const Vector2f& scale ) {
 
 	setDirty();
 
+	if ( NULL != mParentNode )
+		mParentNode->invalidateContentBounds();
+
 	onScaleChange();
 }
 
@@ -1470,6 +1645,10 @@ Node* Node::runAction( Action* action ) {
 		action->start();
 
 		getActionManager()->addAction( action );
+
+		// Actions added from other threads must be noticed by a main loop waiting for events
+		if ( !Engine::instance()->isMainThread() )
+			mSceneNode->wakeUp();
 	}
 
 	return this;
@@ -1506,6 +1685,28 @@ void Node::runOnMainThread( Actions::Runnable::RunnableFunc runnable, const Time
 	runAction( action );
 }
 
+Uint64 Node::setTimeout( const TimerWheel::Callback& callback, const Time& delay ) {
+	Uint64 id = mSceneNode->mTimers.add( callback, delay, false, this );
+
+	if ( !Engine::instance()->isMainThread() )
+		mSceneNode->wakeUp();
+
+	return id;
+}
+
+Uint64 Node::setInterval( const TimerWheel::Callback& callback, const Time& interval ) {
+	Uint64 id = mSceneNode->mTimers.add( callback, interval, true, this );
+
+	if ( !Engine::instance()->isMainThread() )
+		mSceneNode->wakeUp();
+
+	return id;
+}
+
+void Node::clearTimer( const Uint64& id ) {
+	mSceneNode->mTimers.remove( id );
+}
+
 Transform Node::getLocalTransform() const {
 	return getTransform();
 }
@@ -1646,11 +1847,19 @@ void Node::center() {
 
 Node* Node::clipEnable() {
 	writeNodeFlag( NODE_FLAG_CLIP_ENABLE, 1 );
+
+	if ( NULL != mParentNode )
+		mParentNode->invalidateContentBounds();
+
 	return this;
 }
 
 Node* Node::clipDisable() {
 	writeNodeFlag( NODE_FLAG_CLIP_ENABLE, 0 );
+
+	if ( NULL != mParentNode )
+		mParentNode->invalidateContentBounds();
+
 	return this;
 }
 
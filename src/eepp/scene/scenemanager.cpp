@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <eepp/graphics/fontmanager.hpp>
 #include <eepp/scene/scenemanager.hpp>
 #include <eepp/scene/scenenode.hpp>
 #include <eepp/ui/uiscenenode.hpp>
@@ -45,6 +46,18 @@ void SceneManager::draw() {
 }
 
 void SceneManager::update( const Time& elapsed ) {
+	// Glyphs rasterized in the font workers are uploaded before anything is laid out
+	bool metricsChanged = false;
+
+	if ( FontManager::existsSingleton() && FontManager::instance()->update( &metricsChanged ) ) {
+		for ( auto& sceneNode : mSceneNodes ) {
+			if ( metricsChanged )
+				sceneNode->invalidateFontMetrics();
+
+			sceneNode->invalidate( nullptr );
+		}
+	}
+
 	for ( auto& sceneNode : mSceneNodes ) {
 		sceneNode->update( elapsed );
 	}
@@ -79,4 +92,17 @@ Time SceneManager::getElapsed() const {
 	return mClock.getElapsedTime();
 }
 
+Time SceneManager::getIdleTime() const {
+	Time idle( Time::Infinity );
+
+	for ( auto& sceneNode : mSceneNodes ) {
+		idle = eemin( idle, sceneNode->getIdleTime() );
+
+		if ( idle == Time::Zero )
+			break;
+	}
+
+	return idle;
+}
+
 }} // namespace EE::Scene
@@ -7,6 +7,7 @@
 #include <eepp/scene/scenenode.hpp>
 #include <eepp/window/cursormanager.hpp>
 #include <eepp/window/engine.hpp>
+#include <eepp/window/input.hpp>
 #include <eepp/window/window.hpp>
 
 namespace EE { namespace Scene {
@@ -33,7 +34,11 @@ SceneNode::SceneNode( EE::Window::Window* window ) :
 	mHighlightInvalidation( false ),
 	mHighlightFocusColor( 234, 195, 123, 255 ),
 	mHighlightOverColor( 195, 123, 234, 255 ),
-	mHighlightInvalidationColor( 220, 0, 0, 255 ) {
+	mHighlightInvalidationColor( 220, 0, 0, 255 ),
+	mCulling( true ),
+	mCullTransformed( false ),
+	mPartialRedraw( true ),
+	mDamageFull( true ) {
 	mNodeFlags |= NODE_FLAG_SCENENODE;
 	mSceneNode = this;
 
@@ -103,9 +108,16 @@ void SceneNode::draw() {
 		if ( !clips.empty() )
 			clippingMask->clipPlaneDisable();
 
+		bool partialRedraw = updateDamageRects();
+
 		matrixSet();
 
-		if ( NULL == mFrameBuffer || !usesInvalidation() || invalidated() ) {
+		if ( partialRedraw ) {
+			drawDamageRects();
+		} else if ( NULL == mFrameBuffer || !usesInvalidation() || invalidated() ) {
+			mCullRect = getWorldBounds();
+			mCullTransformed = false;
+
 			clipStart();
 
 			drawChilds();
@@ -133,6 +145,8 @@ void SceneNode::update( const Time& time ) {
 
 	mActionManager->update( time );
 
+	mTimers.update();
+
 	if ( NULL == mParentNode && NULL != mEventDispatcher )
 		mEventDispatcher->update( time );
 
@@ -171,6 +185,8 @@ void SceneNode::onSizeChange() {
 		}
 	}
 
+	mDamageFull = true;
+
 	Node::onSizeChange();
 }
 
@@ -263,6 +279,8 @@ void SceneNode::createFrameBuffer() {
 	if ( !mFrameBuffer->created() ) {
 		eeSAFE_DELETE( mFrameBuffer );
 	}
+
+	mDamageFull = true;
 }
 
 void SceneNode::drawFrameBuffer() {
@@ -300,7 +318,9 @@ void SceneNode::matrixSet() {
 
 			mFrameBuffer->bind();
 
-			mFrameBuffer->clear();
+			// The partial redraw clears only the damaged regions
+			if ( mDamageRects.empty() )
+				mFrameBuffer->clear();
 		}
 
 		if ( 0.f != mScreenPos ) {
@@ -499,4 +519,211 @@ const Float& SceneNode::getDPI() const {
 	return mDPI;
 }
 
+void SceneNode::setCulling( bool culling ) {
+	if ( culling != mCulling ) {
+		mCulling = culling;
+		invalidateDraw();
+	}
+}
+
+bool SceneNode::isCulling() const {
+	return mCulling;
+}
+
+const Rectf& SceneNode::getCullRect() const {
+	return mCullRect;
+}
+
+void SceneNode::setPartialRedraw( bool partialRedraw ) {
+	if ( partialRedraw != mPartialRedraw ) {
+		mPartialRedraw = partialRedraw;
+		mDamageFull = true;
+		invalidateDraw();
+	}
+}
+
+bool SceneNode::isPartialRedraw() const {
+	return mPartialRedraw;
+}
+
+void SceneNode::invalidate( Node* invalidator ) {
+	if ( mVisible && mAlpha != 0.f ) {
+		// Nodes invalidated from other threads must be noticed by a main loop waiting for events
+		if ( !invalidated() && !Engine::instance()->isMainThread() )
+			wakeUp();
+
+		writeNodeFlag( NODE_FLAG_VIEW_DIRTY, 1 );
+
+		if ( isDamageTracking() ) {
+			if ( NULL == invalidator || invalidator == this ) {
+				mDamageFull = true;
+			} else if ( !mDamageFull ) {
+				mDamagedNodes.insert( invalidator );
+			}
+		}
+	}
+}
+
+void SceneNode::invalidateFontMetrics() {}
+
+Time SceneNode::getIdleTime() {
+	if ( invalidated() || mUpdateAllChilds )
+		return Time::Zero;
+
+	Time idle( eemin( mActionManager->getIdleTime(), mTimers.getTimeUntilNext() ) );
+
+	for ( auto& node : mScheduledUpdate ) {
+		if ( idle == Time::Zero )
+			break;
+
+		if ( mScheduledUpdateRemove.find( node ) == mScheduledUpdateRemove.end() )
+			idle = eemin( idle, node->getIdleTime() );
+	}
+
+	return idle;
+}
+
+void SceneNode::wakeUp() {
+	if ( NULL != mWindow && NULL != mWindow->getInput() )
+		mWindow->getInput()->wakeUp();
+}
+
+bool SceneNode::isDamageTracking() const {
+	return mPartialRedraw && mUseInvalidation && NULL != mFrameBuffer;
+}
+
+bool SceneNode::updateDamageRects() {
+	mDamageRects.clear();
+
+	if ( !isDamageTracking() || !invalidated() ) {
+		mDamagedNodes.clear();
+		return false;
+	}
+
+	Rectf bounds( getWorldBounds() );
+
+	for ( Node* node : mDamagedNodes ) {
+		if ( mDamageFull )
+			break;
+
+		// Windows draw its shadow outside of its bounds
+		if ( node->isWindow() || node->isMeOrParentTreeScaledOrRotated() ) {
+			mDamageFull = true;
+			break;
+		}
+
+		// The node must be redrawn in its current position, and the area covered in the last
+		// frame must be repainted too ( the node could have been moved, resized or hidden ).
+		Rectf rect( node->getDrawnBounds() );
+
+		if ( node->isMeOrParentTreeVisible() ) {
+			Rectf drawBounds( node->getDrawBounds() );
+
+			if ( rect.getWidth() > 0 && rect.getHeight() > 0 ) {
+				rect.Left = eemin( rect.Left, drawBounds.Left );
+				rect.Top = eemin( rect.Top, drawBounds.Top );
+				rect.Right = eemax( rect.Right, drawBounds.Right );
+				rect.Bottom = eemax( rect.Bottom, drawBounds.Bottom );
+			} else {
+				rect = drawBounds;
+			}
+		}
+
+		rect.shrink( bounds );
+
+		if ( rect.getWidth() > 0 && rect.getHeight() > 0 )
+			addDamageRect( rect );
+	}
+
+	mDamagedNodes.clear();
+
+	// The nodes with its own frame buffer disable the clipping while drawing it, so they are
+	// redrawn completely if they are partially damaged.
+	bool merged = !mDamageFull && !mDamageRects.empty();
+
+	while ( merged ) {
+		merged = false;
+
+		for ( Node* node : mFrameBufferNodes ) {
+			if ( !node->isMeOrParentTreeVisible() )
+				continue;
+
+			Rectf rect( node->getDrawnBounds() );
+			rect.shrink( bounds );
+
+			for ( const auto& damageRect : mDamageRects ) {
+				if ( damageRect.overlap( rect ) && !damageRect.contains( rect ) ) {
+					addDamageRect( rect );
+					merged = true;
+					break;
+				}
+			}
+
+			if ( merged )
+				break;
+		}
+	}
+
+	Float area = 0;
+
+	for ( const auto& rect : mDamageRects )
+		area += rect.getWidth() * rect.getHeight();
+
+	// Many regions or a big damaged area are faster to redraw at once
+	if ( mDamageFull || mDamageRects.size() > 16 ||
+		 area > bounds.getWidth() * bounds.getHeight() * 0.5f )
+		mDamageRects.clear();
+
+	mDamageFull = false;
+
+	return !mDamageRects.empty();
+}
+
+void SceneNode::addDamageRect( Rectf rect ) {
+	// Aligned to pixels, the frame buffer region is cleared before redrawing it
+	rect = Rectf( eefloor( rect.Left ), eefloor( rect.Top ), eeceil( rect.Right ),
+				  eeceil( rect.Bottom ) );
+
+	// Merge the overlapping regions, the merged region can overlap others
+	bool merged = true;
+
+	while ( merged ) {
+		merged = false;
+
+		for ( auto it = mDamageRects.begin(); it != mDamageRects.end(); ++it ) {
+			if ( it->overlap( rect ) ) {
+				rect.Left = eemin( rect.Left, it->Left );
+				rect.Top = eemin( rect.Top, it->Top );
+				rect.Right = eemax( rect.Right, it->Right );
+				rect.Bottom = eemax( rect.Bottom, it->Bottom );
+				mDamageRects.erase( it );
+				merged = true;
+				break;
+			}
+		}
+	}
+
+	mDamageRects.push_back( rect );
+}
+
+void SceneNode::drawDamageRects() {
+	ClippingMask* clippingMask = GLi->getClippingMask();
+
+	for ( const auto& rect : mDamageRects ) {
+		mFrameBuffer->clear( Rect( rect.Left - mScreenPosi.x, rect.Top - mScreenPosi.y,
+								   rect.Right - mScreenPosi.x, rect.Bottom - mScreenPosi.y ) );
+
+		clippingMask->clipPlaneEnable( rect.Left, rect.Top, rect.getWidth(), rect.getHeight() );
+
+		mCullRect = rect;
+		mCullTransformed = false;
+
+		drawChilds();
+
+		clippingMask->clipPlaneDisable();
+	}
+
+	mDamageRects.clear();
+}
+
 }} // namespace EE::Scene
@@ -1,12 +1,26 @@
+#include <condition_variable>
+#include <cstring>
 #include <eepp/core/debug.hpp>
 #include <eepp/system/compression.hpp>
 #include <eepp/system/iostreammemory.hpp>
 #include <eepp/system/scopedbuffer.hpp>
+#include <eepp/system/sys.hpp>
+#include <eepp/system/threadpool.hpp>
+#include <mutex>
 
 #include <zlib.h>
 
 #define DEFLATE_CHUNK_SIZE ( 16384 )
 
+// Block index trailer: the block offsets ( 8 bytes each ), the uncompressed size ( 8 bytes ), the
+// block size ( 4 bytes ), the block count ( 4 bytes ) and the magic, all little endian.
+#define BLOCK_INDEX_MAGIC "EEBI"
+#define BLOCK_INDEX_FOOTER_SIZE ( 20 )
+// In gzip mode the index is stored in the extra field of an empty gzip member
+#define GZIP_INDEX_HEADER_SIZE ( 16 )
+#define GZIP_INDEX_TRAILER_SIZE ( 10 )
+#define GZIP_INDEX_MAX_PAYLOAD ( 65531 )
+
 namespace EE { namespace System {
 
 Compression::Status Compression::compress( Uint8* dst, Uint64 dstMaxSize, const Uint8* src,
@@ -72,6 +86,247 @@ Compression::Status Compression::compress( IOStream& dst, IOStream& src, Compres
 	return Status::OK;
 }
 
+namespace {
+
+struct CompressionBlock {
+	std::vector<Uint8> in;
+	std::vector<Uint8> out;
+	uLong checksum;
+	bool last;
+	int status;
+};
+
+void writeLE( std::vector<Uint8>& buffer, Uint64 value, int bytes ) {
+	for ( int i = 0; i < bytes; i++ )
+		buffer.push_back( static_cast<Uint8>( ( value >> ( i * 8 ) ) & 0xFF ) );
+}
+
+Uint64 readLE( const Uint8* data, int bytes ) {
+	Uint64 value = 0;
+	for ( int i = 0; i < bytes; i++ )
+		value |= static_cast<Uint64>( data[i] ) << ( i * 8 );
+	return value;
+}
+
+void compressBlock( CompressionBlock& block, int level, Compression::Mode mode ) {
+	z_stream strm = {};
+
+	block.status = deflateInit2( &strm, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY );
+
+	if ( block.status != Z_OK )
+		return;
+
+	// Every block but the last one ends with a sync flush, so the next block starts byte aligned
+	block.out.resize( deflateBound( &strm, block.in.size() ) + 16 );
+	strm.next_in = block.in.data();
+	strm.avail_in = block.in.size();
+	strm.next_out = block.out.data();
+	strm.avail_out = block.out.size();
+
+	int ret = deflate( &strm, block.last ? Z_FINISH : Z_SYNC_FLUSH );
+
+	block.status = ( ret == Z_STREAM_END || ( ret == Z_OK && !block.last ) ) &&
+						   strm.avail_in == 0
+					   ? Z_OK
+					   : Z_BUF_ERROR;
+	block.out.resize( block.out.size() - strm.avail_out );
+
+	deflateEnd( &strm );
+
+	block.checksum = mode == Compression::MODE_GZIP
+						 ? crc32( crc32( 0L, Z_NULL, 0 ), block.in.data(), block.in.size() )
+						 : adler32( adler32( 0L, Z_NULL, 0 ), block.in.data(), block.in.size() );
+}
+
+} // namespace
+
+Compression::Status Compression::compressBlocks( IOStream& dst, IOStream& src, Mode mode,
+												 const Config& config ) {
+	int level = mode == MODE_DEFLATE ? config.zlib.level : config.gzip.level;
+	Uint64 srcSize = src.getSize();
+	Uint64 blockSize = eemax<Uint64>( config.blocks.blockSize, 1 );
+
+	// The gzip extra field is limited to 64 KiB, grow the blocks until the index fits
+	if ( config.blocks.writeIndex && mode == MODE_GZIP ) {
+		Uint64 maxBlocks = ( GZIP_INDEX_MAX_PAYLOAD - BLOCK_INDEX_FOOTER_SIZE ) / 8;
+		blockSize = eemax<Uint64>( blockSize, ( srcSize + maxBlocks - 1 ) / maxBlocks );
+	}
+
+	std::shared_ptr<ThreadPool> pool = config.blocks.threadPool;
+
+	if ( !pool ) {
+		Uint32 threads = config.blocks.threads > 0 ? config.blocks.threads
+												   : eemax( Sys::getCPUCount(), 1 );
+		pool = ThreadPool::createShared( threads );
+	}
+
+	std::vector<Uint8> header;
+
+	if ( mode == MODE_GZIP ) {
+		header = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff };
+	} else {
+		// zlib header: deflate with 32K window, the level is only informative
+		int levelFlag = level == 0 || level == 1
+							? 0
+							: ( level >= 2 && level <= 5 ? 1 : ( level <= 6 ? 2 : 3 ) );
+		int cmf = 0x78;
+		int flg = levelFlag << 6;
+		flg += 31 - ( ( cmf * 256 + flg ) % 31 );
+		header = { static_cast<Uint8>( cmf ), static_cast<Uint8>( flg ) };
+	}
+
+	if ( dst.write( (const char*)header.data(), header.size() ) !=
+		 static_cast<ios_size>( header.size() ) )
+		return Status::ERRNO;
+
+	BlockIndex index;
+	index.blockSize = static_cast<Uint32>( blockSize );
+	index.uncompressedSize = srcSize;
+
+	Uint64 offset = header.size();
+	uLong checksum = mode == MODE_GZIP ? crc32( 0L, Z_NULL, 0 ) : adler32( 0L, Z_NULL, 0 );
+	Uint64 blockCount = eemax<Uint64>( ( srcSize + blockSize - 1 ) / blockSize, 1 );
+	// Blocks in flight, enough to keep every thread busy while the previous batch is written
+	Uint64 batchSize = eemax<Uint64>( pool->numThreads() * 2, 1 );
+	std::mutex mutex;
+	std::condition_variable cond;
+
+	src.seek( 0 );
+
+	for ( Uint64 first = 0; first < blockCount; first += batchSize ) {
+		std::vector<CompressionBlock> blocks( eemin( batchSize, blockCount - first ) );
+		size_t pending = blocks.size();
+
+		for ( size_t i = 0; i < blocks.size(); i++ ) {
+			CompressionBlock& block = blocks[i];
+			Uint64 blockIndex = first + i;
+			block.in.resize( eemin( blockSize, srcSize - blockIndex * blockSize ) );
+			block.last = blockIndex == blockCount - 1;
+
+			if ( !block.in.empty() &&
+				 src.read( (char*)block.in.data(), block.in.size() ) !=
+					 static_cast<ios_size>( block.in.size() ) ) {
+				// Wait for the blocks already queued, they reference the batch
+				std::unique_lock<std::mutex> lock( mutex );
+				pending -= blocks.size() - i;
+				cond.wait( lock, [&pending] { return pending == 0; } );
+				return Status::ERRNO;
+			}
+
+			pool->run( [&block, &mutex, &cond, &pending, level, mode] {
+				compressBlock( block, level, mode );
+				std::lock_guard<std::mutex> lock( mutex );
+				if ( --pending == 0 )
+					cond.notify_all();
+			} );
+		}
+
+		{
+			std::unique_lock<std::mutex> lock( mutex );
+			cond.wait( lock, [&pending] { return pending == 0; } );
+		}
+
+		for ( auto& block : blocks ) {
+			if ( block.status != Z_OK )
+				return (Status)block.status;
+
+			if ( dst.write( (const char*)block.out.data(), block.out.size() ) !=
+				 static_cast<ios_size>( block.out.size() ) )
+				return Status::ERRNO;
+
+			index.offsets.push_back( offset );
+			offset += block.out.size();
+			checksum = mode == MODE_GZIP
+						   ? crc32_combine( checksum, block.checksum, block.in.size() )
+						   : adler32_combine( checksum, block.checksum, block.in.size() );
+		}
+	}
+
+	std::vector<Uint8> trailer;
+
+	if ( mode == MODE_GZIP ) {
+		writeLE( trailer, checksum, 4 );
+		writeLE( trailer, srcSize & 0xFFFFFFFF, 4 );
+	} else {
+		for ( int i = 3; i >= 0; i-- )
+			trailer.push_back( static_cast<Uint8>( ( checksum >> ( i * 8 ) ) & 0xFF ) );
+	}
+
+	if ( config.blocks.writeIndex ) {
+		std::vector<Uint8> payload;
+
+		for ( const auto& blockOffset : index.offsets )
+			writeLE( payload, blockOffset, 8 );
+
+		writeLE( payload, index.uncompressedSize, 8 );
+		writeLE( payload, index.blockSize, 4 );
+		writeLE( payload, index.offsets.size(), 4 );
+		payload.insert( payload.end(), BLOCK_INDEX_MAGIC, BLOCK_INDEX_MAGIC + 4 );
+
+		if ( mode == MODE_GZIP ) {
+			// Empty gzip member: FEXTRA flag, extra field with the "EI" subfield holding the
+			// index, an empty final deflate block, and a zero CRC and size.
+			std::vector<Uint8> member = { 0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff };
+			writeLE( member, payload.size() + 4, 2 );
+			member.push_back( 'E' );
+			member.push_back( 'I' );
+			writeLE( member, payload.size(), 2 );
+			member.insert( member.end(), payload.begin(), payload.end() );
+			member.insert( member.end(), { 3, 0, 0, 0, 0, 0, 0, 0, 0, 0 } );
+			payload = std::move( member );
+		}
+
+		trailer.insert( trailer.end(), payload.begin(), payload.end() );
+	}
+
+	if ( dst.write( (const char*)trailer.data(), trailer.size() ) !=
+		 static_cast<ios_size>( trailer.size() ) )
+		return Status::ERRNO;
+
+	return Status::OK;
+}
+
+bool Compression::readBlockIndex( IOStream& src, Mode mode, BlockIndex& index ) {
+	ios_size size = src.getSize();
+	ios_size tail = mode == MODE_GZIP ? GZIP_INDEX_TRAILER_SIZE : 0;
+
+	if ( size < BLOCK_INDEX_FOOTER_SIZE + tail )
+		return false;
+
+	Uint8 footer[BLOCK_INDEX_FOOTER_SIZE + GZIP_INDEX_TRAILER_SIZE];
+	src.seek( size - BLOCK_INDEX_FOOTER_SIZE - tail );
+
+	if ( src.read( (char*)footer, BLOCK_INDEX_FOOTER_SIZE + tail ) !=
+		 BLOCK_INDEX_FOOTER_SIZE + tail )
+		return false;
+
+	if ( memcmp( &footer[16], BLOCK_INDEX_MAGIC, 4 ) != 0 )
+		return false;
+
+	Uint64 count = readLE( &footer[12], 4 );
+	ios_size payloadSize = count * 8 + BLOCK_INDEX_FOOTER_SIZE;
+
+	if ( count == 0 || size < payloadSize + tail )
+		return false;
+
+	index.uncompressedSize = readLE( &footer[0], 8 );
+	index.blockSize = readLE( &footer[8], 4 );
+	index.offsets.resize( count );
+
+	std::vector<Uint8> offsets( count * 8 );
+	src.seek( size - payloadSize - tail );
+
+	if ( src.read( (char*)offsets.data(), offsets.size() ) !=
+		 static_cast<ios_size>( offsets.size() ) )
+		return false;
+
+	for ( Uint64 i = 0; i < count; i++ )
+		index.offsets[i] = readLE( &offsets[i * 8], 8 );
+
+	return index.blockSize > 0 &&
+		   ( index.uncompressedSize + index.blockSize - 1 ) / index.blockSize <= count;
+}
+
 int Compression::getMaxCompressedBufferSize( Uint64 srcSize, Mode mode, const Config& ) {
 	switch ( mode ) {
 		case MODE_DEFLATE:
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <eepp/system/iostreaminflate.hpp>
 
 #include <zlib.h>
@@ -7,20 +8,39 @@ namespace EE { namespace System {
 struct LocalStreamData {
 	z_stream strm;
 	int state;
+	// Raw inflate stream used to decompress the blocks in seekable mode
+	z_stream blockStrm;
+	int blockState;
 };
 
-IOStreamInflate* IOStreamInflate::New( IOStream& inOutStream, Compression::Mode mode ) {
-	return eeNew( IOStreamInflate, ( inOutStream, mode ) );
+IOStreamInflate* IOStreamInflate::New( IOStream& inOutStream, Compression::Mode mode,
+									   bool seekable ) {
+	return eeNew( IOStreamInflate, ( inOutStream, mode, seekable ) );
 }
 
-IOStreamInflate::IOStreamInflate( IOStream& inOutStream, Compression::Mode mode ) :
+IOStreamInflate::IOStreamInflate( IOStream& inOutStream, Compression::Mode mode, bool seekable ) :
 	mStream( inOutStream ),
 	mMode( mode ),
 	mBuffer( Compression::getModeDefaultChunkSize( mode ) ),
-	mLocalStream( eeNew( LocalStreamData, () ) ) {
+	mLocalStream( eeNew( LocalStreamData, () ) ),
+	mSeekable( false ),
+	mPosition( 0 ),
+	mCachedBlock( -1 ) {
 	int windowBits = mode == Compression::MODE_DEFLATE ? MAX_WBITS : MAX_WBITS | 16;
 
 	mLocalStream->strm = z_stream{};
+	mLocalStream->blockStrm = z_stream{};
+	mLocalStream->blockState = Z_STREAM_ERROR;
+
+	if ( seekable && mStream.isOpen() ) {
+		mSeekable = Compression::readBlockIndex( mStream, mode, mBlockIndex );
+
+		if ( mSeekable ) {
+			mLocalStream->blockState = inflateInit2( &mLocalStream->blockStrm, -MAX_WBITS );
+		} else {
+			mStream.seek( 0 );
+		}
+	}
 
 	mLocalStream->state = inflateInit2( &mLocalStream->strm, windowBits );
 }
@@ -28,10 +48,85 @@ IOStreamInflate::IOStreamInflate( IOStream& inOutStream, Compression::Mode mode
 IOStreamInflate::~IOStreamInflate() {
 	inflateEnd( &mLocalStream->strm );
 
+	if ( mLocalStream->blockState == Z_OK )
+		inflateEnd( &mLocalStream->blockStrm );
+
 	eeSAFE_DELETE( mLocalStream );
 }
 
+bool IOStreamInflate::loadBlock( const Uint64& block ) {
+	if ( mLocalStream->blockState != Z_OK || block >= mBlockIndex.offsets.size() )
+		return false;
+
+	z_stream& zstr = mLocalStream->blockStrm;
+	Uint64 blockStart = block * mBlockIndex.blockSize;
+	Uint64 expected = eemin<Uint64>( mBlockIndex.blockSize,
+									 mBlockIndex.uncompressedSize - blockStart );
+	// The last block ends with the final deflate block, the rest end where the next one starts
+	Uint64 compressedLeft = block + 1 < mBlockIndex.offsets.size()
+								? mBlockIndex.offsets[block + 1] - mBlockIndex.offsets[block]
+								: mStream.getSize() - mBlockIndex.offsets[block];
+
+	mCachedBlock = -1;
+	mBlockBuffer.resize( expected );
+	inflateReset( &zstr );
+	zstr.next_out = mBlockBuffer.data();
+	zstr.avail_out = mBlockBuffer.size();
+	zstr.avail_in = 0;
+	mStream.seek( mBlockIndex.offsets[block] );
+
+	while ( zstr.avail_out > 0 ) {
+		if ( zstr.avail_in == 0 ) {
+			ios_size n = mStream.read( (char*)mBuffer.get(),
+									   eemin<Uint64>( mBuffer.length(), compressedLeft ) );
+
+			if ( n == 0 )
+				break;
+
+			compressedLeft -= n;
+			zstr.next_in = mBuffer.get();
+			zstr.avail_in = n;
+		}
+
+		int rc = inflate( &zstr, Z_NO_FLUSH );
+
+		if ( rc == Z_STREAM_END )
+			break;
+
+		if ( rc != Z_OK && rc != Z_BUF_ERROR )
+			return false;
+	}
+
+	if ( zstr.avail_out != 0 )
+		return false;
+
+	mCachedBlock = block;
+	return true;
+}
+
+ios_size IOStreamInflate::readBlocks( char* data, ios_size size ) {
+	ios_size total = 0;
+
+	while ( total < size && static_cast<Uint64>( mPosition ) < mBlockIndex.uncompressedSize ) {
+		Uint64 block = mPosition / mBlockIndex.blockSize;
+
+		if ( static_cast<Int64>( block ) != mCachedBlock && !loadBlock( block ) )
+			break;
+
+		Uint64 offset = mPosition - block * mBlockIndex.blockSize;
+		ios_size n = eemin<Uint64>( size - total, mBlockBuffer.size() - offset );
+		memcpy( data + total, &mBlockBuffer[offset], n );
+		total += n;
+		mPosition += n;
+	}
+
+	return total;
+}
+
 ios_size IOStreamInflate::read( char* buffer, ios_size length ) {
+	if ( mSeekable )
+		return readBlocks( buffer, length );
+
 	if ( mLocalStream->state != Z_OK || !mStream.isOpen() )
 		return 0;
 
@@ -143,21 +238,33 @@ ios_size IOStreamInflate::write( const char* buffer, ios_size length ) {
 }
 
 ios_size IOStreamInflate::seek( ios_size position ) {
+	if ( mSeekable ) {
+		mPosition = eemin<ios_size>( position, mBlockIndex.uncompressedSize );
+		return mPosition;
+	}
+
 	return mStream.seek( position );
 }
 
 ios_size IOStreamInflate::tell() {
-	return mStream.tell();
+	return mSeekable ? mPosition : mStream.tell();
 }
 
 ios_size IOStreamInflate::getSize() {
-	return mStream.getSize();
+	return mSeekable ? mBlockIndex.uncompressedSize : mStream.getSize();
 }
 
 bool IOStreamInflate::isOpen() {
+	if ( mSeekable )
+		return mStream.isOpen();
+
 	return mStream.isOpen() && mLocalStream->state != Z_STREAM_END;
 }
 
+bool IOStreamInflate::isSeekable() const {
+	return mSeekable;
+}
+
 const Compression::Mode& IOStreamInflate::getMode() const {
 	return mMode;
 }
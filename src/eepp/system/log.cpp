@@ -1,6 +1,9 @@
+#include <algorithm>
+#include <chrono>
 #include <cstdarg>
 #include <eepp/system/log.hpp>
 #include <iostream>
+#include <thread>
 
 #if EE_PLATFORM == EE_PLATFORM_ANDROID
 #include <android/log.h>
@@ -20,6 +23,77 @@ namespace EE { namespace System {
 
 SINGLETON_DECLARE_IMPLEMENTATION( Log )
 
+// Number of records each thread can queue before waiting for the log thread
+static constexpr size_t QUEUE_CAPACITY = 1024;
+
+// Maximum time the log thread waits before processing the queued records
+static constexpr int PROCESS_INTERVAL_MS = 50;
+
+// Default size of the log history kept in memory
+static constexpr size_t DEFAULT_HISTORY_LIMIT = 4 * 1024 * 1024;
+
+static std::atomic<Uint64> sLogIdCounter{ 0 };
+
+/** Single producer single consumer ring of records. The producer is the thread that owns the
+ * queue and the consumer the log thread. */
+class Log::RecordQueue {
+  public:
+	explicit RecordQueue( const Uint64& logId ) : mRecords( QUEUE_CAPACITY ), mLogId( logId ) {}
+
+	bool push( Record& record ) {
+		size_t tail = mTail.load( std::memory_order_relaxed );
+		size_t next = ( tail + 1 ) % QUEUE_CAPACITY;
+
+		if ( next == mHead.load( std::memory_order_acquire ) )
+			return false;
+
+		mRecords[tail] = std::move( record );
+		mTail.store( next, std::memory_order_release );
+		return true;
+	}
+
+	void popAll( std::vector<Record>& records ) {
+		size_t head = mHead.load( std::memory_order_relaxed );
+		size_t tail = mTail.load( std::memory_order_acquire );
+
+		while ( head != tail ) {
+			records.emplace_back( std::move( mRecords[head] ) );
+			head = ( head + 1 ) % QUEUE_CAPACITY;
+		}
+
+		mHead.store( head, std::memory_order_release );
+	}
+
+	size_t size() const {
+		size_t head = mHead.load( std::memory_order_acquire );
+		size_t tail = mTail.load( std::memory_order_acquire );
+		return ( tail + QUEUE_CAPACITY - head ) % QUEUE_CAPACITY;
+	}
+
+	bool empty() const { return 0 == size(); }
+
+	const Uint64& getLogId() const { return mLogId; }
+
+	/** Set when the owner thread exits, the queue is removed once drained. */
+	std::atomic<bool> orphaned{ false };
+
+  protected:
+	std::vector<Record> mRecords;
+	std::atomic<size_t> mHead{ 0 };
+	std::atomic<size_t> mTail{ 0 };
+	Uint64 mLogId;
+};
+
+/** Queue of the calling thread, flagged as orphaned when the thread exits. */
+struct Log::ThreadQueue {
+	std::shared_ptr<RecordQueue> queue;
+
+	~ThreadQueue() {
+		if ( queue )
+			queue->orphaned = true;
+	}
+};
+
 std::unordered_map<std::string, LogLevel> Log::getMapFlag() {
 	return { { "debug", LogLevel::Debug },	 { "info", LogLevel::Info },
 			 { "notice", LogLevel::Notice }, { "warning", LogLevel::Warning },
@@ -42,17 +116,33 @@ Log* Log::create( const LogLevel& level, bool consoleOutput, bool liveWrite ) {
 	return ms_singleton;
 }
 
-Log::Log() : mSave( false ), mConsoleOutput( false ), mLiveWrite( false ), mFS( NULL ) {
+#if EE_PLATFORM != EE_PLATFORM_EMSCRIPTEN || defined( __EMSCRIPTEN_PTHREADS__ )
+#define EE_LOG_DEFAULT_ASYNC true
+#else
+#define EE_LOG_DEFAULT_ASYNC false
+#endif
+
+Log::Log() :
+	mHistoryLimit( DEFAULT_HISTORY_LIMIT ),
+	mSave( false ),
+	mConsoleOutput( false ),
+	mLiveWrite( false ),
+	mFS( NULL ),
+	mId( ++sLogIdCounter ),
+	mAsync( EE_LOG_DEFAULT_ASYNC ) {
 	writel( LogLevel::Info, "eepp initialized" );
 }
 
 Log::Log( const std::string& logPath, const LogLevel& level, bool consoleOutput, bool liveWrite ) :
+	mHistoryLimit( DEFAULT_HISTORY_LIMIT ),
 	mFilePath( logPath ),
 	mSave( false ),
 	mConsoleOutput( consoleOutput ),
 	mLiveWrite( liveWrite ),
 	mLogLevelThreshold( level ),
-	mFS( NULL ) {
+	mFS( NULL ),
+	mId( ++sLogIdCounter ),
+	mAsync( EE_LOG_DEFAULT_ASYNC ) {
 	writel( LogLevel::Info, "eepp initialized" );
 }
 
@@ -63,23 +153,30 @@ const std::string& Log::getFilePath() const {
 void Log::setFilePath( const std::string& filePath ) {
 	if ( filePath != mFilePath ) {
 		closeFS();
+		lock();
 		mFilePath = filePath;
+		unlock();
 	}
 }
 
 Log::~Log() {
+	mAsync = false;
+
+	stopThread();
+
 	writel( LogLevel::Info, "eepp stoped\n" );
 
 	if ( mSave && !mLiveWrite ) {
 		openFS();
 
-		mFS->write( mData.c_str(), mData.size() );
+		for ( const auto& text : mHistory )
+			mFS->write( text.c_str(), text.size() );
 	}
 
 	closeFS();
 }
 
-const LogLevel& Log::getLogLevelThreshold() const {
+LogLevel Log::getLogLevelThreshold() const {
 	return mLogLevelThreshold;
 }
 
@@ -88,6 +185,8 @@ void Log::setLogLevelThreshold( const LogLevel& logLevelThreshold ) {
 }
 
 void Log::save( const std::string& filepath ) {
+	lock();
+
 	if ( !filepath.empty() ) {
 		mFilePath = filepath;
 	} else {
@@ -95,36 +194,8 @@ void Log::save( const std::string& filepath ) {
 	}
 
 	mSave = true;
-}
 
-void Log::write( const std::string& text ) {
-	lock();
-	mData += text;
 	unlock();
-
-	writeToReaders( text );
-
-	if ( mConsoleOutput ) {
-#if EE_PLATFORM == EE_PLATFORM_ANDROID
-		__android_log_print( ANDROID_LOG_INFO, "eepp", "%s", text.c_str() );
-#elif defined( EE_COMPILER_MSVC )
-#ifdef UNICODE
-		OutputDebugString( String::fromUtf8( text ).toWideString().c_str() );
-#else
-		OutputDebugString( text.c_str() );
-#endif
-#else
-		std::cout << text;
-#endif
-	}
-
-	if ( mLiveWrite ) {
-		openFS();
-
-		mFS->write( text.c_str(), text.size() );
-
-		mFS->flush();
-	}
 }
 
 static std::string logLevelToString( const LogLevel& level ) {
@@ -147,217 +218,419 @@ static std::string logLevelToString( const LogLevel& level ) {
 	}
 }
 
-static std::string logLevelWithTimestamp( const LogLevel& level, const std::string& text,
-										  bool appendNewLine ) {
-	return String::format( appendNewLine ? "%s - %s: %s\n" : "%s - %s: %s",
-						   Sys::getDateTimeStr().c_str(), logLevelToString( level ).c_str(),
-						   text.c_str() );
+static std::string timeToString( const std::time_t& time ) {
+	char buf[64];
+	// Only called from the log thread or with the log locked
+	struct tm* timeinfo = localtime( &time );
+	strftime( buf, sizeof( buf ), "%Y-%m-%d %X", timeinfo );
+	return std::string( buf );
+}
+
+static std::string formatArgs( const char* format, va_list args ) {
+	int n, size = 256;
+	std::string tstr( size, '\0' );
+
+	while ( 1 ) {
+		va_list argsCopy;
+		va_copy( argsCopy, args );
+		n = vsnprintf( &tstr[0], size, format, argsCopy );
+		va_end( argsCopy );
+
+		if ( n > -1 && n < size ) {
+			tstr.resize( n );
+			return tstr;
+		}
+
+		if ( n > -1 )	  // glibc 2.1
+			size = n + 1; // precisely what is needed
+		else			  // glibc 2.0
+			size *= 2;	  // twice the old size
+
+		tstr.resize( size, '\0' );
+	}
+}
+
+void Log::write( const std::string& text ) {
+	Record record;
+	record.text = text;
+	push( std::move( record ) );
 }
 
 void Log::write( const LogLevel& level, const std::string& text ) {
-	if ( level >= mLogLevelThreshold )
-		write( logLevelWithTimestamp( level, text, false ) );
+	if ( !isLoggable( level ) )
+		return;
+
+	Record record;
+	record.time = std::time( nullptr );
+	record.level = level;
+	record.timestamp = true;
+	record.text = text;
+	push( std::move( record ) );
 }
 
 void Log::writel( const std::string& text ) {
-	lock();
-	mData += text;
-	mData += "\n";
-	unlock();
+	Record record;
+	record.text.reserve( text.size() + 1 );
+	record.text += text;
+	record.text += '\n';
+	push( std::move( record ) );
+}
 
-	writeToReaders( text );
-	writeToReaders( "\n" );
+void Log::writel( const LogLevel& level, const std::string& text ) {
+	if ( !isLoggable( level ) )
+		return;
 
-	if ( mConsoleOutput ) {
-#if EE_PLATFORM == EE_PLATFORM_ANDROID
-		__android_log_print( ANDROID_LOG_INFO, "eepp", "%s\n", text.c_str() );
-#elif defined( EE_COMPILER_MSVC )
-#ifdef UNICODE
-		OutputDebugString( String::fromUtf8( text + "\n" ).toWideString().c_str() );
-#else
-		OutputDebugString( ( text + "\n" ).c_str() );
-#endif
-#else
-		std::cout << text << std::endl;
-#endif
+	Record record;
+	record.time = std::time( nullptr );
+	record.level = level;
+	record.timestamp = true;
+	record.text.reserve( text.size() + 1 );
+	record.text += text;
+	record.text += '\n';
+	push( std::move( record ) );
+}
+
+void Log::writef( const char* format, ... ) {
+	va_list args;
+	va_start( args, format );
+
+	Record record;
+	record.text = formatArgs( format, args );
+	record.text += '\n';
+
+	va_end( args );
+
+	push( std::move( record ) );
+}
+
+void Log::writef( const LogLevel& level, const char* format, ... ) {
+	if ( !isLoggable( level ) )
+		return;
+
+	va_list args;
+	va_start( args, format );
+
+	Record record;
+	record.time = std::time( nullptr );
+	record.level = level;
+	record.timestamp = true;
+	record.text = formatArgs( format, args );
+	record.text += '\n';
+
+	va_end( args );
+
+	push( std::move( record ) );
+}
+
+void Log::push( Record&& record ) {
+	record.sequence = mSequence++;
+
+	if ( !mAsync || Thread::getCurrentThreadId() == mThreadId ) {
+		std::vector<Record> records;
+		records.emplace_back( std::move( record ) );
+		process( records );
+		return;
 	}
 
-	if ( mLiveWrite ) {
-		openFS();
+	bool critical = record.timestamp && record.level >= LogLevel::Critical;
+	RecordQueue* queue = getThreadQueue();
 
-		mFS->write( text.c_str(), text.size() );
-		mFS->write( "\n", 1 );
+	while ( !queue->push( record ) ) {
+		wakeUp();
+		std::this_thread::yield();
+	}
 
-		mFS->flush();
+	if ( critical ) {
+		flush();
+	} else if ( queue->size() >= QUEUE_CAPACITY / 2 ) {
+		wakeUp();
 	}
 }
 
-void Log::writel( const LogLevel& level, const std::string& text ) {
-	if ( level >= mLogLevelThreshold )
-		write( logLevelWithTimestamp( level, text, true ) );
+Log::RecordQueue* Log::getThreadQueue() {
+	static thread_local ThreadQueue sThreadQueue;
+
+	if ( !sThreadQueue.queue || sThreadQueue.queue->getLogId() != mId ) {
+		if ( sThreadQueue.queue )
+			sThreadQueue.queue->orphaned = true;
+
+		sThreadQueue.queue = std::make_shared<RecordQueue>( mId );
+
+		std::unique_lock<std::mutex> lock( mQueuesMutex );
+		mQueues.push_back( sThreadQueue.queue );
+	}
+
+	startThread();
+
+	return sThreadQueue.queue.get();
 }
 
-void Log::openFS() {
-	if ( mFilePath.empty() )
-		mFilePath = Sys::getProcessPath() + "log.log";
+void Log::wakeUp() {
+	{
+		std::unique_lock<std::mutex> lock( mThreadMutex );
+		mWakeUp = true;
+	}
 
-	if ( NULL == mFS )
-		mFS = IOStreamFile::New( mFilePath, "a" );
+	mThreadCond.notify_one();
 }
 
-void Log::closeFS() {
-	lock();
+void Log::startThread() {
+	// Called on every push, the writers must not contend for the thread mutex once it's running
+	if ( mThreadStarted.load( std::memory_order_acquire ) )
+		return;
 
-	eeSAFE_DELETE( mFS );
+	std::unique_lock<std::mutex> lock( mThreadMutex );
 
-	unlock();
+	if ( mThread )
+		return;
+
+	mRunning = true;
+	mThread = std::make_unique<Thread>( &Log::run, this );
+	mThread->launch();
+	mThreadStarted.store( true, std::memory_order_release );
 }
 
-void Log::writef( const char* format, ... ) {
-	int n, size = 256;
-	std::string tstr( size, '\0' );
+void Log::stopThread() {
+	{
+		std::unique_lock<std::mutex> lock( mThreadMutex );
 
-	va_list args;
+		if ( !mThread )
+			return;
 
-	while ( 1 ) {
-		va_start( args, format );
+		mRunning = false;
+	}
 
-		n = vsnprintf( &tstr[0], size, format, args );
+	mThreadCond.notify_one();
+	mThread->wait();
 
-		if ( n > -1 && n < size ) {
-			tstr.resize( n );
-			tstr += '\n';
+	{
+		std::unique_lock<std::mutex> lock( mThreadMutex );
+		mThread.reset();
+		mThreadId = 0;
+		mThreadStarted.store( false, std::memory_order_release );
+	}
 
-			lock();
-			mData += tstr;
-			unlock();
+	// Everything pushed after the last drain of the thread
+	std::vector<Record> records;
+	drain( records );
+	process( records );
+}
 
-			writeToReaders( tstr );
+void Log::flush() {
+	std::unique_lock<std::mutex> lock( mThreadMutex );
 
-			if ( mConsoleOutput ) {
-#if EE_PLATFORM == EE_PLATFORM_ANDROID
-				__android_log_print( ANDROID_LOG_INFO, "eepp", "%s", tstr.c_str() );
-#elif defined( EE_COMPILER_MSVC )
-#ifdef UNICODE
-				OutputDebugString( String::fromUtf8( tstr ).toWideString().c_str() );
-#else
-				OutputDebugString( tstr.c_str() );
-#endif
-#else
-				std::cout << tstr;
-#endif
-			}
+	if ( !mThread || !mRunning || Thread::getCurrentThreadId() == mThreadId )
+		return;
+
+	Uint64 request = ++mFlushRequest;
+	mWakeUp = true;
+	mThreadCond.notify_one();
+	mFlushCond.wait( lock, [this, request] { return mFlushed >= request || !mRunning; } );
+}
+
+void Log::run() {
+	mThreadId = Thread::getCurrentThreadId();
 
-			if ( mLiveWrite ) {
-				openFS();
+	std::vector<Record> records;
+	bool running = true;
 
-				mFS->write( tstr.c_str(), tstr.size() );
+	while ( running ) {
+		Uint64 request;
 
-				mFS->flush();
-			}
+		{
+			std::unique_lock<std::mutex> lock( mThreadMutex );
+			mThreadCond.wait_for( lock, std::chrono::milliseconds( PROCESS_INTERVAL_MS ),
+								  [this] { return mWakeUp || !mRunning; } );
+			mWakeUp = false;
+			request = mFlushRequest;
+			running = mRunning;
+		}
 
-			va_end( args );
+		drain( records );
+		process( records );
+		records.clear();
 
-			return;
+		{
+			std::unique_lock<std::mutex> lock( mThreadMutex );
+			mFlushed = request;
 		}
 
-		if ( n > -1 )	  // glibc 2.1
-			size = n + 1; // precisely what is needed
-		else			  // glibc 2.0
-			size *= 2;	  // twice the old size
+		mFlushCond.notify_all();
+	}
+}
 
-		tstr.resize( size, '\0' );
+void Log::drain( std::vector<Record>& records ) {
+	std::unique_lock<std::mutex> lock( mQueuesMutex );
+
+	for ( auto it = mQueues.begin(); it != mQueues.end(); ) {
+		// Checked before draining, a record pushed right before the owner exits is not lost
+		bool orphaned = ( *it )->orphaned;
+
+		( *it )->popAll( records );
+
+		if ( orphaned ) {
+			it = mQueues.erase( it );
+		} else {
+			++it;
+		}
 	}
+
+	lock.unlock();
+
+	// Restore the order of the messages written from different threads
+	if ( records.size() > 1 )
+		std::sort( records.begin(), records.end(), []( const Record& a, const Record& b ) {
+			return a.sequence < b.sequence;
+		} );
 }
 
-void Log::writef( const LogLevel& level, const char* format, ... ) {
-	if ( mLogLevelThreshold > level )
+void Log::process( std::vector<Record>& records ) {
+	if ( records.empty() )
 		return;
 
-	int n, size = 256;
-	std::string tstr( size, '\0' );
-	bool first = true;
-	va_list args;
+	lock();
 
-	while ( 1 ) {
-		va_start( args, format );
+	bool consoleOutput = mConsoleOutput;
+	bool liveWrite = mLiveWrite;
 
-		n = vsnprintf( &tstr[0], size, format, args );
+	if ( liveWrite )
+		openFS();
 
-		if ( n > -1 && n < size ) {
-			tstr.resize( n );
-			tstr += '\n';
+	for ( auto& record : records ) {
+		if ( record.timestamp )
+			record.text = String::format( "%s - %s: %s", timeToString( record.time ).c_str(),
+										  logLevelToString( record.level ).c_str(),
+										  record.text.c_str() );
+
+		writeToReaders( record.text );
 
-			if ( first ) {
-				tstr = logLevelWithTimestamp( level, tstr, false );
-				first = false;
-			}
+		if ( consoleOutput )
+			writeToConsole( record.text );
 
-			lock();
-			mData += tstr;
-			unlock();
+		if ( liveWrite )
+			mFS->write( record.text.c_str(), record.text.size() );
 
-			writeToReaders( tstr );
+		mHistorySize += record.text.size();
+		mHistory.emplace_back( std::move( record.text ) );
+	}
+
+	while ( mHistorySize > mHistoryLimit && mHistory.size() > 1 ) {
+		mHistorySize -= mHistory.front().size();
+		mHistory.pop_front();
+	}
 
-			if ( mConsoleOutput ) {
+#if EE_PLATFORM != EE_PLATFORM_ANDROID && !defined( EE_COMPILER_MSVC )
+	if ( consoleOutput )
+		std::cout.flush();
+#endif
+
+	if ( liveWrite )
+		mFS->flush();
+
+	unlock();
+}
+
+void Log::writeToConsole( const std::string& text ) {
 #if EE_PLATFORM == EE_PLATFORM_ANDROID
-				__android_log_print( ANDROID_LOG_INFO, "eepp", "%s", tstr.c_str() );
+	__android_log_print( ANDROID_LOG_INFO, "eepp", "%s", text.c_str() );
 #elif defined( EE_COMPILER_MSVC )
 #ifdef UNICODE
-				OutputDebugString( String::fromUtf8( tstr ).toWideString().c_str() );
+	OutputDebugString( String::fromUtf8( text ).toWideString().c_str() );
 #else
-				OutputDebugString( tstr.c_str() );
+	OutputDebugString( text.c_str() );
 #endif
 #else
-				std::cout << tstr;
+	std::cout << text;
 #endif
-			}
+}
 
-			if ( mLiveWrite ) {
-				openFS();
+void Log::openFS() {
+	lock();
 
-				mFS->write( tstr.c_str(), tstr.size() );
+	if ( mFilePath.empty() )
+		mFilePath = Sys::getProcessPath() + "log.log";
 
-				mFS->flush();
-			}
+	if ( NULL == mFS )
+		mFS = IOStreamFile::New( mFilePath, "a" );
 
-			va_end( args );
+	unlock();
+}
 
-			return;
-		}
+void Log::closeFS() {
+	lock();
 
-		if ( n > -1 )	  // glibc 2.1
-			size = n + 1; // precisely what is needed
-		else			  // glibc 2.0
-			size *= 2;	  // twice the old size
+	eeSAFE_DELETE( mFS );
 
-		tstr.resize( size, '\0' );
-	}
+	unlock();
 }
 
 std::string Log::getBuffer() const {
-	return mData;
+	Log* log = const_cast<Log*>( this );
+	log->lock();
+
+	std::string buffer;
+	buffer.reserve( mHistorySize );
+
+	for ( const auto& text : mHistory )
+		buffer += text;
+
+	log->unlock();
+
+	return buffer;
+}
+
+size_t Log::getHistoryLimit() const {
+	return mHistoryLimit;
 }
 
-const bool& Log::isConsoleOutput() const {
+void Log::setHistoryLimit( const size_t& limit ) {
+	lock();
+
+	mHistoryLimit = limit;
+
+	while ( mHistorySize > mHistoryLimit && !mHistory.empty() ) {
+		mHistorySize -= mHistory.front().size();
+		mHistory.pop_front();
+	}
+
+	unlock();
+}
+
+bool Log::isAsync() const {
+	return mAsync;
+}
+
+void Log::setAsync( const bool& async ) {
+	if ( async == mAsync )
+		return;
+
+	mAsync = async;
+
+	if ( !async )
+		stopThread();
+}
+
+bool Log::isConsoleOutput() const {
 	return mConsoleOutput;
 }
 
 void Log::setConsoleOutput( const bool& output ) {
-	bool OldOutput = mConsoleOutput;
+	lock();
+
+	bool oldOutput = mConsoleOutput;
 
 	mConsoleOutput = output;
 
-	if ( !OldOutput && output ) {
-		lock();
-		std::string data( mData );
-		mData = "";
-		unlock();
-		write( data );
+	// Output the history written while the console output was disabled
+	if ( !oldOutput && output ) {
+		for ( const auto& text : mHistory )
+			writeToConsole( text );
 	}
+
+	unlock();
 }
 
-const bool& Log::isLiveWrite() const {
+bool Log::isLiveWrite() const {
 	return mLiveWrite;
 }
 
@@ -366,11 +639,15 @@ void Log::setLiveWrite( const bool& lw ) {
 }
 
 void Log::addLogReader( LogReaderInterface* reader ) {
+	lock();
 	mReaders.push_back( reader );
+	unlock();
 }
 
 void Log::removeLogReader( LogReaderInterface* reader ) {
+	lock();
 	mReaders.remove( reader );
+	unlock();
 }
 
 void Log::writeToReaders( const std::string& text ) {
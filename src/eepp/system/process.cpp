@@ -5,6 +5,7 @@
 #include <eepp/system/filesystem.hpp>
 #include <eepp/system/lock.hpp>
 #include <eepp/system/process.hpp>
+#include <eepp/system/processreactor.hpp>
 #if EE_PLATFORM == EE_PLATFORM_MACOSX
 #define SUBPROCESS_USE_POSIX_SPAWN
 #endif
@@ -135,6 +136,8 @@ size_t Process::write( const char* buffer, const size_t& size ) {
 	eeASSERT( mProcess != nullptr );
 	if ( mShuttingDown )
 		return 0;
+	if ( mIOState )
+		return ProcessReactor::instance()->write( mIOState, buffer, size );
 	Lock l( mStdInMutex );
 	FILE* stdInFile = subprocess_stdin( PROCESS_PTR );
 	if ( !stdInFile )
@@ -160,6 +163,12 @@ bool Process::kill() {
 
 bool Process::destroy() {
 	eeASSERT( mProcess != nullptr );
+	// The pipes must be unregistered from the reactor before closing them
+	if ( mIOState ) {
+		if ( ProcessReactor::existsSingleton() )
+			ProcessReactor::instance()->remove( mIOState );
+		mIOState.reset();
+	}
 	return 0 == subprocess_destroy( PROCESS_PTR );
 }
 
@@ -185,6 +194,8 @@ FILE* Process::getStdErr() const {
 
 void Process::startShutdown() {
 	mShuttingDown = true;
+	if ( mIOState && ProcessReactor::existsSingleton() )
+		ProcessReactor::instance()->close( mIOState );
 }
 
 void Process::startAsyncRead( ReadFn readStdOut, ReadFn readStdErr ) {
@@ -230,6 +241,15 @@ void Process::startAsyncRead( ReadFn readStdOut, ReadFn readStdErr ) {
 		} );
 	}
 #elif defined( EE_PLATFORM_POSIX )
+	if ( ProcessReactor::isSupported() ) {
+		auto stdErrFd = PROCESS_PTR->stderr_file ? fileno( PROCESS_PTR->stderr_file ) : -1;
+		auto stdInFd = PROCESS_PTR->stdin_file ? fileno( PROCESS_PTR->stdin_file ) : -1;
+		mIOState = ProcessReactor::instance()->add( fileno( PROCESS_PTR->stdout_file ), stdErrFd,
+													stdInFd, mReadStdOutFn, mReadStdErrFn,
+													mBufferSize );
+		if ( mIOState )
+			return;
+	}
 	mStdOutThread = std::thread( [this] {
 		auto stdOutFd = fileno( PROCESS_PTR->stdout_file );
 		auto stdErrFd = PROCESS_PTR->stderr_file ? fileno( PROCESS_PTR->stderr_file ) : 0;
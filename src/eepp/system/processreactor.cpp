@@ -0,0 +1,460 @@
+#include <algorithm>
+#include <condition_variable>
+#include <eepp/system/processreactor.hpp>
+
+#if EE_PLATFORM == EE_PLATFORM_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace EE { namespace System {
+
+namespace Private {
+
+struct ProcessIOState {
+	int stdOutFd{ -1 };
+	int stdErrFd{ -1 };
+	int stdInFd{ -1 };
+	ProcessReactor::ReadFn readStdOut;
+	ProcessReactor::ReadFn readStdErr;
+	// Held while the callbacks of the process are being called
+	std::mutex dispatchMutex;
+	std::mutex writeMutex;
+	std::condition_variable writeCond;
+	// Data written to stdin that didn't fit in the pipe, pending from writeOffset
+	std::string writeQueue;
+	size_t writeOffset{ 0 };
+	bool writeArmed{ false };
+	bool stdInClosed{ false };
+	bool registered{ false };
+	std::atomic<bool> closed{ false };
+
+	size_t pendingWrite() const { return writeQueue.size() - writeOffset; }
+};
+
+} // namespace Private
+
+SINGLETON_DECLARE_IMPLEMENTATION( ProcessReactor )
+
+// Default number of bytes queued for the stdin of a process before the writer blocks
+static constexpr size_t DEFAULT_WRITE_QUEUE_LIMIT = 4 * 1024 * 1024;
+
+// Maximum number of events handled per epoll_wait call
+static constexpr int MAX_EVENTS = 64;
+
+bool ProcessReactor::isSupported() {
+#if EE_PLATFORM == EE_PLATFORM_LINUX
+	return true;
+#else
+	return false;
+#endif
+}
+
+ProcessReactor::ProcessReactor() :
+	mEpollFd( -1 ),
+	mWakeUpFd( -1 ),
+	mBufferSize( 0 ),
+	mWriteQueueLimit( DEFAULT_WRITE_QUEUE_LIMIT ),
+	mThreadId( 0 ),
+	mProcessCount( 0 ),
+	mShuttingDown( false ) {
+#if EE_PLATFORM == EE_PLATFORM_LINUX
+	mEpollFd = epoll_create1( EPOLL_CLOEXEC );
+	mWakeUpFd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+
+	if ( mEpollFd >= 0 && mWakeUpFd >= 0 ) {
+		epoll_event event{};
+		event.events = EPOLLIN;
+		event.data.fd = mWakeUpFd;
+		epoll_ctl( mEpollFd, EPOLL_CTL_ADD, mWakeUpFd, &event );
+	}
+#endif
+}
+
+ProcessReactor::~ProcessReactor() {
+	std::vector<std::shared_ptr<Private::ProcessIOState>> states;
+
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mShuttingDown = true;
+
+		for ( auto& channel : mChannels )
+			states.push_back( channel.second.state );
+
+		mChannels.clear();
+	}
+
+#if EE_PLATFORM == EE_PLATFORM_LINUX
+	if ( mWakeUpFd >= 0 ) {
+		Uint64 val = 1;
+		ssize_t res = ::write( mWakeUpFd, &val, sizeof( val ) );
+		(void)res;
+	}
+#endif
+
+	if ( mThread )
+		mThread->wait();
+
+	for ( auto& state : states )
+		close( state );
+
+#if EE_PLATFORM == EE_PLATFORM_LINUX
+	if ( mWakeUpFd >= 0 )
+		::close( mWakeUpFd );
+
+	if ( mEpollFd >= 0 )
+		::close( mEpollFd );
+#endif
+}
+
+size_t ProcessReactor::getProcessCount() const {
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mProcessCount;
+}
+
+Uint32 ProcessReactor::getThreadCount() const {
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mThread ? 1 : 0;
+}
+
+void ProcessReactor::setWriteQueueLimit( const size_t& limit ) {
+	mWriteQueueLimit = limit;
+}
+
+size_t ProcessReactor::getWriteQueueLimit() const {
+	return mWriteQueueLimit;
+}
+
+bool ProcessReactor::isReactorThread() const {
+	return mThreadId != 0 && mThreadId == Thread::getCurrentThreadId();
+}
+
+#if EE_PLATFORM == EE_PLATFORM_LINUX
+
+static bool setNonBlocking( int fd ) {
+	int flags = fcntl( fd, F_GETFL );
+	return flags != -1 && fcntl( fd, F_SETFL, flags | O_NONBLOCK ) == 0;
+}
+
+std::shared_ptr<Private::ProcessIOState>
+ProcessReactor::add( int stdOutFd, int stdErrFd, int stdInFd, const ReadFn& readStdOut,
+					 const ReadFn& readStdErr, const size_t& bufferSize ) {
+	if ( mEpollFd < 0 || mWakeUpFd < 0 || stdOutFd < 0 )
+		return nullptr;
+
+	if ( stdErrFd == stdOutFd )
+		stdErrFd = -1;
+
+	if ( !setNonBlocking( stdOutFd ) || ( stdErrFd >= 0 && !setNonBlocking( stdErrFd ) ) ||
+		 ( stdInFd >= 0 && !setNonBlocking( stdInFd ) ) )
+		return nullptr;
+
+	auto state = std::make_shared<Private::ProcessIOState>();
+	state->stdOutFd = stdOutFd;
+	state->stdErrFd = stdErrFd;
+	state->stdInFd = stdInFd;
+	state->readStdOut = readStdOut;
+	state->readStdErr = readStdErr;
+
+	std::lock_guard<std::mutex> lock( mMutex );
+
+	if ( mShuttingDown )
+		return nullptr;
+
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.fd = stdOutFd;
+
+	if ( epoll_ctl( mEpollFd, EPOLL_CTL_ADD, stdOutFd, &event ) != 0 )
+		return nullptr;
+
+	mChannels[stdOutFd] = { state, true, false };
+
+	if ( stdErrFd >= 0 ) {
+		event.data.fd = stdErrFd;
+
+		if ( epoll_ctl( mEpollFd, EPOLL_CTL_ADD, stdErrFd, &event ) != 0 ) {
+			epoll_ctl( mEpollFd, EPOLL_CTL_DEL, stdOutFd, nullptr );
+			mChannels.erase( stdOutFd );
+			return nullptr;
+		}
+
+		mChannels[stdErrFd] = { state, false, false };
+	}
+
+	state->registered = true;
+	mProcessCount++;
+	mBufferSize = eemax( mBufferSize, eemax<size_t>( bufferSize, 2 ) );
+
+	if ( !mThread ) {
+		mThread = std::make_unique<Thread>( &ProcessReactor::reactorLoop, this );
+		mThread->launch();
+	}
+
+	return state;
+}
+
+void ProcessReactor::unregisterFd( int fd ) {
+	std::lock_guard<std::mutex> lock( mMutex );
+	auto it = mChannels.find( fd );
+
+	if ( it != mChannels.end() ) {
+		epoll_ctl( mEpollFd, EPOLL_CTL_DEL, fd, nullptr );
+		mChannels.erase( it );
+	}
+}
+
+void ProcessReactor::remove( const std::shared_ptr<Private::ProcessIOState>& state ) {
+	if ( !state )
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+
+		for ( int fd : { state->stdOutFd, state->stdErrFd, state->stdInFd } ) {
+			auto it = mChannels.find( fd );
+
+			if ( fd >= 0 && it != mChannels.end() && it->second.state == state ) {
+				epoll_ctl( mEpollFd, EPOLL_CTL_DEL, fd, nullptr );
+				mChannels.erase( it );
+			}
+		}
+
+		if ( state->registered ) {
+			state->registered = false;
+			mProcessCount--;
+		}
+	}
+
+	close( state );
+
+	// Wait for the callback in progress, unless it's the callback removing its own process
+	if ( !isReactorThread() ) {
+		state->dispatchMutex.lock();
+		state->dispatchMutex.unlock();
+	}
+}
+
+void ProcessReactor::armWrite( const std::shared_ptr<Private::ProcessIOState>& state ) {
+	std::lock_guard<std::mutex> lock( mMutex );
+
+	if ( mShuttingDown || !state->registered )
+		return;
+
+	epoll_event event{};
+	event.events = EPOLLOUT;
+	event.data.fd = state->stdInFd;
+
+	if ( epoll_ctl( mEpollFd, EPOLL_CTL_ADD, state->stdInFd, &event ) == 0 ) {
+		mChannels[state->stdInFd] = { state, false, true };
+		state->writeArmed = true;
+	}
+}
+
+size_t ProcessReactor::write( const std::shared_ptr<Private::ProcessIOState>& state,
+							  const char* buffer, const size_t& size ) {
+	if ( !state || state->closed || state->stdInFd < 0 )
+		return 0;
+
+	std::unique_lock<std::mutex> lock( state->writeMutex );
+
+	if ( state->stdInClosed )
+		return 0;
+
+	const char* data = buffer;
+	size_t left = size;
+
+	// Write directly while nothing is queued, the order of the data must be kept
+	while ( left > 0 && state->pendingWrite() == 0 ) {
+		ssize_t n = ::write( state->stdInFd, data, left );
+
+		if ( n > 0 ) {
+			data += n;
+			left -= n;
+		} else if ( n < 0 && errno == EINTR ) {
+			continue;
+		} else if ( n < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) ) {
+			break;
+		} else {
+			state->stdInClosed = true;
+			return size - left;
+		}
+	}
+
+	if ( left == 0 )
+		return size;
+
+	state->writeQueue.append( data, left );
+
+	if ( !state->writeArmed )
+		armWrite( state );
+
+	if ( !isReactorThread() ) {
+		state->writeCond.wait( lock, [this, &state] {
+			return state->pendingWrite() <= mWriteQueueLimit || state->stdInClosed ||
+				   state->closed || !state->writeArmed;
+		} );
+	}
+
+	return size;
+}
+
+void ProcessReactor::close( const std::shared_ptr<Private::ProcessIOState>& state ) {
+	if ( !state )
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock( state->writeMutex );
+		state->closed = true;
+	}
+
+	state->writeCond.notify_all();
+}
+
+void ProcessReactor::dispatchRead( const std::shared_ptr<Private::ProcessIOState>& state, int fd,
+								   bool isStdOut ) {
+	std::lock_guard<std::mutex> dispatchLock( state->dispatchMutex );
+
+	if ( state->closed )
+		return;
+
+	ssize_t n = ::read( fd, &mBuffer[0], mBuffer.size() - 1 );
+
+	if ( n > 0 ) {
+		mBuffer[n] = '\0';
+
+		const ReadFn& readFn = isStdOut ? state->readStdOut : state->readStdErr;
+
+		if ( readFn )
+			readFn( mBuffer.c_str(), static_cast<size_t>( n ) );
+	} else if ( n == 0 || ( errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK ) ) {
+		unregisterFd( fd );
+	}
+}
+
+void ProcessReactor::dispatchWrite( const std::shared_ptr<Private::ProcessIOState>& state,
+									bool hangUp ) {
+	{
+		std::lock_guard<std::mutex> lock( state->writeMutex );
+
+		// Don't write into a pipe without reader, it would raise SIGPIPE
+		if ( hangUp )
+			state->stdInClosed = true;
+
+		while ( !state->stdInClosed && state->pendingWrite() > 0 ) {
+			ssize_t n = ::write( state->stdInFd, state->writeQueue.data() + state->writeOffset,
+								 state->pendingWrite() );
+
+			if ( n > 0 ) {
+				state->writeOffset += n;
+			} else if ( n < 0 && errno == EINTR ) {
+				continue;
+			} else if ( n < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) ) {
+				break;
+			} else {
+				state->stdInClosed = true;
+			}
+		}
+
+		if ( state->stdInClosed || state->pendingWrite() == 0 ) {
+			state->writeQueue.clear();
+			state->writeOffset = 0;
+			state->writeArmed = false;
+			unregisterFd( state->stdInFd );
+		} else if ( state->writeOffset > state->writeQueue.size() / 2 ) {
+			state->writeQueue.erase( 0, state->writeOffset );
+			state->writeOffset = 0;
+		}
+	}
+
+	state->writeCond.notify_all();
+}
+
+void ProcessReactor::reactorLoop() {
+	mThreadId = Thread::getCurrentThreadId();
+
+	epoll_event events[MAX_EVENTS];
+
+	while ( true ) {
+		int count = epoll_wait( mEpollFd, events, MAX_EVENTS, -1 );
+
+		if ( count < 0 ) {
+			if ( errno == EINTR )
+				continue;
+			break;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+
+			if ( mShuttingDown )
+				break;
+
+			if ( mBuffer.size() < mBufferSize )
+				mBuffer.resize( mBufferSize );
+		}
+
+		for ( int i = 0; i < count; i++ ) {
+			int fd = events[i].data.fd;
+
+			if ( fd == mWakeUpFd ) {
+				Uint64 val;
+				ssize_t res = ::read( mWakeUpFd, &val, sizeof( val ) );
+				(void)res;
+				continue;
+			}
+
+			Channel channel;
+
+			{
+				std::lock_guard<std::mutex> lock( mMutex );
+				auto it = mChannels.find( fd );
+
+				if ( it == mChannels.end() )
+					continue;
+
+				channel = it->second;
+			}
+
+			if ( channel.isStdIn ) {
+				dispatchWrite( channel.state,
+							   ( events[i].events & ( EPOLLERR | EPOLLHUP ) ) != 0 );
+			} else {
+				dispatchRead( channel.state, fd, channel.isStdOut );
+			}
+		}
+	}
+}
+
+#else
+
+std::shared_ptr<Private::ProcessIOState> ProcessReactor::add( int, int, int, const ReadFn&,
+															  const ReadFn&, const size_t& ) {
+	return nullptr;
+}
+
+void ProcessReactor::unregisterFd( int ) {}
+
+void ProcessReactor::remove( const std::shared_ptr<Private::ProcessIOState>& ) {}
+
+void ProcessReactor::armWrite( const std::shared_ptr<Private::ProcessIOState>& ) {}
+
+size_t ProcessReactor::write( const std::shared_ptr<Private::ProcessIOState>&, const char*,
+							  const size_t& ) {
+	return 0;
+}
+
+void ProcessReactor::close( const std::shared_ptr<Private::ProcessIOState>& ) {}
+
+void ProcessReactor::dispatchRead( const std::shared_ptr<Private::ProcessIOState>&, int, bool ) {}
+
+void ProcessReactor::dispatchWrite( const std::shared_ptr<Private::ProcessIOState>&, bool ) {}
+
+void ProcessReactor::reactorLoop() {}
+
+#endif
+
+}} // namespace EE::System
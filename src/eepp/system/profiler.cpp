@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <eepp/core/string.hpp>
+#include <eepp/system/filesystem.hpp>
+#include <eepp/system/lock.hpp>
+#include <eepp/system/profiler.hpp>
+#include <eepp/system/sys.hpp>
+#include <eepp/system/thread.hpp>
+#include <mutex>
+
+namespace EE { namespace System {
+
+SINGLETON_DECLARE_IMPLEMENTATION( Profiler )
+
+// Default number of zones kept by each thread
+static constexpr size_t DEFAULT_RING_CAPACITY = 256 * 1024;
+
+static constexpr const char* FRAME_ZONE_NAME = "Frame";
+
+static std::atomic<Uint64> sProfilerIdCounter{ 0 };
+
+static const std::chrono::steady_clock::time_point sEpoch = std::chrono::steady_clock::now();
+
+std::atomic<bool> Profiler::sRunning{ false };
+
+struct Profiler::ThreadRing {
+	struct Zone {
+		const char* name;
+		Int64 start;
+		Int64 end;
+		Uint32 depth;
+	};
+
+	ThreadRing( const Uint64& profilerId, const size_t& capacity, const std::string& name ) :
+		profilerId( profilerId ),
+		threadId( Thread::getCurrentThreadId() ),
+		name( name ),
+		zones( capacity ) {}
+
+	void push( const Zone& zone ) {
+		zones[count % zones.size()] = zone;
+		count++;
+	}
+
+	/** @return The number of zones kept. */
+	size_t size() const { return static_cast<size_t>( eemin<Uint64>( count, zones.size() ) ); }
+
+	/** @return The zone kept at index, 0 being the oldest. */
+	const Zone& at( const size_t& index ) const {
+		return zones[( count - size() + index ) % zones.size()];
+	}
+
+	Uint64 profilerId;
+	Uint32 threadId;
+	std::string name;
+	// Only contended while the zones are being exported or cleared
+	std::mutex mutex;
+	std::vector<Zone> zones;
+	Uint64 count{ 0 };
+	Int64 lastFrameMark{ 0 };
+};
+
+static thread_local std::string tThreadName;
+static thread_local Uint32 tDepth = 0;
+
+Int64 Profiler::now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() -
+																 sEpoch )
+		.count();
+}
+
+Profiler::ThreadRing* Profiler::getThreadRing( const bool& create ) {
+	static thread_local std::shared_ptr<ThreadRing> tRing;
+	Profiler* profiler = existsSingleton();
+
+	if ( NULL == profiler )
+		return NULL;
+
+	if ( tRing && tRing->profilerId == profiler->mId )
+		return tRing.get();
+
+	if ( !create )
+		return NULL;
+
+	Lock l( profiler->mMutex );
+	tRing = std::make_shared<ThreadRing>( profiler->mId, profiler->mRingCapacity, tThreadName );
+	profiler->mRings.push_back( tRing );
+	return tRing.get();
+}
+
+Uint32 Profiler::enterZone() {
+	return tDepth++;
+}
+
+void Profiler::leaveZone( const char* name, const Int64& start, const Uint32& depth ) {
+	tDepth = depth;
+
+	if ( !isRunning() )
+		return;
+
+	ThreadRing* ring = getThreadRing();
+
+	if ( NULL == ring )
+		return;
+
+	Int64 end = now();
+	std::lock_guard<std::mutex> lock( ring->mutex );
+	ring->push( { name, start, end, depth } );
+}
+
+void Profiler::frameMark() {
+	if ( !isRunning() )
+		return;
+
+	ThreadRing* ring = getThreadRing();
+
+	if ( NULL == ring )
+		return;
+
+	struct Outer {
+		Int64 start;
+		Int64 end;
+	};
+
+	Int64 frameEnd = now();
+	Int64 frameStart;
+	std::vector<ZoneStats> stats;
+	std::vector<Outer> outers;
+
+	{
+		std::lock_guard<std::mutex> lock( ring->mutex );
+
+		frameStart = ring->lastFrameMark;
+
+		// Zones are pushed when they end, so walking backwards visits the enclosing zones before
+		// the zones nested inside them. Nested zones with the same name of the enclosing zone are
+		// not counted, otherwise recursive zones would count their time multiple times.
+		for ( size_t i = ring->size(); i > 0; i-- ) {
+			const ThreadRing::Zone& zone = ring->at( i - 1 );
+
+			if ( zone.end <= frameStart )
+				break;
+
+			if ( zone.name == FRAME_ZONE_NAME )
+				continue;
+
+			size_t index = 0;
+
+			while ( index < stats.size() && stats[index].name != zone.name &&
+					strcmp( stats[index].name, zone.name ) != 0 )
+				index++;
+
+			if ( index == stats.size() ) {
+				stats.push_back( { zone.name, Time::Zero, 0 } );
+				outers.push_back( { zone.start, zone.end } );
+			} else if ( zone.start >= outers[index].start && zone.end <= outers[index].end ) {
+				continue;
+			} else {
+				outers[index] = { zone.start, zone.end };
+			}
+
+			stats[index].time += Microseconds( ( zone.end - zone.start ) / 1000 );
+			stats[index].count++;
+		}
+
+		if ( frameStart > 0 )
+			ring->push( { FRAME_ZONE_NAME, frameStart, frameEnd, 0 } );
+
+		ring->lastFrameMark = frameEnd;
+	}
+
+	std::sort( stats.begin(), stats.end(),
+			   []( const ZoneStats& a, const ZoneStats& b ) { return a.time > b.time; } );
+
+	Profiler* profiler = existsSingleton();
+
+	if ( NULL == profiler )
+		return;
+
+	Lock l( profiler->mMutex );
+	profiler->mLastFrameStats = std::move( stats );
+	profiler->mLastFrameTime =
+		frameStart > 0 ? Microseconds( ( frameEnd - frameStart ) / 1000 ) : Time::Zero;
+}
+
+void Profiler::setThreadName( const std::string& name ) {
+	tThreadName = name;
+
+	ThreadRing* ring = getThreadRing( false );
+
+	if ( NULL != ring ) {
+		std::lock_guard<std::mutex> lock( ring->mutex );
+		ring->name = name;
+	}
+}
+
+Profiler::Profiler() : mRingCapacity( DEFAULT_RING_CAPACITY ), mId( ++sProfilerIdCounter ) {}
+
+Profiler::~Profiler() {
+	sRunning = false;
+
+	if ( !mTracePath.empty() )
+		exportChromeTrace( mTracePath );
+}
+
+void Profiler::start() {
+	sRunning = true;
+}
+
+void Profiler::stop() {
+	sRunning = false;
+}
+
+void Profiler::clear() {
+	Lock l( mMutex );
+
+	for ( auto& ring : mRings ) {
+		std::lock_guard<std::mutex> lock( ring->mutex );
+		ring->count = 0;
+		ring->lastFrameMark = 0;
+	}
+
+	// The rings of the threads that already finished are no longer needed
+	mRings.erase( std::remove_if( mRings.begin(), mRings.end(),
+								  []( const std::shared_ptr<ThreadRing>& ring ) {
+									  return ring.use_count() == 1;
+								  } ),
+				  mRings.end() );
+
+	mLastFrameStats.clear();
+	mLastFrameTime = Time::Zero;
+}
+
+size_t Profiler::getRingCapacity() const {
+	return mRingCapacity;
+}
+
+void Profiler::setRingCapacity( const size_t& capacity ) {
+	Lock l( mMutex );
+	mRingCapacity = eemax<size_t>( 1, capacity );
+}
+
+std::vector<Profiler::ZoneStats> Profiler::getLastFrameStats() const {
+	Lock l( mMutex );
+	return mLastFrameStats;
+}
+
+Time Profiler::getLastFrameTime() const {
+	Lock l( mMutex );
+	return mLastFrameTime;
+}
+
+static void appendJsonString( std::string& json, const char* str ) {
+	json += '"';
+
+	for ( const char* c = str; *c; c++ ) {
+		switch ( *c ) {
+			case '"':
+				json += "\\\"";
+				break;
+			case '\\':
+				json += "\\\\";
+				break;
+			case '\n':
+				json += "\\n";
+				break;
+			case '\t':
+				json += "\\t";
+				break;
+			default:
+				if ( static_cast<unsigned char>( *c ) >= 0x20 )
+					json += *c;
+		}
+	}
+
+	json += '"';
+}
+
+std::string Profiler::toChromeTrace() const {
+	std::vector<std::shared_ptr<ThreadRing>> rings;
+
+	{
+		Lock l( mMutex );
+		rings = mRings;
+	}
+
+	Uint64 pid = Sys::getProcessID();
+	std::string json( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" );
+	bool first = true;
+
+	for ( const auto& ring : rings ) {
+		std::lock_guard<std::mutex> lock( ring->mutex );
+
+		if ( !first )
+			json += ',';
+		first = false;
+
+		json += String::format( "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%llu,\"tid\":%u,"
+								"\"args\":{\"name\":",
+								static_cast<unsigned long long>( pid ), ring->threadId );
+		appendJsonString( json, ring->name.empty() ? String::toString( ring->threadId ).c_str()
+												   : ring->name.c_str() );
+		json += "}}";
+
+		for ( size_t i = 0; i < ring->size(); i++ ) {
+			const ThreadRing::Zone& zone = ring->at( i );
+			json += ",{\"name\":";
+			appendJsonString( json, zone.name );
+			json += String::format( ",\"cat\":\"eepp\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+									"\"pid\":%llu,\"tid\":%u}",
+									zone.start / 1000.0, ( zone.end - zone.start ) / 1000.0,
+									static_cast<unsigned long long>( pid ), ring->threadId );
+		}
+	}
+
+	json += "]}";
+	return json;
+}
+
+bool Profiler::exportChromeTrace( const std::string& path ) const {
+	return FileSystem::fileWrite( path, toChromeTrace() );
+}
+
+const std::string& Profiler::getTracePath() const {
+	return mTracePath;
+}
+
+void Profiler::setTracePath( const std::string& path ) {
+	mTracePath = path;
+}
+
+}} // namespace EE::System
@@ -1,3 +1,4 @@
+#include <eepp/system/profiler.hpp>
 #include <eepp/system/resourceloader.hpp>
 #include <eepp/system/sys.hpp>
 #include <eepp/system/threadpool.hpp>
@@ -105,11 +106,19 @@ void ResourceLoader::setLoaded() {
 }
 
 void ResourceLoader::taskRunner() {
+	eePROFILE_THREAD_NAME( "ResourceLoader" );
+	eePROFILE_SCOPE( "ResourceLoader::load" );
+
 	{
 		auto pool = ThreadPool::createUnique( eemin( mThreads, (Uint32)mTasks.size() ) );
 
 		for ( auto& task : mTasks ) {
-			pool->run( task, [&] { mTotalLoaded++; } );
+			pool->run(
+				[task] {
+					eePROFILE_SCOPE( "ResourceLoader::task" );
+					task();
+				},
+				[&] { mTotalLoaded++; } );
 		}
 	}
 
@@ -118,10 +127,15 @@ void ResourceLoader::taskRunner() {
 }
 
 void ResourceLoader::serializedLoad() {
+	eePROFILE_SCOPE( "ResourceLoader::load" );
+
 	mLoading = true;
 
 	for ( auto& task : mTasks ) {
-		task();
+		{
+			eePROFILE_SCOPE( "ResourceLoader::task" );
+			task();
+		}
 
 		mTotalLoaded++;
 	}
@@ -1,3 +1,4 @@
+#include <eepp/system/profiler.hpp>
 #include <eepp/system/threadpool.hpp>
 
 namespace EE { namespace System {
@@ -42,6 +43,8 @@ ThreadPool::~ThreadPool() {
 }
 
 void ThreadPool::threadFunc() {
+	eePROFILE_THREAD_NAME( "ThreadPool" );
+
 	while ( true ) {
 		std::unique_ptr<Work> work;
 		{
@@ -57,10 +60,14 @@ void ThreadPool::threadFunc() {
 			mWork.pop_front();
 		}
 
-		work->func();
+		{
+			eePROFILE_SCOPE( "ThreadPool::task" );
+
+			work->func();
 
-		if ( work->callback != nullptr ) {
-			work->callback();
+			if ( work->callback != nullptr ) {
+				work->callback();
+			}
 		}
 	}
 }
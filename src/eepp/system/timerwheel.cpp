@@ -0,0 +1,215 @@
+#include <eepp/system/lock.hpp>
+#include <eepp/system/timerwheel.hpp>
+
+namespace EE { namespace System {
+
+TimerWheel::TimerWheel( const Time& resolution, const Uint32& slots ) :
+	mResolution( eemax<Int64>( 1, resolution.asMicroseconds() ) ),
+	mTick( 0 ),
+	mLastId( 0 ),
+	mSlots( eemax<Uint32>( 1, slots ) ) {}
+
+Uint64 TimerWheel::getCurrentTick() const {
+	return static_cast<Uint64>( mClock.getElapsedTime().asMicroseconds() / mResolution );
+}
+
+void TimerWheel::schedule( const Uint64& id, const Uint64& expiration ) {
+	mSlots[expiration % mSlots.size()].emplace_back( id );
+}
+
+Uint64 TimerWheel::add( const Callback& callback, const Time& delay, bool repeat, void* owner ) {
+	Lock l( mMutex );
+
+	Int64 delayUs = eemax<Int64>( 0, delay.asMicroseconds() );
+	Int64 expirationUs = mClock.getElapsedTime().asMicroseconds() + delayUs;
+
+	// Expires in the first tick after the delay, and never in an already expired tick
+	Uint64 expiration =
+		eemax<Uint64>( mTick + 1, ( expirationUs + mResolution - 1 ) / mResolution );
+	Uint64 interval =
+		repeat ? eemax<Uint64>( 1, ( delayUs + mResolution - 1 ) / mResolution ) : 0;
+	Uint64 id = ++mLastId;
+
+	mTimers[id] = { callback, expiration, interval, owner };
+
+	schedule( id, expiration );
+
+	return id;
+}
+
+bool TimerWheel::remove( const Uint64& id ) {
+	Lock l( mMutex );
+
+	if ( mTimers.erase( id ) == 0 )
+		return false;
+
+	// Removed timers are discarded from its slot when the slot is visited, once there are no
+	// timers left the slots are cleared at once
+	if ( mTimers.empty() ) {
+		for ( auto& slot : mSlots )
+			slot.clear();
+	}
+
+	return true;
+}
+
+void TimerWheel::removeOwner( void* owner ) {
+	Lock l( mMutex );
+
+	if ( mTimers.empty() )
+		return;
+
+	for ( auto it = mTimers.begin(); it != mTimers.end(); ) {
+		if ( it->second.owner == owner ) {
+			it = mTimers.erase( it );
+		} else {
+			++it;
+		}
+	}
+
+	if ( mTimers.empty() ) {
+		for ( auto& slot : mSlots )
+			slot.clear();
+	}
+}
+
+bool TimerWheel::exists( const Uint64& id ) const {
+	Lock l( mMutex );
+	return mTimers.find( id ) != mTimers.end();
+}
+
+void TimerWheel::update() {
+	std::vector<Uint64> expired;
+
+	{
+		Lock l( mMutex );
+
+		Uint64 now = getCurrentTick();
+
+		if ( now <= mTick )
+			return;
+
+		if ( mTimers.empty() ) {
+			mTick = now;
+			return;
+		}
+
+		// If the wheel wasn't updated during a whole revolution every slot is visited once
+		Uint64 steps = eemin<Uint64>( now - mTick, mSlots.size() );
+		std::vector<std::pair<Uint64, Uint64>> rescheduled;
+
+		for ( Uint64 step = 1; step <= steps; step++ ) {
+			std::vector<Uint64>& slot = mSlots[( mTick + step ) % mSlots.size()];
+			std::size_t kept = 0;
+
+			for ( std::size_t i = 0; i < slot.size(); i++ ) {
+				auto it = mTimers.find( slot[i] );
+
+				if ( it == mTimers.end() )
+					continue;
+
+				Timer& timer = it->second;
+
+				if ( timer.expiration > now ) {
+					slot[kept++] = slot[i];
+					continue;
+				}
+
+				expired.emplace_back( it->first );
+
+				if ( timer.interval > 0 ) {
+					timer.expiration = now + timer.interval;
+					rescheduled.emplace_back( it->first, timer.expiration );
+				}
+			}
+
+			slot.resize( kept );
+		}
+
+		for ( const auto& timer : rescheduled )
+			schedule( timer.first, timer.second );
+
+		mTick = now;
+	}
+
+	// The callbacks can remove timers expired in this same update, so each timer is checked
+	// before running it
+	for ( const auto& id : expired ) {
+		Callback callback;
+
+		{
+			Lock l( mMutex );
+
+			auto it = mTimers.find( id );
+
+			if ( it == mTimers.end() )
+				continue;
+
+			callback = it->second.callback;
+
+			if ( 0 == it->second.interval )
+				mTimers.erase( it );
+		}
+
+		if ( callback )
+			callback();
+	}
+}
+
+Time TimerWheel::getTimeUntilNext() const {
+	Lock l( mMutex );
+
+	if ( mTimers.empty() )
+		return Time::Infinity;
+
+	Int64 elapsed = mClock.getElapsedTime().asMicroseconds();
+	Uint64 now = static_cast<Uint64>( elapsed / mResolution );
+	Uint64 next = 0;
+
+	for ( Uint64 step = 1; step <= mSlots.size(); step++ ) {
+		Uint64 tick = mTick + step;
+
+		for ( const auto& id : mSlots[tick % mSlots.size()] ) {
+			auto it = mTimers.find( id );
+
+			if ( it == mTimers.end() )
+				continue;
+
+			if ( it->second.expiration <= now )
+				return Time::Zero;
+
+			if ( 0 == next || it->second.expiration < next )
+				next = it->second.expiration;
+		}
+
+		// The following slots only contain timers that expire later
+		if ( 0 != next && next <= tick )
+			break;
+	}
+
+	if ( 0 == next )
+		return Time::Infinity;
+
+	return Microseconds( eemax<Int64>( 0, static_cast<Int64>( next ) * mResolution - elapsed ) );
+}
+
+std::size_t TimerWheel::count() const {
+	Lock l( mMutex );
+	return mTimers.size();
+}
+
+bool TimerWheel::isEmpty() const {
+	Lock l( mMutex );
+	return mTimers.empty();
+}
+
+void TimerWheel::clear() {
+	Lock l( mMutex );
+
+	mTimers.clear();
+
+	for ( auto& slot : mSlots )
+		slot.clear();
+}
+
+}} // namespace EE::System
@@ -31,11 +31,19 @@ MediaQuery::MediaQuery( const MediaQuery& val ) {
 	mMediaType = val.mMediaType;
 }
 
-MediaQuery::ptr MediaQuery::parse( const std::string& str ) {
+MediaQuery::MediaQuery( bool negated, MediaType mediaType,
+						const MediaQueryExpression::vector& expressions ) :
+	mExpressions( expressions ), mNot( negated ), mMediaType( mediaType ) {}
+
+Float MediaQuery::getDisplayDPI() {
 	DisplayManager* displayManager = Engine::instance()->getDisplayManager();
 	int currentDisplayIndex = Engine::instance()->getCurrentWindow()->getCurrentDisplayIndex();
 	Display* currentDisplay = displayManager->getDisplayIndex( currentDisplayIndex );
-	Float dpi = currentDisplay->getDPI();
+	return currentDisplay->getDPI();
+}
+
+MediaQuery::ptr MediaQuery::parse( const std::string& str ) {
+	Float dpi = getDisplayDPI();
 	MediaQuery::ptr query = std::make_shared<MediaQuery>();
 
 	std::vector<std::string> tokens = String::split( str, " \t\r\n", "", "(" );
@@ -434,6 +442,9 @@ MediaQueryList::MediaQueryList() {
 	mUsed = false;
 }
 
+MediaQueryList::MediaQueryList( const std::string& queryStr, const MediaQuery::vector& queries ) :
+	mQueries( queries ), mUsed( false ), mQueryStr( queryStr ) {}
+
 bool MediaQueryList::isUsed() const {
 	return mUsed;
 }
@@ -1,35 +1,416 @@
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <eepp/network/http.hpp>
 #include <eepp/network/uri.hpp>
 #include <eepp/system/clock.hpp>
+#include <eepp/system/fileinfo.hpp>
 #include <eepp/system/filesystem.hpp>
 #include <eepp/system/functionstring.hpp>
 #include <eepp/system/iostreamfile.hpp>
 #include <eepp/system/iostreammemory.hpp>
 #include <eepp/system/log.hpp>
+#include <eepp/system/md5.hpp>
 #include <eepp/system/pack.hpp>
 #include <eepp/system/packmanager.hpp>
 #include <eepp/system/virtualfilesystem.hpp>
 #include <eepp/ui/css/keyframesdefinition.hpp>
+#include <eepp/ui/css/mediaquery.hpp>
 #include <eepp/ui/css/stylesheetparser.hpp>
 #include <eepp/ui/css/stylesheetpropertiesparser.hpp>
 #include <eepp/ui/css/stylesheetselectorparser.hpp>
+#include <eepp/ui/css/stylesheetselectorrule.hpp>
+#include <eepp/ui/css/stylesheetspecification.hpp>
 
 using namespace EE::Network;
 using namespace EE::System;
 
 namespace EE { namespace UI { namespace CSS {
 
-StyleSheetParser::StyleSheetParser() : mLoaded( false ) {}
+static std::string sCachePath;
+
+// Binary cache format identifier and version, the version must be increased every time the
+// serialized data changes.
+static const char CACHE_MAGIC[4] = { 'E', 'C', 'S', 'S' };
+static const Uint32 CACHE_VERSION = 3;
+
+// Style sheets smaller than this are parsed faster than its cache is read
+static const size_t CACHE_MIN_SIZE = 1024;
+
+// Cache entries not written during this time ( in seconds ) are evicted
+static const Uint64 CACHE_MAX_AGE = 30 * 24 * 60 * 60;
+
+// Maximum size of all the cache entries, the oldest entries are evicted first
+static const Uint64 CACHE_MAX_SIZE = 16 * 1024 * 1024;
+
+namespace {
+
+std::string getImportPath( const std::vector<std::string>& tokens ) {
+	std::string path( tokens[1] );
+	FunctionString function( FunctionString::parse( path ) );
+
+	if ( function.getName() == "url" && !function.getParameters().empty() )
+		path = function.getParameters().at( 0 );
+
+	return path;
+}
+
+// Describes where an imported path resolves to, it changes when the imported file is modified,
+// created or removed
+std::string getImportState( std::string path ) {
+	if ( String::startsWith( path, "file://" ) )
+		path = path.substr( 7 );
+
+	if ( FileSystem::fileExists( path ) ) {
+		FileInfo info( path );
+		return "file:" + String::toString( info.getSize() ) + ":" +
+			   String::toString( info.getModificationTime() );
+	} else if ( String::startsWith( path, "http://" ) || String::startsWith( path, "https://" ) ) {
+		return "remote";
+	} else if ( VFS::instance()->fileExists( path ) ) {
+		return "vfs";
+	} else if ( PackManager::instance()->isFallbackToPacksActive() &&
+				NULL != PackManager::instance()->exists( path ) ) {
+		return "pack";
+	}
+
+	return "missing";
+}
+
+// FNV-1a, only used to identify the style sheets loaded from memory ( the files are identified by
+// their path, size and modification time )
+Uint64 hashData( const std::string& data ) {
+	Uint64 hash = 14695981039346656037ULL;
+	for ( const unsigned char& c : data ) {
+		hash ^= c;
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+void pruneCache( const std::string& cachePath ) {
+	std::vector<FileInfo> entries;
+	Uint64 totalSize = 0;
+	Uint64 now = std::time( nullptr );
+
+	for ( const auto& file : FileSystem::filesInfoGetInPath( cachePath ) ) {
+		if ( !file.isRegularFile() )
+			continue;
+
+		std::string ext( FileSystem::fileExtension( file.getFilepath() ) );
+
+		// Temporary files are only left behind by an interrupted write
+		if ( ext == "tmp" || file.getModificationTime() + CACHE_MAX_AGE < now ) {
+			FileSystem::fileRemove( file.getFilepath() );
+		} else if ( ext == "ecss" ) {
+			totalSize += file.getSize();
+			entries.push_back( file );
+		}
+	}
+
+	if ( totalSize <= CACHE_MAX_SIZE )
+		return;
+
+	std::sort( entries.begin(), entries.end(), []( const FileInfo& a, const FileInfo& b ) {
+		return a.getModificationTime() < b.getModificationTime();
+	} );
+
+	for ( const auto& file : entries ) {
+		if ( totalSize <= CACHE_MAX_SIZE )
+			break;
+
+		if ( FileSystem::fileRemove( file.getFilepath() ) )
+			totalSize -= file.getSize();
+	}
+}
+
+class CacheWriter {
+  public:
+	explicit CacheWriter( std::string& buffer ) : mBuffer( buffer ) {}
+
+	void writeUint32( const Uint32& val ) {
+		mBuffer.append( reinterpret_cast<const char*>( &val ), sizeof( val ) );
+	}
+
+	void writeFloat( const Float& val ) {
+		mBuffer.append( reinterpret_cast<const char*>( &val ), sizeof( val ) );
+	}
+
+	void writeString( const std::string& str ) {
+		writeUint32( str.size() );
+		mBuffer.append( str );
+	}
+
+	void writeStrings( const std::vector<std::string>& strings ) {
+		writeUint32( strings.size() );
+		for ( const auto& str : strings )
+			writeString( str );
+	}
+
+	void writeSelector( const StyleSheetSelector& selector ) {
+		writeString( selector.getName() );
+		writeUint32( selector.getRules().size() );
+
+		for ( const auto& rule : selector.getRules() ) {
+			writeUint32( rule.getPatternMatch() );
+			writeUint32( static_cast<Uint32>( rule.getSpecificity() ) );
+			writeString( rule.getTagName() );
+			writeString( rule.getId() );
+			writeStrings( rule.getClasses() );
+			writeStrings( rule.getPseudoClasses() );
+			writeStrings( rule.getStructuralPseudoClasses() );
+		}
+	}
+
+	void writeMediaQueryList( const MediaQueryList& mediaQueryList ) {
+		writeString( mediaQueryList.getQueryString() );
+		writeUint32( mediaQueryList.getQueries().size() );
+
+		for ( const auto& query : mediaQueryList.getQueries() ) {
+			writeUint32( query->isNegated() ? 1 : 0 );
+			writeUint32( query->getMediaType() );
+			writeUint32( query->getExpressions().size() );
+
+			for ( const auto& expr : query->getExpressions() ) {
+				writeUint32( expr.feature );
+				writeUint32( static_cast<Uint32>( expr.val ) );
+				writeUint32( static_cast<Uint32>( expr.val2 ) );
+				writeFloat( expr.fval );
+				writeFloat( expr.fval2 );
+				writeUint32( expr.checkAsBool ? 1 : 0 );
+				writeString( expr.valStr );
+			}
+		}
+	}
+
+	void writeProperties( const StyleSheetProperties& properties ) {
+		writeUint32( properties.size() );
+
+		for ( const auto& it : properties ) {
+			const StyleSheetProperty& prop = it.second;
+			writeUint32( NULL != prop.getPropertyDefinition() ? prop.getId() : 0 );
+			writeString( prop.getName() );
+			writeString( prop.getSpecificity() == StyleSheetSelectorRule::SpecificityImportant
+							 ? prop.getValue() + " !important"
+							 : prop.getValue() );
+			writeUint32( prop.getIndex() );
+			writeUint32( prop.isVolatile() ? 1 : 0 );
+		}
+	}
+
+  protected:
+	std::string& mBuffer;
+};
+
+class CacheReader {
+  public:
+	explicit CacheReader( const std::string& buffer ) : mBuffer( buffer ) {}
+
+	bool isValid() const { return mValid; }
+
+	Uint32 readUint32() {
+		Uint32 val = 0;
+		read( &val, sizeof( val ) );
+		return val;
+	}
+
+	Float readFloat() {
+		Float val = 0;
+		read( &val, sizeof( val ) );
+		return val;
+	}
+
+	std::string readString() {
+		Uint32 size = readUint32();
+
+		if ( !mValid || mPos + size > mBuffer.size() ) {
+			mValid = false;
+			return std::string();
+		}
+
+		std::string str( mBuffer, mPos, size );
+		mPos += size;
+		return str;
+	}
+
+	std::vector<std::string> readStrings() {
+		std::vector<std::string> strings;
+		Uint32 count = readUint32();
+
+		for ( Uint32 i = 0; i < count && mValid; i++ )
+			strings.emplace_back( readString() );
+
+		return strings;
+	}
+
+	// The selector is restored from its rules, without parsing it again
+	StyleSheetSelector readSelector() {
+		std::string name( readString() );
+		std::vector<StyleSheetSelectorRule> rules;
+		Uint32 count = readUint32();
+
+		for ( Uint32 i = 0; i < count && mValid; i++ ) {
+			auto patternMatch = static_cast<StyleSheetSelectorRule::PatternMatch>( readUint32() );
+			int specificity = static_cast<int>( readUint32() );
+			std::string tagName( readString() );
+			std::string id( readString() );
+			std::vector<std::string> classes( readStrings() );
+			std::vector<std::string> pseudoClasses( readStrings() );
+			std::vector<std::string> structuralPseudoClasses( readStrings() );
+
+			if ( !mValid )
+				break;
+
+			rules.emplace_back( patternMatch, specificity, tagName, id, classes, pseudoClasses,
+								structuralPseudoClasses );
+		}
+
+		return StyleSheetSelector( name, rules );
+	}
+
+	MediaQueryList::ptr readMediaQueryList() {
+		std::string queryStr( readString() );
+		MediaQuery::vector queries;
+		Uint32 count = readUint32();
+
+		for ( Uint32 i = 0; i < count && mValid; i++ ) {
+			bool negated = readUint32() != 0;
+			MediaType mediaType = static_cast<MediaType>( readUint32() );
+			MediaQueryExpression::vector expressions;
+			Uint32 expressionsCount = readUint32();
+
+			for ( Uint32 e = 0; e < expressionsCount && mValid; e++ ) {
+				MediaQueryExpression expr;
+				expr.feature = static_cast<MediaFeature>( readUint32() );
+				expr.val = static_cast<int>( readUint32() );
+				expr.val2 = static_cast<int>( readUint32() );
+				expr.fval = readFloat();
+				expr.fval2 = readFloat();
+				expr.checkAsBool = readUint32() != 0;
+				expr.valStr = readString();
+				expressions.emplace_back( std::move( expr ) );
+			}
+
+			queries.emplace_back( std::make_shared<MediaQuery>( negated, mediaType, expressions ) );
+		}
+
+		return std::make_shared<MediaQueryList>( queryStr, queries );
+	}
+
+	StyleSheetProperties readProperties() {
+		StyleSheetProperties properties;
+		Uint32 count = readUint32();
+
+		for ( Uint32 i = 0; i < count && mValid; i++ ) {
+			Uint32 id = readUint32();
+			std::string name( readString() );
+			std::string value( readString() );
+			Uint32 index = readUint32();
+			bool isVolatile = readUint32() != 0;
+
+			if ( !mValid )
+				break;
+
+			// The property definition is resolved by its id, the name is only used for the
+			// properties without definition ( or if the definitions changed )
+			const PropertyDefinition* definition =
+				0 != id ? StyleSheetSpecification::instance()->getProperty( id ) : NULL;
+
+			StyleSheetProperty property = NULL != definition
+											  ? StyleSheetProperty( definition, value, index )
+											  : StyleSheetProperty( name, value );
+			property.setVolatile( isVolatile );
+			properties.emplace( std::make_pair( property.getId(), std::move( property ) ) );
+		}
+
+		return properties;
+	}
+
+	bool readMagic() {
+		char magic[sizeof( CACHE_MAGIC )];
+		read( magic, sizeof( magic ) );
+		return mValid && memcmp( magic, CACHE_MAGIC, sizeof( magic ) ) == 0 &&
+			   readUint32() == CACHE_VERSION;
+	}
+
+  protected:
+	const std::string& mBuffer;
+	size_t mPos{ 0 };
+	bool mValid{ true };
+
+	void read( void* dst, const size_t& size ) {
+		if ( !mValid || mPos + size > mBuffer.size() ) {
+			mValid = false;
+			return;
+		}
+
+		memcpy( dst, &mBuffer[mPos], size );
+		mPos += size;
+	}
+};
+
+} // namespace
+
+void StyleSheetParser::setCachePath( const std::string& path ) {
+	sCachePath = path;
+
+	if ( !sCachePath.empty() ) {
+		FileSystem::dirAddSlashAtEnd( sCachePath );
+
+		if ( !FileSystem::fileExists( sCachePath ) )
+			FileSystem::makeDir( sCachePath );
+		else
+			pruneCache( sCachePath );
+	}
+}
+
+const std::string& StyleSheetParser::getCachePath() {
+	return sCachePath;
+}
+
+StyleSheetParser::StyleSheetParser() : mLoaded( false ), mUseCache( true ) {}
 
 bool StyleSheetParser::loadFromStream( IOStream& stream ) {
+	return loadFromStream( stream, "" );
+}
+
+bool StyleSheetParser::loadFromStream( IOStream& stream, std::string cacheKey ) {
 	Clock elapsed;
 	std::vector<std::string> importedList;
+	mMissingImports.clear();
 	mCSS.resize( stream.getSize() );
 	stream.read( &mCSS[0], stream.getSize() );
+
+	std::string cacheFile;
+
+	if ( isCacheEnabled( mCSS.size() ) ) {
+		if ( cacheKey.empty() ) {
+			cacheKey = "data:" + String::toString( mCSS.size() ) + ":" +
+					   String::toString( hashData( mCSS ) );
+		}
+
+		cacheFile = getCacheFilePath( cacheKey );
+
+		if ( loadFromCache( cacheFile ) ) {
+			Log::info( "StyleSheet loaded from cache in: %4.3f ms.",
+					   elapsed.getElapsedTime().asMilliseconds() );
+			mLoaded = true;
+			return true;
+		}
+
+		// A stale entry would be rejected every time, it's replaced by the new one
+		if ( FileSystem::fileExists( cacheFile ) )
+			FileSystem::fileRemove( cacheFile );
+	}
+
 	bool ok = parse( mCSS, importedList );
 	Log::info( "StyleSheet loaded in: %4.3f ms.", elapsed.getElapsedTime().asMilliseconds() );
 	mLoaded = ok;
+
+	if ( ok && !cacheFile.empty() )
+		saveToCache( cacheFile, importedList );
+
 	return ok;
 }
 
@@ -46,25 +427,60 @@ bool StyleSheetParser::loadFromFile( const std::string& filename ) {
 		return false;
 	}
 
+	// The file is identified by its path, size and modification time, a cached file isn't read
+	FileInfo info( filename );
+	std::string cacheKey;
+
+	if ( isCacheEnabled( info.getSize() ) ) {
+		cacheKey = "file:" + FileSystem::getRealPath( filename ) + ":" +
+				   String::toString( info.getSize() ) + ":" +
+				   String::toString( info.getModificationTime() );
+
+		if ( loadFromCache( getCacheFilePath( cacheKey ) ) ) {
+			mCSS.clear();
+			mLoaded = true;
+			return true;
+		}
+	}
+
 	IOStreamFile stream( filename );
-	return loadFromStream( stream );
+	return loadFromStream( stream, cacheKey );
 }
 
 bool StyleSheetParser::loadFromPack( Pack* pack, std::string filePackPath ) {
-	if ( NULL == pack )
+	if ( NULL == pack || !pack->isOpen() )
 		return false;
 
+	// The packed file is identified by the pack file state, a cached file isn't extracted
+	std::string cacheKey;
+
+	if ( isCacheEnabled( CACHE_MIN_SIZE ) && FileSystem::fileExists( pack->getPackPath() ) ) {
+		cacheKey = "pack:" + getImportState( pack->getPackPath() ) + ":" +
+				   FileSystem::getRealPath( pack->getPackPath() ) + ":" + filePackPath;
+
+		if ( loadFromCache( getCacheFilePath( cacheKey ) ) ) {
+			mCSS.clear();
+			mLoaded = true;
+			return true;
+		}
+	}
+
 	bool Ret = false;
 
 	ScopedBuffer buffer;
 
-	if ( pack->isOpen() && pack->extractFileToMemory( filePackPath, buffer ) ) {
-		Ret = loadFromMemory( buffer.get(), buffer.length() );
+	if ( pack->extractFileToMemory( filePackPath, buffer ) ) {
+		IOStreamMemory stream( reinterpret_cast<const char*>( buffer.get() ), buffer.length() );
+		Ret = loadFromStream( stream, cacheKey );
 	}
 
 	return Ret;
 }
 
+bool StyleSheetParser::isCacheEnabled( const Uint64& size ) const {
+	return mUseCache && !sCachePath.empty() && size >= CACHE_MIN_SIZE;
+}
+
 bool StyleSheetParser::loadFromMemory( const Uint8* RAWData, const Uint32& size ) {
 	IOStreamMemory stream( (const char*)RAWData, size );
 	return loadFromStream( stream );
@@ -269,6 +685,8 @@ std::string StyleSheetParser::importCSS( std::string path,
 		}
 	}
 
+	mMissingImports.push_back( path );
+
 	return std::string();
 }
 
@@ -302,7 +720,7 @@ void StyleSheetParser::importParse( std::string& css, std::size_t& pos, std::str
 	std::vector<std::string> tokens = String::split( import, " " );
 
 	if ( tokens.size() >= 2 ) {
-		std::string path( tokens[1] );
+		std::string path( getImportPath( tokens ) );
 		std::string mediaStr;
 
 		if ( tokens.size() > 2 ) {
@@ -311,12 +729,6 @@ void StyleSheetParser::importParse( std::string& css, std::size_t& pos, std::str
 			}
 		}
 
-		FunctionString function( FunctionString::parse( path ) );
-
-		if ( function.getName() == "url" && !function.getParameters().empty() ) {
-			path = function.getParameters().at( 0 );
-		}
-
 		if ( std::find( importedList.begin(), importedList.end(), path ) == importedList.end() ) {
 			std::string newCss( importCSS( path, importedList ) );
 
@@ -350,6 +762,7 @@ void StyleSheetParser::keyframesParse( std::string& css, ReadState& rs, std::siz
 
 	if ( keyframesClosePos != std::string::npos ) {
 		StyleSheetParser keyframeParser;
+		keyframeParser.mUseCache = false;
 		keyframeParser.loadFromMemory( reinterpret_cast<const Uint8*>( &css[pos] ),
 									   keyframesClosePos - pos );
 		const std::vector<std::shared_ptr<StyleSheetStyle>>& styles =
@@ -365,4 +778,209 @@ void StyleSheetParser::keyframesParse( std::string& css, ReadState& rs, std::siz
 	pos = keyframesClosePos + 1;
 }
 
+std::string StyleSheetParser::getCacheFilePath( const std::string& cacheKey ) const {
+	// The imports are resolved from the working directory, the same style sheet can import
+	// different files from another directory
+	return sCachePath +
+		   MD5::fromString( cacheKey + "\n" + FileSystem::getCurrentWorkingDirectory() )
+			   .toHexString() +
+		   ".ecss";
+}
+
+bool StyleSheetParser::loadFromCache( const std::string& cacheFile ) {
+	std::string buffer;
+
+	if ( !FileSystem::fileExists( cacheFile ) || !FileSystem::fileGet( cacheFile, buffer ) )
+		return false;
+
+	CacheReader reader( buffer );
+
+	if ( !reader.readMagic() )
+		return false;
+
+	// The imported files ( including the nested imports ) must have the same size and
+	// modification time they had at the moment of caching
+	Uint32 importsCount = reader.readUint32();
+
+	for ( Uint32 i = 0; i < importsCount && reader.isValid(); i++ ) {
+		std::string path( reader.readString() );
+		std::string state( reader.readString() );
+
+		if ( !reader.isValid() || getImportState( path ) != state )
+			return false;
+	}
+
+	// An import that couldn't be resolved at the moment of caching must still be missing
+	std::vector<std::string> missingImports;
+	Uint32 missingCount = reader.readUint32();
+
+	for ( Uint32 i = 0; i < missingCount && reader.isValid(); i++ ) {
+		missingImports.emplace_back( reader.readString() );
+
+		if ( getImportState( missingImports.back() ) != "missing" )
+			return false;
+	}
+
+	// The media query lengths were converted to pixels with the DPI of the display
+	std::vector<MediaQueryList::ptr> mediaQueryLists;
+	Uint32 mediaQueryListsCount = reader.readUint32();
+
+	if ( mediaQueryListsCount > 0 && reader.readFloat() != MediaQuery::getDisplayDPI() )
+		return false;
+
+	for ( Uint32 i = 0; i < mediaQueryListsCount && reader.isValid(); i++ )
+		mediaQueryLists.emplace_back( reader.readMediaQueryList() );
+
+	StyleSheet styleSheet;
+	Uint32 stylesCount = reader.readUint32();
+
+	for ( Uint32 i = 0; i < stylesCount && reader.isValid(); i++ ) {
+		StyleSheetSelector selector( reader.readSelector() );
+		Uint32 mediaQueryListIndex = reader.readUint32();
+		StyleSheetProperties properties( reader.readProperties() );
+		StyleSheetVariables variables;
+		Uint32 variablesCount = reader.readUint32();
+
+		for ( Uint32 v = 0; v < variablesCount && reader.isValid(); v++ ) {
+			std::string name( reader.readString() );
+			std::string value( reader.readString() );
+			variables[String::hash( name )] = StyleSheetVariable( name, value );
+		}
+
+		if ( !reader.isValid() || mediaQueryListIndex > mediaQueryLists.size() )
+			break;
+
+		// Styles declared in the same media query share the same media query list
+		styleSheet.addStyle( std::make_shared<StyleSheetStyle>(
+			selector, properties, variables,
+			mediaQueryListIndex > 0 ? mediaQueryLists[mediaQueryListIndex - 1]
+									: MediaQueryList::ptr() ) );
+	}
+
+	Uint32 keyframesCount = reader.readUint32();
+
+	for ( Uint32 i = 0; i < keyframesCount && reader.isValid(); i++ ) {
+		KeyframesDefinition keyframes;
+		keyframes.name = reader.readString();
+		Uint32 blocksCount = reader.readUint32();
+
+		for ( Uint32 b = 0; b < blocksCount && reader.isValid(); b++ ) {
+			KeyframesDefinition::KeyframeBlock block;
+			block.normalizedTime = reader.readFloat();
+			block.properties = reader.readProperties();
+			keyframes.keyframeBlocks[block.normalizedTime] = block;
+		}
+
+		styleSheet.addKeyframes( keyframes );
+	}
+
+	if ( !reader.isValid() ) {
+		Log::warning( "StyleSheetParser::loadFromCache: corrupted cache file %s",
+					  cacheFile.c_str() );
+		return false;
+	}
+
+	mStyleSheet = styleSheet;
+	mMissingImports = missingImports;
+
+	return true;
+}
+
+bool StyleSheetParser::saveToCache( const std::string& cacheFile,
+									const std::vector<std::string>& importedList ) {
+	std::string buffer;
+	CacheWriter writer( buffer );
+
+	buffer.append( CACHE_MAGIC, sizeof( CACHE_MAGIC ) );
+	writer.writeUint32( CACHE_VERSION );
+	writer.writeUint32( importedList.size() );
+
+	for ( const auto& path : importedList ) {
+		// Only the local files can be validated without fetching them again
+		std::string state( getImportState( path ) );
+
+		if ( !String::startsWith( state, "file:" ) )
+			return false;
+
+		writer.writeString( path );
+		writer.writeString( state );
+	}
+
+	writer.writeUint32( mMissingImports.size() );
+
+	for ( const auto& path : mMissingImports ) {
+		// A remote import could be only temporarily unavailable
+		if ( getImportState( path ) != "missing" )
+			return false;
+
+		writer.writeString( path );
+	}
+
+	const auto& styles = mStyleSheet.getStyles();
+	std::map<const MediaQueryList*, Uint32> mediaQueryListIndex;
+	std::vector<const MediaQueryList*> mediaQueryLists;
+
+	for ( const auto& style : styles ) {
+		const MediaQueryList* mediaQueryList = style->getMediaQueryList().get();
+
+		if ( nullptr != mediaQueryList &&
+			 mediaQueryListIndex.find( mediaQueryList ) == mediaQueryListIndex.end() ) {
+			mediaQueryLists.push_back( mediaQueryList );
+			mediaQueryListIndex[mediaQueryList] = mediaQueryLists.size();
+		}
+	}
+
+	writer.writeUint32( mediaQueryLists.size() );
+
+	if ( !mediaQueryLists.empty() )
+		writer.writeFloat( MediaQuery::getDisplayDPI() );
+
+	for ( const auto& mediaQueryList : mediaQueryLists )
+		writer.writeMediaQueryList( *mediaQueryList );
+
+	writer.writeUint32( styles.size() );
+
+	for ( const auto& style : styles ) {
+		writer.writeSelector( style->getSelector() );
+		const MediaQueryList* mediaQueryList = style->getMediaQueryList().get();
+		writer.writeUint32( nullptr != mediaQueryList ? mediaQueryListIndex[mediaQueryList] : 0 );
+		writer.writeProperties( style->getProperties() );
+		writer.writeUint32( style->getVariables().size() );
+
+		for ( const auto& variable : style->getVariables() ) {
+			writer.writeString( variable.second.getName() );
+			writer.writeString( variable.second.getValue() );
+		}
+	}
+
+	const KeyframesDefinitionMap& keyframesMap = mStyleSheet.getKeyframes();
+	writer.writeUint32( keyframesMap.size() );
+
+	for ( const auto& keyframes : keyframesMap ) {
+		writer.writeString( keyframes.second.getName() );
+		writer.writeUint32( keyframes.second.getKeyframeBlocks().size() );
+
+		for ( const auto& block : keyframes.second.getKeyframeBlocks() ) {
+			writer.writeFloat( block.second.normalizedTime );
+			writer.writeProperties( block.second.properties );
+		}
+	}
+
+	// Write and rename, so a concurrent load never reads a partially written cache
+	std::string tmpFile( cacheFile + ".tmp" );
+
+	if ( !FileSystem::fileWrite( tmpFile, buffer ) )
+		return false;
+
+	if ( FileSystem::fileExists( cacheFile ) )
+		FileSystem::fileRemove( cacheFile );
+
+	if ( std::rename( tmpFile.c_str(), cacheFile.c_str() ) != 0 ) {
+		FileSystem::fileRemove( tmpFile );
+		return false;
+	}
+
+	return true;
+}
+
 }}} // namespace EE::UI::CSS
@@ -15,6 +15,19 @@ StyleSheetSelector::StyleSheetSelector( const std::string& selectorName ) :
 	parseSelector( mName );
 }
 
+StyleSheetSelector::StyleSheetSelector( const std::string& selectorName,
+										const std::vector<StyleSheetSelectorRule>& rules ) :
+	mName( selectorName ),
+	mSpecificity( 0 ),
+	mSelectorRules( rules ),
+	mCacheable( true ),
+	mStructurallyVolatile( false ) {
+	for ( const auto& rule : mSelectorRules )
+		mSpecificity += rule.getSpecificity();
+
+	updateCacheable();
+}
+
 const std::string& StyleSheetSelector::getName() const {
 	return mName;
 }
@@ -83,22 +96,26 @@ void StyleSheetSelector::parseSelector( std::string selector ) {
 			buffer.clear();
 		}
 
-		mCacheable = true;
+		updateCacheable();
+	}
+}
 
-		if ( !mSelectorRules.empty() ) {
-			if ( mSelectorRules[0].hasStructuralPseudoClasses() ) {
-				mStructurallyVolatile = true;
-				mCacheable = false;
-			}
+void StyleSheetSelector::updateCacheable() {
+	mCacheable = true;
+
+	if ( !mSelectorRules.empty() ) {
+		if ( mSelectorRules[0].hasStructuralPseudoClasses() ) {
+			mStructurallyVolatile = true;
+			mCacheable = false;
 		}
+	}
 
-		if ( mCacheable ) {
-			for ( size_t i = 1; i < mSelectorRules.size(); i++ ) {
-				if ( mSelectorRules[i].hasPseudoClasses() ||
-					 mSelectorRules[i].hasStructuralPseudoClasses() ) {
-					mCacheable = false;
-					break;
-				}
+	if ( mCacheable ) {
+		for ( size_t i = 1; i < mSelectorRules.size(); i++ ) {
+			if ( mSelectorRules[i].hasPseudoClasses() ||
+				 mSelectorRules[i].hasStructuralPseudoClasses() ) {
+				mCacheable = false;
+				break;
 			}
 		}
 	}
@@ -313,6 +330,10 @@ const StyleSheetSelectorRule& StyleSheetSelector::getRule( const Uint32& index )
 	return mSelectorRules[index];
 }
 
+const std::vector<StyleSheetSelectorRule>& StyleSheetSelector::getRules() const {
+	return mSelectorRules;
+}
+
 const std::string& StyleSheetSelector::getSelectorId() const {
 	return mSelectorRules[0].getId();
 }
@@ -84,6 +84,54 @@ StyleSheetSelectorRule::StyleSheetSelectorRule( const std::string& selectorFragm
 	parseFragment( selectorFragment );
 }
 
+StyleSheetSelectorRule::StyleSheetSelectorRule(
+	PatternMatch patternMatch, const int& specificity, const std::string& tagName,
+	const std::string& id, const std::vector<std::string>& classes,
+	const std::vector<std::string>& pseudoClasses,
+	const std::vector<std::string>& structuralPseudoClasses ) :
+	mSpecificity( specificity ),
+	mPatternMatch( patternMatch ),
+	mTagName( tagName ),
+	mId( id ),
+	mClasses( classes ),
+	mPseudoClasses( pseudoClasses ),
+	mRequirementFlags( 0 ) {
+	for ( const auto& pseudoClass : structuralPseudoClasses )
+		addStructuralPseudoClass( pseudoClass );
+
+	updateRequirementFlags();
+}
+
+void StyleSheetSelectorRule::addStructuralPseudoClass( const std::string& pseudoClass ) {
+	mStructuralPseudoClasses.push_back( pseudoClass );
+
+	StructuralSelector structuralSelector =
+		StyleSheetSpecification::instance()->getStructuralSelector( pseudoClass );
+
+	if ( structuralSelector.selector ) {
+		mStructuralSelectors.push_back( structuralSelector );
+	}
+}
+
+void StyleSheetSelectorRule::updateRequirementFlags() {
+	mRequirementFlags = 0;
+
+	if ( !mTagName.empty() )
+		mRequirementFlags |= TagName;
+
+	if ( !mId.empty() )
+		mRequirementFlags |= Id;
+
+	if ( !mClasses.empty() )
+		mRequirementFlags |= Class;
+
+	if ( !mPseudoClasses.empty() )
+		mRequirementFlags |= PseudoClass;
+
+	if ( !mStructuralPseudoClasses.empty() )
+		mRequirementFlags |= StructuralPseudoClass;
+}
+
 void StyleSheetSelectorRule::pushSelectorTypeIdentifier( TypeIdentifier selectorTypeIdentifier,
 														 std::string name ) {
 	switch ( selectorTypeIdentifier ) {
@@ -124,14 +172,7 @@ void StyleSheetSelectorRule::parseFragment( const std::string& selectorFragment
 				if ( isPseudoClassState( pseudoClass ) ) {
 					mPseudoClasses.push_back( pseudoClass == "active" ? "pressed" : pseudoClass );
 				} else if ( isStructuralPseudoClass( pseudoClass ) ) {
-					mStructuralPseudoClasses.push_back( pseudoClass );
-
-					StructuralSelector structuralSelector =
-						StyleSheetSpecification::instance()->getStructuralSelector( pseudoClass );
-
-					if ( structuralSelector.selector ) {
-						mStructuralSelectors.push_back( structuralSelector );
-					}
+					addStructuralPseudoClass( pseudoClass );
 				}
 
 				selector = realSelector;
@@ -180,24 +221,9 @@ void StyleSheetSelectorRule::parseFragment( const std::string& selectorFragment
 		pushSelectorTypeIdentifier( curSelectorType, buffer );
 	}
 
-	if ( !mTagName.empty() )
-		mRequirementFlags |= TagName;
-
-	if ( !mId.empty() )
-		mRequirementFlags |= Id;
-
-	if ( !mClasses.empty() )
-		mRequirementFlags |= Class;
-
-	if ( !mPseudoClasses.empty() ) {
-		mRequirementFlags |= PseudoClass;
-		mSpecificity += SpecificityPseudoClass * mPseudoClasses.size();
-	}
-
-	if ( !mStructuralPseudoClasses.empty() ) {
-		mRequirementFlags |= StructuralPseudoClass;
-		mSpecificity += SpecificityStructuralPseudoClass * mStructuralPseudoClasses.size();
-	}
+	updateRequirementFlags();
+	mSpecificity += SpecificityPseudoClass * mPseudoClasses.size();
+	mSpecificity += SpecificityStructuralPseudoClass * mStructuralPseudoClasses.size();
 }
 
 bool StyleSheetSelectorRule::hasClass( const std::string& cls ) const {
@@ -237,6 +263,10 @@ const std::string& StyleSheetSelectorRule::getId() const {
 	return mId;
 }
 
+const std::vector<std::string>& StyleSheetSelectorRule::getClasses() const {
+	return mClasses;
+}
+
 bool StyleSheetSelectorRule::matches( UIWidget* element, const bool& applyPseudo ) const {
 	Uint32 flags = 0;
 
@@ -8,6 +8,12 @@ StyleSheetStyle::StyleSheetStyle( const std::string& selector,
 								  const StyleSheetProperties& properties,
 								  const StyleSheetVariables& variables,
 								  MediaQueryList::ptr mediaQueryList ) :
+	StyleSheetStyle( StyleSheetSelector( selector ), properties, variables, mediaQueryList ) {}
+
+StyleSheetStyle::StyleSheetStyle( const StyleSheetSelector& selector,
+								  const StyleSheetProperties& properties,
+								  const StyleSheetVariables& variables,
+								  MediaQueryList::ptr mediaQueryList ) :
 	mSelector( selector ),
 	mProperties( properties ),
 	mVariables( variables ),
@@ -1,3 +1,4 @@
+#include <eepp/system/profiler.hpp>
 #include <eepp/ui/doc/syntaxdefinitionmanager.hpp>
 #include <eepp/ui/doc/syntaxhighlighter.hpp>
 #include <eepp/ui/doc/syntaxtokenizer.hpp>
@@ -38,6 +39,10 @@ TokenizedLine SyntaxHighlighter::tokenizeLine( const size_t& line, const Uint64&
 }
 
 const std::vector<SyntaxToken>& SyntaxHighlighter::getLine( const size_t& index ) {
+	return getTokenizedLine( index ).tokens;
+}
+
+const TokenizedLine& SyntaxHighlighter::getTokenizedLine( const size_t& index ) {
 	const auto& it = mLines.find( index );
 	if ( it == mLines.end() ||
 		 ( index < mDoc->linesCount() && mDoc->line( index ).getHash() != it->second.hash ) ) {
@@ -49,10 +54,10 @@ const std::vector<SyntaxToken>& SyntaxHighlighter::getLine( const size_t& index
 			}
 		}
 		mLines[index] = tokenizeLine( index, prevState );
-		return mLines[index].tokens;
+		return mLines[index];
 	}
 	mMaxWantedLine = eemax<Int64>( mMaxWantedLine, index );
-	return it->second.tokens;
+	return it->second;
 }
 
 Int64 SyntaxHighlighter::getFirstInvalidLine() const {
@@ -64,6 +69,8 @@ Int64 SyntaxHighlighter::getMaxWantedLine() const {
 }
 
 bool SyntaxHighlighter::updateDirty( int visibleLinesCount ) {
+	eePROFILE_SCOPE( "SyntaxHighlighter::updateDirty" );
+
 	if ( visibleLinesCount <= 0 )
 		return 0;
 	if ( mFirstInvalidLine > mMaxWantedLine ) {
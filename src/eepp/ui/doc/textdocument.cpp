@@ -10,6 +10,7 @@
 #include <eepp/system/packmanager.hpp>
 #include <eepp/ui/doc/syntaxdefinitionmanager.hpp>
 #include <eepp/ui/doc/textdocument.hpp>
+#include <eepp/ui/doc/textsearchindex.hpp>
 #include <sstream>
 #include <string>
 
@@ -33,7 +34,8 @@ TextDocument::TextDocument( bool verbose ) :
 		{ { '(', ')' }, { '[', ']' }, { '{', '}' }, { '\'', '\'' }, { '"', '"' }, { '`', '`' } } ),
 	mDefaultFileName( "untitled" ),
 	mCleanChangeId( 0 ),
-	mNonWordChars( DEFAULT_NON_WORD_CHARS ) {
+	mNonWordChars( DEFAULT_NON_WORD_CHARS ),
+	mSearchIndex( std::make_unique<TextSearchIndex>( this ) ) {
 	initializeCommands();
 	reset();
 }
@@ -66,6 +68,7 @@ void TextDocument::reset() {
 	mSyntaxDefinition = SyntaxDefinitionManager::instance()->getPlainStyle();
 	mUndoStack.clear();
 	cleanChangeId();
+	mSearchIndex->invalidate();
 	if ( oldSelection.isValid() )
 		notifyTextChanged( { { oldSelection.end(), oldSelection.start() }, "" } );
 	notifyCursorChanged();
@@ -178,6 +181,7 @@ TextDocument::LoadStatus TextDocument::loadFromStream( IOStream& file, std::stri
 		mLines.clear();
 		mLines.push_back( String( "\n" ) );
 	}
+	mSearchIndex->invalidate();
 	mLoading = false;
 	return wasInterrupted ? LoadStatus::Interrupted
 						  : ( file.isOpen() ? LoadStatus::Loaded : LoadStatus::Failed );
@@ -1544,47 +1548,6 @@ bool TextDocument::removeCommand( const std::string& command ) {
 	return mCommands.erase( command ) > 0;
 }
 
-static std::pair<size_t, size_t> findType( const String& str, const String& findStr,
-										   const TextDocument::FindReplaceType& type ) {
-	switch ( type ) {
-		case TextDocument::FindReplaceType::LuaPattern: {
-			LuaPattern words( findStr );
-			int start, end = 0;
-			words.find( str, start, end );
-			if ( start < 0 )
-				return { String::StringType::npos, String::StringType::npos };
-			else
-				return { start, end };
-		}
-		case TextDocument::FindReplaceType::Normal:
-		default: {
-			size_t res = str.find( findStr );
-			return { res, String::InvalidPos == res ? res : res + findStr.size() };
-		}
-	}
-}
-
-static std::pair<size_t, size_t> findLastType( const String& str, const String& findStr,
-											   const TextDocument::FindReplaceType& type ) {
-	switch ( type ) {
-		case TextDocument::FindReplaceType::LuaPattern: {
-			// TODO: Implement findLastType for Lua patterns
-			LuaPattern words( findStr );
-			int start, end = 0;
-			words.find( str, start, end );
-			if ( start < 0 )
-				return { String::StringType::npos, String::StringType::npos };
-			else
-				return { end, start };
-		}
-		case TextDocument::FindReplaceType::Normal:
-		default: {
-			size_t res = str.rfind( findStr );
-			return { res, String::InvalidPos == res ? res : res + findStr.size() };
-		}
-	}
-}
-
 TextRange TextDocument::findText( String text, TextPosition from, const bool& caseSensitive,
 								  const bool& wholeWord, const FindReplaceType& type,
 								  TextRange restrictRange ) {
@@ -1603,28 +1566,14 @@ TextRange TextDocument::findText( String text, TextPosition from, const bool& ca
 	if ( !caseSensitive )
 		text.toLower();
 
+	TextSearchIndex::Query query{ text, caseSensitive, wholeWord, type };
+
 	for ( Int64 i = from.line(); i <= to.line(); i++ ) {
-		std::pair<size_t, size_t> col;
-		if ( i == from.line() ) {
-			col = caseSensitive
-					  ? findType( line( i ).getText().substr( from.column() ), text, type )
-					  : findType( String::toLower( line( i ).getText() ).substr( from.column() ),
-								  text, type );
-			if ( String::StringType::npos != col.first ) {
-				col.first += from.column();
-				col.second += from.column();
-			}
-		} else if ( i == to.line() && to != endOfDoc() ) {
-			col = caseSensitive
-					  ? findType( line( i ).getText().substr( 0, to.column() ), text, type )
-					  : findType( String::toLower( line( i ).getText() ).substr( 0, to.column() ),
-								  text, type );
-		} else {
-			col = caseSensitive ? findType( line( i ).getText(), text, type )
-								: findType( String::toLower( line( i ).getText() ), text, type );
-		}
-		if ( String::StringType::npos != col.first &&
-			 ( !wholeWord || String::isWholeWord( line( i ).getText(), text, col.first ) ) ) {
+		size_t startCol = i == from.line() ? from.column() : 0;
+		size_t endCol =
+			i == to.line() && to != endOfDoc() ? to.column() : String::StringType::npos;
+		std::pair<size_t, size_t> col( mSearchIndex->findInLine( query, i, startCol, endCol ) );
+		if ( String::StringType::npos != col.first ) {
 			TextRange pos( { { (Int64)i, (Int64)col.first }, { (Int64)i, (Int64)col.second } } );
 			if ( pos.end().column() == (Int64)mLines[pos.end().line()].size() )
 				pos.setEnd( positionOffset( pos.end(), 1 ) );
@@ -1652,30 +1601,14 @@ TextRange TextDocument::findTextLast( String text, TextPosition from, const bool
 	if ( !caseSensitive )
 		text.toLower();
 
+	TextSearchIndex::Query query{ text, caseSensitive, wholeWord, type };
+
 	for ( Int64 i = from.line(); i >= to.line(); i-- ) {
-		std::pair<size_t, size_t> col;
-		if ( i == from.line() ) {
-			col = caseSensitive
-					  ? findLastType( line( i ).getText().substr( 0, from.column() ), text, type )
-					  : findLastType(
-							String::toLower( line( i ).getText().substr( 0, from.column() ) ), text,
-							type );
-		} else if ( i == to.line() ) {
-			col = caseSensitive
-					  ? findLastType( line( i ).getText().substr( to.column() ), text, type )
-					  : findLastType( String::toLower( line( i ).getText().substr( to.column() ) ),
-									  text, type );
-			if ( String::StringType::npos != col.first ) {
-				col.first += to.column();
-				col.second += to.column();
-			}
-		} else {
-			col = caseSensitive
-					  ? findLastType( line( i ).getText(), text, type )
-					  : findLastType( String::toLower( line( i ).getText() ), text, type );
-		}
-		if ( String::StringType::npos != col.first &&
-			 ( !wholeWord || String::isWholeWord( line( i ).getText(), text, col.first ) ) ) {
+		size_t startCol = i == to.line() ? to.column() : 0;
+		size_t endCol = i == from.line() ? from.column() : String::StringType::npos;
+		std::pair<size_t, size_t> col(
+			mSearchIndex->findLastInLine( query, i, startCol, endCol ) );
+		if ( String::StringType::npos != col.first ) {
 			TextRange pos( { { (Int64)i, (Int64)col.second }, { (Int64)i, (Int64)col.first } } );
 			if ( pos.start().column() == (Int64)mLines[pos.start().line()].size() )
 				pos.setStart( positionOffset( pos.start(), 1 ) );
@@ -1844,6 +1777,23 @@ std::vector<TextRange> TextDocument::findAll( const String& text, const bool& ca
 											  const bool& wholeWord, const FindReplaceType& type,
 											  TextRange restrictRange ) {
 	std::vector<TextRange> all;
+	TextSearchIndex::Query query{ text, caseSensitive, wholeWord, type };
+
+	if ( TextSearchIndex::isIndexable( query ) ) {
+		if ( !restrictRange.isValid() )
+			return mSearchIndex->getMatches( query );
+		restrictRange = sanitizeRange( restrictRange.normalized() );
+		all = mSearchIndex->getMatches( query, restrictRange.start().line(),
+										restrictRange.end().line() );
+		all.erase( std::remove_if( all.begin(), all.end(),
+								   [&restrictRange]( const TextRange& range ) {
+									   return range.start() < restrictRange.start() ||
+											  range.end() > restrictRange.end();
+								   } ),
+				   all.end() );
+		return all;
+	}
+
 	TextRange found;
 	TextPosition from = startOfDoc();
 	if ( restrictRange.isValid() )
@@ -1866,6 +1816,23 @@ int TextDocument::replaceAll( const String& text, const String& replace, const b
 	int count = 0;
 	TextRange found;
 	TextPosition startedPosition = getSelection().start();
+
+	if ( TextSearchIndex::isIndexable( { text, caseSensitive, wholeWord, type } ) ) {
+		// Replace from the last match to the first one, so the positions of the pending matches
+		// are not moved by the replacements. The cached matches are dropped first, otherwise
+		// every replacement would update them.
+		std::vector<TextRange> matches(
+			findAll( text, caseSensitive, wholeWord, type, restrictRange ) );
+		mSearchIndex->invalidate();
+		for ( auto it = matches.rbegin(); it != matches.rend(); ++it ) {
+			setSelection( *it );
+			replaceSelection( replace );
+			count++;
+		}
+		setSelection( startedPosition );
+		return count;
+	}
+
 	TextPosition from = startOfDoc();
 	if ( restrictRange.isValid() )
 		from = restrictRange.normalized().start();
@@ -1889,6 +1856,10 @@ TextPosition TextDocument::replaceSelection( const String& replace ) {
 	return getSelection( true ).end();
 }
 
+TextSearchIndex& TextDocument::getSearchIndex() {
+	return *mSearchIndex;
+}
+
 TextPosition TextDocument::replace( String search, const String& replace, TextPosition from,
 									const bool& caseSensitive, const bool& wholeWord,
 									const FindReplaceType& type, TextRange restrictRange ) {
@@ -1912,6 +1883,7 @@ void TextDocument::setPageSize( const Uint32& pageSize ) {
 
 void TextDocument::cleanChangeId() {
 	mCleanChangeId = getCurrentChangeId();
+	mUndoStack.setMergeBarrier();
 }
 
 TextPosition TextDocument::findOpenBracket( TextPosition startPosition,
@@ -1993,6 +1965,7 @@ void TextDocument::setNonWordChars( const String& nonWordChars ) {
 }
 
 void TextDocument::notifyTextChanged( const DocumentContentChange& change ) {
+	mSearchIndex->onTextChanged( change );
 	Lock l( mClientsMutex );
 	for ( auto& client : mClients ) {
 		client->onDocumentTextChanged( change );
@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <iterator>
+#include <eepp/system/luapattern.hpp>
+#include <eepp/ui/doc/textsearchindex.hpp>
+
+namespace EE { namespace UI { namespace Doc {
+
+// Maximum number of unscanned lines between the scanned window of a query and the requested lines
+// to extend the window instead of starting a new one.
+static const Int64 MAX_WINDOW_GAP = 1024;
+
+static bool startsBeforeLine( const TextRange& range, const Int64& line ) {
+	return range.start().line() < line;
+}
+
+static bool lineBeforeStart( const Int64& line, const TextRange& range ) {
+	return line < range.start().line();
+}
+
+static void shiftLines( std::vector<TextRange>::iterator begin,
+						std::vector<TextRange>::iterator end, const Int64& delta ) {
+	if ( delta == 0 )
+		return;
+	for ( auto it = begin; it != end; ++it ) {
+		it->start().setLine( it->start().line() + delta );
+		it->end().setLine( it->end().line() + delta );
+	}
+}
+
+bool TextSearchIndex::isIndexable( const Query& query ) {
+	return !query.text.empty() && query.text.find( '\n' ) == String::InvalidPos;
+}
+
+TextSearchIndex::TextSearchIndex( TextDocument* doc ) :
+	mDoc( doc ), mLineCount( doc->linesCount() ) {}
+
+std::vector<TextRange> TextSearchIndex::getMatches( Query query, Int64 fromLine, Int64 toLine ) {
+	std::vector<TextRange> matches;
+	if ( !isIndexable( query ) )
+		return matches;
+
+	// The document was loaded or modified without notifying the change.
+	if ( mLineCount != (Int64)mDoc->linesCount() )
+		invalidate();
+
+	Int64 lastLine = mLineCount - 1;
+	if ( toLine < 0 || toLine > lastLine )
+		toLine = lastLine;
+	fromLine = eemax<Int64>( 0, fromLine );
+	if ( fromLine > toLine )
+		return matches;
+
+	if ( !query.caseSensitive )
+		query.text.toLower();
+
+	Entry& entry = getEntry( query );
+	scanWindow( entry, fromLine, toLine );
+
+	auto begin = std::lower_bound( entry.matches.begin(), entry.matches.end(), fromLine,
+								   startsBeforeLine );
+	auto end = std::upper_bound( begin, entry.matches.end(), toLine, lineBeforeStart );
+	matches.assign( begin, end );
+	return matches;
+}
+
+std::pair<size_t, size_t> TextSearchIndex::findInLine( const Query& query, const Int64& line,
+													   size_t startCol, size_t endCol ) {
+	const String& str = getLineText( query, line );
+	if ( endCol > str.size() )
+		endCol = str.size();
+	if ( startCol >= endCol )
+		return { String::StringType::npos, String::StringType::npos };
+
+	switch ( query.type ) {
+		case TextDocument::FindReplaceType::LuaPattern: {
+			LuaPattern pattern( query.text );
+			int start, end = 0;
+			std::string utf8( ( startCol > 0 || endCol < str.size() )
+								  ? str.substr( startCol, endCol - startCol ).toUtf8()
+								  : str.toUtf8() );
+			if ( pattern.find( utf8, start, end ) && start >= 0 && end > start &&
+				 ( !query.wholeWord ||
+				   String::isWholeWord( str, query.text, startCol + start ) ) )
+				return { startCol + start, startCol + end };
+			break;
+		}
+		case TextDocument::FindReplaceType::Normal:
+		default: {
+			size_t pos = startCol;
+			while ( ( pos = str.find( query.text, pos ) ) != String::InvalidPos ) {
+				size_t end = pos + query.text.size();
+				if ( end > endCol )
+					break;
+				if ( !query.wholeWord || String::isWholeWord( str, query.text, pos ) )
+					return { pos, end };
+				pos++;
+			}
+			break;
+		}
+	}
+
+	return { String::StringType::npos, String::StringType::npos };
+}
+
+std::pair<size_t, size_t> TextSearchIndex::findLastInLine( const Query& query, const Int64& line,
+														   size_t startCol, size_t endCol ) {
+	const String& str = getLineText( query, line );
+	if ( endCol > str.size() )
+		endCol = str.size();
+	if ( startCol >= endCol )
+		return { String::StringType::npos, String::StringType::npos };
+
+	switch ( query.type ) {
+		case TextDocument::FindReplaceType::LuaPattern: {
+			std::pair<size_t, size_t> last{ String::StringType::npos,
+											String::StringType::npos };
+			std::pair<size_t, size_t> col;
+			while ( startCol < endCol &&
+					( col = findInLine( query, line, startCol, endCol ) ).first !=
+						String::StringType::npos ) {
+				last = col;
+				startCol = col.second;
+			}
+			return last;
+		}
+		case TextDocument::FindReplaceType::Normal:
+		default: {
+			if ( query.text.size() > endCol - startCol )
+				break;
+			size_t pos = endCol - query.text.size();
+			while ( ( pos = str.rfind( query.text, pos ) ) != String::InvalidPos &&
+					pos >= startCol ) {
+				if ( !query.wholeWord || String::isWholeWord( str, query.text, pos ) )
+					return { pos, pos + query.text.size() };
+				if ( pos == 0 )
+					break;
+				pos--;
+			}
+			break;
+		}
+	}
+
+	return { String::StringType::npos, String::StringType::npos };
+}
+
+const String& TextSearchIndex::getFoldedLine( const Int64& index ) {
+	if ( mFoldedLines.size() != mDoc->linesCount() ) {
+		mFoldedLines.clear();
+		mFoldedLines.resize( mDoc->linesCount() );
+	}
+	FoldedLine& folded = mFoldedLines[index];
+	const TextDocumentLine& line = mDoc->line( index );
+	if ( !folded.valid || folded.hash != line.getHash() ) {
+		folded.text = String::toLower( line.getText() );
+		folded.hash = line.getHash();
+		folded.valid = true;
+	}
+	return folded.text;
+}
+
+void TextSearchIndex::onTextChanged( const DocumentContentChange& change ) {
+	Int64 oldLineCount = mLineCount;
+	mLineCount = mDoc->linesCount();
+	Int64 delta = mLineCount - oldLineCount;
+
+	if ( mEntries.empty() && mFoldedLines.empty() )
+		return;
+
+	// The lines between start and oldLast were replaced by the lines between start and newLast.
+	TextRange range( change.range.normalized() );
+	Int64 start = range.start().line();
+	Int64 oldLast = change.text.empty() ? range.end().line() : start;
+	Int64 newLast = oldLast + delta;
+
+	if ( !range.isValid() || start < 0 || oldLast >= oldLineCount || newLast < start ||
+		 newLast >= mLineCount ) {
+		invalidate();
+		return;
+	}
+
+	if ( !mFoldedLines.empty() ) {
+		if ( (Int64)mFoldedLines.size() != oldLineCount ) {
+			mFoldedLines.clear();
+		} else {
+			if ( delta > 0 ) {
+				std::vector<FoldedLine> added( delta );
+				mFoldedLines.insert( mFoldedLines.begin() + start + 1,
+									 std::make_move_iterator( added.begin() ),
+									 std::make_move_iterator( added.end() ) );
+			} else if ( delta < 0 ) {
+				mFoldedLines.erase( mFoldedLines.begin() + start + 1,
+									mFoldedLines.begin() + start + 1 - delta );
+			}
+			for ( Int64 i = start; i <= newLast; i++ )
+				mFoldedLines[i].valid = false;
+		}
+	}
+
+	for ( auto& entry : mEntries ) {
+		if ( entry.toLine < entry.fromLine || start > entry.toLine )
+			continue;
+
+		if ( oldLast < entry.fromLine ) {
+			entry.fromLine += delta;
+			entry.toLine += delta;
+			shiftLines( entry.matches.begin(), entry.matches.end(), delta );
+			continue;
+		}
+
+		std::vector<TextRange> scanned;
+		scanLines( entry.query, start, newLast, scanned );
+
+		auto first = std::lower_bound( entry.matches.begin(), entry.matches.end(), start,
+									   startsBeforeLine );
+		auto last = std::upper_bound( first, entry.matches.end(), oldLast, lineBeforeStart );
+		shiftLines( last, entry.matches.end(), delta );
+		first = entry.matches.erase( first, last );
+		entry.matches.insert( first, scanned.begin(), scanned.end() );
+
+		entry.fromLine = eemin( entry.fromLine, start );
+		entry.toLine = eemax( entry.toLine, oldLast ) + delta;
+	}
+}
+
+void TextSearchIndex::invalidate() {
+	mEntries.clear();
+	mFoldedLines.clear();
+	mLineCount = mDoc->linesCount();
+}
+
+void TextSearchIndex::setMaxCachedQueries( const size_t& maxCachedQueries ) {
+	mMaxCachedQueries = eemax<size_t>( 1, maxCachedQueries );
+	while ( mEntries.size() > mMaxCachedQueries ) {
+		auto oldest = std::min_element(
+			mEntries.begin(), mEntries.end(),
+			[]( const Entry& a, const Entry& b ) { return a.lastUse < b.lastUse; } );
+		mEntries.erase( oldest );
+	}
+}
+
+const size_t& TextSearchIndex::getMaxCachedQueries() const {
+	return mMaxCachedQueries;
+}
+
+size_t TextSearchIndex::getCachedQueriesCount() const {
+	return mEntries.size();
+}
+
+TextSearchIndex::Entry& TextSearchIndex::getEntry( const Query& query ) {
+	mUseCount++;
+
+	for ( auto& entry : mEntries ) {
+		if ( entry.query == query ) {
+			entry.lastUse = mUseCount;
+			return entry;
+		}
+	}
+
+	if ( mEntries.size() >= mMaxCachedQueries ) {
+		auto oldest = std::min_element(
+			mEntries.begin(), mEntries.end(),
+			[]( const Entry& a, const Entry& b ) { return a.lastUse < b.lastUse; } );
+		mEntries.erase( oldest );
+	}
+
+	// Entries are never moved by a reallocation, their matches would be copied.
+	mEntries.reserve( mMaxCachedQueries );
+	Entry entry;
+	entry.query = query;
+	entry.lastUse = mUseCount;
+	mEntries.emplace_back( std::move( entry ) );
+	return mEntries.back();
+}
+
+const String& TextSearchIndex::getLineText( const Query& query, const Int64& line ) {
+	return query.caseSensitive ? mDoc->line( line ).getText() : getFoldedLine( line );
+}
+
+void TextSearchIndex::scanLines( const Query& query, Int64 fromLine, Int64 toLine,
+								 std::vector<TextRange>& matches ) {
+	for ( Int64 i = fromLine; i <= toLine; i++ ) {
+		size_t lineSize = getLineText( query, i ).size();
+		size_t startCol = 0;
+		std::pair<size_t, size_t> col;
+		while ( startCol < lineSize && ( col = findInLine( query, i, startCol ) ).first !=
+											   String::StringType::npos ) {
+			TextRange range( { i, (Int64)col.first }, { i, (Int64)col.second } );
+			// Same as TextDocument::find, a match that includes the line break ends in the next
+			// line.
+			if ( col.second == lineSize )
+				range.setEnd( mDoc->positionOffset( range.end(), 1 ) );
+			matches.emplace_back( range );
+			startCol = col.second;
+		}
+	}
+}
+
+void TextSearchIndex::scanWindow( Entry& entry, Int64 fromLine, Int64 toLine ) {
+	if ( entry.toLine < entry.fromLine || toLine < entry.fromLine - MAX_WINDOW_GAP ||
+		 fromLine > entry.toLine + MAX_WINDOW_GAP ) {
+		entry.matches.clear();
+		scanLines( entry.query, fromLine, toLine, entry.matches );
+		entry.fromLine = fromLine;
+		entry.toLine = toLine;
+		return;
+	}
+
+	if ( fromLine < entry.fromLine ) {
+		std::vector<TextRange> head;
+		scanLines( entry.query, fromLine, entry.fromLine - 1, head );
+		entry.matches.insert( entry.matches.begin(), head.begin(), head.end() );
+		entry.fromLine = fromLine;
+	}
+
+	if ( toLine > entry.toLine ) {
+		scanLines( entry.query, entry.toLine + 1, toLine, entry.matches );
+		entry.toLine = toLine;
+	}
+}
+
+}}} // namespace EE::UI::Doc
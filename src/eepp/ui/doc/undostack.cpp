@@ -1,4 +1,6 @@
+#include <cstring>
 #include <eepp/core/core.hpp>
+#include <eepp/system/filesystem.hpp>
 #include <eepp/ui/doc/textdocument.hpp>
 #include <eepp/ui/doc/undostack.hpp>
 
@@ -6,59 +8,279 @@ using namespace EE::System;
 
 namespace EE { namespace UI { namespace Doc {
 
-TextUndoCommand::TextUndoCommand( const Uint64& id, const TextUndoCommandType& type,
-								  const Time& timestamp ) :
-	mId( id ), mType( type ), mTimestamp( timestamp ) {}
+// Minimum amount of history moved to disk at once, as a fraction of the memory limit
+static constexpr size_t SPILL_CHUNK_DIVISOR = 4;
 
-TextUndoCommand::~TextUndoCommand() {}
+// Once the consumed front of the journal reaches this size it's discarded
+static constexpr size_t COMPACT_MIN_BYTES = 64 * 1024;
 
-const Uint64& TextUndoCommand::getId() const {
-	return mId;
+static size_t utf8Length( const std::string& text ) {
+	size_t length = 0;
+	for ( const char& ch : text )
+		if ( ( static_cast<Uint8>( ch ) & 0xC0 ) != 0x80 )
+			length++;
+	return length;
 }
 
-const TextUndoCommandType& TextUndoCommand::getType() const {
-	return mType;
+TextUndoJournal::TextUndoJournal( const size_t& maxMemory ) : mMaxMemory( maxMemory ) {}
+
+TextUndoJournal::~TextUndoJournal() {
+	closeSpillFile();
+}
+
+bool TextUndoJournal::empty() const {
+	return 0 == mCount && 0 == mSpillCount;
+}
+
+size_t TextUndoJournal::size() const {
+	return mCount + mSpillCount;
+}
+
+size_t TextUndoJournal::getMemoryUsage() const {
+	return mData.size() - mBegin;
+}
+
+const size_t& TextUndoJournal::getMaxMemory() const {
+	return mMaxMemory;
+}
+
+void TextUndoJournal::setMaxMemory( const size_t& maxMemory ) {
+	mMaxMemory = maxMemory;
+	trim();
+}
+
+void TextUndoJournal::setSpillPath( const std::string& path ) {
+	if ( path == mSpillPath )
+		return;
+
+	closeSpillFile();
+	mSpillPath = path;
+	trim();
+}
+
+const std::string& TextUndoJournal::getSpillPath() const {
+	return mSpillPath;
+}
+
+void TextUndoJournal::push( const TextUndoCommand& cmd ) {
+	Header header;
+	header.id = cmd.id;
+	header.timestamp = cmd.timestamp.asMicroseconds();
+	header.startTimestamp = cmd.startTimestamp.asMicroseconds();
+	header.startLine = cmd.range.start().line();
+	header.startColumn = cmd.range.start().column();
+	header.endLine = cmd.range.end().line();
+	header.endColumn = cmd.range.end().column();
+	header.textSize = static_cast<Uint32>( cmd.text.size() );
+	header.type = static_cast<Uint32>( cmd.type );
+
+	Uint32 recordSize =
+		static_cast<Uint32>( sizeof( Header ) + cmd.text.size() + sizeof( Uint32 ) );
+	size_t offset = mData.size();
+
+	mData.resize( offset + recordSize );
+	memcpy( &mData[offset], &header, sizeof( Header ) );
+	if ( !cmd.text.empty() )
+		memcpy( &mData[offset + sizeof( Header )], cmd.text.data(), cmd.text.size() );
+	memcpy( &mData[offset + recordSize - sizeof( Uint32 )], &recordSize, sizeof( Uint32 ) );
+
+	mCount++;
+	mBackId.store( cmd.id, std::memory_order_relaxed );
+
+	trim();
+}
+
+bool TextUndoJournal::backHeader( Header& header, size_t& offset ) {
+	if ( 0 == mCount && !unspill() )
+		return false;
+
+	Uint32 recordSize;
+	memcpy( &recordSize, &mData[mData.size() - sizeof( Uint32 )], sizeof( Uint32 ) );
+	offset = mData.size() - recordSize;
+	memcpy( &header, &mData[offset], sizeof( Header ) );
+	return true;
+}
+
+bool TextUndoJournal::back( TextUndoCommand& cmd ) {
+	Header header;
+	size_t offset;
+
+	if ( !backHeader( header, offset ) )
+		return false;
+
+	cmd.id = header.id;
+	cmd.type = static_cast<TextUndoCommandType>( header.type );
+	cmd.timestamp = Microseconds( header.timestamp );
+	cmd.startTimestamp = Microseconds( header.startTimestamp );
+	cmd.range = TextRange( { header.startLine, header.startColumn },
+						   { header.endLine, header.endColumn } );
+	cmd.text.assign( reinterpret_cast<const char*>( &mData[offset + sizeof( Header )] ),
+					 header.textSize );
+	return true;
 }
 
-const Time& TextUndoCommand::getTimestamp() const {
-	return mTimestamp;
+Uint64 TextUndoJournal::backId() const {
+	return mBackId.load( std::memory_order_relaxed );
 }
 
-TextUndoCommandInsert::TextUndoCommandInsert( const Uint64& id, const String& text,
-											  const TextPosition& position,
-											  const Time& timestamp ) :
-	TextUndoCommand( id, TextUndoCommandType::Insert, timestamp ),
-	mText( text ),
-	mPosition( position ) {}
+void TextUndoJournal::updateBackId() {
+	Uint64 id = 0;
+
+	if ( mCount > 0 ) {
+		Header header;
+		Uint32 recordSize;
+		memcpy( &recordSize, &mData[mData.size() - sizeof( Uint32 )], sizeof( Uint32 ) );
+		memcpy( &header, &mData[mData.size() - recordSize], sizeof( Header ) );
+		id = header.id;
+	} else if ( !mSpillChunks.empty() ) {
+		id = mSpillChunks.back().backId;
+	}
+
+	mBackId.store( id, std::memory_order_relaxed );
+}
+
+void TextUndoJournal::pop() {
+	Header header;
+	size_t offset;
+
+	if ( !backHeader( header, offset ) )
+		return;
+
+	mData.resize( offset );
+	mCount--;
+
+	if ( 0 == mCount ) {
+		mData.clear();
+		mBegin = 0;
+	}
+
+	updateBackId();
+}
+
+void TextUndoJournal::clear() {
+	if ( mData.empty() && mSpillChunks.empty() )
+		return;
+
+	mData.clear();
+	if ( mData.capacity() > mMaxMemory / SPILL_CHUNK_DIVISOR )
+		mData.shrink_to_fit();
+	mBegin = 0;
+	mCount = 0;
+	mSpillChunks.clear();
+	mSpillSize = 0;
+	mSpillCount = 0;
+	mBackId.store( 0, std::memory_order_relaxed );
+}
+
+void TextUndoJournal::trim() {
+	if ( getMemoryUsage() <= mMaxMemory || mCount <= 1 )
+		return;
+
+	// Spill more than strictly needed so the disk is not touched on every new record
+	if ( mSpillPath.empty() ||
+		 !spill( eemax( getMemoryUsage() - mMaxMemory, mMaxMemory / SPILL_CHUNK_DIVISOR ) ) ) {
+		while ( getMemoryUsage() > mMaxMemory && mCount > 1 ) {
+			Header header;
+			memcpy( &header, &mData[mBegin], sizeof( Header ) );
+			mBegin += sizeof( Header ) + header.textSize + sizeof( Uint32 );
+			mCount--;
+		}
+	}
 
-const String& TextUndoCommandInsert::getText() const {
-	return mText;
+	if ( mBegin >= COMPACT_MIN_BYTES && mBegin >= mData.size() / 2 ) {
+		mData.erase( mData.begin(), mData.begin() + mBegin );
+		mBegin = 0;
+	}
 }
 
-const TextPosition& TextUndoCommandInsert::getPosition() const {
-	return mPosition;
+bool TextUndoJournal::spill( const size_t& bytes ) {
+	if ( !mSpillFile ) {
+		mSpillFile = std::make_unique<IOStreamFile>( mSpillPath, "w+b" );
+
+		if ( !mSpillFile->isOpen() ) {
+			mSpillFile.reset();
+			return false;
+		}
+	}
+
+	size_t size = 0;
+	size_t count = 0;
+	Uint64 lastId = 0;
+
+	// Always keep the top record in memory
+	while ( size < bytes && count + 1 < mCount ) {
+		Header header;
+		memcpy( &header, &mData[mBegin + size], sizeof( Header ) );
+		size += sizeof( Header ) + header.textSize + sizeof( Uint32 );
+		lastId = header.id;
+		count++;
+	}
+
+	if ( 0 == count )
+		return false;
+
+	mSpillFile->seek( mSpillSize );
+
+	if ( mSpillFile->write( reinterpret_cast<const char*>( &mData[mBegin] ), size ) !=
+		 static_cast<ios_size>( size ) )
+		return false;
+
+	mSpillChunks.push_back( { size, count, lastId } );
+	mSpillSize += size;
+	mSpillCount += count;
+	mBegin += size;
+	mCount -= count;
+	return true;
 }
 
-TextUndoCommandRemove::TextUndoCommandRemove( const Uint64& id, const TextRange& range,
-											  const Time& timestamp ) :
-	TextUndoCommand( id, TextUndoCommandType::Remove, timestamp ), mRange( range ) {}
+bool TextUndoJournal::unspill() {
+	if ( mSpillChunks.empty() || !mSpillFile )
+		return false;
+
+	SpillChunk chunk = mSpillChunks.back();
+	mSpillChunks.pop_back();
+	mSpillSize -= chunk.size;
+	mSpillCount -= chunk.count;
+
+	mData.resize( chunk.size );
+	mBegin = 0;
+	mSpillFile->seek( mSpillSize );
+
+	if ( mSpillFile->read( reinterpret_cast<char*>( &mData[0] ), chunk.size ) !=
+		 static_cast<ios_size>( chunk.size ) ) {
+		// The history can't be recovered
+		mData.clear();
+		mSpillChunks.clear();
+		mSpillSize = 0;
+		mSpillCount = 0;
+		mBackId.store( 0, std::memory_order_relaxed );
+		return false;
+	}
 
-const TextRange& TextUndoCommandRemove::getRange() const {
-	return mRange;
+	mCount = chunk.count;
+	return true;
 }
 
-TextUndoCommandSelection::TextUndoCommandSelection( const Uint64& id, const TextRange& selection,
-													const Time& timestamp ) :
-	TextUndoCommand( id, TextUndoCommandType::Selection, timestamp ), mSelection( selection ) {}
+void TextUndoJournal::closeSpillFile() {
+	mSpillChunks.clear();
+	mSpillSize = 0;
+	mSpillCount = 0;
 
-const TextRange& TextUndoCommandSelection::getSelection() const {
-	return mSelection;
+	if ( mSpillFile ) {
+		mSpillFile.reset();
+		FileSystem::fileRemove( mSpillPath );
+	}
+
+	updateBackId();
 }
 
-UndoStack::UndoStack( TextDocument* owner, const Uint32& maxStackSize ) :
+UndoStack::UndoStack( TextDocument* owner, const size_t& maxMemory ) :
 	mDoc( owner ),
-	mMaxStackSize( maxStackSize ),
+	mMaxMemory( maxMemory ),
 	mChangeIdCounter( 0 ),
+	mMergeBarrierId( 0 ),
+	mUndoStack( maxMemory ),
+	mRedoStack( maxMemory ),
 	mMergeTimeout( Milliseconds( 300.f ) ) {}
 
 UndoStack::~UndoStack() {
@@ -71,77 +293,135 @@ void UndoStack::clear() {
 }
 
 void UndoStack::clearUndoStack() {
-	for ( TextUndoCommand* cmd : mUndoStack ) {
-		eeDelete( cmd );
-	}
 	mUndoStack.clear();
 }
 
 void UndoStack::clearRedoStack() {
-	for ( TextUndoCommand* cmd : mRedoStack ) {
-		eeDelete( cmd );
-	}
 	mRedoStack.clear();
 }
 
-void UndoStack::pushUndo( UndoStackContainer& undoStack, TextUndoCommand* cmd ) {
-	undoStack.push_back( cmd );
-	while ( undoStack.size() > mMaxStackSize ) {
-		eeDelete( undoStack.front() );
-		undoStack.pop_front();
+bool UndoStack::tryMerge( UndoStackContainer& undoStack, const TextUndoCommand& cmd ) {
+	// Only the edits done by the user are merged, not the ones done while undoing or redoing
+	if ( &undoStack != &mUndoStack || !mRedoStack.empty() || undoStack.mCount < 3 )
+		return false;
+
+	// Every edit pushes the selection before the edit and the edit itself. Consecutive edits are
+	// merged into the previous edit record, dropping the intermediate selection.
+	TextUndoCommand selection;
+	if ( !undoStack.back( selection ) || selection.type != TextUndoCommandType::Selection )
+		return false;
+
+	undoStack.pop();
+
+	TextUndoCommand prev;
+	bool merged = false;
+
+	if ( undoStack.back( prev ) && prev.type == cmd.type && prev.id != mMergeBarrierId &&
+		 cmd.timestamp >= prev.timestamp &&
+		 ( cmd.timestamp - prev.timestamp ).asMicroseconds() < mMergeTimeout.asMicroseconds() ) {
+		if ( cmd.type == TextUndoCommandType::Remove ) {
+			// Typing: the new text starts where the previous one ends
+			if ( prev.range.end() == cmd.range.start() ) {
+				prev.range.setEnd( cmd.range.end() );
+				merged = true;
+			}
+		} else if ( cmd.type == TextUndoCommandType::Insert &&
+					cmd.text.find( '\n' ) == std::string::npos &&
+					prev.text.find( '\n' ) == std::string::npos ) {
+			const TextPosition& pos = cmd.range.start();
+			if ( pos == prev.range.start() ) {
+				// Forward deletion
+				prev.text += cmd.text;
+				merged = true;
+			} else if ( pos.line() == prev.range.start().line() &&
+						pos.column() + static_cast<Int64>( utf8Length( cmd.text ) ) ==
+							prev.range.start().column() ) {
+				// Backward deletion
+				prev.text = cmd.text + prev.text;
+				prev.range = TextRange( pos, pos );
+				merged = true;
+			}
+		}
 	}
+
+	if ( !merged ) {
+		undoStack.push( selection );
+		return false;
+	}
+
+	prev.id = cmd.id;
+	prev.timestamp = cmd.timestamp;
+	undoStack.pop();
+	undoStack.push( prev );
+	return true;
 }
 
 void UndoStack::pushInsert( UndoStackContainer& undoStack, const String& string,
 							const TextPosition& position, const Time& time ) {
-	pushUndo( undoStack,
-			  eeNew( TextUndoCommandInsert, ( ++mChangeIdCounter, string, position, time ) ) );
+	TextUndoCommand cmd;
+	cmd.id = ++mChangeIdCounter;
+	cmd.type = TextUndoCommandType::Insert;
+	cmd.timestamp = cmd.startTimestamp = time;
+	cmd.range = TextRange( position, position );
+	cmd.text = string.toUtf8();
+	if ( !tryMerge( undoStack, cmd ) )
+		undoStack.push( cmd );
 }
 
 void UndoStack::pushRemove( UndoStackContainer& undoStack, const TextRange& range,
 							const Time& time ) {
-	pushUndo( undoStack, eeNew( TextUndoCommandRemove, ( ++mChangeIdCounter, range, time ) ) );
+	TextUndoCommand cmd;
+	cmd.id = ++mChangeIdCounter;
+	cmd.type = TextUndoCommandType::Remove;
+	cmd.timestamp = cmd.startTimestamp = time;
+	cmd.range = range;
+	if ( !tryMerge( undoStack, cmd ) )
+		undoStack.push( cmd );
 }
 
 void UndoStack::pushSelection( UndoStackContainer& undoStack, const TextRange& selection,
 							   const Time& time ) {
-	pushUndo( undoStack,
-			  eeNew( TextUndoCommandSelection, ( ++mChangeIdCounter, selection, time ) ) );
+	TextUndoCommand cmd;
+	cmd.id = ++mChangeIdCounter;
+	cmd.type = TextUndoCommandType::Selection;
+	cmd.timestamp = cmd.startTimestamp = time;
+	cmd.range = selection;
+	undoStack.push( cmd );
 }
 
-void UndoStack::popUndo( UndoStackContainer& undoStack, UndoStackContainer& redoStack ) {
-	if ( undoStack.empty() )
-		return;
-
-	TextUndoCommand* cmd = undoStack.back();
-	Time lastTimestamp = cmd->getTimestamp();
-	undoStack.pop_back();
+void UndoStack::setMergeBarrier() {
+	mMergeBarrierId = getCurrentChangeId();
+}
 
-	switch ( cmd->getType() ) {
-		case TextUndoCommandType::Insert: {
-			TextUndoCommandInsert* insert = static_cast<TextUndoCommandInsert*>( cmd );
-			mDoc->insert( insert->getPosition(), insert->getText(), redoStack,
-						  cmd->getTimestamp() );
-			break;
-		}
-		case TextUndoCommandType::Remove: {
-			TextUndoCommandRemove* remove = static_cast<TextUndoCommandRemove*>( cmd );
-			mDoc->remove( remove->getRange(), redoStack, cmd->getTimestamp() );
-			break;
-		}
-		case TextUndoCommandType::Selection: {
-			TextUndoCommandSelection* selection = static_cast<TextUndoCommandSelection*>( cmd );
-			mDoc->setSelection( selection->getSelection() );
-			break;
+void UndoStack::popUndo( UndoStackContainer& undoStack, UndoStackContainer& redoStack ) {
+	TextUndoCommand cmd;
+	TextUndoJournal::Header next;
+	size_t offset;
+
+	// Pops all the records done within the merge timeout of each other
+	while ( undoStack.back( cmd ) ) {
+		undoStack.pop();
+
+		switch ( cmd.type ) {
+			case TextUndoCommandType::Insert: {
+				mDoc->insert( cmd.range.start(), String::fromUtf8( cmd.text ), redoStack,
+							  cmd.timestamp );
+				break;
+			}
+			case TextUndoCommandType::Remove: {
+				mDoc->remove( cmd.range, redoStack, cmd.timestamp );
+				break;
+			}
+			case TextUndoCommandType::Selection: {
+				mDoc->setSelection( cmd.range );
+				break;
+			}
 		}
-	}
 
-	eeSAFE_DELETE( cmd );
-
-	if ( !undoStack.empty() &&
-		 eeabs( ( lastTimestamp - undoStack.back()->getTimestamp() ).asMilliseconds() ) <
-			 mMergeTimeout.asMilliseconds() ) {
-		popUndo( undoStack, redoStack );
+		if ( !undoStack.backHeader( next, offset ) ||
+			 eeabs( cmd.startTimestamp.asMicroseconds() - next.timestamp ) >=
+				 mMergeTimeout.asMicroseconds() )
+			break;
 	}
 }
 
@@ -161,8 +441,26 @@ bool UndoStack::hasRedo() const {
 	return !mRedoStack.empty();
 }
 
-const Uint32& UndoStack::getMaxStackSize() const {
-	return mMaxStackSize;
+const size_t& UndoStack::getMaxMemory() const {
+	return mMaxMemory;
+}
+
+void UndoStack::setMaxMemory( const size_t& maxMemory ) {
+	mMaxMemory = maxMemory;
+	mUndoStack.setMaxMemory( maxMemory );
+	mRedoStack.setMaxMemory( maxMemory );
+}
+
+size_t UndoStack::getMemoryUsage() const {
+	return mUndoStack.getMemoryUsage() + mRedoStack.getMemoryUsage();
+}
+
+void UndoStack::setSpillPath( const std::string& path ) {
+	mUndoStack.setSpillPath( path );
+}
+
+const std::string& UndoStack::getSpillPath() const {
+	return mUndoStack.getSpillPath();
 }
 
 const Time& UndoStack::getMergeTimeout() const {
@@ -174,9 +472,7 @@ void UndoStack::setMergeTimeout( const Time& mergeTimeout ) {
 }
 
 Uint64 UndoStack::getCurrentChangeId() const {
-	if ( mUndoStack.empty() )
-		return 0;
-	return mUndoStack.back()->getId();
+	return mUndoStack.backId();
 }
 
 UndoStackContainer& UndoStack::getUndoStackContainer() {
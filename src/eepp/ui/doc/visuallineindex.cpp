@@ -0,0 +1,374 @@
+#include <eepp/ui/doc/visuallineindex.hpp>
+
+namespace EE { namespace UI { namespace Doc {
+
+// Lines per block, blocks are split at twice this size and merged below a quarter of it
+static constexpr Int64 BLOCK_SIZE = 512;
+
+namespace {
+
+void treeAdd( std::vector<Int64>& tree, size_t index, const Int64& delta ) {
+	for ( size_t i = index + 1; i < tree.size(); i += i & ( ~i + 1 ) )
+		tree[i] += delta;
+}
+
+/** @return The sum of the first count blocks. */
+Int64 treePrefix( const std::vector<Int64>& tree, size_t count ) {
+	Int64 sum = 0;
+	for ( size_t i = count; i > 0; i -= i & ( ~i + 1 ) )
+		sum += tree[i];
+	return sum;
+}
+
+/** @return The number of leading blocks whose sum is not greater than value, value is left with
+ * the remainder. */
+size_t treeFind( const std::vector<Int64>& tree, const size_t& highBit, Int64& value ) {
+	size_t index = 0;
+	for ( size_t step = highBit; step > 0; step >>= 1 ) {
+		if ( index + step < tree.size() && tree[index + step] <= value ) {
+			index += step;
+			value -= tree[index];
+		}
+	}
+	return index;
+}
+
+} // namespace
+
+void VisualLineIndex::reset( const Int64& lineCount ) {
+	mBlocks.clear();
+	for ( Int64 line = 0; line < lineCount; line += BLOCK_SIZE ) {
+		Block block;
+		block.lines = eemin( BLOCK_SIZE, lineCount - line );
+		block.rows = block.unmeasured = block.lines;
+		mBlocks.emplace_back( std::move( block ) );
+	}
+	build();
+}
+
+void VisualLineIndex::invalidate() {
+	for ( auto& block : mBlocks ) {
+		block.lineRows.clear();
+		block.rows = block.unmeasured = block.lines;
+	}
+	build();
+}
+
+const Int64& VisualLineIndex::getLineCount() const {
+	return mLineCount;
+}
+
+const Int64& VisualLineIndex::getRowCount() const {
+	return mRowCount;
+}
+
+const Int64& VisualLineIndex::getUnmeasuredCount() const {
+	return mUnmeasuredCount;
+}
+
+bool VisualLineIndex::isLineMeasured( const Int64& line ) const {
+	if ( line < 0 || line >= mLineCount )
+		return false;
+	Int64 offset;
+	const Block& block = mBlocks[findBlock( line, offset )];
+	return !block.lineRows.empty() && block.lineRows[offset] != 0;
+}
+
+Int64 VisualLineIndex::getLineRows( const Int64& line ) const {
+	if ( line < 0 || line >= mLineCount )
+		return 1;
+	Int64 offset;
+	const Block& block = mBlocks[findBlock( line, offset )];
+	return block.lineRows.empty() ? 1 : eemax<Int64>( 1, block.lineRows[offset] );
+}
+
+void VisualLineIndex::setLineRows( const Int64& line, const Int64& rows ) {
+	if ( line < 0 || line >= mLineCount )
+		return;
+	Int64 offset;
+	size_t index = findBlock( line, offset );
+	Block& block = mBlocks[index];
+	if ( block.lineRows.empty() )
+		block.lineRows.assign( block.lines, 0 );
+	Uint32& lineRows = block.lineRows[offset];
+	Uint32 newRows = eeclamp<Int64>( rows, 1, 0xFFFFFFFF );
+	if ( lineRows == 0 ) {
+		block.unmeasured--;
+		mUnmeasuredCount--;
+	}
+	Int64 delta = (Int64)newRows - eemax<Int64>( 1, lineRows );
+	lineRows = newRows;
+	if ( delta != 0 )
+		updateBlock( index, 0, delta );
+}
+
+void VisualLineIndex::invalidateLine( const Int64& line ) {
+	if ( line < 0 || line >= mLineCount )
+		return;
+	Int64 offset;
+	size_t index = findBlock( line, offset );
+	Block& block = mBlocks[index];
+	if ( block.lineRows.empty() || block.lineRows[offset] == 0 )
+		return;
+	Int64 delta = 1 - (Int64)block.lineRows[offset];
+	block.lineRows[offset] = 0;
+	block.unmeasured++;
+	mUnmeasuredCount++;
+	if ( delta != 0 )
+		updateBlock( index, 0, delta );
+}
+
+void VisualLineIndex::insertLines( const Int64& line, const Int64& count ) {
+	if ( count <= 0 || line < 0 || line > mLineCount )
+		return;
+
+	if ( mBlocks.empty() ) {
+		reset( count );
+		return;
+	}
+
+	Int64 offset;
+	size_t index;
+
+	if ( line == mLineCount ) {
+		index = mBlocks.size() - 1;
+		offset = mBlocks[index].lines;
+	} else {
+		index = findBlock( line, offset );
+	}
+
+	Block& block = mBlocks[index];
+	if ( !block.lineRows.empty() )
+		block.lineRows.insert( block.lineRows.begin() + offset, count, 0 );
+	block.unmeasured += count;
+	mUnmeasuredCount += count;
+
+	if ( block.lines + count > BLOCK_SIZE * 2 ) {
+		block.lines += count;
+		block.rows += count;
+		splitBlock( index );
+		build();
+	} else {
+		updateBlock( index, count, count );
+	}
+}
+
+void VisualLineIndex::removeLines( const Int64& line, const Int64& count ) {
+	if ( count <= 0 || line < 0 || line + count > mLineCount )
+		return;
+
+	Int64 offset;
+	size_t index = findBlock( line, offset );
+	Int64 remaining = count;
+	Int64 removedRows = 0;
+	size_t first = index;
+	size_t touched = 0;
+
+	while ( remaining > 0 ) {
+		Block& block = mBlocks[index];
+		Int64 lines = eemin( remaining, block.lines - offset );
+		Int64 rows = lines;
+		Int64 unmeasured = lines;
+
+		if ( !block.lineRows.empty() ) {
+			auto begin = block.lineRows.begin() + offset;
+			rows = unmeasured = 0;
+			for ( auto it = begin; it != begin + lines; ++it ) {
+				rows += eemax<Uint32>( 1, *it );
+				unmeasured += *it == 0 ? 1 : 0;
+			}
+			block.lineRows.erase( begin, begin + lines );
+		}
+
+		block.lines -= lines;
+		block.rows -= rows;
+		block.unmeasured -= unmeasured;
+		mLineCount -= lines;
+		mRowCount -= rows;
+		mUnmeasuredCount -= unmeasured;
+		removedRows += rows;
+		remaining -= lines;
+		offset = 0;
+		touched++;
+
+		if ( block.lines == 0 ) {
+			mBlocks.erase( mBlocks.begin() + index );
+		} else {
+			index++;
+		}
+	}
+
+	// Only a block was touched and it's still large enough, the totals are already updated
+	if ( touched == 1 && index == first + 1 && mBlocks[first].lines >= BLOCK_SIZE / 4 ) {
+		treeAdd( mLineTree, first, -count );
+		treeAdd( mRowTree, first, -removedRows );
+		return;
+	}
+
+	if ( index < mBlocks.size() && mBlocks[index].lines < BLOCK_SIZE / 4 )
+		mergeBlock( index );
+
+	if ( first < mBlocks.size() && first != index && mBlocks[first].lines < BLOCK_SIZE / 4 )
+		mergeBlock( first );
+
+	build();
+}
+
+Int64 VisualLineIndex::getLineFirstRow( const Int64& line ) const {
+	if ( line <= 0 )
+		return 0;
+	if ( line >= mLineCount )
+		return mRowCount + line - mLineCount;
+	Int64 offset;
+	size_t index = findBlock( line, offset );
+	const Block& block = mBlocks[index];
+	Int64 row = treePrefix( mRowTree, index );
+	if ( block.lineRows.empty() )
+		return row + offset;
+	for ( Int64 i = 0; i < offset; i++ )
+		row += eemax<Uint32>( 1, block.lineRows[i] );
+	return row;
+}
+
+Int64 VisualLineIndex::getRowLine( const Int64& row ) const {
+	if ( mBlocks.empty() || row <= 0 )
+		return 0;
+	if ( row >= mRowCount )
+		return mLineCount - 1;
+	Int64 remaining = row;
+	size_t index = treeFind( mRowTree, mHighBit, remaining );
+	const Block& block = mBlocks[index];
+	Int64 line = treePrefix( mLineTree, index );
+	if ( block.lineRows.empty() )
+		return line + remaining;
+	for ( Int64 i = 0; i < block.lines; i++ ) {
+		remaining -= eemax<Uint32>( 1, block.lineRows[i] );
+		if ( remaining < 0 )
+			return line + i;
+	}
+	return line + block.lines - 1;
+}
+
+Int64 VisualLineIndex::findUnmeasuredLine( const Int64& line ) const {
+	if ( mUnmeasuredCount == 0 )
+		return -1;
+
+	Int64 offset = 0;
+	size_t start = line > 0 && line < mLineCount ? findBlock( line, offset ) : 0;
+
+	for ( size_t n = 0; n <= mBlocks.size(); n++ ) {
+		size_t index = ( start + n ) % mBlocks.size();
+		const Block& block = mBlocks[index];
+		// The first block is visited twice, the second time from its first line
+		Int64 from = n == 0 ? offset : 0;
+
+		if ( block.unmeasured == 0 )
+			continue;
+
+		if ( block.lineRows.empty() )
+			return treePrefix( mLineTree, index ) + from;
+
+		for ( Int64 i = from; i < block.lines; i++ )
+			if ( block.lineRows[i] == 0 )
+				return treePrefix( mLineTree, index ) + i;
+	}
+
+	return -1;
+}
+
+size_t VisualLineIndex::findBlock( const Int64& line, Int64& offset ) const {
+	offset = line;
+	return eemin( treeFind( mLineTree, mHighBit, offset ), mBlocks.size() - 1 );
+}
+
+void VisualLineIndex::updateBlock( const size_t& block, const Int64& lines, const Int64& rows ) {
+	mBlocks[block].lines += lines;
+	mBlocks[block].rows += rows;
+	mLineCount += lines;
+	mRowCount += rows;
+	if ( lines != 0 )
+		treeAdd( mLineTree, block, lines );
+	if ( rows != 0 )
+		treeAdd( mRowTree, block, rows );
+}
+
+void VisualLineIndex::splitBlock( const size_t& index ) {
+	Block block( std::move( mBlocks[index] ) );
+	std::vector<Block> blocks;
+
+	for ( Int64 line = 0; line < block.lines; line += BLOCK_SIZE ) {
+		Block part;
+		part.lines = eemin( BLOCK_SIZE, block.lines - line );
+
+		if ( block.lineRows.empty() ) {
+			part.rows = part.unmeasured = part.lines;
+		} else {
+			part.lineRows.assign( block.lineRows.begin() + line,
+								  block.lineRows.begin() + line + part.lines );
+			for ( const auto& rows : part.lineRows ) {
+				part.rows += eemax<Uint32>( 1, rows );
+				part.unmeasured += rows == 0 ? 1 : 0;
+			}
+		}
+
+		blocks.emplace_back( std::move( part ) );
+	}
+
+	mBlocks.erase( mBlocks.begin() + index );
+	mBlocks.insert( mBlocks.begin() + index, std::make_move_iterator( blocks.begin() ),
+					std::make_move_iterator( blocks.end() ) );
+}
+
+bool VisualLineIndex::mergeBlock( const size_t& index ) {
+	if ( mBlocks.size() < 2 )
+		return false;
+
+	size_t first = index + 1 < mBlocks.size() ? index : index - 1;
+	Block& block = mBlocks[first];
+	Block& next = mBlocks[first + 1];
+
+	if ( !block.lineRows.empty() || !next.lineRows.empty() ) {
+		if ( block.lineRows.empty() )
+			block.lineRows.assign( block.lines, 0 );
+		if ( next.lineRows.empty() )
+			next.lineRows.assign( next.lines, 0 );
+		block.lineRows.insert( block.lineRows.end(), next.lineRows.begin(), next.lineRows.end() );
+	}
+
+	block.lines += next.lines;
+	block.rows += next.rows;
+	block.unmeasured += next.unmeasured;
+	mBlocks.erase( mBlocks.begin() + first + 1 );
+
+	if ( block.lines > BLOCK_SIZE * 2 )
+		splitBlock( first );
+
+	return true;
+}
+
+void VisualLineIndex::build() {
+	size_t count = mBlocks.size();
+	mLineTree.assign( count + 1, 0 );
+	mRowTree.assign( count + 1, 0 );
+	mLineCount = mRowCount = mUnmeasuredCount = 0;
+
+	for ( size_t i = 1; i <= count; i++ ) {
+		const Block& block = mBlocks[i - 1];
+		mLineTree[i] += block.lines;
+		mRowTree[i] += block.rows;
+		mLineCount += block.lines;
+		mRowCount += block.rows;
+		mUnmeasuredCount += block.unmeasured;
+		size_t parent = i + ( i & ( ~i + 1 ) );
+		if ( parent <= count ) {
+			mLineTree[parent] += mLineTree[i];
+			mRowTree[parent] += mRowTree[i];
+		}
+	}
+
+	mHighBit = 1;
+	while ( mHighBit * 2 <= count )
+		mHighBit *= 2;
+}
+
+}}} // namespace EE::UI::Doc
@@ -1,10 +1,15 @@
 #include <algorithm>
 #include <eepp/graphics/fontmanager.hpp>
 #include <eepp/graphics/fonttruetype.hpp>
+#include <eepp/graphics/framebuffer.hpp>
+#include <eepp/graphics/globalbatchrenderer.hpp>
 #include <eepp/graphics/primitives.hpp>
+#include <eepp/graphics/renderer/renderer.hpp>
+#include <eepp/graphics/textureregion.hpp>
 #include <eepp/scene/scenemanager.hpp>
 #include <eepp/system/luapattern.hpp>
 #include <eepp/ui/doc/syntaxdefinitionmanager.hpp>
+#include <eepp/ui/doc/textsearchindex.hpp>
 #include <eepp/ui/tools/uicolorpicker.hpp>
 #include <eepp/ui/tools/uidocfindreplace.hpp>
 #include <eepp/ui/uicodeeditor.hpp>
@@ -170,6 +175,8 @@ UICodeEditor::~UICodeEditor() {
 	} else {
 		mDoc->unregisterClient( this );
 	}
+
+	eeSAFE_DELETE( mMinimapBuffer );
 }
 
 Uint32 UICodeEditor::getType() const {
@@ -210,6 +217,9 @@ void UICodeEditor::draw() {
 	if ( mDirtyEditor )
 		updateEditor();
 
+	if ( mSoftWrap )
+		measureVisualLines();
+
 	Color col;
 	auto lineRange = getVisibleLineRange();
 	Float charSize = PixelDensity::pxToDp( getCharacterSize() );
@@ -235,10 +245,12 @@ void UICodeEditor::draw() {
 	}
 
 	if ( !mLocked && mHighlightCurrentLine ) {
+		Float lineTop = getTextPositionOffset( { cursor.line(), 0 } ).y;
+		Float rows = getLineWrapColumns( cursor.line() ).size() + 1;
 		primitives.setColor( Color( mCurrentLineBackgroundColor ).blendAlpha( mAlpha ) );
-		primitives.drawRectangle( Rectf(
-			Vector2f( startScroll.x + mScroll.x, startScroll.y + cursor.line() * lineHeight ),
-			Sizef( mSize.getWidth(), lineHeight ) ) );
+		primitives.drawRectangle(
+			Rectf( Vector2f( startScroll.x + mScroll.x, startScroll.y + lineTop ),
+				   Sizef( mSize.getWidth(), lineHeight * rows ) ) );
 	}
 
 	if ( mLineBreakingColumn ) {
@@ -278,13 +290,18 @@ void UICodeEditor::draw() {
 	}
 
 	for ( unsigned long i = lineRange.first; i <= lineRange.second; i++ ) {
+		Int64 row = getVisualRow( { (Int64)i, 0 } );
 		Vector2f curScroll(
-			{ startScroll.x, static_cast<float>( startScroll.y + lineHeight * (double)i ) } );
+			{ startScroll.x, static_cast<float>( startScroll.y + lineHeight * (double)row ) } );
 
 		for ( auto& plugin : mPlugins )
 			plugin->drawBeforeLineText( this, i, curScroll, charSize, lineHeight );
 
-		drawLineText( i, curScroll, charSize, lineHeight );
+		if ( mSoftWrap ) {
+			drawWrappedLineText( i, curScroll, charSize, lineHeight );
+		} else {
+			drawLineText( i, curScroll, charSize, lineHeight );
+		}
 
 		for ( auto& plugin : mPlugins )
 			plugin->drawAfterLineText( this, i, curScroll, charSize, lineHeight );
@@ -354,7 +371,12 @@ void UICodeEditor::scheduledUpdate( const Time& ) {
 		invalidateDraw();
 	}
 
-	if ( mDoc && !mDoc->isLoading() && mHorizontalScrollBarEnabled && hasFocus() &&
+	if ( mSoftWrap && mDoc && !mDoc->isLoading() && mVisualLines.getUnmeasuredCount() > 0 ) {
+		measureVisualLines( -1, Milliseconds( 2 ) );
+		invalidateDraw();
+	}
+
+	if ( mDoc && !mDoc->isLoading() && mHorizontalScrollBarEnabled && !mSoftWrap && hasFocus() &&
 		 mLongestLineWidthDirty &&
 		 mLongestLineWidthLastUpdate.getElapsedTime() > mFindLongestLineWidthUpdateFrequency ) {
 		updateLongestLineWidth();
@@ -364,8 +386,43 @@ void UICodeEditor::scheduledUpdate( const Time& ) {
 		plugin->update( this );
 }
 
+Time UICodeEditor::getIdleTime() {
+	if ( mMouseDown )
+		return Time::Zero;
+
+	if ( !mVisible )
+		return Time::Infinity;
+
+	if ( mDoc && ( mDoc->isLoading() ||
+				   mHighlighter.getFirstInvalidLine() <= mHighlighter.getMaxWantedLine() ) )
+		return Time::Zero;
+
+	if ( mSoftWrap && mVisualLines.getUnmeasuredCount() > 0 )
+		return Time::Zero;
+
+	Time idle( Time::Infinity );
+
+	if ( hasFocus() && getUISceneNode()->getWindow()->hasFocus() && mBlinkTime != Time::Zero ) {
+		Time elapsed( mBlinkTimer.getElapsedTime() );
+		idle = elapsed < mBlinkTime ? mBlinkTime - elapsed : Time::Zero;
+	}
+
+	if ( mDoc && mHorizontalScrollBarEnabled && !mSoftWrap && hasFocus() &&
+		 mLongestLineWidthDirty ) {
+		Time elapsed( mLongestLineWidthLastUpdate.getElapsedTime() );
+		idle = eemin( idle, elapsed < mFindLongestLineWidthUpdateFrequency
+								? mFindLongestLineWidthUpdateFrequency - elapsed
+								: Time::Zero );
+	}
+
+	for ( auto& plugin : mPlugins )
+		idle = eemin( idle, plugin->getIdleTime( this ) );
+
+	return idle;
+}
+
 void UICodeEditor::updateLongestLineWidth() {
-	if ( mHorizontalScrollBarEnabled && mDoc && !mDoc->isLoading() ) {
+	if ( mHorizontalScrollBarEnabled && !mSoftWrap && mDoc && !mDoc->isLoading() ) {
 		Float maxWidth = mLongestLineWidth;
 		findLongestLine();
 		mLongestLineWidthLastUpdate.restart();
@@ -506,15 +563,19 @@ UICodeEditor* UICodeEditor::setFont( Font* font ) {
 
 void UICodeEditor::onFontChanged() {
 	invalidateLinesCache();
+	invalidateVisualLines();
 	udpateGlyphWidth();
 }
 
 void UICodeEditor::onFontStyleChanged() {
 	invalidateLinesCache();
+	invalidateVisualLines();
 	udpateGlyphWidth();
 }
 
-void UICodeEditor::onDocumentLoaded( TextDocument* ) {}
+void UICodeEditor::onDocumentLoaded( TextDocument* ) {
+	invalidateVisualLines();
+}
 
 void UICodeEditor::onDocumentLoaded() {
 	DocEvent event( this, mDoc.get(), Event::OnDocumentLoaded );
@@ -523,6 +584,7 @@ void UICodeEditor::onDocumentLoaded() {
 
 void UICodeEditor::onDocumentChanged() {
 	invalidateLinesCache();
+	invalidateVisualLines();
 	if ( mFindReplace )
 		mFindReplace->setDoc( mDoc );
 	DocEvent event( this, mDoc.get(), Event::OnDocumentChanged );
@@ -618,7 +680,10 @@ const Uint32& UICodeEditor::getTabWidth() const {
 }
 
 UICodeEditor* UICodeEditor::setTabWidth( const Uint32& tabWidth ) {
-	mTabWidth = tabWidth;
+	if ( tabWidth != mTabWidth ) {
+		mTabWidth = tabWidth;
+		invalidateVisualLines();
+	}
 	return this;
 }
 
@@ -750,6 +815,7 @@ void UICodeEditor::updateColorScheme() {
 
 void UICodeEditor::setColorScheme( const SyntaxColorScheme& colorScheme ) {
 	mColorScheme = colorScheme;
+	mMinimapRows.clear();
 	updateColorScheme();
 	invalidateDraw();
 }
@@ -881,6 +947,14 @@ TextPosition UICodeEditor::resolveScreenPosition( const Vector2f& position, bool
 	localPos.y -= mPaddingPx.Top;
 	localPos.y -= getPluginsTopSpace();
 	Int64 line = (Int64)eefloor( localPos.y / getLineHeight() );
+	if ( mSoftWrap ) {
+		Int64 rowCount = getVisualRowCount();
+		if ( clamp || ( line >= 0 && line < rowCount ) )
+			return getVisualRowPosition( eeclamp<Int64>( line, 0, rowCount - 1 ), localPos.x );
+		// The rows outside the document are resolved as unwrapped lines
+		if ( line >= rowCount )
+			line = mDoc->linesCount() + line - rowCount;
+	}
 	if ( clamp )
 		line = eeclamp<Int64>( line, 0, (Int64)( mDoc->linesCount() - 1 ) );
 	return TextPosition( line, getColFromXOffset( line, localPos.x ) );
@@ -891,6 +965,14 @@ Rectf UICodeEditor::getScreenPosition( const TextPosition& position ) const {
 	Vector2f screenStart( getScreenStart() );
 	Vector2f start( screenStart.x + getGutterWidth(), screenStart.y );
 	Vector2f startScroll( start - mScroll );
+	if ( mSoftWrap ) {
+		TextPosition pos( position );
+		pos.setLine( eeclamp<Int64>( pos.line(), 0L, mDoc->linesCount() - 1 ) );
+		pos.setColumn( eeclamp<Int64>( pos.column(), 0L, mDoc->line( pos.line() ).size() ) );
+		Vector2f offset( getTextPositionOffset( pos ) );
+		return { { startScroll.x + offset.x, startScroll.y + offset.y },
+				 { getGlyphWidth(), lineHeight } };
+	}
 	return { { startScroll.x + getXOffsetColSanitized( position ),
 			   startScroll.y + lineHeight * position.line() },
 			 { getGlyphWidth(), lineHeight } };
@@ -910,11 +992,9 @@ Vector2f UICodeEditor::getViewPortLineCount() const {
 
 Sizef UICodeEditor::getMaxScroll() const {
 	Vector2f vplc( getViewPortLineCount() );
-	return Sizef( eemax( 0.f, mLongestLineWidth - getViewportWidth() ),
-				  vplc.y > mDoc->linesCount() - 1
-					  ? 0.f
-					  : eefloor( mDoc->linesCount() - getViewPortLineCount().y ) *
-							getLineHeight() );
+	Int64 rowCount = getVisualRowCount();
+	return Sizef( mSoftWrap ? 0.f : eemax( 0.f, mLongestLineWidth - getViewportWidth() ),
+				  vplc.y > rowCount - 1 ? 0.f : eefloor( rowCount - vplc.y ) * getLineHeight() );
 }
 
 UIMenuItem* UICodeEditor::menuAdd( UIPopUpMenu* menu, const std::string& translateKey,
@@ -1319,8 +1399,8 @@ void UICodeEditor::checkColorPickerAction() {
 void UICodeEditor::drawCursor( const Vector2f& startScroll, const Float& lineHeight,
 							   const TextPosition& cursor ) {
 	if ( mCursorVisible && !mLocked && isTextSelectionEnabled() ) {
-		Vector2f cursorPos( startScroll.x + getXOffsetCol( cursor ),
-							startScroll.y + cursor.line() * lineHeight + getLineOffset() );
+		Vector2f offset( getTextPositionOffset( cursor ) );
+		Vector2f cursorPos( startScroll.x + offset.x, startScroll.y + offset.y + getLineOffset() );
 		Primitives primitives;
 		primitives.setColor( Color( mCaretColor ).blendAlpha( mAlpha ) );
 		primitives.drawRectangle(
@@ -1354,7 +1434,7 @@ Float UICodeEditor::getLineWidth( const Int64& lineIndex ) {
 }
 
 void UICodeEditor::updateScrollBar() {
-	int notVisibleLineCount = (int)mDoc->linesCount() - (int)getViewPortLineCount().y;
+	int notVisibleLineCount = (int)getVisualRowCount() - (int)getViewPortLineCount().y;
 
 	if ( mLongestLineWidthDirty ) {
 		updateLongestLineWidth();
@@ -1365,7 +1445,7 @@ void UICodeEditor::updateScrollBar() {
 
 	mVScrollBar->setPixelsSize( mVScrollBar->getPixelsSize().getWidth(), mSize.getHeight() );
 
-	if ( mHorizontalScrollBarEnabled ) {
+	if ( mHorizontalScrollBarEnabled && !mSoftWrap ) {
 		mHScrollBar->setPixelsPosition( 0, mSize.getHeight() -
 											   mHScrollBar->getPixelsSize().getHeight() );
 		mHScrollBar->setPixelsSize( mSize.getWidth() -
@@ -1381,7 +1461,7 @@ void UICodeEditor::updateScrollBar() {
 	}
 
 	mVScrollBar->setPixelsPosition( mSize.getWidth() - mVScrollBar->getPixelsSize().getWidth(), 0 );
-	mVScrollBar->setPageStep( getViewPortLineCount().y / (float)mDoc->linesCount() );
+	mVScrollBar->setPageStep( getViewPortLineCount().y / (float)getVisualRowCount() );
 	mVScrollBar->setClickStep( 0.2f );
 	mVScrollBar->setEnabled( mVerticalScrollBarEnabled && notVisibleLineCount > 0 );
 	mVScrollBar->setVisible( mVerticalScrollBarEnabled && notVisibleLineCount > 0 );
@@ -1470,7 +1550,13 @@ void UICodeEditor::updateEditor() {
 	mDirtyScroll = false;
 }
 
-void UICodeEditor::onDocumentTextChanged( const DocumentContentChange& ) {
+void UICodeEditor::onDocumentTextChanged( const DocumentContentChange& change ) {
+	if ( mSoftWrap ) {
+		Int64 rowCount = mVisualLines.getRowCount();
+		updateVisualLines( change );
+		if ( rowCount != mVisualLines.getRowCount() )
+			updateScrollBar();
+	}
 	invalidateDraw();
 	checkMatchingBrackets();
 	sendCommonEvent( Event::OnTextChanged );
@@ -1527,12 +1613,20 @@ void UICodeEditor::onDocumentDirtyOnFileSystem( TextDocument* doc ) {
 	sendEvent( &event );
 }
 
-std::pair<Uint64, Uint64> UICodeEditor::getVisibleLineRange() const {
+std::pair<Int64, Int64> UICodeEditor::getVisibleRowRange() const {
 	Float lineHeight = getLineHeight();
-	Float minLine = eemax( 0.f, eefloor( mScroll.y / lineHeight ) );
-	Float maxLine = eemin( mDoc->linesCount() - 1.f,
-						   eefloor( ( mSize.getHeight() + mScroll.y ) / lineHeight ) + 1 );
-	return std::make_pair<Uint64, Uint64>( (Uint64)minLine, (Uint64)maxLine );
+	Float minRow = eemax( 0.f, eefloor( mScroll.y / lineHeight ) );
+	Float maxRow = eemin( getVisualRowCount() - 1.f,
+						  eefloor( ( mSize.getHeight() + mScroll.y ) / lineHeight ) + 1 );
+	return std::make_pair<Int64, Int64>( (Int64)minRow, (Int64)maxRow );
+}
+
+std::pair<Uint64, Uint64> UICodeEditor::getVisibleLineRange() const {
+	auto rowRange = getVisibleRowRange();
+	if ( !mSoftWrap )
+		return std::make_pair<Uint64, Uint64>( (Uint64)rowRange.first, (Uint64)rowRange.second );
+	return std::make_pair<Uint64, Uint64>( (Uint64)mVisualLines.getRowLine( rowRange.first ),
+										   (Uint64)mVisualLines.getRowLine( rowRange.second ) );
 }
 
 bool UICodeEditor::isLineVisible( const Uint64& line ) const {
@@ -1545,6 +1639,56 @@ int UICodeEditor::getVisibleLinesCount() const {
 	return lines.second - lines.first;
 }
 
+Int64 UICodeEditor::getVisualRowCount() const {
+	if ( !mSoftWrap )
+		return mDoc->linesCount();
+	updateVisualLines();
+	return mVisualLines.getRowCount();
+}
+
+Int64 UICodeEditor::getVisualRow( const TextPosition& position ) const {
+	if ( !mSoftWrap || position.line() < 0 )
+		return position.line();
+	updateVisualLines();
+	const std::vector<Int64>& columns = getLineWrapColumns( position.line() );
+	return mVisualLines.getLineFirstRow( position.line() ) +
+		   std::distance( columns.begin(),
+						  std::upper_bound( columns.begin(), columns.end(), position.column() ) );
+}
+
+TextPosition UICodeEditor::getVisualRowStart( const Int64& row ) const {
+	if ( !mSoftWrap )
+		return TextPosition( row, 0 );
+	updateVisualLines();
+	Int64 line = mVisualLines.getRowLine( row );
+	const std::vector<Int64>& columns = getLineWrapColumns( line );
+	Int64 lineRow = eeclamp<Int64>( row - mVisualLines.getLineFirstRow( line ), 0,
+									(Int64)columns.size() );
+	return TextPosition( line, lineRow == 0 ? 0 : columns[lineRow - 1] );
+}
+
+Vector2f UICodeEditor::getTextPositionOffset( const TextPosition& position ) const {
+	if ( !mSoftWrap )
+		return { getXOffsetCol( position ), getLineHeight() * position.line() };
+	const std::vector<Int64>& columns = getLineWrapColumns( position.line() );
+	auto it = std::upper_bound( columns.begin(), columns.end(), position.column() );
+	Float rowX = it == columns.begin() ? 0.f : getXOffsetCol( { position.line(), *( it - 1 ) } );
+	return { getXOffsetCol( position ) - rowX, getLineHeight() * getVisualRow( position ) };
+}
+
+TextPosition UICodeEditor::getVisualRowPosition( const Int64& row, const Float& x ) const {
+	if ( !mSoftWrap )
+		return TextPosition( row, getColFromXOffset( row, x ) );
+	TextPosition start( getVisualRowStart( row ) );
+	const std::vector<Int64>& columns = getLineWrapColumns( start.line() );
+	auto next = std::upper_bound( columns.begin(), columns.end(), start.column() );
+	Int64 column = getColFromXOffset( start.line(), x + getXOffsetCol( start ) );
+	// The first column of the next row is displayed in the next row
+	if ( next != columns.end() )
+		column = eemin( column, *next - 1 );
+	return TextPosition( start.line(), eemax( column, start.column() ) );
+}
+
 const StyleSheetLength& UICodeEditor::getLineSpacing() const {
 	return mLineSpacing;
 }
@@ -1558,32 +1702,33 @@ void UICodeEditor::setLineSpacing( const StyleSheetLength& lineSpace ) {
 
 void UICodeEditor::scrollTo( const TextPosition& position, bool centered, bool forceExactPosition,
 							 bool scrollX ) {
-	auto lineRange = getVisibleLineRange();
+	if ( mSoftWrap )
+		measureVisualLines( position.line() );
+
+	auto rowRange = getVisibleRowRange();
+	Int64 row = getVisualRow( position );
 
 	Int64 minDistance = mHScrollBar->isVisible() ? 3 : 2;
 
-	if ( forceExactPosition || position.line() <= (Int64)lineRange.first ||
-		 position.line() >= (Int64)lineRange.second - minDistance ) {
+	if ( forceExactPosition || row <= rowRange.first || row >= rowRange.second - minDistance ) {
 		// Vertical Scroll
 		Float lineHeight = getLineHeight();
-		Float min = eefloor( lineHeight * ( eemax<Float>( 0, position.line() - 1 ) ) );
-		Float max = eefloor( lineHeight * ( position.line() + minDistance ) - mSize.getHeight() );
+		Float min = eefloor( lineHeight * ( eemax<Float>( 0, row - 1 ) ) );
+		Float max = eefloor( lineHeight * ( row + minDistance ) - mSize.getHeight() );
 		Float halfScreenLines = eefloor( mSize.getHeight() / lineHeight * 0.5f );
 
 		if ( forceExactPosition ) {
-			setScrollY(
-				lineHeight *
-				( eemax<Float>( 0, position.line() - 1 - ( centered ? halfScreenLines : 0 ) ) ) );
+			setScrollY( lineHeight *
+						( eemax<Float>( 0, row - 1 - ( centered ? halfScreenLines : 0 ) ) ) );
 		} else if ( min < mScroll.y ) {
 			if ( centered ) {
-				if ( position.line() - 1 - halfScreenLines >= 0 )
-					min = eefloor( lineHeight *
-								   ( eemax<Float>( 0, position.line() - 1 - halfScreenLines ) ) );
+				if ( row - 1 - halfScreenLines >= 0 )
+					min = eefloor( lineHeight * ( eemax<Float>( 0, row - 1 - halfScreenLines ) ) );
 			}
 			setScrollY( min );
 		} else if ( max > mScroll.y ) {
 			if ( centered ) {
-				max = eefloor( lineHeight * ( position.line() + minDistance + halfScreenLines ) -
+				max = eefloor( lineHeight * ( row + minDistance + halfScreenLines ) -
 							   mSize.getHeight() );
 				max = eemin( max, getMaxScroll().y );
 			}
@@ -1592,7 +1737,7 @@ void UICodeEditor::scrollTo( const TextPosition& position, bool centered, bool f
 	}
 
 	// Horizontal Scroll
-	if ( !scrollX )
+	if ( !scrollX || mSoftWrap )
 		return;
 	Float offsetX = getXOffsetCol( position );
 	Float glyphSize = getGlyphWidth();
@@ -1811,6 +1956,24 @@ void UICodeEditor::setLineBreakingColumn( const Uint32& lineBreakingColumn ) {
 	}
 }
 
+bool UICodeEditor::isSoftWrap() const {
+	return mSoftWrap;
+}
+
+void UICodeEditor::setSoftWrap( bool softWrap ) {
+	if ( softWrap != mSoftWrap ) {
+		// Keeps the first visible line at the top of the viewport
+		TextPosition top( getVisualRowStart( getVisibleRowRange().first ) );
+		mSoftWrap = softWrap;
+		invalidateVisualLines();
+		invalidateLongestLineWidth();
+		setScrollX( 0, false );
+		updateScrollBar();
+		setScrollY( getTextPositionOffset( { top.line(), 0 } ).y );
+		invalidateDraw();
+	}
+}
+
 void UICodeEditor::addUnlockedCommand( const std::string& command ) {
 	mUnlockedCmd.insert( command );
 }
@@ -2237,6 +2400,13 @@ void UICodeEditor::resetCursor() {
 
 TextPosition UICodeEditor::moveToLineOffset( const TextPosition& position, int offset ) {
 	auto& xo = mLastXOffset;
+	if ( mSoftWrap ) {
+		// Moves between the visual rows, a wrapped line is traversed row by row
+		if ( xo.position != position )
+			xo.offset = getTextPositionOffset( position ).x;
+		xo.position = getVisualRowPosition( getVisualRow( position ) + offset, xo.offset );
+		return xo.position;
+	}
 	if ( xo.position != position )
 		xo.offset = getXOffsetColSanitized( position );
 	xo.position.setLine( position.line() + offset );
@@ -2246,28 +2416,28 @@ TextPosition UICodeEditor::moveToLineOffset( const TextPosition& position, int o
 
 void UICodeEditor::moveToPreviousLine() {
 	TextPosition position = mDoc->getSelection().start();
-	if ( position.line() == 0 )
+	if ( getVisualRow( position ) == 0 )
 		return mDoc->moveToStartOfDoc();
 	mDoc->moveTo( moveToLineOffset( position, -1 ) );
 }
 
 void UICodeEditor::moveToNextLine() {
 	TextPosition position = mDoc->getSelection().start();
-	if ( position.line() == (Int64)mDoc->linesCount() - 1 )
+	if ( getVisualRow( position ) == getVisualRowCount() - 1 )
 		return mDoc->moveToEndOfDoc();
 	mDoc->moveTo( moveToLineOffset( position, 1 ) );
 }
 
 void UICodeEditor::selectToPreviousLine() {
 	TextPosition position = mDoc->getSelection().start();
-	if ( position.line() == 0 )
+	if ( getVisualRow( position ) == 0 )
 		return mDoc->selectToStartOfDoc();
 	mDoc->selectTo( moveToLineOffset( position, -1 ) );
 }
 
 void UICodeEditor::selectToNextLine() {
 	TextPosition position = mDoc->getSelection().start();
-	if ( position.line() == (Int64)mDoc->linesCount() - 1 )
+	if ( getVisualRow( position ) == getVisualRowCount() - 1 )
 		return mDoc->selectToEndOfDoc();
 	mDoc->selectTo( moveToLineOffset( position, 1 ) );
 }
@@ -2428,9 +2598,10 @@ void UICodeEditor::drawMatchingBrackets( const Vector2f& startScroll, const Floa
 		primitive.setForceDraw( false );
 		primitive.setColor( Color( mMatchingBracketColor ).blendAlpha( mAlpha ) );
 		auto drawBracket = [&]( const TextPosition& pos ) {
-			primitive.drawRectangle( Rectf( Vector2f( startScroll.x + getXOffsetCol( pos ),
-													  startScroll.y + pos.line() * lineHeight ),
-											Sizef( getGlyphWidth(), lineHeight ) ) );
+			Vector2f offset( getTextPositionOffset( pos ) );
+			primitive.drawRectangle(
+				Rectf( Vector2f( startScroll.x + offset.x, startScroll.y + offset.y ),
+					   Sizef( getGlyphWidth(), lineHeight ) ) );
 		};
 		drawBracket( mMatchingBrackets.start() );
 		drawBracket( mMatchingBrackets.end() );
@@ -2462,36 +2633,29 @@ void UICodeEditor::drawWordMatch( const String& text, const std::pair<int, int>&
 	Primitives primitives;
 	primitives.setForceDraw( false );
 	primitives.setColor( Color( mSelectionMatchColor ).blendAlpha( mAlpha ) );
-	for ( auto ln = lineRange.first; ln <= lineRange.second; ln++ ) {
-		const String& line = mDoc->line( ln ).getText();
-		size_t pos = 0;
+	TextRange selection = mDoc->getSelection( true );
+	std::vector<TextRange> matches(
+		mDoc->getSearchIndex().getMatches( { text }, lineRange.first, lineRange.second ) );
+	for ( const auto& match : matches ) {
+		Int64 ln = match.start().line();
 		// Skip ridiculously long lines.
-		if ( line.size() > 300 )
+		if ( mDoc->line( ln ).size() > 300 )
 			continue;
 
-		do {
-			pos = line.find( text, pos );
-			if ( pos != String::InvalidPos ) {
-				if ( ignoreSelectionMatch ) {
-					TextRange selection = mDoc->getSelection( true );
-					if ( selection.inSameLine() && selection.start().line() == ln &&
-						 selection.start().column() == (Int64)pos )
-						break;
-				}
+		if ( ignoreSelectionMatch && selection.inSameLine() && selection.start().line() == ln &&
+			 selection.start().column() == match.start().column() )
+			continue;
 
-				Rectf selRect;
-				Int64 startCol = pos;
-				Int64 endCol = pos + text.size();
-				selRect.Top = startScroll.y + ln * lineHeight;
-				selRect.Bottom = selRect.Top + lineHeight;
-				selRect.Left = startScroll.x + getXOffsetCol( { ln, startCol } );
-				selRect.Right = startScroll.x + getXOffsetCol( { ln, endCol } );
-				primitives.drawRectangle( selRect );
-				pos = endCol;
-			} else {
-				break;
-			}
-		} while ( true );
+		Rectf selRect;
+		Int64 startCol = match.start().column();
+		Int64 endCol = startCol + text.size();
+		Vector2f offset( getTextPositionOffset( { ln, startCol } ) );
+		selRect.Top = startScroll.y + offset.y;
+		selRect.Bottom = selRect.Top + lineHeight;
+		selRect.Left = startScroll.x + offset.x;
+		selRect.Right = selRect.Left + getXOffsetCol( { ln, endCol } ) -
+						getXOffsetCol( { ln, startCol } );
+		primitives.drawRectangle( selRect );
 	}
 	primitives.setForceDraw( true );
 }
@@ -2638,6 +2802,57 @@ void UICodeEditor::drawLineText( const Int64& line, Vector2f position, const Flo
 	}
 }
 
+void UICodeEditor::drawWrappedLineText( const Int64& line, Vector2f position,
+										const Float& fontSize, const Float& lineHeight ) {
+	const std::vector<Int64>& columns = getLineWrapColumns( line );
+	auto& tokens = mHighlighter.getLine( line );
+	Primitives primitives;
+	bool isMonospace = mFont->isMonospace();
+	Float lineOffset = getLineOffset();
+	Float rowStartX = position.x;
+	Float maxY = mScreenPos.y + mSize.getHeight();
+	Int64 curChar = 0;
+	size_t row = 0;
+	for ( auto& token : tokens ) {
+		String tokenText( token.text );
+		Int64 tokenEnd = curChar + tokenText.size();
+		Int64 start = curChar;
+		// The token is split at the start of every row
+		while ( start < tokenEnd ) {
+			Int64 rowEnd = row < columns.size() ? columns[row] : tokenEnd;
+			Int64 end = eemin( tokenEnd, rowEnd );
+			if ( end > start && position.y + lineHeight >= mScreenPos.y ) {
+				String text( tokenText.substr( start - curChar, end - start ) );
+				const SyntaxColorScheme::Style& style = mColorScheme.getSyntaxStyle( token.type );
+				Text txt( "", mFont, fontSize );
+				txt.setTabWidth( mTabWidth );
+				txt.setStyleConfig( mFontStyleConfig );
+				if ( style.style )
+					txt.setStyle( style.style );
+				txt.setColor( Color( style.color ).blendAlpha( mAlpha ) );
+				if ( isMonospace )
+					txt.setDisableCacheWidth( true );
+				txt.setString( text );
+				Float textWidth = isMonospace ? getTextWidth( text ) : txt.getTextWidth();
+				if ( style.background != Color::Transparent ) {
+					primitives.setColor( Color( style.background ).blendAlpha( mAlpha ) );
+					primitives.drawRectangle( Rectf( position, Sizef( textWidth, lineHeight ) ) );
+				}
+				txt.draw( position.x, position.y + lineOffset );
+				position.x += textWidth;
+			}
+			if ( end == rowEnd && row < columns.size() ) {
+				position = { rowStartX, position.y + lineHeight };
+				row++;
+				if ( position.y > maxY )
+					return;
+			}
+			start = end;
+		}
+		curChar = tokenEnd;
+	}
+}
+
 void UICodeEditor::drawTextRange( const TextRange& range, const std::pair<int, int>& lineRange,
 								  const Vector2f& startScroll, const Float& lineHeight,
 								  const Color& backgroundColor ) {
@@ -2648,6 +2863,34 @@ void UICodeEditor::drawTextRange( const TextRange& range, const std::pair<int, i
 	int startLine = eemax<int>( lineRange.first, range.start().line() );
 	int endLine = eemin<int>( lineRange.second, range.end().line() );
 
+	if ( mSoftWrap ) {
+		for ( auto ln = startLine; ln <= endLine; ln++ ) {
+			Int64 lineLength = mDoc->line( ln ).getText().length();
+			Int64 startCol = range.start().line() == ln ? range.start().column() : 0;
+			Int64 endCol = range.end().line() == ln ? range.end().column() : lineLength;
+			const std::vector<Int64>& columns = getLineWrapColumns( ln );
+			Float top = startScroll.y + getTextPositionOffset( { ln, 0 } ).y;
+			// One rectangle for every row of the line that contains part of the range
+			for ( size_t row = 0; row <= columns.size(); row++ ) {
+				Int64 rowStart = row == 0 ? 0 : columns[row - 1];
+				Int64 rowEnd = row < columns.size() ? columns[row] : lineLength;
+				Int64 start = eemax( startCol, rowStart );
+				Int64 end = eemin( endCol, rowEnd );
+				if ( start <= end && ( start < end || row == columns.size() ) ) {
+					Float rowX = getXOffsetCol( { ln, rowStart } );
+					Rectf selRect;
+					selRect.Top = top + lineHeight * row;
+					selRect.Bottom = selRect.Top + lineHeight;
+					selRect.Left = startScroll.x + getXOffsetCol( { ln, start } ) - rowX;
+					selRect.Right = startScroll.x + getXOffsetCol( { ln, end } ) - rowX;
+					primitives.drawRectangle( selRect );
+				}
+			}
+		}
+		primitives.setForceDraw( true );
+		return;
+	}
+
 	for ( auto ln = startLine; ln <= endLine; ln++ ) {
 		const String& line = mDoc->line( ln ).getText();
 		Rectf selRect;
@@ -2692,19 +2935,20 @@ void UICodeEditor::drawLineNumbers( const std::pair<int, int>& lineRange,
 						   ? mLineNumberActiveFontColor
 						   : mLineNumberFontColor );
 		line.draw( screenStart.x + mLineNumberPaddingLeft,
-				   startScroll.y + lineHeight * (double)i + lineOffset );
+				   startScroll.y + lineHeight * (double)getVisualRow( { i, 0 } ) + lineOffset );
 	}
 }
 
 void UICodeEditor::drawColorPreview( const Vector2f& startScroll, const Float& lineHeight ) {
 	Primitives primitives;
 	primitives.setColor( mPreviewColor );
-	Float startX = getXOffsetCol( mPreviewColorRange.start() );
-	Float endX = getXOffsetCol( mPreviewColorRange.end() );
-	primitives.drawRectangle( Rectf(
-		Vector2f( startScroll.x + mScroll.x + startX,
-				  startScroll.y + mPreviewColorRange.start().line() * lineHeight + lineHeight ),
-		Sizef( endX - startX, lineHeight * 2 ) ) );
+	Vector2f offset( getTextPositionOffset( mPreviewColorRange.start() ) );
+	Float width = getXOffsetCol( mPreviewColorRange.end() ) -
+				  getXOffsetCol( mPreviewColorRange.start() );
+	primitives.drawRectangle(
+		Rectf( Vector2f( startScroll.x + mScroll.x + offset.x,
+						 startScroll.y + offset.y + lineHeight ),
+			   Sizef( width, lineHeight * 2 ) ) );
 }
 
 void UICodeEditor::drawWhitespaces( const std::pair<int, int>& lineRange,
@@ -2722,9 +2966,16 @@ void UICodeEditor::drawWhitespaces( const std::pair<int, int>& lineRange,
 	adv->setColor( color );
 	cpoint->setColor( color );
 	for ( int index = lineRange.first; index <= lineRange.second; index++ ) {
-		Vector2f position( { startScroll.x, startScroll.y + lineHeight * index } );
+		Vector2f position(
+			{ startScroll.x, startScroll.y + lineHeight * getVisualRow( { index, 0 } ) } );
 		const auto& text = mDoc->line( index ).getText();
+		const std::vector<Int64>& columns = getLineWrapColumns( index );
+		size_t row = 0;
 		for ( size_t i = 0; i < text.size(); i++ ) {
+			if ( row < columns.size() && (Int64)i == columns[row] ) {
+				position = { startScroll.x, position.y + lineHeight };
+				row++;
+			}
 			if ( position.x + mScroll.x + ( text[i] == '\t' ? tabWidth : glyphW ) >= mScreenPos.x &&
 				 position.x <= mScreenPos.x + mScroll.x + mSize.getWidth() ) {
 				if ( ' ' == text[i] ) {
@@ -2946,6 +3197,188 @@ Rectf UICodeEditor::getMinimapRect( const Vector2f& start ) const {
 		Sizef( w, h ) );
 }
 
+void UICodeEditor::drawMinimapLineText( Primitives& primitives, const Int64& index,
+										const Vector2f& position, const Float& cutoffX,
+										const Float& charHeight, const Float& charSpacing,
+										const Uint8& alpha ) {
+	Color color = mColorScheme.getSyntaxStyle( "normal" ).color;
+	color.a *= 0.5f;
+	Float batchWidth = 0;
+	Float batchStart = position.x;
+	std::string batchSyntaxType = "normal";
+	auto flushBatch = [&]( const std::string& type ) {
+		Color oldColor = color;
+		color = mColorScheme.getSyntaxStyle( batchSyntaxType ).color;
+		if ( mMinimapConfig.syntaxHighlight && color != Color::Transparent ) {
+			color.a *= 0.5f;
+		} else {
+			color = oldColor;
+		}
+
+		if ( batchWidth > 0 ) {
+			primitives.setColor( Color( color ).blendAlpha( alpha ) );
+			primitives.drawRectangle( { { batchStart, position.y }, { batchWidth, charHeight } } );
+		}
+
+		batchSyntaxType = type;
+		batchStart += batchWidth;
+		batchWidth = 0;
+	};
+
+	if ( mMinimapConfig.syntaxHighlight ) {
+		const auto& tokens = mHighlighter.getLine( index );
+		for ( const auto& token : tokens ) {
+			if ( batchSyntaxType != token.type ) {
+				flushBatch( batchSyntaxType );
+				batchSyntaxType = token.type;
+			}
+
+			if ( token.text.empty() )
+				continue;
+
+			char* str = (char*)token.text.c_str();
+			char* end = str + token.text.size();
+
+			do {
+				Uint32 ch = String::utf8Next( str );
+				if ( ch == ' ' || ch == '\n' ) {
+					flushBatch( token.type );
+					batchStart += charSpacing;
+				} else if ( ch == '\t' ) {
+					flushBatch( token.type );
+					batchStart += charSpacing * mMinimapConfig.tabWidth;
+				} else if ( batchStart + batchWidth > cutoffX ) {
+					flushBatch( token.type );
+					break;
+				} else {
+					batchWidth += charSpacing;
+				}
+			} while ( str < end );
+		}
+	} else {
+		const String& text( mDoc->line( index ).getText() );
+		for ( size_t i = 0; i < text.size(); ++i ) {
+			String::StringBaseType ch = text[i];
+			if ( ch == ' ' || ch == '\n' ) {
+				flushBatch( "normal" );
+				batchStart += charSpacing;
+			} else if ( ch == '\t' ) {
+				flushBatch( "normal" );
+				batchStart += charSpacing * mMinimapConfig.tabWidth;
+			} else if ( batchStart + batchWidth > cutoffX ) {
+				flushBatch( "normal" );
+				break;
+			} else {
+				batchWidth += charSpacing;
+			}
+		}
+	}
+	flushBatch( "normal" );
+}
+
+Uint64 UICodeEditor::getMinimapLineSignature( const Int64& index ) {
+	Uint64 signature = mDoc->line( index ).getHash();
+	// The tokens of a line also depend on the state where the previous line ended.
+	if ( mMinimapConfig.syntaxHighlight )
+		signature = signature * 31 + mHighlighter.getTokenizedLine( index ).initState;
+	return signature;
+}
+
+bool UICodeEditor::updateMinimapBuffer( const Rectf& rect, const Int64& startLine,
+										const Int64& endLine, const Float& charHeight,
+										const Float& charSpacing, const Float& gutterWidth ) {
+	if ( mMinimapBufferFailed )
+		return false;
+
+	Float lineSpacing = getMinimapLineSpacing();
+	size_t rowsCount = eefloor( rect.getHeight() / lineSpacing ) + 1;
+	Sizei size( eemax( 1, (int)eeceil( rect.getWidth() ) ),
+				eemax( 1, (int)eeceil( rowsCount * lineSpacing ) ) );
+
+	if ( nullptr == mMinimapBuffer ) {
+		mMinimapBuffer = FrameBuffer::New( size.getWidth(), size.getHeight(), false, false, false );
+
+		if ( !mMinimapBuffer->created() ) {
+			eeSAFE_DELETE( mMinimapBuffer );
+			mMinimapBufferFailed = true;
+			return false;
+		}
+
+		mMinimapBuffer->setClearColor( ColorAf( 0, 0, 0, 0 ) );
+		mMinimapBuffer->getTexture()->setFilter( Texture::Filter::Nearest );
+	} else if ( mMinimapBuffer->getSize() != size ) {
+		mMinimapBuffer->resize( size.getWidth(), size.getHeight() );
+	}
+
+	// Everything that changes how the lines are painted, except the line contents.
+	Uint64 key = String::hash( mColorScheme.getName() );
+	auto combine = [&key]( const Uint64& value ) { key = key * 31 + value; };
+	combine( String::hash( mDoc->getSyntaxDefinition().getLanguageName() ) );
+	combine( (Uint64)(uintptr_t)mDoc.get() );
+	combine( size.getWidth() );
+	combine( size.getHeight() );
+	combine( (Uint64)( charHeight * 100 ) );
+	combine( (Uint64)( charSpacing * 100 ) );
+	combine( (Uint64)( gutterWidth * 100 ) );
+	combine( mMinimapConfig.tabWidth );
+	combine( mMinimapConfig.syntaxHighlight ? 1 : 0 );
+
+	if ( key != mMinimapBufferKey || mMinimapRows.size() != rowsCount ) {
+		mMinimapBufferKey = key;
+		mMinimapRows.assign( rowsCount, MinimapRow() );
+	}
+
+	std::vector<Int64> dirtyLines;
+
+	for ( Int64 index = startLine; index <= endLine; index++ ) {
+		MinimapRow& row = mMinimapRows[index % rowsCount];
+		Uint64 signature = getMinimapLineSignature( index );
+		if ( row.line != index || row.signature != signature ) {
+			row.line = index;
+			row.signature = signature;
+			dirtyLines.push_back( index );
+		}
+	}
+
+	if ( dirtyLines.empty() )
+		return true;
+
+	// The clipping areas are in window coordinates, disable them while painting the buffer.
+	ClippingMask* clippingMask = GLi->getClippingMask();
+	std::list<Rectf> scissors( clippingMask->getScissorsClipped() );
+	std::list<Rectf> planes( clippingMask->getPlanesClipped() );
+
+	clippingMask->clipDisableAll();
+
+	mMinimapBuffer->bind();
+
+	for ( const auto& index : dirtyLines ) {
+		int rowY = ( index % rowsCount ) * lineSpacing;
+		mMinimapBuffer->clear( Rect( 0, rowY, size.getWidth(), rowY + lineSpacing ) );
+	}
+
+	// The rows are transparent and the line batches don't overlap, overwriting keeps the colors
+	// unblended so the buffer can be drawn with the usual alpha blending.
+	Primitives primitives;
+	primitives.setForceDraw( false );
+	primitives.setBlendMode( BlendMode::None() );
+
+	for ( const auto& index : dirtyLines ) {
+		drawMinimapLineText( primitives, index,
+							 { gutterWidth, ( index % rowsCount ) * lineSpacing },
+							 size.getWidth(), charHeight, charSpacing, 255 );
+	}
+
+	GlobalBatchRenderer::instance()->draw();
+
+	mMinimapBuffer->unbind();
+
+	clippingMask->setScissorsClipped( scissors );
+	clippingMask->setPlanesClipped( planes );
+
+	return true;
+}
+
 void UICodeEditor::drawMinimap( const Vector2f& start,
 								const std::pair<Uint64, Uint64>& lineRange ) {
 	Float charHeight = PixelDensity::getPixelDensity() * mMinimapConfig.scale;
@@ -2973,6 +3406,15 @@ void UICodeEditor::drawMinimap( const Vector2f& start,
 		minimapStartLine = eemax( 0, eemin( minimapStartLine, lineCount - maxMinmapLines ) );
 	}
 
+	int endidx = minimapStartLine + maxMinmapLines;
+	endidx = eemin( endidx, lineCount - 1 );
+
+	Float gutterWidth = PixelDensity::dpToPx( mMinimapConfig.gutterWidth );
+
+	// Paint the lines that changed before drawing anything, binding the buffer flushes the batch.
+	bool bufferReady = updateMinimapBuffer( rect, minimapStartLine, endidx, charHeight,
+											charSpacing, gutterWidth );
+
 	Primitives primitives;
 	primitives.setForceDraw( false );
 
@@ -2990,64 +3432,38 @@ void UICodeEditor::drawMinimap( const Vector2f& start,
 			{ { rect.Left, visibleY }, Sizef( rect.getWidth(), scrollerHeight ) } );
 	}
 
-	Float gutterWidth = PixelDensity::dpToPx( mMinimapConfig.gutterWidth );
 	Float lineY = rect.Top;
-	Color color = mColorScheme.getSyntaxStyle( "normal" ).color;
-	color.a *= 0.5f;
-	Float batchWidth = 0;
-	Float batchStart = rect.Left;
 	Float minimapCutoffX = rect.Left + rect.getWidth();
-	std::string batchSyntaxType = "normal";
 	Float widthScale = charSpacing / getGlyphWidth();
-	auto flushBatch = [&]( const std::string& type ) {
-		Color oldColor = color;
-		color = mColorScheme.getSyntaxStyle( batchSyntaxType ).color;
-		if ( mMinimapConfig.syntaxHighlight && color != Color::Transparent ) {
-			color.a *= 0.5f;
-		} else {
-			color = oldColor;
-		}
-
-		if ( batchWidth > 0 ) {
-			primitives.setColor( color.blendAlpha( mAlpha ) );
-			primitives.drawRectangle( { { batchStart, lineY }, { batchWidth, charHeight } } );
-		}
-
-		batchSyntaxType = type;
-		batchStart += batchWidth;
-		batchWidth = 0;
-	};
+	Float minimapStart = rect.Left + gutterWidth;
 
-	int endidx = minimapStartLine + maxMinmapLines;
-	endidx = eemin( endidx, lineCount - 1 );
+	std::vector<TextRange> highlightWordMatches;
+	std::vector<TextRange> selectionMatches;
+	size_t highlightWordIndex = 0;
+	size_t selectionIndex = 0;
 
-	auto drawWordMatch = [&]( const String& text, const Int64& ln ) {
-		size_t pos = 0;
-		const String& line( mDoc->line( ln ).getText() );
-		if ( line.size() > 300 )
+	auto drawWordMatch = [&]( const std::vector<TextRange>& matches, size_t& matchIndex,
+							  const Int64& ln ) {
+		while ( matchIndex < matches.size() && matches[matchIndex].start().line() < ln )
+			matchIndex++;
+		if ( mDoc->line( ln ).size() > 300 )
 			return;
 		primitives.setColor( Color( mMinimapHighlightColor ).blendAlpha( mAlpha ) );
 
-		do {
-			pos = line.find( text, pos );
-			if ( pos != String::InvalidPos ) {
-				Rectf selRect;
-				Int64 startCol = pos;
-				Int64 endCol = pos + text.size();
-				selRect.Top = lineY;
-				selRect.Bottom = lineY + charHeight;
-				selRect.Left = batchStart + getXOffsetCol( { ln, startCol } ) * widthScale;
-				selRect.Right = batchStart + getXOffsetCol( { ln, endCol } ) * widthScale;
-				if ( selRect.Left < minimapCutoffX )
-					primitives.drawRectangle( selRect );
-				pos = endCol;
-			} else {
-				break;
-			}
-		} while ( true );
+		for ( ; matchIndex < matches.size() && matches[matchIndex].start().line() == ln;
+			  matchIndex++ ) {
+			Rectf selRect;
+			Int64 startCol = matches[matchIndex].start().column();
+			Int64 endCol = matches[matchIndex].end().column();
+			selRect.Top = lineY;
+			selRect.Bottom = lineY + charHeight;
+			selRect.Left = minimapStart + getXOffsetCol( { ln, startCol } ) * widthScale;
+			selRect.Right = minimapStart + getXOffsetCol( { ln, endCol } ) * widthScale;
+			if ( selRect.Left < minimapCutoffX )
+				primitives.drawRectangle( selRect );
+		}
 	};
 
-	Float minimapStart = rect.Left + gutterWidth;
 	auto drawTextRange = [&]( const TextRange& range, const Int64& ln,
 							  const Color& backgroundColor ) {
 		if ( !( ln >= range.start().line() && ln <= range.end().line() ) )
@@ -3102,54 +3518,60 @@ void UICodeEditor::drawMinimap( const Vector2f& start,
 		}
 	}
 
-	if ( mMinimapConfig.syntaxHighlight ) {
-		for ( int index = minimapStartLine; index <= endidx; index++ ) {
-			batchSyntaxType = "normal";
-			batchStart = rect.Left + gutterWidth;
-			batchWidth = 0;
+	if ( !mHighlightWord.empty() )
+		highlightWordMatches =
+			mDoc->getSearchIndex().getMatches( { mHighlightWord }, minimapStartLine, endidx );
 
-			if ( !mHighlightWord.empty() )
-				drawWordMatch( mHighlightWord, index );
+	if ( !selectionString.empty() )
+		selectionMatches =
+			mDoc->getSearchIndex().getMatches( { selectionString }, minimapStartLine, endidx );
 
-			if ( !selectionString.empty() )
-				drawWordMatch( selectionString, index );
+	// Below the text: the matches and the plugins decorations.
+	for ( int index = minimapStartLine; index <= endidx; index++ ) {
+		drawWordMatch( highlightWordMatches, highlightWordIndex, index );
+		drawWordMatch( selectionMatches, selectionIndex, index );
 
+		if ( mMinimapConfig.syntaxHighlight ) {
 			for ( auto* plugin : mPlugins )
 				plugin->minimapDrawBeforeLineText( this, index, { rect.Left, lineY },
 												   { rect.getWidth(), charHeight }, charSpacing,
 												   gutterWidth );
+		}
 
-			const auto& tokens = mHighlighter.getLine( index );
-			for ( const auto& token : tokens ) {
-				if ( batchSyntaxType != token.type ) {
-					flushBatch( batchSyntaxType );
-					batchSyntaxType = token.type;
-				}
-
-				if ( token.text.empty() )
-					continue;
-
-				char* str = (char*)token.text.c_str();
-				char* end = str + token.text.size();
-
-				do {
-					Uint32 ch = String::utf8Next( str );
-					if ( ch == ' ' || ch == '\n' ) {
-						flushBatch( token.type );
-						batchStart += charSpacing;
-					} else if ( ch == '\t' ) {
-						flushBatch( token.type );
-						batchStart += charSpacing * mMinimapConfig.tabWidth;
-					} else if ( batchStart + batchWidth > minimapCutoffX ) {
-						flushBatch( token.type );
-						break;
-					} else {
-						batchWidth += charSpacing;
-					}
-				} while ( str < end );
-			}
-			flushBatch( "normal" );
+		lineY += lineSpacing;
+	}
+
+	if ( bufferReady ) {
+		// The visible lines are contiguous in the ring of rows, at most two quads are needed.
+		Int64 rowsCount = mMinimapRows.size();
+		Int64 pending = endidx - minimapStartLine + 1;
+		Int64 row = minimapStartLine % rowsCount;
+		Float y = rect.Top;
+		Color color( Color( Color::White ).blendAlpha( mAlpha ) );
+
+		while ( pending > 0 ) {
+			Int64 rows = eemin( pending, rowsCount - row );
+			TextureRegion region( mMinimapBuffer->getTexture()->getTextureId(),
+								  Rect( 0, row * lineSpacing, mMinimapBuffer->getWidth(),
+										( row + rows ) * lineSpacing ) );
+			region.draw( rect.Left, y, color );
+			y += rows * lineSpacing;
+			pending -= rows;
+			row = 0;
+		}
+	} else {
+		lineY = rect.Top;
+		for ( int index = minimapStartLine; index <= endidx; index++ ) {
+			drawMinimapLineText( primitives, index, { minimapStart, lineY }, minimapCutoffX,
+								 charHeight, charSpacing, mAlpha );
+			lineY += lineSpacing;
+		}
+	}
 
+	// Above the text: the plugins decorations and the selections.
+	if ( mMinimapConfig.syntaxHighlight ) {
+		lineY = rect.Top;
+		for ( int index = minimapStartLine; index <= endidx; index++ ) {
 			for ( auto* plugin : mPlugins )
 				plugin->minimapDrawAfterLineText( this, index, { rect.Left, lineY },
 												  { rect.getWidth(), charHeight }, charSpacing,
@@ -3165,37 +3587,7 @@ void UICodeEditor::drawMinimap( const Vector2f& start,
 							   Color( mMinimapSelectionColor ).blendAlpha( mAlpha ) );
 			}
 
-			lineY = lineY + lineSpacing;
-		}
-	} else {
-		for ( int index = minimapStartLine; index <= endidx; index++ ) {
-			batchSyntaxType = "normal";
-			batchStart = rect.Left + gutterWidth;
-			batchWidth = 0;
-
-			if ( !mHighlightWord.empty() )
-				drawWordMatch( mHighlightWord, index );
-			if ( !selectionString.empty() )
-				drawWordMatch( selectionString, index );
-
-			const String& text( mDoc->line( index ).getText() );
-			for ( size_t i = 0; i < text.size(); ++i ) {
-				String::StringBaseType ch = text[i];
-				if ( ch == ' ' || ch == '\n' ) {
-					flushBatch( "normal" );
-					batchStart += charSpacing;
-				} else if ( ch == '\t' ) {
-					flushBatch( "normal" );
-					batchStart += charSpacing * mMinimapConfig.tabWidth;
-				} else if ( batchStart + batchWidth > minimapCutoffX ) {
-					flushBatch( "normal" );
-					break;
-				} else {
-					batchWidth += charSpacing;
-				}
-			}
-			flushBatch( "normal" );
-			lineY = lineY + lineSpacing;
+			lineY += lineSpacing;
 		}
 	}
 
@@ -3320,6 +3712,197 @@ void UICodeEditor::updateLineCache( const Int64& lineIndex ) {
 	}
 }
 
+void UICodeEditor::invalidateVisualLines() {
+	mVisualLinesDirty = true;
+	mWrapCache.clear();
+}
+
+void UICodeEditor::updateVisualLines() const {
+	if ( !mSoftWrap || mDoc->isLoading() )
+		return;
+	Int64 lineCount = mDoc->linesCount();
+	Float width = mFont ? getSoftWrapWidth() : 0.f;
+	if ( mVisualLines.getLineCount() != lineCount ) {
+		mVisualLines.reset( lineCount );
+	} else if ( mVisualLinesDirty || width != mVisualLinesWidth ) {
+		mVisualLines.invalidate();
+	} else {
+		return;
+	}
+	mVisualLinesWidth = width;
+	mVisualLinesDirty = false;
+	mWrapCache.clear();
+}
+
+void UICodeEditor::measureVisualLines( const Int64& aroundLine, const Time& budget ) {
+	if ( !mSoftWrap || nullptr == mFont || mDoc->isLoading() )
+		return;
+
+	// The position displayed at the top of the viewport stays there while the rows of the lines
+	// above it change. It's resolved before the lines are invalidated by updateVisualLines.
+	Float lineHeight = getLineHeight();
+	Int64 lineCount = mDoc->linesCount();
+	Int64 topRow = eefloor( mScroll.y / lineHeight );
+	Float topOffset = mScroll.y - topRow * lineHeight;
+	Int64 topLine = eeclamp<Int64>( mVisualLines.getRowLine( topRow ), 0, lineCount - 1 );
+	Int64 topLineRow = topRow - mVisualLines.getLineFirstRow( topLine );
+	Int64 topColumn = 0;
+	auto cached = mWrapCache.find( topLine );
+
+	if ( topLineRow > 0 && cached != mWrapCache.end() &&
+		 cached->second.hash == mDoc->line( topLine ).getHash() &&
+		 topLineRow <= (Int64)cached->second.columns.size() )
+		topColumn = cached->second.columns[topLineRow - 1];
+
+	Int64 rowCount = mVisualLines.getRowCount();
+	updateVisualLines();
+
+	Int64 pageRows = getViewPortLineCount().y + 1;
+
+	for ( Int64 line = topLine, rows = 0; line < lineCount && rows <= pageRows; line++ )
+		rows += getLineWrapColumns( line ).size() + 1;
+
+	if ( aroundLine >= 0 ) {
+		Int64 last = eemin( aroundLine + pageRows, lineCount - 1 );
+		for ( Int64 line = eemax<Int64>( 0, aroundLine - pageRows ); line <= last; line++ )
+			getLineWrapColumns( line );
+	}
+
+	if ( budget != Time::Zero ) {
+		Clock clock;
+		std::vector<Int64> columns;
+		Int64 line = topLine;
+
+		while ( clock.getElapsedTime() < budget &&
+				( line = mVisualLines.findUnmeasuredLine( line ) ) != -1 ) {
+			computeLineWrapColumns( line, columns );
+			mVisualLines.setLineRows( line, columns.size() + 1 );
+		}
+	}
+
+	if ( rowCount != mVisualLines.getRowCount() )
+		updateScrollBar();
+
+	Float scrollY = lineHeight * getVisualRow( { topLine, topColumn } ) + topOffset;
+
+	if ( scrollY != mScroll.y )
+		setScrollY( scrollY );
+}
+
+void UICodeEditor::updateVisualLines( const DocumentContentChange& change ) {
+	if ( !mSoftWrap || mVisualLinesDirty || mDoc->isLoading() )
+		return;
+
+	// The lines between start and oldLast were replaced by the lines between start and newLast.
+	Int64 oldLineCount = mVisualLines.getLineCount();
+	Int64 lineCount = mDoc->linesCount();
+	Int64 delta = lineCount - oldLineCount;
+	TextRange range( change.range.normalized() );
+	Int64 start = range.start().line();
+	Int64 oldLast = change.text.empty() ? range.end().line() : start;
+	Int64 newLast = oldLast + delta;
+
+	if ( !range.isValid() || start < 0 || oldLast >= oldLineCount || newLast < start ||
+		 newLast >= lineCount ) {
+		invalidateVisualLines();
+		return;
+	}
+
+	if ( delta > 0 ) {
+		mVisualLines.insertLines( start + 1, delta );
+	} else if ( delta < 0 ) {
+		mVisualLines.removeLines( start + 1, -delta );
+	}
+
+	// The lines of a small edit are wrapped right away, the rest when they are displayed
+	bool measure = newLast - start < 64;
+
+	for ( Int64 i = start; i <= newLast; i++ ) {
+		mVisualLines.invalidateLine( i );
+		if ( measure )
+			getLineWrapColumns( i );
+	}
+}
+
+Float UICodeEditor::getSoftWrapWidth() const {
+	// Leaves room for the cursor at the end of the rows
+	return eemax( getGlyphWidth(), getViewportWidth( true ) - getGlyphWidth() );
+}
+
+void UICodeEditor::computeLineWrapColumns( const Int64& line,
+										   std::vector<Int64>& columns ) const {
+	columns.clear();
+	const String& text = mDoc->line( line ).getText();
+	bool isMonospace = mFont->isMonospace();
+	bool bold = ( mFontStyleConfig.Style & Text::Bold ) != 0;
+	unsigned int characterSize = getCharacterSize();
+	Float glyphWidth = getGlyphWidth();
+	Float spaceWidth =
+		isMonospace ? glyphWidth : mFont->getGlyph( ' ', characterSize, bold ).advance;
+	Float x = 0;
+	Float breakX = 0;
+	Int64 rowStart = 0;
+	Int64 breakCol = 0;
+	Int64 len = text.size();
+
+	for ( Int64 i = 0; i < len; i++ ) {
+		String::StringBaseType ch = text[i];
+		if ( ch == '\n' || ch == '\r' )
+			continue;
+
+		Float width = glyphWidth;
+		if ( ch == '\t' ) {
+			width = spaceWidth * mTabWidth;
+		} else if ( !isMonospace ) {
+			width = mFont->getGlyph( ch, characterSize, bold ).advance;
+		}
+
+		while ( x + width > mVisualLinesWidth && i > rowStart ) {
+			// Breaks after the last whitespace of the row, or before the character if the row is a
+			// single word
+			if ( breakCol > rowStart ) {
+				x -= breakX;
+				rowStart = breakCol;
+			} else {
+				x = 0;
+				rowStart = i;
+			}
+			breakCol = rowStart;
+			columns.push_back( rowStart );
+		}
+
+		x += width;
+
+		if ( ch == ' ' || ch == '\t' ) {
+			breakCol = i + 1;
+			breakX = x;
+		}
+	}
+}
+
+const std::vector<Int64>& UICodeEditor::getLineWrapColumns( const Int64& line ) const {
+	static const std::vector<Int64> NO_COLUMNS;
+	if ( !mSoftWrap || nullptr == mFont || line < 0 || line >= (Int64)mDoc->linesCount() )
+		return NO_COLUMNS;
+	updateVisualLines();
+	const TextDocumentLine& docLine = mDoc->line( line );
+	auto it = mWrapCache.find( line );
+	if ( it != mWrapCache.end() && it->second.hash == docLine.getHash() ) {
+		if ( !mVisualLines.isLineMeasured( line ) )
+			mVisualLines.setLineRows( line, it->second.columns.size() + 1 );
+		return it->second.columns;
+	}
+	// Only the lines around the viewport are requested, the cache is just dropped when it grows.
+	if ( mWrapCache.size() >= 1024 )
+		mWrapCache.clear();
+	WrappedLine& wrapped = mWrapCache[line];
+	wrapped.hash = docLine.getHash();
+	computeLineWrapColumns( line, wrapped.columns );
+	// The line is measured every time it's wrapped
+	mVisualLines.setLineRows( line, wrapped.columns.size() + 1 );
+	return wrapped.columns;
+}
+
 void UICodeEditor::invalidateLinesCache() {
 	if ( mFont && !mFont->isMonospace() ) {
 		mTextCache.clear();
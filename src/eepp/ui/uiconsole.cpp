@@ -10,6 +10,7 @@
 #include <eepp/scene/actions/actions.hpp>
 #include <eepp/system/filesystem.hpp>
 #include <eepp/system/lock.hpp>
+#include <eepp/system/profiler.hpp>
 #include <eepp/system/sys.hpp>
 #include <eepp/ui/css/propertydefinition.hpp>
 #include <eepp/ui/uiconsole.hpp>
@@ -104,6 +105,15 @@ void UIConsole::scheduledUpdate( const Time& ) {
 	}
 }
 
+Time UIConsole::getIdleTime() {
+	if ( hasFocus() && getUISceneNode()->getWindow()->hasFocus() && mBlinkTime != Time::Zero ) {
+		Time elapsed( mBlinkTimer.getElapsedTime() );
+		return elapsed < mBlinkTime ? mBlinkTime - elapsed : Time::Zero;
+	}
+
+	return Time::Infinity;
+}
+
 const Time& UIConsole::getBlinkTime() const {
 	return mBlinkTime;
 }
@@ -440,9 +450,38 @@ void UIConsole::draw() {
 					   mPaddingPx.Right,
 				   mScreenPos.y + mPaddingPx.Top + eefloor( lineHeight / 2 ) );
 		text.setFillColor( OldColor1 );
+
+		if ( mShowProfiler && mTextCache.size() >= 4 ) {
+			Text& profText = mTextCache[mTextCache.size() - 4].text;
+			profText.setStyleConfig( mFontStyleConfig );
+			profText.setFillColor( fontColor );
+			profText.setString( getProfilerText() );
+			profText.draw( mScreenPos.x + getPixelsSize().getWidth() - profText.getTextWidth() -
+							   cw - mPaddingPx.Right,
+						   mScreenPos.y + mPaddingPx.Top + eefloor( lineHeight / 2 ) +
+							   lineHeight );
+		}
 	}
 }
 
+String UIConsole::getProfilerText() const {
+	if ( !Profiler::isCompiledIn() )
+		return "Profiler not available ( build with --with-profiler )";
+
+	// Zones displayed in the overlay
+	static constexpr size_t MAX_ZONES = 12;
+
+	auto stats = Profiler::instance()->getLastFrameStats();
+	std::string str( String::format(
+		"Frame: %.2f ms", Profiler::instance()->getLastFrameTime().asMilliseconds() ) );
+
+	for ( size_t i = 0; i < stats.size() && i < MAX_ZONES; i++ )
+		str += String::format( "\n%s: %.2f ms ( %u )", stats[i].name,
+							   stats[i].time.asMilliseconds(), stats[i].count );
+
+	return String::fromUtf8( str );
+}
+
 // CMDS
 void UIConsole::createDefaultCommands() {
 	addCommand( "clear", [&]( const auto& ) { cmdClear(); } );
@@ -458,6 +497,7 @@ void UIConsole::createDefaultCommands() {
 	addCommand( "dir", [&]( const auto& params ) { cmdDir( params ); } );
 	addCommand( "ls", [&]( const auto& params ) { cmdDir( params ); } );
 	addCommand( "showfps", [&]( const auto& params ) { cmdShowFps( params ); } );
+	addCommand( "showprofiler", [&]( const auto& params ) { cmdShowProfiler( params ); } );
 	addCommand( "gettexturememory", [&]( const auto& ) { cmdGetTextureMemory(); } );
 	addCommand( "hide", [&]( const auto& ) { hide(); } );
 }
@@ -627,6 +667,21 @@ void UIConsole::cmdShowFps( const std::vector<String>& params ) {
 	privPushText( "Valid parameters are 0 ( hide ) or 1 ( show )." );
 }
 
+void UIConsole::cmdShowProfiler( const std::vector<String>& params ) {
+	if ( params.size() >= 2 ) {
+		Int32 tInt = 0;
+
+		bool res = String::fromString<Int32>( tInt, params[1] );
+
+		if ( res && ( tInt == 0 || tInt == 1 ) ) {
+			showProfiler( 0 != tInt );
+			return;
+		}
+	}
+
+	privPushText( "Valid parameters are 0 ( hide ) or 1 ( show ). Requires showfps 1." );
+}
+
 void UIConsole::writeLog( const std::string& text ) {
 	std::vector<String> strings = String::split( String( text ) );
 	for ( size_t i = 0; i < strings.size(); i++ )
@@ -641,6 +696,17 @@ void UIConsole::showFps( const bool& show ) {
 	mShowFps = show;
 }
 
+const bool& UIConsole::isShowingProfiler() const {
+	return mShowProfiler;
+}
+
+void UIConsole::showProfiler( const bool& show ) {
+	mShowProfiler = show;
+
+	if ( show && !Profiler::isRunning() )
+		Profiler::instance()->start();
+}
+
 void UIConsole::copy() {
 	getUISceneNode()->getWindow()->getClipboard()->setText( mDoc.getSelectedText().toUtf8() );
 }
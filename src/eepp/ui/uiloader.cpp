@@ -85,6 +85,11 @@ void UILoader::scheduledUpdate( const Time& time ) {
 	}
 }
 
+Time UILoader::getIdleTime() {
+	return mVisible && isMeOrParentTreeVisible() && mAnimationSpeed != 0.f ? Time::Zero
+																		   : Time::Infinity;
+}
+
 UILoader* UILoader::setOutlineThickness( const Float& thickness ) {
 	if ( thickness != mOutlineThickness ) {
 		mOutlineThickness = thickness;
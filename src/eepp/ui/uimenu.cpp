@@ -669,6 +669,14 @@ void UIMenu::scheduledUpdate( const Time& ) {
 		hide();
 }
 
+Time UIMenu::getIdleTime() {
+	if ( !mVisible )
+		return Time::Infinity;
+
+	Time elapsed( mInactiveTime.getElapsedTime() );
+	return elapsed < Seconds( 1 ) ? Seconds( 1 ) - elapsed : Time::Zero;
+}
+
 bool UIMenu::isChildOfMeOrSubMenu( Node* node ) {
 	return isParentOf( node ) || mOwnerNode == node ||
 		   ( mCurrentSubMenu && mCurrentSubMenu->isChildOfMeOrSubMenu( node ) );
@@ -1,4 +1,5 @@
 #include <eepp/graphics/font.hpp>
+#include <eepp/graphics/framebuffer.hpp>
 #include <eepp/graphics/globalbatchrenderer.hpp>
 #include <eepp/graphics/primitives.hpp>
 #include <eepp/graphics/renderer/renderer.hpp>
@@ -40,7 +41,8 @@ UINode::UINode() :
 	mBorder( NULL ),
 	mDragButton( EE_BUTTON_LMASK ),
 	mSkinColor( Color::White ),
-	mUISceneNode( SceneManager::instance()->getUISceneNode() ) {
+	mUISceneNode( SceneManager::instance()->getUISceneNode() ),
+	mRetainedFrameBuffer( NULL ) {
 	mNodeFlags |= NODE_FLAG_UINODE | NODE_FLAG_OVER_FIND_ALLOWED;
 
 	if ( NULL != mUISceneNode )
@@ -53,6 +55,7 @@ UINode::~UINode() {
 	eeSAFE_DELETE( mBackground );
 	eeSAFE_DELETE( mForeground );
 	eeSAFE_DELETE( mBorder );
+	eeSAFE_DELETE( mRetainedFrameBuffer );
 
 	if ( isDragging() && getEventDispatcher() )
 		getEventDispatcher()->setNodeDragging( NULL );
@@ -100,6 +103,9 @@ void UINode::setInternalPosition( const Vector2f& Pos ) {
 	mDpPos = Pos;
 	Transformable::setPosition( PixelDensity::dpToPx( Pos ) );
 	setDirty();
+
+	if ( NULL != mParentNode )
+		mParentNode->invalidateContentBounds();
 }
 
 void UINode::setPosition( const Vector2f& Pos ) {
@@ -119,6 +125,10 @@ void UINode::setPixelsPosition( const Vector2f& Pos ) {
 		mDpPos = PixelDensity::pxToDp( Pos );
 		Transformable::setPosition( Pos );
 		setDirty();
+
+		if ( NULL != mParentNode )
+			mParentNode->invalidateContentBounds();
+
 		onPositionChange();
 	}
 }
@@ -148,6 +158,9 @@ void UINode::setInternalSize( const Sizef& size ) {
 		mDpSize = size;
 		mSize = PixelDensity::dpToPx( s );
 		mNodeFlags |= NODE_FLAG_POLYGON_DIRTY;
+		invalidateContentBounds();
+		if ( NULL != mParentNode )
+			mParentNode->invalidateContentBounds();
 		updateCenter();
 		sendCommonEvent( Event::OnSizeChange );
 		invalidateDraw();
@@ -168,6 +181,9 @@ void UINode::setInternalPixelsSize( const Sizef& size ) {
 		mDpSize = PixelDensity::pxToDp( s ).ceil();
 		mSize = s;
 		mNodeFlags |= NODE_FLAG_POLYGON_DIRTY;
+		invalidateContentBounds();
+		if ( NULL != mParentNode )
+			mParentNode->invalidateContentBounds();
 		updateCenter();
 		sendCommonEvent( Event::OnSizeChange );
 		invalidateDraw();
@@ -1014,51 +1030,154 @@ void UINode::nodeDraw() {
 		if ( mNodeFlags & NODE_FLAG_POLYGON_DIRTY )
 			updateWorldPolygon();
 
-		matrixSet();
+		updateDrawnBounds();
 
-		smartClipStart( ClipType::BorderBox );
+		if ( NULL != mRetainedFrameBuffer ) {
+			drawRetained();
+		} else {
+			matrixSet();
 
-		if ( mWorldBounds.intersect( mSceneNode->getWorldBounds() ) ) {
-			smartClipStart( ClipType::ContentBox );
+			drawNode( mWorldBounds.intersect( mSceneNode->getCullRect() ) );
 
-			if ( 0.f != mAlpha ) {
-				drawBackground();
+			matrixUnset();
+		}
+	}
+}
 
-				drawSkin();
-			}
+void UINode::drawNode( bool visible ) {
+	smartClipStart( ClipType::BorderBox );
+
+	if ( visible ) {
+		smartClipStart( ClipType::ContentBox );
+
+		if ( 0.f != mAlpha ) {
+			drawBackground();
+
+			drawSkin();
+		}
+
+		smartClipStart( ClipType::PaddingBox );
+
+		draw();
+
+		drawChilds();
+
+		smartClipEnd( ClipType::PaddingBox );
+
+		if ( 0.f != mAlpha )
+			drawForeground();
+
+		smartClipEnd( ClipType::ContentBox );
+	} else if ( !isClipped() ) {
+		drawChilds();
+	}
+
+	drawBorder();
+
+	if ( mNodeFlags & NODE_FLAG_DROPPABLE_HOVERING )
+		drawDroppableHovering();
+
+	drawHighlightFocus();
+
+	drawOverNode();
+
+	updateDebugData();
+
+	drawBox();
 
-			smartClipStart( ClipType::PaddingBox );
+	smartClipEnd( ClipType::BorderBox );
+}
+
+void UINode::drawRetained() {
+	if ( invalidated() ) {
+		Sizei size( eemax( 1, (int)eeceil( mSize.getWidth() ) ),
+					eemax( 1, (int)eeceil( mSize.getHeight() ) ) );
+
+		if ( mRetainedFrameBuffer->getWidth() != size.getWidth() ||
+			 mRetainedFrameBuffer->getHeight() != size.getHeight() )
+			mRetainedFrameBuffer->resize( size.getWidth(), size.getHeight() );
+
+		// The clipping areas are in window coordinates, the childs clip against the frame buffer
+		ClippingMask* clippingMask = GLi->getClippingMask();
+		std::list<Rectf> scissors( clippingMask->getScissorsClipped() );
+		std::list<Rectf> planes( clippingMask->getPlanesClipped() );
+
+		clippingMask->clipDisableAll();
+
+		mRetainedFrameBuffer->bind();
+
+		mRetainedFrameBuffer->clear();
 
-			draw();
+		GLi->pushMatrix();
+		GLi->translatef( -mScreenPosi.x, -mScreenPosi.y, 0.f );
 
-			drawChilds();
+		drawNode( true );
+
+		GlobalBatchRenderer::instance()->draw();
+
+		GLi->popMatrix();
+
+		mRetainedFrameBuffer->unbind();
+
+		clippingMask->setScissorsClipped( scissors );
+		clippingMask->setPlanesClipped( planes );
+
+		writeNodeFlag( NODE_FLAG_VIEW_DIRTY, 0 );
+	}
 
-			smartClipEnd( ClipType::PaddingBox );
+	matrixSet();
 
-			if ( 0.f != mAlpha )
-				drawForeground();
+	Rect r( 0, 0, mSize.getWidth(), mSize.getHeight() );
+	TextureRegion textureRegion( mRetainedFrameBuffer->getTexture()->getTextureId(), r,
+								 r.getSize().asFloat() );
+	textureRegion.draw( mScreenPosi.x, mScreenPosi.y );
 
-			smartClipEnd( ClipType::ContentBox );
-		} else if ( !isClipped() ) {
-			drawChilds();
+	matrixUnset();
+}
+
+UINode* UINode::setRetainedDraw( bool retained ) {
+	if ( isWindow() || retained == ( NULL != mRetainedFrameBuffer ) )
+		return this;
+
+	if ( retained ) {
+		mRetainedFrameBuffer =
+			FrameBuffer::New( eemax( 1, (int)eeceil( mSize.getWidth() ) ),
+							  eemax( 1, (int)eeceil( mSize.getHeight() ) ), true, false, false );
+
+		// Frame buffer failed to create?
+		if ( !mRetainedFrameBuffer->created() ) {
+			eeSAFE_DELETE( mRetainedFrameBuffer );
+			return this;
 		}
+	} else {
+		eeSAFE_DELETE( mRetainedFrameBuffer );
+	}
 
-		drawBorder();
+	writeNodeFlag( NODE_FLAG_FRAME_BUFFER, retained ? 1 : 0 );
+	writeNodeFlag( NODE_FLAG_RETAINED_DRAW, retained ? 1 : 0 );
 
-		if ( mNodeFlags & NODE_FLAG_DROPPABLE_HOVERING )
-			drawDroppableHovering();
+	updateDrawInvalidator( true );
 
-		drawHighlightFocus();
+	invalidateDraw();
 
-		drawOverNode();
+	return this;
+}
 
-		updateDebugData();
+FrameBuffer* UINode::getRetainedFrameBuffer() const {
+	return mRetainedFrameBuffer;
+}
 
-		drawBox();
+bool UINode::isDrawInvalidator() const {
+	return NULL != mRetainedFrameBuffer;
+}
 
-		smartClipEnd( ClipType::BorderBox );
+void UINode::invalidate( Node* ) {
+	if ( mVisible && mAlpha != 0.f ) {
+		writeNodeFlag( NODE_FLAG_VIEW_DIRTY, 1 );
 
-		matrixUnset();
+		// The retained frame buffer is drawn into the parent invalidator
+		if ( NULL != mRetainedFrameBuffer && NULL != mNodeDrawInvalidator )
+			mNodeDrawInvalidator->invalidate( this );
 	}
 }
 
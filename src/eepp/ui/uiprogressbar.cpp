@@ -107,6 +107,13 @@ void UIProgressBar::scheduledUpdate( const Time& time ) {
 		invalidateDraw();
 }
 
+Time UIProgressBar::getIdleTime() {
+	return NULL != mFiller->mFillerSkin && mStyleConfig.MovementSpeed != Vector2f::Zero &&
+				   isMeOrParentTreeVisible()
+			   ? Time::Zero
+			   : Time::Infinity;
+}
+
 void UIProgressBar::setTheme( UITheme* Theme ) {
 	UIWidget::setTheme( Theme );
 	setThemeSkin( Theme, "progressbar" );
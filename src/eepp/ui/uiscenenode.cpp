@@ -8,6 +8,7 @@
 #include <eepp/system/filesystem.hpp>
 #include <eepp/system/functionstring.hpp>
 #include <eepp/system/packmanager.hpp>
+#include <eepp/system/profiler.hpp>
 #include <eepp/system/virtualfilesystem.hpp>
 #include <eepp/ui/css/mediaquery.hpp>
 #include <eepp/ui/css/stylesheetparser.hpp>
@@ -388,6 +389,17 @@ bool UISceneNode::hasStyleSheet() {
 	return !mStyleSheet.isEmpty();
 }
 
+void UISceneNode::invalidateFontMetrics() {
+	Node* child = mChild;
+
+	while ( NULL != child ) {
+		if ( child->isWidget() )
+			child->asType<UIWidget>()->reloadFontMetrics();
+
+		child = child->getNextNode();
+	}
+}
+
 void UISceneNode::reloadStyle( const bool& disableAnimations ) {
 	if ( NULL != mChild ) {
 		Node* child = mChild;
@@ -497,6 +509,7 @@ void UISceneNode::setInternalSize( const Sizef& size ) {
 	if ( size != mDpSize ) {
 		mDpSize = size;
 		mSize = PixelDensity::dpToPx( size );
+		invalidateContentBounds();
 		updateCenter();
 		sendCommonEvent( Event::OnSizeChange );
 		invalidateDraw();
@@ -547,7 +560,16 @@ UISceneNode* UISceneNode::setPixelsSize( const Float& x, const Float& y ) {
 	return setPixelsSize( Sizef( x, y ) );
 }
 
+Time UISceneNode::getIdleTime() {
+	if ( !mDirtyStyle.empty() || !mDirtyStyleState.empty() || !mDirtyLayouts.empty() )
+		return Time::Zero;
+
+	return SceneNode::getIdleTime();
+}
+
 void UISceneNode::update( const Time& elapsed ) {
+	eePROFILE_SCOPE( "UISceneNode::update" );
+
 	UISceneNode* uiSceneNode = SceneManager::instance()->getUISceneNode();
 
 	SceneManager::instance()->setCurrentUISceneNode( this );
@@ -731,6 +753,8 @@ void UISceneNode::setIsLoading( bool isLoading ) {
 }
 
 void UISceneNode::updateDirtyLayouts() {
+	eePROFILE_SCOPE( "UISceneNode::updateDirtyLayouts" );
+
 	if ( !mDirtyLayouts.empty() ) {
 		mUpdatingLayouts = true;
 
@@ -744,6 +768,8 @@ void UISceneNode::updateDirtyLayouts() {
 }
 
 void UISceneNode::updateDirtyStyles() {
+	eePROFILE_SCOPE( "UISceneNode::updateDirtyStyles" );
+
 	if ( !mDirtyStyle.empty() ) {
 		Clock clock;
 		for ( auto& node : mDirtyStyle ) {
@@ -757,6 +783,8 @@ void UISceneNode::updateDirtyStyles() {
 }
 
 void UISceneNode::updateDirtyStyleStates() {
+	eePROFILE_SCOPE( "UISceneNode::updateDirtyStyleStates" );
+
 	if ( !mDirtyStyleState.empty() ) {
 		Clock clock;
 		for ( auto& node : mDirtyStyleState ) {
@@ -897,6 +925,7 @@ void UISceneNode::setInternalPixelsSize( const Sizef& size ) {
 		mDpSize = PixelDensity::pxToDp( s ).ceil();
 		mSize = s;
 		mNodeFlags |= NODE_FLAG_POLYGON_DIRTY;
+		invalidateContentBounds();
 		updateCenter();
 		sendCommonEvent( Event::OnSizeChange );
 		invalidateDraw();
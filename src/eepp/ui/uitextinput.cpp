@@ -96,6 +96,16 @@ void UITextInput::scheduledUpdate( const Time& time ) {
 	}
 }
 
+Time UITextInput::getIdleTime() {
+	if ( mMouseDown )
+		return Time::Zero;
+
+	if ( mVisible && hasFocus() )
+		return Milliseconds( eemax( 0.f, 500.f - mWaitCursorTime ) );
+
+	return Time::Infinity;
+}
+
 void UITextInput::onCursorPosChange() {
 	sendCommonEvent( Event::OnCursorPosChange );
 	invalidateDraw();
@@ -290,10 +290,15 @@ void UITextView::autoWrap() {
 
 void UITextView::wrapText( const Uint32& maxWidth ) {
 	if ( mFlags & UI_WORD_WRAP ) {
-		mTextCache->setString( mString );
+		// The words are measured once, resizing only fits them again. The text cache is not
+		// invalidated if the lines didn't change.
+		mWrapLayout.setStyle( *mTextCache );
+		mWrapLayout.setString( mString );
+		mTextCache->setString( mWrapLayout.getWrappedString( maxWidth ) );
+	} else {
+		mTextCache->wrapText( maxWidth );
 	}
 
-	mTextCache->wrapText( maxWidth );
 	invalidateDraw();
 }
 
@@ -399,6 +404,13 @@ void UITextView::onFontStyleChanged() {
 	invalidateDraw();
 }
 
+void UITextView::onFontMetricsChange() {
+	// The cached text width was measured with the placeholder glyphs
+	mTextCache->invalidate();
+	recalculate();
+	invalidateDraw();
+}
+
 void UITextView::onAlphaChange() {
 	Color color( getFontColor() );
 	Color newColor( color.r, color.g, color.b, color.a * mAlpha / 255.f );
@@ -205,6 +205,12 @@ void UITooltip::onAutoSize() {
 	}
 }
 
+void UITooltip::onFontMetricsChange() {
+	mTextCache->invalidate();
+	onAutoSize();
+	invalidateDraw();
+}
+
 void UITooltip::autoAlign() {
 	Uint32 Width = mSize.getWidth() - mPaddingPx.Left - mPaddingPx.Right;
 	Uint32 Height = mSize.getHeight() - mPaddingPx.Top - mPaddingPx.Bottom;
@@ -128,6 +128,14 @@ void UITouchDraggableWidget::scheduledUpdate( const Time& time ) {
 	}
 }
 
+Time UITouchDraggableWidget::getIdleTime() {
+	if ( mEnabled && mVisible && isTouchDragEnabled() &&
+		 ( isTouchDragging() || mTouchDragAcceleration != Vector2f::Zero ) )
+		return Time::Zero;
+
+	return Time::Infinity;
+}
+
 Uint32 UITouchDraggableWidget::onMessage( const NodeMessage* msg ) {
 	if ( msg->getMsg() == NodeMessage::MouseDown && ( msg->getFlags() & EE_BUTTON_LMASK ) &&
 		 !isTouchDragging() && isTouchOverAllowedChilds() &&
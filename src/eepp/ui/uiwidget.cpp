@@ -1852,6 +1852,18 @@ void UIWidget::reloadFontFamily() {
 	}
 }
 
+void UIWidget::reloadFontMetrics() {
+	onFontMetricsChange();
+	Node* child = getFirstChild();
+	while ( NULL != child ) {
+		if ( child->isWidget() )
+			child->asType<UIWidget>()->reloadFontMetrics();
+		child = child->getNextNode();
+	}
+}
+
+void UIWidget::onFontMetricsChange() {}
+
 bool UIWidget::isTabStop() const {
 	return ( mFlags & UI_TAB_STOP ) != 0;
 }
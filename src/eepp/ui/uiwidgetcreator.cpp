@@ -113,15 +113,21 @@ void UIWidgetCreator::createBaseWidgetList() {
 UIWidget* UIWidgetCreator::createFromName( std::string widgetName ) {
 	createBaseWidgetList();
 
-	String::toLowerInPlace( widgetName );
+	// Layouts usually declare the widgets in lowercase, only convert it if it's not found
+	auto regIt = registeredWidget.find( widgetName );
 
-	if ( registeredWidget.find( widgetName ) != registeredWidget.end() ) {
-		return registeredWidget[widgetName]();
+	if ( regIt == registeredWidget.end() ) {
+		String::toLowerInPlace( widgetName );
+		regIt = registeredWidget.find( widgetName );
 	}
 
-	if ( widgetCallback.find( widgetName ) != widgetCallback.end() ) {
-		return widgetCallback[widgetName]( widgetName );
-	}
+	if ( regIt != registeredWidget.end() )
+		return regIt->second();
+
+	auto cbIt = widgetCallback.find( widgetName );
+
+	if ( cbIt != widgetCallback.end() )
+		return cbIt->second( widgetName );
 
 	return NULL;
 }
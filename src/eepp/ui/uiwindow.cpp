@@ -1042,6 +1042,11 @@ void UIWindow::scheduledUpdate( const Time& ) {
 	updateResize();
 }
 
+Time UIWindow::getIdleTime() {
+	// The resize cursor is updated by the mouse events, only resizing needs every frame
+	return RESIZE_NONE != mResizeType ? Time::Zero : Time::Infinity;
+}
+
 UIWidget* UIWindow::getContainer() const {
 	return mContainer;
 }
@@ -1245,6 +1250,8 @@ void UIWindow::nodeDraw() {
 		if ( mNodeFlags & NODE_FLAG_POLYGON_DIRTY )
 			updateWorldPolygon();
 
+		updateDrawnBounds();
+
 		preDraw();
 
 		drawShadow();
@@ -12,7 +12,10 @@
 namespace EE { namespace Window { namespace Backend { namespace SDL2 {
 
 InputSDL::InputSDL( EE::Window::Window* window ) :
-	Input( window, eeNew( JoystickManagerSDL, () ) ), mDPIScale( 1.f ) {
+	Input( window, eeNew( JoystickManagerSDL, () ) ),
+	mDPIScale( 1.f ),
+	mWakeUpEventType( (Uint32)-1 ),
+	mWakeUpPending( false ) {
 #if defined( EE_X11_PLATFORM )
 	mMouseSpeed = 1.75f;
 #endif
@@ -33,8 +36,14 @@ void InputSDL::update() {
 			sendEvent( prevEvent );
 		mQueuedEvents.clear();
 	}
-	while ( SDL_PollEvent( &SDLEvent ) )
+	while ( SDL_PollEvent( &SDLEvent ) ) {
+		if ( SDLEvent.type == mWakeUpEventType ) {
+			mWakeUpPending = false;
+			continue;
+		}
+
 		sendEvent( SDLEvent );
+	}
 	InputEvent endProcessingEvent;
 	endProcessingEvent.Type = InputEvent::EventsSent;
 	processEvent( &endProcessingEvent );
@@ -42,15 +51,36 @@ void InputSDL::update() {
 
 void InputSDL::waitEvent( const Time& timeout ) {
 	SDL_Event SDLEvent;
+	int res;
+
 	if ( timeout == Time::Zero ) {
-		if ( SDL_WaitEvent( &SDLEvent ) )
-			mQueuedEvents.emplace_back( SDLEvent );
-	} else if ( SDL_WaitEventTimeout( &SDLEvent, (int)timeout.asMilliseconds() ) ) {
-		if ( SDLEvent.type != SDL_FIRSTEVENT )
+		res = SDL_WaitEvent( &SDLEvent );
+	} else {
+		// Rounded up, waking up before the timeout would make the caller wait again
+		res = SDL_WaitEventTimeout( &SDLEvent, (int)eeceil( timeout.asMilliseconds() ) );
+	}
+
+	if ( res ) {
+		if ( SDLEvent.type == mWakeUpEventType ) {
+			mWakeUpPending = false;
+		} else if ( SDLEvent.type != SDL_FIRSTEVENT ) {
 			mQueuedEvents.emplace_back( SDLEvent );
+		}
 	}
 }
 
+void InputSDL::wakeUp() {
+	if ( (Uint32)-1 == mWakeUpEventType || mWakeUpPending.exchange( true ) )
+		return;
+
+	SDL_Event event;
+	SDL_zero( event );
+	event.type = mWakeUpEventType;
+
+	if ( SDL_PushEvent( &event ) <= 0 )
+		mWakeUpPending = false;
+}
+
 bool InputSDL::grabInput() {
 	return ( SDL_GetWindowGrab( static_cast<WindowSDL*>( mWindow )->GetSDLWindow() ) == SDL_TRUE )
 			   ? true
@@ -118,6 +148,7 @@ Scancode InputSDL::getScancodeFromKey( const Keycode& scancode ) const {
 
 void InputSDL::init() {
 	mDPIScale = mWindow->getScale();
+	mWakeUpEventType = SDL_RegisterEvents( 1 );
 	mMousePos = queryMousePos();
 }
 
@@ -2,6 +2,7 @@
 #define EE_WINDOWCINPUTSDL2_HPP
 
 #include <eepp/window/backend.hpp>
+#include <atomic>
 #include <eepp/window/backend/SDL2/base.hpp>
 
 #ifdef EE_BACKEND_SDL2
@@ -18,6 +19,8 @@ class EE_API InputSDL : public Input {
 
 	void waitEvent( const Time& timeout = Time::Zero );
 
+	void wakeUp();
+
 	bool grabInput();
 
 	void grabInput( const bool& Grab );
@@ -46,6 +49,8 @@ class EE_API InputSDL : public Input {
 	friend class WindowSDL;
 	Float mDPIScale;
 	std::vector<SDL_Event> mQueuedEvents;
+	Uint32 mWakeUpEventType;
+	std::atomic<bool> mWakeUpPending;
 
 	InputSDL( EE::Window::Window* window );
 
@@ -227,6 +227,13 @@ bool WindowSDL::create( WindowSettings Settings, ContextSettings Context ) {
 	mWindow.WindowConfig = Settings;
 	mWindow.ContextConfig = Context;
 
+	bool nullRenderer = GLv_Null == Context.Version;
+
+	// The null renderer doesn't need a graphics context, unless other video driver is requested the
+	// dummy driver is used, so it can run without a display
+	if ( nullRenderer )
+		SDL_setenv( "SDL_VIDEODRIVER", "dummy", 0 );
+
 	if ( SDL_Init( SDL_INIT_VIDEO ) != 0 ) {
 		Log::error( "Unable to initialize SDL: %s", SDL_GetError() );
 
@@ -249,7 +256,10 @@ bool WindowSDL::create( WindowSettings Settings, ContextSettings Context ) {
 		mWindow.WindowConfig.Height = mWindow.DesktopResolution.getHeight();
 	}
 
-	mWindow.Flags = SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | SDL_WINDOW_ALLOW_HIGHDPI;
+	mWindow.Flags = SDL_WINDOW_SHOWN | SDL_WINDOW_ALLOW_HIGHDPI;
+
+	if ( !nullRenderer )
+		mWindow.Flags |= SDL_WINDOW_OPENGL;
 
 	if ( mWindow.WindowConfig.Style & WindowStyle::Resize ) {
 		mWindow.Flags |= SDL_WINDOW_RESIZABLE;
@@ -329,36 +339,45 @@ bool WindowSDL::create( WindowSettings Settings, ContextSettings Context ) {
 	}
 #endif
 
+	if ( nullRenderer ) {
+		mWindow.ContextConfig.SharedGLContext = false;
+	} else {
 #ifdef SDL2_THREADED_GLCONTEXT
-	if ( mWindow.ContextConfig.SharedGLContext ) {
-		SDL_GL_SetAttribute( SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1 );
+		if ( mWindow.ContextConfig.SharedGLContext ) {
+			SDL_GL_SetAttribute( SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1 );
 
-		mGLContextThread = SDL_GL_CreateContext( mSDLWindow );
-		mGLContext = SDL_GL_CreateContext( mSDLWindow );
-	} else {
-		mGLContext = SDL_GL_CreateContext( mSDLWindow );
-	}
+			mGLContextThread = SDL_GL_CreateContext( mSDLWindow );
+			mGLContext = SDL_GL_CreateContext( mSDLWindow );
+		} else {
+			mGLContext = SDL_GL_CreateContext( mSDLWindow );
+		}
 #else
-	mGLContext = SDL_GL_CreateContext( mSDLWindow );
-	mWindow.ContextConfig.SharedGLContext = false;
+		mGLContext = SDL_GL_CreateContext( mSDLWindow );
+		mWindow.ContextConfig.SharedGLContext = false;
 #endif
 
-	if ( NULL == mGLContext
+		if ( NULL == mGLContext
 #ifdef SDL2_THREADED_GLCONTEXT
-		 || ( mWindow.ContextConfig.SharedGLContext && NULL == mGLContextThread )
+			 || ( mWindow.ContextConfig.SharedGLContext && NULL == mGLContextThread )
 #endif
-	) {
-		Log::error( "Unable to create context: %s", SDL_GetError() );
+		) {
+			Log::error( "Unable to create context: %s", SDL_GetError() );
 
-		logFailureInit( "WindowSDL", getVersion() );
+			logFailureInit( "WindowSDL", getVersion() );
 
-		return false;
+			return false;
+		}
 	}
 
 	// In some platforms it will not create the desired window size, so we query the real window
 	// size created
 	int w, h;
-	SDL_GL_GetDrawableSize( mSDLWindow, &w, &h );
+
+	if ( nullRenderer ) {
+		SDL_GetWindowSize( mSDLWindow, &w, &h );
+	} else {
+		SDL_GL_GetDrawableSize( mSDLWindow, &w, &h );
+	}
 
 	if ( w > 0 && h > 0 ) {
 		mWindow.WindowConfig.Width = w;
@@ -375,9 +394,11 @@ bool WindowSDL::create( WindowSettings Settings, ContextSettings Context ) {
 		return false;
 	}
 
-	SDL_GL_SetSwapInterval( ( mWindow.ContextConfig.VSync ? 1 : 0 ) ); // VSync
+	if ( !nullRenderer ) {
+		SDL_GL_SetSwapInterval( ( mWindow.ContextConfig.VSync ? 1 : 0 ) ); // VSync
 
-	SDL_GL_MakeCurrent( mSDLWindow, mGLContext );
+		SDL_GL_MakeCurrent( mSDLWindow, mGLContext );
+	}
 
 	mID = SDL_GetWindowID( mSDLWindow );
 
@@ -643,7 +664,8 @@ void WindowSDL::setSize( Uint32 width, Uint32 height, bool windowed ) {
 }
 
 void WindowSDL::swapBuffers() {
-	SDL_GL_SwapWindow( mSDLWindow );
+	if ( NULL != mGLContext )
+		SDL_GL_SwapWindow( mSDLWindow );
 }
 
 std::vector<DisplayMode> WindowSDL::getDisplayModes() const {
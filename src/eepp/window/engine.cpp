@@ -1,3 +1,6 @@
+#include <cstdlib>
+#include <eepp/audio/soundbuffercache.hpp>
+#include <eepp/audio/soundstreamscheduler.hpp>
 #include <eepp/graphics/fontmanager.hpp>
 #include <eepp/graphics/framebuffermanager.hpp>
 #include <eepp/graphics/globalbatchrenderer.hpp>
@@ -14,6 +17,8 @@
 #include <eepp/system/filesystem.hpp>
 #include <eepp/system/inifile.hpp>
 #include <eepp/system/packmanager.hpp>
+#include <eepp/system/processreactor.hpp>
+#include <eepp/system/profiler.hpp>
 #include <eepp/system/thread.hpp>
 #include <eepp/system/virtualfilesystem.hpp>
 #include <eepp/ui/css/stylesheetspecification.hpp>
@@ -58,9 +63,24 @@ Engine::Engine() :
 #endif
 
 	TextureAtlasManager::createSingleton();
+
+	eePROFILE_THREAD_NAME( "Main" );
+
+	const char* tracePath = getenv( "EEPP_PROFILER_TRACE" );
+
+	if ( NULL != tracePath && tracePath[0] != '\0' ) {
+		Profiler::instance()->setTracePath( tracePath );
+		Profiler::instance()->start();
+	}
 }
 
 Engine::~Engine() {
+	Profiler::destroySingleton();
+
+	Audio::SoundStreamScheduler::destroySingleton();
+
+	Audio::SoundBufferCache::destroySingleton();
+
 	Physics::PhysicsManager::destroySingleton();
 
 	GlobalBatchRenderer::destroySingleton();
@@ -71,6 +91,8 @@ Engine::~Engine() {
 
 	Scene::SceneManager::destroySingleton();
 
+	ProcessReactor::destroySingleton();
+
 	CSS::StyleSheetSpecification::destroySingleton();
 
 	Doc::SyntaxDefinitionManager::destroySingleton();
@@ -4,6 +4,7 @@
 #include <eepp/graphics/renderer/renderer.hpp>
 #include <eepp/graphics/texturefactory.hpp>
 #include <eepp/system/filesystem.hpp>
+#include <eepp/system/profiler.hpp>
 #include <eepp/version.hpp>
 #include <eepp/window/clipboard.hpp>
 #include <eepp/window/cursormanager.hpp>
@@ -210,7 +211,8 @@ void Window::setup2D( const bool& KeepView ) {
 
 	BlendMode::setMode( BlendMode::Alpha(), true );
 
-	if ( GLv_3CP != GLi->version() && GLv_3 != GLi->version() && GLv_ES2 != GLi->version() ) {
+	if ( GLv_3CP != GLi->version() && GLv_3 != GLi->version() && GLv_ES2 != GLi->version() &&
+		 GLv_Null != GLi->version() ) {
 #if !defined( EE_GLES2 ) || defined( EE_GLES_BOTH )
 		glTexEnvi( GL_POINT_SPRITE, GL_COORD_REPLACE, GL_TRUE );
 #endif
@@ -410,6 +412,8 @@ void Window::display( bool clear ) {
 	calculateFps();
 
 	mFrameData.FPS.RenderClock.restart();
+
+	eePROFILE_FRAME_MARK();
 }
 
 Clipboard* Window::getClipboard() const {
@@ -59,6 +59,11 @@ class EE_MAPS_API MapLight {
 
 	void setPosition( const Vector2f& newPos );
 
+	/** @return A counter that is increased every time the light position, radius, color, type or
+	 * active state changes. Used by the MapLightManager to detect which lights need to be
+	 * recomputed. */
+	const Uint32& getVersion() const;
+
   protected:
 	Float mRadius;
 	Vector2f mPos;
@@ -66,6 +71,7 @@ class EE_MAPS_API MapLight {
 	MapLightType mType;
 	Rectf mAABB;
 	bool mActive;
+	Uint32 mVersion;
 
 	void updateAABB();
 };
@@ -3,12 +3,20 @@
 
 #include <eepp/maps/base.hpp>
 #include <eepp/maps/maplight.hpp>
+#include <eepp/system/threadpool.hpp>
 #include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace EE { namespace Maps {
 
 class TileMap;
 
+/** The light manager keeps the light map of the visible tiles of a TileMap.
+ * The light map is updated incrementally: only the tile regions affected by lights that were
+ * added, removed, moved or modified ( and the tiles that became visible ) are recomputed.
+ * Large regions can be split across the threads of a ThreadPool ( see setThreadPool ). */
 class EE_MAPS_API MapLightManager {
   public:
 	typedef std::list<MapLight*> LightsList;
@@ -39,12 +47,50 @@ class EE_MAPS_API MapLightManager {
 
 	MapLight* getLightOver( const Vector2f& OverPos, MapLight* LightCurrent = NULL );
 
+	/** Forces a full recomputation of the visible light map in the next update. */
+	void invalidate();
+
+	/** Sets the thread pool used to split the computation of large regions. Pass an empty pointer
+	 * to compute everything in the calling thread ( default ). */
+	void setThreadPool( std::shared_ptr<ThreadPool> threadPool );
+
+	const std::shared_ptr<ThreadPool>& getThreadPool() const;
+
+	/** @return The number of tiles recomputed during the last update. */
+	const Uint32& getLastUpdatedTilesCount() const;
+
   protected:
+	struct LightState {
+		Rectf AABB;
+		Uint32 Version;
+		Uint32 Frame;
+	};
+
+	struct LightParams {
+		Float x;
+		Float y;
+		Float Radius;
+		Float Color[3];
+		bool Isometric;
+		Rectf AABB;
+	};
+
 	TileMap* mMap;
 	Int32 mNumVertex;
-	Color**** mTileColors;
+	std::vector<Color> mTileColors;
 	LightsList mLights;
+	std::unordered_map<MapLight*, LightState> mLightsState;
+	std::vector<Rectf> mDirtyAreas;
+	std::vector<Rect> mDirtyRegions;
+	std::vector<LightParams> mRegionLights;
+	std::vector<std::vector<Float>> mScratch;
+	std::shared_ptr<ThreadPool> mThreadPool;
+	Rect mValidTiles;
+	Color mLastBaseColor;
+	Uint32 mFrame;
+	Uint32 mLastUpdatedTiles;
 	bool mIsByVertex;
+	bool mFullUpdate;
 
 	void allocateColors();
 
@@ -52,9 +98,19 @@ class EE_MAPS_API MapLightManager {
 
 	void destroyLights();
 
-	virtual void updateByVertex();
+	void collectDirtyRegions( const Rect& visible );
+
+	Rect areaToTiles( const Rectf& area ) const;
+
+	virtual void updateRegion( const Rect& tiles );
+
+	virtual void updateByVertex( const Rect& tiles, Int32 fromColumn, Int32 toColumn,
+								 std::vector<Float>& scratch );
+
+	virtual void updateByTile( const Rect& tiles, Int32 fromColumn, Int32 toColumn,
+							   std::vector<Float>& scratch );
 
-	virtual void updateByTile();
+	Color* tileColors( const Int32& x, const Int32& y );
 };
 
 }} // namespace EE::Maps
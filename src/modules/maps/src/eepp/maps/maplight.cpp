@@ -3,13 +3,17 @@
 namespace EE { namespace Maps {
 
 MapLight::MapLight() :
-	mRadius( 0 ), mColor( 255, 255, 255 ), mType( MapLightType::Normal ), mActive( true ) {}
+	mRadius( 0 ),
+	mColor( 255, 255, 255 ),
+	mType( MapLightType::Normal ),
+	mActive( true ),
+	mVersion( 0 ) {}
 
 MapLight::~MapLight() {}
 
 MapLight::MapLight( const Float& Radius, const Float& x, const Float& y, const RGB& Color,
 					MapLightType Type ) :
-	mActive( true ) {
+	mActive( true ), mVersion( 0 ) {
 	create( Radius, x, y, Color, Type );
 }
 
@@ -142,6 +146,8 @@ Rectf MapLight::getAABB() const {
 }
 
 void MapLight::updateAABB() {
+	mVersion++;
+
 	if ( mType == MapLightType::Normal )
 		mAABB = Rectf( mPos.x - mRadius, mPos.y - mRadius, mPos.x + mRadius, mPos.y + mRadius );
 	else
@@ -165,11 +171,17 @@ const bool& MapLight::isActive() const {
 }
 
 void MapLight::setActive( const bool& active ) {
-	mActive = active;
+	if ( active != mActive ) {
+		mActive = active;
+		mVersion++;
+	}
 }
 
 void MapLight::setColor( const RGB& color ) {
-	mColor = color;
+	if ( mColor != color ) {
+		mColor = color;
+		mVersion++;
+	}
 }
 
 const RGB& MapLight::getColor() const {
@@ -189,4 +201,8 @@ const Vector2f& MapLight::getPosition() const {
 	return mPos;
 }
 
+const Uint32& MapLight::getVersion() const {
+	return mVersion;
+}
+
 }} // namespace EE::Maps
@@ -1,11 +1,63 @@
 #include <eepp/maps/maplightmanager.hpp>
 #include <eepp/maps/tilemap.hpp>
+#include <condition_variable>
+#include <mutex>
 
 namespace EE { namespace Maps {
 
-MapLightManager::MapLightManager( TileMap* Map, bool ByVertex ) : mMap( Map ), mTileColors( NULL ) {
-	mIsByVertex = ByVertex;
+// Minimum amount of light map points of a region to split its computation across threads.
+static constexpr Int32 PARALLEL_POINTS_THRESHOLD = 4096;
+
+// Accumulates a light into a column of points. The column is stored as a flat buffer: the first
+// row holds the distances to the light and the following three rows hold the red, green and blue
+// channels. The loops are branchless so the compiler can vectorize them.
+static inline void accumulateLight( const Float& lightX, const Float& lightY,
+									const Float& lightRadius, const Float* lightColor,
+									const bool& isometric, const Float& pointX,
+									const Float& firstPointY, const Float& stepY, const Int32& from,
+									const Int32& to, Float* buffer, const Int32& stride ) {
+	Float* dist = buffer;
+	Float dx = isometric ? ( pointX - lightX ) * 0.5f : pointX - lightX;
+	Float dx2 = dx * dx;
+	Float distScale = isometric ? 2.f : 1.f;
+	Float invRadius = 1.f / lightRadius;
+
+	for ( Int32 i = from; i < to; i++ ) {
+		Float dy = firstPointY + i * stepY - lightY;
+		dist[i] = eesqrt( dx2 + dy * dy ) * distScale;
+	}
+
+	for ( Int32 c = 0; c < 3; c++ ) {
+		Float* channel = buffer + ( c + 1 ) * stride;
+		Float lc = lightColor[c];
+
+		for ( Int32 i = from; i < to; i++ ) {
+			Float vc = channel[i];
+			Float tc = lc - dist[i] * eeabs( lc - vc ) * invRadius;
+			tc = tc < 0 ? 0 : tc;
+			tc = (Float)(Int32)tc;
+			tc = tc < vc ? vc : tc;
+			channel[i] = dist[i] <= lightRadius ? tc : vc;
+		}
+	}
+}
+
+static inline Rect intersectTiles( const Rect& a, const Rect& b ) {
+	return Rect( eemax( a.Left, b.Left ), eemax( a.Top, b.Top ), eemin( a.Right, b.Right ),
+				 eemin( a.Bottom, b.Bottom ) );
+}
 
+static inline bool isEmptyTiles( const Rect& r ) {
+	return r.Right <= r.Left || r.Bottom <= r.Top;
+}
+
+MapLightManager::MapLightManager( TileMap* Map, bool ByVertex ) :
+	mMap( Map ),
+	mLastBaseColor( Map->getBaseColor() ),
+	mFrame( 0 ),
+	mLastUpdatedTiles( 0 ),
+	mIsByVertex( ByVertex ),
+	mFullUpdate( true ) {
 	if ( mIsByVertex )
 		mNumVertex = 4;
 	else
@@ -20,120 +72,314 @@ MapLightManager::~MapLightManager() {
 }
 
 void MapLightManager::update() {
-	if ( mIsByVertex ) {
-		updateByVertex();
-	} else {
-		updateByTile();
+	mLastUpdatedTiles = 0;
+
+	if ( mLights.empty() ) {
+		mFullUpdate = true;
+		mDirtyAreas.clear();
+		mLightsState.clear();
+		return;
 	}
+
+	Rect visible( mMap->getStartTile().x, mMap->getStartTile().y, mMap->getEndTile().x,
+				  mMap->getEndTile().y );
+
+	collectDirtyRegions( visible );
+
+	for ( const Rect& region : mDirtyRegions )
+		updateRegion( region );
+
+	mDirtyRegions.clear();
+	mValidTiles = visible;
 }
 
 const bool& MapLightManager::isByVertex() const {
 	return mIsByVertex;
 }
 
-void MapLightManager::updateByVertex() {
-	Vector2i start = mMap->getStartTile();
-	Vector2i end = mMap->getEndTile();
-	Rectf VisibleArea = mMap->getViewAreaAABB();
-	Sizei TileSize = mMap->getTileSize();
-	Color BaseColor = mMap->getBaseColor();
-	bool firstLight = true;
-	Vector2i Pos;
+void MapLightManager::invalidate() {
+	mFullUpdate = true;
+}
 
-	if ( !mLights.size() )
+void MapLightManager::setThreadPool( std::shared_ptr<ThreadPool> threadPool ) {
+	mThreadPool = threadPool;
+}
+
+const std::shared_ptr<ThreadPool>& MapLightManager::getThreadPool() const {
+	return mThreadPool;
+}
+
+const Uint32& MapLightManager::getLastUpdatedTilesCount() const {
+	return mLastUpdatedTiles;
+}
+
+Rect MapLightManager::areaToTiles( const Rectf& area ) const {
+	Sizei tileSize = mMap->getTileSize();
+	return Rect( (Int32)eefloor( area.Left / tileSize.x ) - 1,
+				 (Int32)eefloor( area.Top / tileSize.y ) - 1,
+				 (Int32)eefloor( area.Right / tileSize.x ) + 2,
+				 (Int32)eefloor( area.Bottom / tileSize.y ) + 2 );
+}
+
+void MapLightManager::collectDirtyRegions( const Rect& visible ) {
+	mDirtyRegions.clear();
+	mFrame++;
+
+	if ( isEmptyTiles( visible ) )
 		return;
 
-	for ( LightsList::iterator it = mLights.begin(); it != mLights.end(); ++it ) {
-		MapLight* Light = ( *it );
+	if ( mLastBaseColor != mMap->getBaseColor() ) {
+		mLastBaseColor = mMap->getBaseColor();
+		mFullUpdate = true;
+	}
 
-		if ( firstLight || VisibleArea.intersect( Light->getAABB() ) ) {
-			for ( Int32 x = start.x; x < end.x; x++ ) {
-				for ( Int32 y = start.y; y < end.y; y++ ) {
-					if ( firstLight ) {
-						mTileColors[x][y][0]->r = mTileColors[x][y][1]->r =
-							mTileColors[x][y][2]->r = mTileColors[x][y][3]->r = BaseColor.r;
-						mTileColors[x][y][0]->g = mTileColors[x][y][1]->g =
-							mTileColors[x][y][2]->g = mTileColors[x][y][3]->g = BaseColor.g;
-						mTileColors[x][y][0]->b = mTileColors[x][y][1]->b =
-							mTileColors[x][y][2]->b = mTileColors[x][y][3]->b = BaseColor.b;
-					}
+	for ( MapLight* light : mLights ) {
+		auto it = mLightsState.find( light );
 
-					Pos.x = x * TileSize.x;
-					Pos.y = y * TileSize.y;
-
-					Rectf TileAABB( Pos.x, Pos.y, Pos.x + TileSize.x, Pos.y + TileSize.y );
-
-					if ( TileAABB.intersect( Light->getAABB() ) ) {
-						if ( y > 0 )
-							mTileColors[x][y][0]->assign( *mTileColors[x][y - 1][1] );
-						else
-							mTileColors[x][y][0]->assign(
-								Light->processVertex( Pos.x, Pos.y, *( mTileColors[x][y][0] ),
-													  *( mTileColors[x][y][0] ) ) );
-
-						mTileColors[x][y][1]->assign( Light->processVertex(
-							Pos.x, Pos.y + TileSize.getHeight(), *( mTileColors[x][y][1] ),
-							*( mTileColors[x][y][1] ) ) );
-
-						mTileColors[x][y][2]->assign( Light->processVertex(
-							Pos.x + TileSize.getWidth(), Pos.y + TileSize.getHeight(),
-							*( mTileColors[x][y][2] ), *( mTileColors[x][y][2] ) ) );
-
-						if ( y > 0 )
-							mTileColors[x][y][3]->assign( *mTileColors[x][y - 1][2] );
-						else
-							mTileColors[x][y][3]->assign( Light->processVertex(
-								Pos.x + TileSize.getWidth(), Pos.y, *( mTileColors[x][y][3] ),
-								*( mTileColors[x][y][3] ) ) );
-					}
-				}
+		if ( it == mLightsState.end() ) {
+			mLightsState[light] = { light->getAABB(), light->getVersion(), mFrame };
+			mDirtyAreas.push_back( light->getAABB() );
+		} else {
+			LightState& state = it->second;
+
+			if ( state.Version != light->getVersion() ) {
+				mDirtyAreas.push_back( state.AABB );
+				mDirtyAreas.push_back( light->getAABB() );
+				state.AABB = light->getAABB();
+				state.Version = light->getVersion();
 			}
 
-			firstLight = false;
+			state.Frame = mFrame;
 		}
 	}
-}
 
-void MapLightManager::updateByTile() {
-	Vector2i start = mMap->getStartTile();
-	Vector2i end = mMap->getEndTile();
-	Rectf VisibleArea = mMap->getViewAreaAABB();
-	Sizei TileSize = mMap->getTileSize();
-	Sizei HalfTileSize = mMap->getTileSize() / 2;
-	Color BaseColor = mMap->getBaseColor();
-	bool firstLight = true;
-	Vector2i Pos;
+	// Lights that were removed from the list without going through removeLight
+	if ( mLightsState.size() != mLights.size() ) {
+		for ( auto it = mLightsState.begin(); it != mLightsState.end(); ) {
+			if ( it->second.Frame != mFrame ) {
+				mDirtyAreas.push_back( it->second.AABB );
+				it = mLightsState.erase( it );
+			} else {
+				++it;
+			}
+		}
+	}
 
-	if ( !mLights.size() )
+	Rect valid( intersectTiles( mValidTiles, visible ) );
+
+	if ( mFullUpdate || isEmptyTiles( valid ) ) {
+		mDirtyRegions.push_back( visible );
+		mDirtyAreas.clear();
+		mFullUpdate = false;
 		return;
+	}
 
-	for ( LightsList::iterator it = mLights.begin(); it != mLights.end(); ++it ) {
-		MapLight* Light = ( *it );
+	// Tiles that just became visible
+	if ( visible.Top < valid.Top )
+		mDirtyRegions.push_back( Rect( visible.Left, visible.Top, visible.Right, valid.Top ) );
 
-		if ( firstLight || VisibleArea.intersect( Light->getAABB() ) ) {
-			for ( Int32 x = start.x; x < end.x; x++ ) {
-				for ( Int32 y = start.y; y < end.y; y++ ) {
-					if ( firstLight ) {
-						mTileColors[x][y][0]->r = BaseColor.r;
-						mTileColors[x][y][0]->g = BaseColor.g;
-						mTileColors[x][y][0]->b = BaseColor.b;
-					}
+	if ( visible.Bottom > valid.Bottom )
+		mDirtyRegions.push_back(
+			Rect( visible.Left, valid.Bottom, visible.Right, visible.Bottom ) );
 
-					Pos.x = x * TileSize.x;
-					Pos.y = y * TileSize.y;
+	if ( visible.Left < valid.Left )
+		mDirtyRegions.push_back( Rect( visible.Left, valid.Top, valid.Left, valid.Bottom ) );
 
-					Rectf TileAABB( Pos.x, Pos.y, Pos.x + TileSize.x, Pos.y + TileSize.y );
+	if ( visible.Right > valid.Right )
+		mDirtyRegions.push_back( Rect( valid.Right, valid.Top, visible.Right, valid.Bottom ) );
 
-					if ( TileAABB.intersect( Light->getAABB() ) ) {
-						mTileColors[x][y][0]->assign( Light->processVertex(
-							Pos.x + HalfTileSize.getWidth(), Pos.y + HalfTileSize.getHeight(),
-							*( mTileColors[x][y][0] ), *( mTileColors[x][y][0] ) ) );
-					}
-				}
+	// Tiles affected by the modified lights
+	for ( const Rectf& area : mDirtyAreas ) {
+		Rect region( intersectTiles( areaToTiles( area ), visible ) );
+
+		if ( !isEmptyTiles( region ) )
+			mDirtyRegions.push_back( region );
+	}
+
+	mDirtyAreas.clear();
+
+	Int64 dirtyCount = 0;
+
+	for ( const Rect& region : mDirtyRegions )
+		dirtyCount += (Int64)region.getWidth() * region.getHeight();
+
+	if ( dirtyCount >= (Int64)visible.getWidth() * visible.getHeight() ) {
+		mDirtyRegions.clear();
+		mDirtyRegions.push_back( visible );
+	}
+}
+
+void MapLightManager::updateRegion( const Rect& tiles ) {
+	Sizei tileSize = mMap->getTileSize();
+	Rectf area( ( tiles.Left - 1 ) * tileSize.x, ( tiles.Top - 1 ) * tileSize.y,
+				( tiles.Right + 1 ) * tileSize.x, ( tiles.Bottom + 1 ) * tileSize.y );
+
+	mRegionLights.clear();
+
+	for ( MapLight* light : mLights ) {
+		if ( light->isActive() && light->getRadius() > 0 && area.intersect( light->getAABB() ) ) {
+			LightParams params;
+			params.x = light->getPosition().x;
+			params.y = light->getPosition().y;
+			params.Radius = light->getRadius();
+			params.Color[0] = light->getColor().r;
+			params.Color[1] = light->getColor().g;
+			params.Color[2] = light->getColor().b;
+			params.Isometric = light->getType() == MapLightType::Isometric;
+			params.AABB = light->getAABB();
+			mRegionLights.push_back( params );
+		}
+	}
+
+	Int32 columns = tiles.getWidth() + ( mIsByVertex ? 1 : 0 );
+	Int32 rows = tiles.getHeight() + ( mIsByVertex ? 1 : 0 );
+	Int32 chunks = 1;
+
+	if ( mThreadPool && columns * rows >= PARALLEL_POINTS_THRESHOLD )
+		chunks = eemin( columns, (Int32)mThreadPool->numThreads() + 1 );
+
+	if ( (Int32)mScratch.size() < chunks )
+		mScratch.resize( chunks );
+
+	auto runChunk = [this, tiles, columns, chunks]( Int32 chunk ) {
+		Int32 from = tiles.Left + columns * chunk / chunks;
+		Int32 to = tiles.Left + columns * ( chunk + 1 ) / chunks;
+
+		if ( mIsByVertex ) {
+			updateByVertex( tiles, from, to, mScratch[chunk] );
+		} else {
+			updateByTile( tiles, from, to, mScratch[chunk] );
+		}
+	};
+
+	if ( chunks > 1 ) {
+		std::mutex mutex;
+		std::condition_variable cv;
+		Int32 pending = chunks - 1;
+
+		for ( Int32 chunk = 1; chunk < chunks; chunk++ ) {
+			mThreadPool->run( [runChunk, chunk] { runChunk( chunk ); },
+							  [&mutex, &cv, &pending] {
+								  std::unique_lock<std::mutex> lock( mutex );
+								  pending--;
+								  cv.notify_one();
+							  } );
+		}
+
+		runChunk( 0 );
+
+		std::unique_lock<std::mutex> lock( mutex );
+		cv.wait( lock, [&pending] { return pending == 0; } );
+	} else {
+		runChunk( 0 );
+	}
+
+	mLastUpdatedTiles += tiles.getWidth() * tiles.getHeight();
+}
+
+void MapLightManager::updateByVertex( const Rect& tiles, Int32 fromColumn, Int32 toColumn,
+									  std::vector<Float>& scratch ) {
+	Sizei tileSize = mMap->getTileSize();
+	const Color& baseColor = mMap->getBaseColor();
+	Int32 rows = tiles.getHeight() + 1;
+	Float firstPointY = tiles.Top * tileSize.y;
+	Float stepY = tileSize.y;
+
+	scratch.resize( rows * 4 );
+
+	Float* buffer = scratch.data();
+	Float* r = buffer + rows;
+	Float* g = buffer + rows * 2;
+	Float* b = buffer + rows * 3;
+
+	for ( Int32 x = fromColumn; x < toColumn; x++ ) {
+		Float pointX = x * tileSize.x;
+
+		for ( Int32 i = 0; i < rows; i++ ) {
+			r[i] = baseColor.r;
+			g[i] = baseColor.g;
+			b[i] = baseColor.b;
+		}
+
+		for ( const LightParams& light : mRegionLights ) {
+			if ( pointX < light.AABB.Left || pointX > light.AABB.Right )
+				continue;
+
+			Int32 from = eemax( 0, (Int32)eeceil( ( light.AABB.Top - firstPointY ) / stepY ) );
+			Int32 to =
+				eemin( rows, (Int32)eefloor( ( light.AABB.Bottom - firstPointY ) / stepY ) + 1 );
+
+			if ( from < to )
+				accumulateLight( light.x, light.y, light.Radius, light.Color, light.Isometric,
+								 pointX, firstPointY, stepY, from, to, buffer, rows );
+		}
+
+		// Point ( x, y ) is the top-left vertex ( 0 ) of tile ( x, y ), the bottom-left ( 1 ) of
+		// tile ( x, y - 1 ), the bottom-right ( 2 ) of tile ( x - 1, y - 1 ) and the top-right
+		// ( 3 ) of tile ( x - 1, y ).
+		for ( Int32 i = 0; i < rows; i++ ) {
+			Int32 y = tiles.Top + i;
+			Color color( (Uint8)r[i], (Uint8)g[i], (Uint8)b[i], 255 );
+
+			if ( x < tiles.Right ) {
+				if ( y < tiles.Bottom )
+					tileColors( x, y )[0] = color;
+
+				if ( y > tiles.Top )
+					tileColors( x, y - 1 )[1] = color;
 			}
 
-			firstLight = false;
+			if ( x > tiles.Left ) {
+				if ( y > tiles.Top )
+					tileColors( x - 1, y - 1 )[2] = color;
+
+				if ( y < tiles.Bottom )
+					tileColors( x - 1, y )[3] = color;
+			}
+		}
+	}
+}
+
+void MapLightManager::updateByTile( const Rect& tiles, Int32 fromColumn, Int32 toColumn,
+									std::vector<Float>& scratch ) {
+	Sizei tileSize = mMap->getTileSize();
+	Sizei halfTileSize = tileSize / 2;
+	const Color& baseColor = mMap->getBaseColor();
+	Int32 rows = tiles.getHeight();
+	Float firstPointY = tiles.Top * tileSize.y + halfTileSize.y;
+	Float stepY = tileSize.y;
+
+	scratch.resize( rows * 4 );
+
+	Float* buffer = scratch.data();
+	Float* r = buffer + rows;
+	Float* g = buffer + rows * 2;
+	Float* b = buffer + rows * 3;
+
+	for ( Int32 x = fromColumn; x < toColumn; x++ ) {
+		Float pointX = x * tileSize.x + halfTileSize.x;
+
+		for ( Int32 i = 0; i < rows; i++ ) {
+			r[i] = baseColor.r;
+			g[i] = baseColor.g;
+			b[i] = baseColor.b;
+		}
+
+		for ( const LightParams& light : mRegionLights ) {
+			if ( pointX < light.AABB.Left || pointX > light.AABB.Right )
+				continue;
+
+			Int32 from = eemax( 0, (Int32)eeceil( ( light.AABB.Top - firstPointY ) / stepY ) );
+			Int32 to =
+				eemin( rows, (Int32)eefloor( ( light.AABB.Bottom - firstPointY ) / stepY ) + 1 );
+
+			if ( from < to )
+				accumulateLight( light.x, light.y, light.Radius, light.Color, light.Isometric,
+								 pointX, firstPointY, stepY, from, to, buffer, rows );
 		}
+
+		for ( Int32 i = 0; i < rows; i++ )
+			tileColors( x, tiles.Top + i )[0] = Color( (Uint8)r[i], (Uint8)g[i], (Uint8)b[i], 255 );
 	}
 }
 
@@ -163,6 +409,13 @@ void MapLightManager::addLight( MapLight* Light ) {
 
 void MapLightManager::removeLight( MapLight* Light ) {
 	mLights.remove( Light );
+
+	auto it = mLightsState.find( Light );
+
+	if ( it != mLightsState.end() ) {
+		mDirtyAreas.push_back( it->second.AABB );
+		mLightsState.erase( it );
+	}
 }
 
 void MapLightManager::removeLight( const Vector2f& OverPos ) {
@@ -170,7 +423,7 @@ void MapLightManager::removeLight( const Vector2f& OverPos ) {
 		MapLight* Light = ( *it );
 
 		if ( Light->getAABB().contains( OverPos ) ) {
-			mLights.remove( Light );
+			removeLight( Light );
 			eeSAFE_DELETE( Light );
 			break;
 		}
@@ -183,7 +436,7 @@ const Color* MapLightManager::getTileColor( const Vector2i& TilePos ) {
 	if ( !mLights.size() )
 		return &mMap->getBaseColor();
 
-	return mTileColors[TilePos.x][TilePos.y][0];
+	return tileColors( TilePos.x, TilePos.y );
 }
 
 const Color* MapLightManager::getTileColor( const Vector2i& TilePos, const Uint32& Vertex ) {
@@ -192,42 +445,22 @@ const Color* MapLightManager::getTileColor( const Vector2i& TilePos, const Uint3
 	if ( !mLights.size() )
 		return &mMap->getBaseColor();
 
-	return mTileColors[TilePos.x][TilePos.y][Vertex];
+	return tileColors( TilePos.x, TilePos.y ) + Vertex;
 }
 
 void MapLightManager::allocateColors() {
 	Sizei Size = mMap->getSize();
-	mTileColors = eeNewArray( Color***, Size.getWidth() );
-
-	for ( Int32 x = 0; x < Size.x; x++ ) {
-		mTileColors[x] = eeNewArray( Color**, Size.getHeight() );
-
-		for ( Int32 y = 0; y < Size.y; y++ ) {
-			mTileColors[x][y] = eeNewArray( Color*, mNumVertex );
-
-			for ( Int32 v = 0; v < mNumVertex; v++ ) {
-				mTileColors[x][y][v] = eeNew( Color, ( 255, 255, 255, 255 ) );
-			}
-		}
-	}
+	mTileColors.assign( (size_t)Size.getWidth() * Size.getHeight() * mNumVertex,
+						Color( 255, 255, 255, 255 ) );
 }
 
 void MapLightManager::deallocateColors() {
-	Sizei Size = mMap->getSize();
-
-	for ( Int32 x = 0; x < Size.x; x++ ) {
-		for ( Int32 y = 0; y < Size.y; y++ ) {
-			for ( Int32 v = 0; v < mNumVertex; v++ ) {
-				eeSAFE_DELETE( mTileColors[x][y][v] );
-			}
-
-			eeSAFE_DELETE_ARRAY( mTileColors[x][y] );
-		}
-
-		eeSAFE_DELETE_ARRAY( mTileColors[x] );
-	}
+	mTileColors.clear();
+	mTileColors.shrink_to_fit();
+}
 
-	eeSAFE_DELETE_ARRAY( mTileColors );
+Color* MapLightManager::tileColors( const Int32& x, const Int32& y ) {
+	return &mTileColors[( (size_t)x * mMap->getSize().getHeight() + y ) * mNumVertex];
 }
 
 void MapLightManager::destroyLights() {
@@ -0,0 +1,871 @@
+#include "benchmark.hpp"
+#include <args/args.hxx>
+#include <atomic>
+#include <eepp/ee.hpp>
+#include <eepp/system/iostreammemory.hpp>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <pugixml/pugixml.hpp>
+#include <thread>
+
+using json = nlohmann::json;
+
+// Headless micro-benchmarks of the engine hot paths. All the inputs are generated from a fixed
+// seed so the results of two builds are comparable.
+
+class Random {
+  public:
+	explicit Random( Uint64 seed = 0x9E3779B97F4A7C15ULL ) : mState( seed ) {}
+
+	Uint64 next() {
+		// xorshift64*, deterministic on every platform
+		mState ^= mState >> 12;
+		mState ^= mState << 25;
+		mState ^= mState >> 27;
+		return mState * 0x2545F4914F6CDD1DULL;
+	}
+
+	size_t range( size_t max ) { return max > 0 ? next() % max : 0; }
+
+  protected:
+	Uint64 mState;
+};
+
+static const char* WORDS[] = { "lorem", "ipsum",	"dolor",	"sit",	   "amet",	 "consectetur",
+							   "adipiscing", "elit",  "sed",	"eiusmod", "tempor", "incididunt",
+							   "labore",	 "magna", "aliqua", "veniam",  "quis",	 "nostrud",
+							   "ñandú",		 "über",  "señal",	"köln",	   "πάντα",	 "日本語" };
+
+static std::string generateText( size_t size, Random& rand ) {
+	std::string text;
+	text.reserve( size + 16 );
+
+	while ( text.size() < size ) {
+		text += WORDS[rand.range( eeARRAY_SIZE( WORDS ) )];
+		text += rand.range( 12 ) == 0 ? '\n' : ' ';
+	}
+
+	return text;
+}
+
+static std::string generateCode( size_t lines, Random& rand ) {
+	static const char* SNIPPETS[] = {
+		"#include <vector>\n",
+		"// Computes the layout of the node and its children\n",
+		"static int computeValue( const std::vector<int>& values, int offset ) {\n",
+		"\tfor ( size_t i = 0; i < values.size(); i++ ) {\n",
+		"\t\tif ( values[i] > offset && values[i] % 2 == 0 )\n",
+		"\t\t\treturn values[i] * 0x1F + 3.1415f;\n",
+		"\t}\n",
+		"\tconst char* str = \"string with \\\"escaped\\\" quotes\";\n",
+		"\t/* a multi line\n",
+		"\t   comment */ auto lambda = [&]( auto& v ) { return v.size(); };\n",
+		"}\n",
+		"class Widget : public Node {\n",
+		"  public:\n",
+		"\tvirtual ~Widget() override = default;\n",
+		"};\n",
+		"\n" };
+
+	std::string code;
+
+	for ( size_t i = 0; i < lines; i++ )
+		code += SNIPPETS[rand.range( eeARRAY_SIZE( SNIPPETS ) )];
+
+	return code;
+}
+
+static std::string generateCss( size_t rules, Random& rand ) {
+	static const char* SELECTORS[] = { "widget",
+									   "button",
+									   "textview",
+									   ".primary",
+									   "#main_window",
+									   "linearlayout > button",
+									   "button:hover",
+									   ".panel .title",
+									   "textview.label",
+									   "* > .icon",
+									   "button.primary:focus",
+									   "relativelayout textview" };
+	static const char* PROPERTIES[] = { "background-color: #323232;",
+										"color: rgba(255, 255, 255, 0.8);",
+										"padding: 4dp 8dp;",
+										"margin-left: 2dp;",
+										"border-radius: 4dp;",
+										"font-size: 12dp;",
+										"layout-width: match_parent;",
+										"transition: all 0.125s;" };
+
+	std::string css;
+
+	for ( size_t i = 0; i < rules; i++ ) {
+		css += SELECTORS[rand.range( eeARRAY_SIZE( SELECTORS ) )];
+		css += String::format( ".r%zu {\n", i % 64 );
+
+		for ( size_t p = 0, count = 1 + rand.range( 5 ); p < count; p++ ) {
+			css += '\t';
+			css += PROPERTIES[rand.range( eeARRAY_SIZE( PROPERTIES ) )];
+			css += '\n';
+		}
+
+		css += "}\n";
+	}
+
+	return css;
+}
+
+static std::string frameLspMessage( const json& message ) {
+	std::string payload( message.dump() );
+	return String::format( "Content-Length: %zu\r\n\r\n", payload.size() ) + payload;
+}
+
+static std::string generateLspStream( size_t messages, Random& rand ) {
+	std::string stream;
+
+	for ( size_t m = 0; m < messages; m++ ) {
+		if ( m % 4 == 3 ) {
+			json diagnostics = json::array();
+
+			for ( size_t d = 0; d < 20; d++ ) {
+				size_t line = rand.range( 5000 );
+				diagnostics.push_back(
+					{ { "range",
+						{ { "start", { { "line", line }, { "character", rand.range( 80 ) } } },
+						  { "end", { { "line", line }, { "character", 80 } } } } },
+					  { "severity", 1 + rand.range( 4 ) },
+					  { "source", "clangd" },
+					  { "message", generateText( 64, rand ) } } );
+			}
+
+			stream += frameLspMessage( { { "jsonrpc", "2.0" },
+										 { "method", "textDocument/publishDiagnostics" },
+										 { "params",
+										   { { "uri", "file:///home/user/project/src/main.cpp" },
+											 { "diagnostics", diagnostics } } } } );
+		} else {
+			json items = json::array();
+
+			for ( size_t i = 0; i < 100; i++ ) {
+				std::string label( WORDS[rand.range( eeARRAY_SIZE( WORDS ) )] );
+				items.push_back( { { "label", label },
+								   { "kind", 1 + rand.range( 25 ) },
+								   { "detail", "std::vector<int> " + label + "( size_t )" },
+								   { "sortText", String::format( "%08zu", i ) },
+								   { "insertText", label } } );
+			}
+
+			stream += frameLspMessage(
+				{ { "jsonrpc", "2.0" },
+				  { "id", m },
+				  { "result", { { "isIncomplete", false }, { "items", items } } } } );
+		}
+	}
+
+	return stream;
+}
+
+// Same framing as LSPClientServer::readStdOut, the LSP client lives in ecode and can't be linked
+static size_t parseLspStream( std::string buffer ) {
+	static const char* CONTENT_LENGTH_HEADER = "Content-Length:";
+	size_t responses = 0;
+
+	while ( true ) {
+		auto index = buffer.find( CONTENT_LENGTH_HEADER );
+		if ( index == std::string::npos )
+			break;
+
+		index += strlen( CONTENT_LENGTH_HEADER );
+		auto endindex = buffer.find( "\r\n", index );
+		auto msgstart = buffer.find( "\r\n\r\n", index );
+		if ( endindex == std::string::npos || msgstart == std::string::npos )
+			break;
+
+		msgstart += 4;
+		int length = 0;
+		if ( !String::fromString( length, buffer.substr( index, endindex - index ) ) ) {
+			buffer.erase( 0, msgstart );
+			continue;
+		}
+
+		if ( msgstart + length > buffer.length() )
+			break;
+
+		auto payload = buffer.substr( msgstart, length );
+		buffer.erase( 0, msgstart + length );
+
+		auto res = json::parse( payload );
+		if ( res.contains( "id" ) )
+			responses++;
+	}
+
+	return responses;
+}
+
+static void addStringBenchmarks( Benchmark& bench ) {
+	Random rand;
+	auto text = std::make_shared<std::string>( generateText( 1024 * 1024, rand ) );
+	auto utf32 = std::make_shared<String>( String::fromUtf8( *text ) );
+	auto needle = std::make_shared<std::string>( "needle_not_in_the_haystack" );
+	auto occ = std::make_shared<String::BMH::OccTable>( String::BMH::createOccTable(
+		reinterpret_cast<const unsigned char*>( needle->c_str() ), needle->size() ) );
+
+	bench.add(
+		"string/utf8_to_utf32",
+		[text] { Benchmark::keep( String::fromUtf8( *text ).size() ); }, text->size() );
+
+	bench.add(
+		"string/utf32_to_utf8", [utf32] { Benchmark::keep( utf32->toUtf8().size() ); },
+		utf32->size() * sizeof( String::StringBaseType ) );
+
+	bench.add(
+		"string/bmh_find",
+		[text, needle, occ] { Benchmark::keep( String::BMH::find( *text, *needle, 0, *occ ) ); },
+		text->size() );
+
+	bench.add(
+		"string/std_find", [text, needle] { Benchmark::keep( text->find( *needle ) ); },
+		text->size() );
+
+	bench.add(
+		"string/hash", [text] { Benchmark::keep( String::hash( *text ) ); }, text->size() );
+}
+
+static void addLuaPatternBenchmarks( Benchmark& bench ) {
+	Random rand;
+	auto code = std::make_shared<std::string>( generateCode( 2000, rand ) );
+
+	bench.add(
+		"luapattern/gmatch_identifiers",
+		[code] {
+			LuaPattern pattern( "[%a_][%w_]*" );
+			Uint64 count = 0;
+			for ( auto& match : pattern.gmatch( *code ) ) {
+				(void)match;
+				count++;
+			}
+			Benchmark::keep( count );
+		},
+		code->size() );
+
+	bench.add(
+		"luapattern/find_number",
+		[code] {
+			LuaPattern pattern( "0x%x+" );
+			int start = 0, end = 0;
+			Uint64 count = 0;
+			int offset = 0;
+			while ( pattern.find( *code, start, end, offset ) ) {
+				offset = end;
+				count++;
+			}
+			Benchmark::keep( count );
+		},
+		code->size() );
+}
+
+static void addDocumentBenchmarks( Benchmark& bench ) {
+	Random rand;
+	auto code = std::make_shared<std::string>( generateCode( 20000, rand ) );
+	auto lines = std::make_shared<std::vector<std::string>>( String::split( *code, '\n' ) );
+
+	for ( auto& line : *lines )
+		line += '\n';
+
+	bench.add(
+		"syntaxtokenizer/tokenize_cpp",
+		[lines] {
+			const SyntaxDefinition& syntax =
+				SyntaxDefinitionManager::instance()->getByLanguageName( "C++" );
+			Uint32 state = SYNTAX_TOKENIZER_STATE_NONE;
+			Uint64 tokens = 0;
+			for ( const auto& line : *lines ) {
+				auto res = SyntaxTokenizer::tokenize( syntax, line, state );
+				state = res.second;
+				tokens += res.first.size();
+			}
+			Benchmark::keep( tokens );
+		},
+		code->size() );
+
+	auto loadDoc = std::make_shared<TextDocument>( false );
+
+	bench.add(
+		"textdocument/load",
+		[code, loadDoc] {
+			loadDoc->loadFromMemory( reinterpret_cast<const Uint8*>( code->c_str() ),
+									 code->size() );
+			Benchmark::keep( loadDoc->linesCount() );
+		},
+		code->size() );
+
+	auto doc = std::make_shared<TextDocument>( false );
+	doc->loadFromMemory( reinterpret_cast<const Uint8*>( code->c_str() ), code->size() );
+	auto positions = std::make_shared<std::vector<TextPosition>>();
+
+	for ( size_t i = 0; i < 256; i++ ) {
+		Int64 line = rand.range( doc->linesCount() );
+		positions->push_back(
+			{ line, static_cast<Int64>( rand.range( doc->line( line ).size() ) ) } );
+	}
+
+	auto cursor = std::make_shared<size_t>( 0 );
+
+	bench.add( "textdocument/type_and_undo", [doc, positions, cursor] {
+		doc->setSelection( ( *positions )[( *cursor )++ % positions->size()] );
+		for ( const char* c = "for ( auto& item : items ) {}"; *c; c++ )
+			doc->textInput( String( *c ) );
+		while ( doc->hasUndo() )
+			doc->undo();
+	} );
+
+	auto block = std::make_shared<String>( String::fromUtf8( generateCode( 100, rand ) ) );
+
+	bench.add(
+		"textdocument/paste_and_undo",
+		[doc, positions, cursor, block] {
+			doc->insert( ( *positions )[( *cursor )++ % positions->size()], *block );
+			while ( doc->hasUndo() )
+				doc->undo();
+		},
+		block->size() );
+
+	bench.add(
+		"textdocument/find_next_nocase",
+		[doc] {
+			Uint64 count = 0;
+			TextRange found( doc->find( "VALUES", doc->startOfDoc(), false ) );
+			while ( found.isValid() ) {
+				count++;
+				found = doc->find( "VALUES", found.end(), false );
+			}
+			Benchmark::keep( count );
+		},
+		code->size() );
+
+	bench.add(
+		"textdocument/find_all_after_edit",
+		[doc, positions, cursor] {
+			doc->insert( ( *positions )[( *cursor )++ % positions->size()], "values\n" );
+			Benchmark::keep( doc->findAll( "values", false ).size() );
+			while ( doc->hasUndo() )
+				doc->undo();
+		},
+		code->size() );
+
+	// A long editing session: the history exceeds the memory limit and is spilled to disk, then
+	// it's undone and redone while the current change id is polled as the editor does every frame
+	const size_t editsCount = 1000000;
+	unsigned long long pid = static_cast<unsigned long long>( Sys::getProcessID() );
+	std::string spillPath( Sys::getTempPath() + String::format( "eepp-bench-%llu.undo", pid ) );
+
+	bench.addItems(
+		"undostack/undo_redo_1m_edits",
+		[editsCount, spillPath] {
+			TextUndoJournal undoStack( 8 * 1024 * 1024 );
+			TextUndoJournal redoStack( 8 * 1024 * 1024 );
+			undoStack.setSpillPath( spillPath );
+			redoStack.setSpillPath( spillPath + ".redo" );
+			TextUndoCommand cmd;
+			Uint64 ids = 0;
+
+			for ( size_t i = 0; i < editsCount; i++ ) {
+				cmd.id = i + 1;
+				cmd.type = i % 2 ? TextUndoCommandType::Insert : TextUndoCommandType::Selection;
+				Int64 line = static_cast<Int64>( i / 80 );
+				cmd.range = TextRange( { line, 0 }, { line, static_cast<Int64>( i % 80 ) } );
+				cmd.text = i % 2 ? "x" : "";
+				undoStack.push( cmd );
+				ids += undoStack.backId();
+			}
+
+			while ( undoStack.back( cmd ) ) {
+				undoStack.pop();
+				redoStack.push( cmd );
+				ids += undoStack.backId();
+			}
+
+			while ( redoStack.back( cmd ) ) {
+				redoStack.pop();
+				undoStack.push( cmd );
+				ids += redoStack.backId();
+			}
+
+			Benchmark::keep( ids );
+		},
+		editsCount, "edits" );
+}
+
+static std::string generateLayout( size_t nodes, Random& rand ) {
+	static const char* TAGS[] = { "widget", "linearlayout", "relativelayout" };
+	static const char* ATTRIBUTES[] = { "layout_width=\"match_parent\"",
+										"layout_height=\"wrap_content\"",
+										"layout_gravity=\"center\"", "padding=\"4dp\"",
+										"background-color=\"#323232\"" };
+	std::string layout( "<relativelayout id=\"root\">\n" );
+	std::vector<const char*> open{ "relativelayout" };
+
+	for ( size_t i = 0; i < nodes; i++ ) {
+		const char* tag = TAGS[rand.range( eeARRAY_SIZE( TAGS ) )];
+		layout += String::format( "<%s id=\"node_%zu\" class=\"r%zu\"", tag, i,
+								  rand.range( 64 ) );
+
+		for ( size_t a = 0, count = 1 + rand.range( 4 ); a < count; a++ ) {
+			layout += ' ';
+			layout += ATTRIBUTES[rand.range( eeARRAY_SIZE( ATTRIBUTES ) )];
+		}
+
+		// Every node opens a container or is a leaf, the containers are closed randomly
+		if ( open.size() < 12 && rand.range( 3 ) == 0 ) {
+			layout += ">\n";
+			open.push_back( tag );
+		} else {
+			layout += " />\n";
+
+			if ( open.size() > 1 && rand.range( 3 ) == 0 ) {
+				layout += String::format( "</%s>\n", open.back() );
+				open.pop_back();
+			}
+		}
+	}
+
+	while ( !open.empty() ) {
+		layout += String::format( "</%s>\n", open.back() );
+		open.pop_back();
+	}
+
+	return layout;
+}
+
+static void addCssBenchmarks( Benchmark& bench, std::vector<std::string>& tempFiles ) {
+	Random rand;
+	auto css = std::make_shared<std::string>( generateCss( 2000, rand ) );
+
+	bench.add(
+		"css/parse_stylesheet",
+		[css] {
+			CSS::StyleSheetParser parser;
+			parser.loadFromString( *css );
+			Benchmark::keep( parser.getStyleSheet().getStyles().size() );
+		},
+		css->size() );
+
+	auto parser = std::make_shared<CSS::StyleSheetParser>();
+	parser->loadFromString( *css );
+
+	static const char* TAGS[] = { "widget", "button", "textview", "linearlayout",
+								  "relativelayout" };
+	static const char* CLASSES[] = { "primary", "panel", "title", "label", "icon" };
+
+	std::shared_ptr<UIWidget> root( UIWidget::NewWithTag( "relativelayout" ),
+									[]( UIWidget* widget ) { eeDelete( widget ); } );
+	root->setId( "main_window" );
+	auto widgets = std::make_shared<std::vector<UIWidget*>>();
+	widgets->push_back( root.get() );
+
+	for ( size_t i = 0; i < 256; i++ ) {
+		UIWidget* widget = UIWidget::NewWithTag( TAGS[rand.range( eeARRAY_SIZE( TAGS ) )] );
+		widget->addClass( CLASSES[rand.range( eeARRAY_SIZE( CLASSES ) )] );
+		widget->addClass( String::format( "r%zu", rand.range( 64 ) ) );
+		widget->setParent( ( *widgets )[rand.range( widgets->size() )] );
+		widgets->push_back( widget );
+	}
+
+	bench.add( "css/get_element_styles", [parser, root, widgets] {
+		CSS::StyleSheet& styleSheet = parser->getStyleSheet();
+		styleSheet.invalidateCache();
+		Uint64 count = 0;
+		for ( auto widget : *widgets )
+			count += styleSheet.getElementStyles( widget ) ? 1 : 0;
+		Benchmark::keep( count );
+	} );
+
+	unsigned long long pid = static_cast<unsigned long long>( Sys::getProcessID() );
+	auto cssFile = std::make_shared<std::string>( Sys::getTempPath() +
+												  String::format( "eepp-bench-%llu.css", pid ) );
+	std::string cachePath( Sys::getTempPath() + String::format( "eepp-bench-%llu-cache", pid ) );
+
+	if ( !FileSystem::fileWrite( *cssFile, *css ) ) {
+		std::cerr << "Couldn't create " << *cssFile << std::endl;
+		return;
+	}
+
+	tempFiles.push_back( *cssFile );
+
+	bench.add(
+		"css/load_file",
+		[cssFile] {
+			CSS::StyleSheetParser parser;
+			parser.loadFromFile( *cssFile );
+			Benchmark::keep( parser.getStyleSheet().getStyles().size() );
+		},
+		css->size() );
+
+	// The cache is only enabled while the benchmark runs, the other benchmarks parse the CSS
+	CSS::StyleSheetParser::setCachePath( cachePath );
+	CSS::StyleSheetParser().loadFromFile( *cssFile );
+
+	for ( const auto& file : FileSystem::filesGetInPath( cachePath ) )
+		tempFiles.push_back( cachePath + FileSystem::getOSSlash() + file );
+
+	tempFiles.push_back( cachePath );
+	CSS::StyleSheetParser::setCachePath( "" );
+
+	bench.add(
+		"css/load_file_cached",
+		[cssFile, cachePath] {
+			CSS::StyleSheetParser::setCachePath( cachePath );
+			CSS::StyleSheetParser parser;
+			parser.loadFromFile( *cssFile );
+			Benchmark::keep( parser.getStyleSheet().getStyles().size() );
+			CSS::StyleSheetParser::setCachePath( "" );
+		},
+		css->size() );
+}
+
+// The work a compiled layout cache would save: parsing the XML and resolving every tag name to
+// its widget factory, compared to the creation of the widgets that a cache can't skip
+static void addLayoutBenchmarks( Benchmark& bench ) {
+	Random rand;
+	const size_t nodesCount = 2000;
+	auto layout = std::make_shared<std::string>( generateLayout( nodesCount, rand ) );
+
+	bench.addItems(
+		"ui/parse_layout",
+		[layout] {
+			pugi::xml_document doc;
+			doc.load_buffer( layout->c_str(), layout->size() );
+			const auto& widgets = UIWidgetCreator::getRegisteredWidgets();
+			Uint64 found = 0;
+
+			std::function<void( pugi::xml_node )> resolve = [&]( pugi::xml_node node ) {
+				for ( pugi::xml_node child : node.children() ) {
+					std::string name( String::toLower( std::string( child.name() ) ) );
+					found += widgets.find( name ) != widgets.end();
+					resolve( child );
+				}
+			};
+
+			resolve( doc );
+			Benchmark::keep( found );
+		},
+		nodesCount, "nodes" );
+
+	pugi::xml_document doc;
+	doc.load_buffer( layout->c_str(), layout->size() );
+	auto tags = std::make_shared<std::vector<std::string>>();
+
+	std::function<void( pugi::xml_node )> collect = [&]( pugi::xml_node node ) {
+		for ( pugi::xml_node child : node.children() ) {
+			tags->push_back( child.name() );
+			collect( child );
+		}
+	};
+
+	collect( doc );
+
+	bench.addItems(
+		"ui/create_layout_widgets",
+		[tags] {
+			std::vector<UIWidget*> widgets;
+			widgets.reserve( tags->size() );
+
+			for ( const auto& tag : *tags )
+				widgets.push_back( UIWidgetCreator::createFromName( tag ) );
+
+			for ( auto widget : widgets )
+				eeSAFE_DELETE( widget );
+
+			Benchmark::keep( widgets.size() );
+		},
+		nodesCount, "widgets" );
+}
+
+static void addCompressionBenchmarks( Benchmark& bench ) {
+	Random rand;
+	auto text = std::make_shared<std::string>( generateCode( 20000, rand ) );
+	auto compressed = std::make_shared<std::vector<Uint8>>(
+		Compression::getMaxCompressedBufferSize( text->size() ) );
+	auto uncompressed = std::make_shared<std::vector<Uint8>>( text->size() );
+
+	bench.add(
+		"compression/deflate",
+		[text, compressed] {
+			Benchmark::keep( Compression::compress(
+				compressed->data(), compressed->size(),
+				reinterpret_cast<const Uint8*>( text->c_str() ), text->size() ) );
+		},
+		text->size() );
+
+	bench.add(
+		"compression/gzip",
+		[text, compressed] {
+			Benchmark::keep( Compression::compress(
+				compressed->data(), compressed->size(),
+				reinterpret_cast<const Uint8*>( text->c_str() ), text->size(),
+				Compression::MODE_GZIP ) );
+		},
+		text->size() );
+
+	Compression::Config blocksConfig;
+	blocksConfig.blocks.threadPool = ThreadPool::createShared( eemax( Sys::getCPUCount(), 1 ) );
+
+	bench.add(
+		"compression/gzip_blocks",
+		[text, compressed, blocksConfig] {
+			IOStreamMemory src( text->c_str(), text->size() );
+			IOStreamMemory dst( reinterpret_cast<char*>( compressed->data() ),
+								compressed->size() );
+			Benchmark::keep(
+				Compression::compressBlocks( dst, src, Compression::MODE_GZIP, blocksConfig ) );
+		},
+		text->size() );
+
+	std::vector<Uint8> deflated( Compression::getMaxCompressedBufferSize( text->size() ) );
+	IOStreamMemory src( reinterpret_cast<const char*>( text->c_str() ), text->size() );
+	IOStreamMemory dst( reinterpret_cast<char*>( deflated.data() ), deflated.size() );
+	Compression::compress( dst, src );
+	deflated.resize( dst.tell() );
+	auto deflatedPtr = std::make_shared<std::vector<Uint8>>( std::move( deflated ) );
+
+	bench.add(
+		"compression/inflate",
+		[deflatedPtr, uncompressed] {
+			Benchmark::keep( Compression::decompress( uncompressed->data(), uncompressed->size(),
+													  deflatedPtr->data(),
+													  deflatedPtr->size() ) );
+		},
+		text->size() );
+}
+
+static void addPackBenchmarks( Benchmark& bench, std::vector<std::string>& tempFiles ) {
+	Random rand;
+	const size_t filesCount = 64;
+	auto files = std::make_shared<std::vector<std::string>>();
+	std::vector<std::string> contents;
+
+	for ( size_t i = 0; i < filesCount; i++ ) {
+		files->push_back( String::format( "assets/file_%zu.txt", i ) );
+		contents.push_back( generateText( 16 * 1024, rand ) );
+	}
+
+	unsigned long long pid = static_cast<unsigned long long>( Sys::getProcessID() );
+	std::string basePath( Sys::getTempPath() + String::format( "eepp-bench-%llu", pid ) );
+
+	std::shared_ptr<Pack> pak( Pak::New(), []( Pack* pack ) { eeDelete( pack ); } );
+	std::shared_ptr<Pack> zip( Zip::New(), []( Pack* pack ) { eeDelete( pack ); } );
+	std::vector<std::pair<std::string, std::shared_ptr<Pack>>> packs{
+		{ "pak", pak }, { "zip", zip } };
+
+	for ( auto& pack : packs ) {
+		std::string path( basePath + "." + pack.first );
+		tempFiles.push_back( path );
+
+		if ( !pack.second->create( path ) ) {
+			std::cerr << "Couldn't create " << path << std::endl;
+			continue;
+		}
+
+		for ( size_t i = 0; i < filesCount; i++ )
+			pack.second->addFile( reinterpret_cast<const Uint8*>( contents[i].c_str() ),
+								  contents[i].size(), ( *files )[i] );
+
+		pack.second->close();
+		pack.second->open( path );
+
+		bench.add(
+			pack.first + "/extract_all",
+			[pack, files] {
+				std::vector<Uint8> data;
+				Uint64 size = 0;
+				for ( const auto& file : *files ) {
+					pack.second->extractFileToMemory( file, data );
+					size += data.size();
+				}
+				Benchmark::keep( size );
+			},
+			filesCount * 16 * 1024 );
+	}
+}
+
+static void addImageBenchmarks( Benchmark& bench ) {
+	Random rand;
+	auto image = std::make_shared<Image>( 1024, 1024, 4 );
+
+	for ( Uint32 y = 0; y < image->getHeight(); y++ )
+		for ( Uint32 x = 0; x < image->getWidth(); x++ )
+			image->setPixel( x, y, Color( rand.next() ) );
+
+	bench.add(
+		"image/resize_lanczos",
+		[image] {
+			Image* thumb = image->thumbnail( 512, 512 );
+			Benchmark::keep( thumb->getMemSize() );
+			eeSAFE_DELETE( thumb );
+		},
+		image->getMemSize() );
+
+	bench.add(
+		"image/resize_box",
+		[image] {
+			Image* thumb = image->thumbnail( 512, 512, Image::RESAMPLER_BOX );
+			Benchmark::keep( thumb->getMemSize() );
+			eeSAFE_DELETE( thumb );
+		},
+		image->getMemSize() );
+}
+
+static void addLspBenchmarks( Benchmark& bench ) {
+	Random rand;
+	auto stream = std::make_shared<std::string>( generateLspStream( 32, rand ) );
+
+	bench.add(
+		"lsp/read_stdout_json", [stream] { Benchmark::keep( parseLspStream( *stream ) ); },
+		stream->size() );
+}
+
+static void addThreadPoolBenchmarks( Benchmark& bench ) {
+	std::shared_ptr<ThreadPool> pool =
+		ThreadPool::createShared( eemax( 2, Sys::getCPUCount() ) );
+	const Uint64 tasks = 1000;
+
+	bench.add( "threadpool/run_1000_tasks", [pool, tasks] {
+		std::atomic<Uint64> done{ 0 };
+		for ( Uint64 i = 0; i < tasks; i++ )
+			pool->run( [&done] { done++; } );
+		while ( done.load() < tasks )
+			std::this_thread::yield();
+	} );
+}
+
+static void addFontBenchmarks( Benchmark& bench ) {
+	// Glyph pages are stored in textures, the null renderer creates them without a GL context
+	EE::Window::Window* win = Engine::instance()->createWindow(
+		WindowSettings( 640, 480, "eepp - Benchmarks" ), ContextSettings( true, GLv_Null ) );
+	FontTrueType* font =
+		win->isOpen() ? FontTrueType::New( "NotoSans-Regular",
+										   Sys::getProcessPath() +
+											   "assets/fonts/NotoSans-Regular.ttf" )
+					  : nullptr;
+
+	if ( nullptr == font || !font->loaded() ) {
+		std::cerr << "Couldn't load the font, skipping the font benchmarks" << std::endl;
+		return;
+	}
+
+	Random rand;
+	String string( generateText( 16 * 1024, rand ) );
+	Uint64 glyphs = 0;
+
+	for ( const auto& ch : string )
+		if ( ch != '\n' )
+			glyphs++;
+
+	auto text = std::make_shared<Text>( string, font, 14 );
+
+	// Rasterize the glyphs once, the benchmark measures the layout of already cached glyphs
+	text->getLocalBounds();
+
+	bench.addItems(
+		"font/layout_glyphs",
+		[text] {
+			text->invalidate();
+			Benchmark::keep( text->getLocalBounds().getWidth() );
+		},
+		glyphs, "glyphs" );
+}
+
+EE_MAIN_FUNC int main( int argc, char* argv[] ) {
+	args::ArgumentParser parser( "eepp micro-benchmarks" );
+	args::HelpFlag help( parser, "help", "Display this help menu", { 'h', "help" } );
+	args::Flag list( parser, "list", "List the available benchmarks", { 'l', "list" } );
+	args::ValueFlag<std::string> filter(
+		parser, "filter", "Only run the benchmarks containing the filter", { 'f', "filter" } );
+	args::ValueFlag<int> warmup( parser, "warmup", "Number of warmup samples", { "warmup" }, 3 );
+	args::ValueFlag<int> samples( parser, "samples", "Number of measured samples", { "samples" },
+								  15 );
+	args::ValueFlag<int> minTime( parser, "min-time",
+								  "Minimum time of each sample in milliseconds", { "min-time" },
+								  20 );
+	args::ValueFlag<std::string> output( parser, "output", "Write a JSON report to the path",
+										 { 'o', "output" } );
+	args::ValueFlag<std::string> baseline(
+		parser, "baseline", "Compare the results against a JSON report", { 'b', "baseline" } );
+	args::ValueFlag<double> threshold(
+		parser, "threshold", "Median slowdown in percent considered a regression",
+		{ 't', "threshold" }, 10 );
+
+	try {
+		parser.ParseCLI( argc, argv );
+	} catch ( const args::Help& ) {
+		std::cout << parser;
+		return EXIT_SUCCESS;
+	} catch ( const args::ParseError& e ) {
+		std::cerr << e.what() << std::endl;
+		std::cerr << parser;
+		return EXIT_FAILURE;
+	} catch ( args::ValidationError& e ) {
+		std::cerr << e.what() << std::endl;
+		std::cerr << parser;
+		return EXIT_FAILURE;
+	}
+
+	Engine::instance();
+
+	int res = EXIT_SUCCESS;
+	std::vector<std::string> tempFiles;
+
+	{
+		Benchmark bench;
+		addStringBenchmarks( bench );
+		addLuaPatternBenchmarks( bench );
+		addDocumentBenchmarks( bench );
+		addCssBenchmarks( bench, tempFiles );
+		addLayoutBenchmarks( bench );
+		addCompressionBenchmarks( bench );
+		addPackBenchmarks( bench, tempFiles );
+		addImageBenchmarks( bench );
+		addLspBenchmarks( bench );
+		addThreadPoolBenchmarks( bench );
+		addFontBenchmarks( bench );
+
+		if ( list ) {
+			for ( const auto& name : bench.getNames() )
+				std::cout << name << std::endl;
+		} else {
+			Benchmark::Options options;
+			options.warmup = eemax( 0, warmup.Get() );
+			options.samples = eemax( 1, samples.Get() );
+			options.minSampleTime = Milliseconds( eemax( 1, minTime.Get() ) );
+			options.filter = filter.Get();
+
+			std::vector<Benchmark::Result> results = bench.run( options );
+
+			if ( output && !FileSystem::fileWrite( output.Get(),
+												   Benchmark::toJson( results, options ) ) ) {
+				std::cerr << "Couldn't write the report to " << output.Get() << std::endl;
+				res = EXIT_FAILURE;
+			}
+
+			if ( baseline ) {
+				std::string baselineJson;
+
+				if ( !FileSystem::fileGet( baseline.Get(), baselineJson ) ) {
+					std::cerr << "Couldn't read the baseline " << baseline.Get() << std::endl;
+					res = EXIT_FAILURE;
+				} else if ( Benchmark::compare( results, baselineJson, threshold.Get() ) != 0 ) {
+					res = EXIT_FAILURE;
+				}
+			}
+		}
+	}
+
+	for ( const auto& path : tempFiles )
+		FileSystem::fileRemove( path );
+
+	Engine::destroySingleton();
+
+	MemoryManager::showResults();
+
+	return res;
+}
@@ -0,0 +1,260 @@
+#include "benchmark.hpp"
+#include <algorithm>
+#include <cmath>
+#include <eepp/system/clock.hpp>
+#include <eepp/system/sys.hpp>
+#include <eepp/version.hpp>
+#include <iomanip>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <sstream>
+
+using json = nlohmann::json;
+
+// Upper bound of iterations per sample, for operations that are faster than the clock resolution
+static constexpr Uint64 MAX_ITERATIONS = 1 << 24;
+
+static volatile Uint64 sSink = 0;
+
+void Benchmark::keep( const Uint64& value ) {
+	sSink = sSink + value;
+}
+
+void Benchmark::add( const std::string& name, const Operation& op, const Uint64& bytesPerOp ) {
+	mEntries.push_back( { name, op, bytesPerOp, 0, "" } );
+}
+
+void Benchmark::addItems( const std::string& name, const Operation& op, const Uint64& itemsPerOp,
+						  const std::string& itemsName ) {
+	mEntries.push_back( { name, op, 0, itemsPerOp, itemsName } );
+}
+
+std::vector<std::string> Benchmark::getNames() const {
+	std::vector<std::string> names;
+	for ( const auto& entry : mEntries )
+		names.push_back( entry.name );
+	return names;
+}
+
+static double percentile( const std::vector<double>& sorted, const double& p ) {
+	if ( sorted.size() == 1 )
+		return sorted[0];
+
+	double rank = p * ( sorted.size() - 1 );
+	size_t low = static_cast<size_t>( std::floor( rank ) );
+	size_t high = eemin( low + 1, sorted.size() - 1 );
+	return sorted[low] + ( sorted[high] - sorted[low] ) * ( rank - low );
+}
+
+Benchmark::Result Benchmark::measure( const Entry& entry, const Options& options ) {
+	Result result;
+	result.name = entry.name;
+	result.bytesPerOp = entry.bytesPerOp;
+	result.itemsPerOp = entry.itemsPerOp;
+	result.itemsName = entry.itemsName;
+
+	// Calibrate the batch size, growing it until a batch takes at least the minimum sample time
+	Uint64 iterations = 1;
+	Clock clock;
+
+	while ( true ) {
+		clock.restart();
+
+		for ( Uint64 i = 0; i < iterations; i++ )
+			entry.op();
+
+		Time elapsed = clock.getElapsedTime();
+
+		if ( elapsed >= options.minSampleTime || iterations >= MAX_ITERATIONS )
+			break;
+
+		if ( elapsed.asMicroseconds() <= 0 ) {
+			iterations *= 16;
+		} else {
+			double ratio = options.minSampleTime.asMicroseconds() /
+						   static_cast<double>( elapsed.asMicroseconds() );
+			iterations =
+				static_cast<Uint64>( std::ceil( iterations * eemin( ratio * 1.1, 16.0 ) ) );
+		}
+
+		iterations = eemin( iterations, MAX_ITERATIONS );
+	}
+
+	result.iterations = iterations;
+
+	std::vector<double> samples;
+
+	for ( int s = 0; s < options.warmup + options.samples; s++ ) {
+		clock.restart();
+
+		for ( Uint64 i = 0; i < iterations; i++ )
+			entry.op();
+
+		double ns = clock.getElapsedTime().asMicroseconds() * 1000.0 / iterations;
+
+		if ( s >= options.warmup )
+			samples.push_back( ns );
+	}
+
+	std::sort( samples.begin(), samples.end() );
+
+	double sum = 0;
+	for ( const auto& sample : samples )
+		sum += sample;
+
+	result.samples = static_cast<int>( samples.size() );
+	result.min = samples.front();
+	result.max = samples.back();
+	result.mean = sum / samples.size();
+	result.median = percentile( samples, 0.5 );
+	result.p90 = percentile( samples, 0.9 );
+	result.p99 = percentile( samples, 0.99 );
+
+	double variance = 0;
+	for ( const auto& sample : samples )
+		variance += ( sample - result.mean ) * ( sample - result.mean );
+	result.stddev = std::sqrt( variance / samples.size() );
+
+	return result;
+}
+
+std::vector<Benchmark::Result> Benchmark::run( const Options& options ) const {
+	std::vector<Result> results;
+
+	for ( const auto& entry : mEntries ) {
+		if ( !options.filter.empty() && entry.name.find( options.filter ) == std::string::npos )
+			continue;
+
+		results.push_back( measure( entry, options ) );
+		print( results.back() );
+	}
+
+	return results;
+}
+
+static std::string formatTime( const double& ns ) {
+	std::ostringstream out;
+	out << std::fixed << std::setprecision( 2 );
+
+	if ( ns >= 1e9 ) {
+		out << ns / 1e9 << " s";
+	} else if ( ns >= 1e6 ) {
+		out << ns / 1e6 << " ms";
+	} else if ( ns >= 1e3 ) {
+		out << ns / 1e3 << " us";
+	} else {
+		out << ns << " ns";
+	}
+
+	return out.str();
+}
+
+void Benchmark::print( const Result& result ) {
+	std::cout << std::left << std::setw( 40 ) << result.name << std::right << " median "
+			  << std::setw( 11 ) << formatTime( result.median ) << "  p90 " << std::setw( 11 )
+			  << formatTime( result.p90 ) << "  min " << std::setw( 11 )
+			  << formatTime( result.min );
+
+	if ( result.bytesPerOp > 0 && result.median > 0 )
+		std::cout << "  " << std::fixed << std::setprecision( 1 )
+				  << result.bytesPerOp / ( result.median / 1e9 ) / ( 1024 * 1024 ) << " MB/s";
+
+	if ( result.itemsPerOp > 0 && result.median > 0 )
+		std::cout << "  " << std::fixed << std::setprecision( 1 )
+				  << result.itemsPerOp / ( result.median / 1e9 ) / 1e6 << " M" << result.itemsName
+				  << "/s";
+
+	std::cout << std::endl;
+}
+
+std::string Benchmark::toJson( const std::vector<Result>& results, const Options& options ) {
+	json report;
+	report["eepp_version"] = Version::getVersionName();
+	report["platform"] = Sys::getPlatform();
+	report["cpu_count"] = Sys::getCPUCount();
+	report["options"] = { { "warmup", options.warmup },
+						  { "samples", options.samples },
+						  { "min_sample_time_ms", options.minSampleTime.asMilliseconds() } };
+
+	json benchmarks = json::array();
+
+	for ( const auto& result : results ) {
+		json entry{ { "name", result.name },
+					{ "iterations", result.iterations },
+					{ "samples", result.samples },
+					{ "bytes_per_op", result.bytesPerOp },
+					{ "ns_per_op",
+					  { { "min", result.min },
+						{ "mean", result.mean },
+						{ "median", result.median },
+						{ "p90", result.p90 },
+						{ "p99", result.p99 },
+						{ "max", result.max },
+						{ "stddev", result.stddev } } } };
+
+		if ( result.bytesPerOp > 0 && result.median > 0 )
+			entry["mb_per_s"] = result.bytesPerOp / ( result.median / 1e9 ) / ( 1024 * 1024 );
+
+		if ( result.itemsPerOp > 0 && result.median > 0 ) {
+			entry["items_per_op"] = result.itemsPerOp;
+			entry[result.itemsName + "_per_s"] = result.itemsPerOp / ( result.median / 1e9 );
+		}
+
+		benchmarks.push_back( entry );
+	}
+
+	report["benchmarks"] = benchmarks;
+
+	return report.dump( 2 );
+}
+
+int Benchmark::compare( const std::vector<Result>& results, const std::string& baselineJson,
+						const double& threshold ) {
+	json baseline;
+
+	try {
+		baseline = json::parse( baselineJson );
+	} catch ( const json::exception& e ) {
+		std::cerr << "Invalid baseline report: " << e.what() << std::endl;
+		return -1;
+	}
+
+	if ( !baseline.contains( "benchmarks" ) || !baseline["benchmarks"].is_array() ) {
+		std::cerr << "Invalid baseline report: missing benchmarks" << std::endl;
+		return -1;
+	}
+
+	int regressions = 0;
+
+	std::cout << std::endl << "Comparison against baseline ( median ):" << std::endl;
+
+	for ( const auto& result : results ) {
+		auto it = std::find_if( baseline["benchmarks"].begin(), baseline["benchmarks"].end(),
+								[&result]( const json& entry ) {
+									return entry.value( "name", "" ) == result.name;
+								} );
+
+		if ( it == baseline["benchmarks"].end() ) {
+			std::cout << std::left << std::setw( 40 ) << result.name << " new" << std::endl;
+			continue;
+		}
+
+		double base = ( *it )["ns_per_op"].value( "median", 0.0 );
+
+		if ( base <= 0 )
+			continue;
+
+		double delta = ( result.median - base ) / base * 100.0;
+		bool regression = delta > threshold;
+
+		if ( regression )
+			regressions++;
+
+		std::cout << std::left << std::setw( 40 ) << result.name << std::right << std::setw( 11 )
+				  << formatTime( base ) << " -> " << std::setw( 11 ) << formatTime( result.median )
+				  << "  " << std::showpos << std::fixed << std::setprecision( 1 ) << delta
+				  << std::noshowpos << "%" << ( regression ? "  REGRESSION" : "" ) << std::endl;
+	}
+
+	return regressions;
+}
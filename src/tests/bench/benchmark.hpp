@@ -0,0 +1,81 @@
+#ifndef EE_BENCH_BENCHMARK_HPP
+#define EE_BENCH_BENCHMARK_HPP
+
+#include <eepp/system/time.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace EE;
+using namespace EE::System;
+
+// Micro-benchmark harness. Every benchmark operation is calibrated to run in batches of at least
+// the minimum sample time, then it's run during the warmup samples ( discarded ) and the measured
+// samples. The statistics are reported in nanoseconds per operation.
+class Benchmark {
+  public:
+	typedef std::function<void()> Operation;
+
+	struct Options {
+		int warmup{ 3 };
+		int samples{ 15 };
+		Time minSampleTime{ Milliseconds( 20 ) };
+		std::string filter;
+	};
+
+	struct Result {
+		std::string name;
+		Uint64 iterations{ 0 };
+		Uint64 bytesPerOp{ 0 };
+		Uint64 itemsPerOp{ 0 };
+		std::string itemsName;
+		int samples{ 0 };
+		double min{ 0 };
+		double mean{ 0 };
+		double median{ 0 };
+		double p90{ 0 };
+		double p99{ 0 };
+		double max{ 0 };
+		double stddev{ 0 };
+	};
+
+	/** Prevents the compiler from optimizing away a value computed by a benchmark. */
+	static void keep( const Uint64& value );
+
+	/** Registers a benchmark. bytesPerOp is used to report the throughput of the operation. */
+	void add( const std::string& name, const Operation& op, const Uint64& bytesPerOp = 0 );
+
+	/** Registers a benchmark that reports its throughput in items per second ( itemsPerOp items
+	 * named itemsName are processed by every operation ). */
+	void addItems( const std::string& name, const Operation& op, const Uint64& itemsPerOp,
+				   const std::string& itemsName );
+
+	std::vector<std::string> getNames() const;
+
+	/** Runs the benchmarks that contain the options filter in its name. */
+	std::vector<Result> run( const Options& options ) const;
+
+	static std::string toJson( const std::vector<Result>& results, const Options& options );
+
+	/** Compares the results against a JSON report created by toJson.
+	 * @return The number of benchmarks with a median slower than the threshold ( in percent ). */
+	static int compare( const std::vector<Result>& results, const std::string& baselineJson,
+						const double& threshold );
+
+	static void print( const Result& result );
+
+  protected:
+	struct Entry {
+		std::string name;
+		Operation op;
+		Uint64 bytesPerOp;
+		Uint64 itemsPerOp;
+		std::string itemsName;
+	};
+
+	std::vector<Entry> mEntries;
+
+	static Result measure( const Entry& entry, const Options& options );
+};
+
+#endif
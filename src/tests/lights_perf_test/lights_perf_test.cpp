@@ -0,0 +1,124 @@
+#include <eepp/ee.hpp>
+#include <eepp/maps/maps.hpp>
+#include <iostream>
+
+// Benchmark of the MapLightManager: a big map with 200 dynamic lights moving around while the
+// camera pans through the map. It reports the average light map update time with and without a
+// thread pool.
+// Keys: T toggles the thread pool, L toggles the light movement, ESC exits.
+
+static constexpr int LIGHTS_COUNT = 200;
+static constexpr int BENCHMARK_FRAMES = 600;
+
+struct DynamicLight {
+	MapLight* light;
+	Vector2f center;
+	Float orbit;
+	Float speed;
+	Float phase;
+};
+
+EE::Window::Window* win = NULL;
+TileMap* map = NULL;
+std::vector<DynamicLight> lights;
+std::shared_ptr<ThreadPool> pool;
+Clock frameClock;
+bool moveLights = true;
+int frames = 0;
+double lightsTime[2] = { 0, 0 };
+int lightsFrames[2] = { 0, 0 };
+
+void mainLoop() {
+	win->getInput()->update();
+
+	if ( win->getInput()->isKeyUp( KEY_ESCAPE ) )
+		win->close();
+
+	if ( win->getInput()->isKeyUp( KEY_T ) )
+		map->getLightManager()->setThreadPool( map->getLightManager()->getThreadPool()
+												   ? std::shared_ptr<ThreadPool>()
+												   : pool );
+
+	if ( win->getInput()->isKeyUp( KEY_L ) )
+		moveLights = !moveLights;
+
+	Float t = frameClock.getElapsedTime().asSeconds();
+
+	if ( moveLights ) {
+		for ( auto& dl : lights ) {
+			Float angle = dl.phase + t * dl.speed;
+			dl.light->setPosition( Vector2f( dl.center.x + eecos( angle ) * dl.orbit,
+											 dl.center.y + eesin( angle ) * dl.orbit ) );
+		}
+	}
+
+	map->setOffset( Vector2f( -( eesin( t * 0.25f ) + 1.f ) * 1024.f,
+							  -( eecos( t * 0.25f ) + 1.f ) * 1024.f ) );
+
+	Clock clock;
+	map->update();
+	int idx = map->getLightManager()->getThreadPool() ? 1 : 0;
+	lightsTime[idx] += clock.getElapsedTime().asMilliseconds();
+	lightsFrames[idx]++;
+
+	win->clear();
+	map->draw();
+	win->display();
+
+	if ( ++frames == BENCHMARK_FRAMES / 2 )
+		map->getLightManager()->setThreadPool( pool );
+
+	if ( frames == BENCHMARK_FRAMES ) {
+		for ( int i = 0; i < 2; i++ ) {
+			if ( lightsFrames[i] ) {
+				std::cout << ( i ? "thread pool" : "single thread" ) << ": "
+						  << lightsTime[i] / lightsFrames[i] << " ms per update ("
+						  << lightsFrames[i] << " frames)" << std::endl;
+			}
+		}
+	}
+}
+
+EE_MAIN_FUNC int main( int, char*[] ) {
+	win = Engine::instance()->createWindow(
+		WindowSettings( 1280, 720, "eepp - MapLightManager Perf Test" ), ContextSettings( false ) );
+
+	if ( win->isOpen() ) {
+		pool = ThreadPool::createShared( eemax<int>( 1, Sys::getCPUCount() - 1 ) );
+
+		map = eeNew( TileMap, () );
+		map->create( Sizei( 256, 256 ), 1, Sizei( 32, 32 ),
+					 MAP_FLAG_LIGHTS_ENABLED | MAP_FLAG_LIGHTS_BYVERTEX | MAP_FLAG_CLAMP_BORDERS |
+						 MAP_FLAG_DRAW_BACKGROUND,
+					 Sizef( win->getWidth(), win->getHeight() ), win );
+		map->setBaseColor( Color( 40, 40, 60, 255 ) );
+
+		Sizef mapSize( map->getSize().getWidth() * map->getTileSize().getWidth(),
+					   map->getSize().getHeight() * map->getTileSize().getHeight() );
+
+		for ( int i = 0; i < LIGHTS_COUNT; i++ ) {
+			DynamicLight dl;
+			dl.center = Vector2f( Math::randf( 0, mapSize.x ), Math::randf( 0, mapSize.y ) );
+			dl.orbit = Math::randf( 32, 256 );
+			dl.speed = Math::randf( 0.5f, 2.f );
+			dl.phase = Math::randf( 0, EE_PI2 );
+			dl.light = eeNew( MapLight, ( Math::randf( 64, 320 ), dl.center.x, dl.center.y,
+										  RGB( Math::randi( 64, 255 ), Math::randi( 64, 255 ),
+											   Math::randi( 64, 255 ) ),
+										  i % 4 == 0 ? MapLightType::Isometric
+													 : MapLightType::Normal ) );
+			map->getLightManager()->addLight( dl.light );
+			lights.push_back( dl );
+		}
+
+		win->runMainLoop( &mainLoop );
+
+		eeSAFE_DELETE( map );
+	}
+
+	Engine::destroySingleton();
+
+	MemoryManager::showResults();
+
+	return EXIT_SUCCESS;
+}
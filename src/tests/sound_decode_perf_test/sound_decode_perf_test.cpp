@@ -0,0 +1,170 @@
+#include <eepp/ee.hpp>
+#include <iomanip>
+#include <iostream>
+
+// Headless benchmark of the sound decoders and the SoundBufferCache.
+// It decodes every sound file found in assets/sounds ( plus any file passed as argument, useful to
+// benchmark the mp3 and flac readers ) and reports the decoding throughput of each file format.
+// The ogg sounds are also re-encoded as wav, so the wav reader is always benchmarked.
+// Then it reports the throughput of the cache hits and the speedup of the parallel batch decoding.
+
+static constexpr int REPETITIONS = 5;
+
+struct FormatStats {
+	Uint64 encodedBytes{ 0 };
+	Uint64 samples{ 0 };
+	double seconds{ 0 };
+};
+
+static bool decodeFile( const std::string& path, Uint64& samples ) {
+	InputSoundFile file;
+
+	if ( !file.openFromFile( path ) )
+		return false;
+
+	std::vector<Int16> buffer( 4096 * file.getChannelCount() );
+	Uint64 read;
+
+	while ( ( read = file.read( &buffer[0], buffer.size() ) ) > 0 )
+		samples += read;
+
+	return true;
+}
+
+static std::string encodeAsWav( const std::string& path, const std::string& tmpPath ) {
+	InputSoundFile input;
+
+	if ( !input.openFromFile( path ) )
+		return "";
+
+	std::string name( FileSystem::fileRemoveExtension( FileSystem::fileNameFromPath( path ) ) );
+	std::string wavPath( tmpPath + name + ".wav" );
+	OutputSoundFile output;
+
+	if ( !output.openFromFile( wavPath, input.getSampleRate(), input.getChannelCount() ) )
+		return "";
+
+	std::vector<Int16> buffer( 4096 * input.getChannelCount() );
+	Uint64 read;
+
+	while ( ( read = input.read( &buffer[0], buffer.size() ) ) > 0 )
+		output.write( &buffer[0], read );
+
+	return wavPath;
+}
+
+static void printStats( const std::string& name, const FormatStats& stats ) {
+	double mb = stats.encodedBytes / ( 1024.0 * 1024.0 );
+	std::cout << std::setw( 8 ) << name << ": " << std::fixed << std::setprecision( 2 )
+			  << mb / stats.seconds << " MB/s, " << stats.samples / stats.seconds / 1000000.0
+			  << " Msamples/s" << std::endl;
+}
+
+EE_MAIN_FUNC int main( int argc, char* argv[] ) {
+	FileSystem::changeWorkingDirectory( Sys::getProcessPath() );
+
+	std::string tmpPath( Sys::getTempPath() + "eepp-sound-decode-perf-test" +
+						 FileSystem::getOSSlash() );
+
+	if ( !FileSystem::isDirectory( tmpPath ) )
+		FileSystem::makeDir( tmpPath );
+
+	std::vector<std::string> paths;
+	std::vector<std::string> files = FileSystem::filesGetInPath( std::string( "assets/sounds/" ) );
+
+	for ( const auto& file : files )
+		paths.push_back( "assets/sounds/" + file );
+
+	for ( int i = 1; i < argc; i++ )
+		paths.push_back( argv[i] );
+
+	std::size_t encodedCount = paths.size();
+
+	for ( std::size_t i = 0; i < encodedCount; i++ ) {
+		if ( FileSystem::fileExtension( paths[i] ) == "ogg" ) {
+			std::string wavPath( encodeAsWav( paths[i], tmpPath ) );
+
+			if ( !wavPath.empty() )
+				paths.push_back( wavPath );
+		}
+	}
+
+	std::map<std::string, FormatStats> formats;
+
+	for ( const auto& path : paths ) {
+		FormatStats& stats = formats[FileSystem::fileExtension( path )];
+
+		for ( int i = 0; i < REPETITIONS; i++ ) {
+			Clock clock;
+
+			if ( !decodeFile( path, stats.samples ) ) {
+				std::cerr << "Failed to decode: " << path << std::endl;
+				break;
+			}
+
+			stats.seconds += clock.getElapsedTime().asSeconds();
+			stats.encodedBytes += FileSystem::fileSize( path );
+		}
+	}
+
+	std::cout << "Decoding throughput per format:" << std::endl;
+
+	for ( const auto& format : formats ) {
+		if ( format.second.seconds > 0 )
+			printStats( format.first, format.second );
+	}
+
+	SoundBufferCache* cache = SoundBufferCache::instance();
+	cache->setEnabled( true );
+
+	std::shared_ptr<ThreadPool> pool =
+		ThreadPool::createShared( eemax<int>( 1, Sys::getCPUCount() ) );
+
+	Clock clock;
+
+	for ( const auto& path : paths )
+		cache->decodeFile( path );
+
+	double serial = clock.getElapsedTime().asSeconds();
+
+	FormatStats hitStats;
+	clock.restart();
+
+	for ( int i = 0; i < REPETITIONS; i++ ) {
+		for ( const auto& path : paths ) {
+			SoundBufferCache::EntryPtr entry( cache->decodeFile( path ) );
+
+			if ( entry ) {
+				hitStats.samples += entry->samples.size();
+				hitStats.encodedBytes += FileSystem::fileSize( path );
+			}
+		}
+	}
+
+	hitStats.seconds = clock.getElapsedTime().asSeconds();
+
+	std::cout << "Cache hits:" << std::endl;
+	printStats( "cached", hitStats );
+
+	cache->clear();
+	clock.restart();
+
+	Uint32 decoded = cache->decodeBatch( paths, *pool );
+
+	double parallel = clock.getElapsedTime().asSeconds();
+
+	std::cout << "Batch decoding of " << decoded << " files: serial " << serial * 1000.0
+			  << " ms, parallel " << parallel * 1000.0 << " ms ( " << pool->numThreads()
+			  << " threads, " << serial / parallel << "x speedup )" << std::endl;
+
+	pool.reset();
+
+	for ( std::size_t i = encodedCount; i < paths.size(); i++ )
+		FileSystem::fileRemove( paths[i] );
+
+	Engine::destroySingleton();
+
+	MemoryManager::showResults();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+#include <cstdlib>
+#include <eepp/ee.hpp>
+#include <iostream>
+
+// Headless test of the SoundStreamScheduler. It's meant to run with the mojoAL backend on the SDL2
+// dummy audio driver ( or openal-soft on its null backend ), so no audio hardware is needed.
+// Several generated streams are played at once, every stream must be played for its whole
+// duration: a stream that stops early lost its last chunks. The underrun and decode stall counters
+// are reported at the end.
+
+static constexpr unsigned int SAMPLE_RATE = 22050;
+static constexpr unsigned int CHANNELS = 1;
+static constexpr std::size_t CHUNK_SAMPLES = SAMPLE_RATE / 4;
+static constexpr std::size_t CHUNK_COUNT = 8;
+static constexpr int STREAM_COUNT = 8;
+static constexpr int ROUNDS = 3;
+
+class GeneratedStream : public SoundStream {
+  public:
+	GeneratedStream() : mSamples( CHUNK_SAMPLES ) {
+		for ( std::size_t i = 0; i < mSamples.size(); i++ )
+			mSamples[i] = static_cast<Int16>( ( i % 100 ) * 100 );
+		initialize( CHANNELS, SAMPLE_RATE );
+	}
+
+	~GeneratedStream() { stop(); }
+
+	Time getDuration() const {
+		return Seconds( static_cast<float>( CHUNK_SAMPLES * CHUNK_COUNT ) /
+						( SAMPLE_RATE * CHANNELS ) );
+	}
+
+  protected:
+	std::vector<Int16> mSamples;
+	std::size_t mChunk{ 0 };
+
+	bool onGetData( Chunk& data ) override {
+		data.samples = &mSamples[0];
+		data.sampleCount = mSamples.size();
+		// The last chunk is returned along with the end of the stream
+		return ++mChunk < CHUNK_COUNT;
+	}
+
+	void onSeek( Time ) override { mChunk = 0; }
+};
+
+static void setEnv( const char* name, const char* value ) {
+#if EE_PLATFORM == EE_PLATFORM_WIN
+	_putenv_s( name, value );
+#else
+	setenv( name, value, 0 );
+#endif
+}
+
+EE_MAIN_FUNC int main( int, char*[] ) {
+	// Null output devices, mojoAL outputs through SDL2
+	setEnv( "SDL_AUDIODRIVER", "dummy" );
+	setEnv( "ALSOFT_DRIVERS", "null" );
+
+	int res = EXIT_SUCCESS;
+
+	for ( int round = 0; round < ROUNDS && res == EXIT_SUCCESS; round++ ) {
+		std::vector<std::unique_ptr<GeneratedStream>> streams;
+		std::vector<Time> elapsed( STREAM_COUNT, Time::Zero );
+
+		for ( int i = 0; i < STREAM_COUNT; i++ )
+			streams.emplace_back( std::make_unique<GeneratedStream>() );
+
+		Clock clock;
+
+		for ( auto& stream : streams ) {
+			stream->play();
+
+			if ( stream->getStatus() != SoundSource::Playing ) {
+				std::cerr << "The stream couldn't be played, no audio device available"
+						  << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+
+		Time timeout( streams[0]->getDuration() * 3.f );
+		int playing = STREAM_COUNT;
+
+		while ( playing > 0 && clock.getElapsedTime() < timeout ) {
+			Sys::sleep( Milliseconds( 5 ) );
+
+			for ( int i = 0; i < STREAM_COUNT; i++ ) {
+				if ( elapsed[i] == Time::Zero &&
+					 streams[i]->getStatus() == SoundSource::Stopped ) {
+					elapsed[i] = clock.getElapsedTime();
+					playing--;
+				}
+			}
+		}
+
+		// A stream is allowed to finish half a chunk earlier than its duration ( the device
+		// consumes the samples in periods ), a lost chunk makes it finish a whole chunk earlier
+		Time minDuration( streams[0]->getDuration() -
+						  Seconds( CHUNK_SAMPLES * 0.5f / ( SAMPLE_RATE * CHANNELS ) ) );
+
+		for ( int i = 0; i < STREAM_COUNT; i++ ) {
+			if ( elapsed[i] == Time::Zero ) {
+				std::cerr << "Round " << round << ", stream " << i << " never stopped"
+						  << std::endl;
+				res = EXIT_FAILURE;
+			} else if ( elapsed[i] < minDuration ) {
+				std::cerr << "Round " << round << ", stream " << i << " stopped after "
+						  << elapsed[i].asMilliseconds() << " ms, expected at least "
+						  << minDuration.asMilliseconds() << " ms" << std::endl;
+				res = EXIT_FAILURE;
+			}
+		}
+	}
+
+	SoundStreamScheduler* scheduler = SoundStreamScheduler::instance();
+	std::cout << "Underruns: " << scheduler->getUnderrunCount()
+			  << ", decode stalls: " << scheduler->getDecodeStallCount() << std::endl;
+	std::cout << ( res == EXIT_SUCCESS ? "Passed" : "Failed" ) << std::endl;
+
+	Engine::destroySingleton();
+
+	MemoryManager::showResults();
+
+	return res;
+}
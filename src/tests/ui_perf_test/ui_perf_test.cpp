@@ -141,9 +141,65 @@ void mainLoop() {
 	}
 }
 
-EE_MAIN_FUNC int main( int, char*[] ) {
-	win = Engine::instance()->createWindow( WindowSettings( 1024, 768, "eepp - UI Perf Test" ),
-											ContextSettings( true ) );
+// Runs the scene with the null renderer and reports the CPU frame time and the draw calls per
+// frame.
+// Usage: ui_perf_test --headless [frames]
+void runHeadless( int frames ) {
+	RendererNull* renderer = GLi->getRendererNull();
+	UISceneNode* uiSceneNode = SceneManager::instance()->getUISceneNode();
+	std::vector<double> frameTimes;
+	Clock clock;
+
+	renderer->resetStats();
+
+	for ( int i = 0; i < frames; i++ ) {
+		clock.restart();
+
+		uiSceneNode->invalidateDraw();
+		SceneManager::instance()->update();
+		win->clear();
+		SceneManager::instance()->draw();
+		win->display();
+
+		frameTimes.push_back( clock.getElapsedTime().asMilliseconds() );
+		renderer->clearCommands();
+	}
+
+	if ( frameTimes.empty() )
+		return;
+
+	std::sort( frameTimes.begin(), frameTimes.end() );
+
+	double total = 0;
+	for ( const auto& time : frameTimes )
+		total += time;
+
+	const Renderer::Stats& stats = renderer->getStats();
+	const RendererNull::Counters& counters = renderer->getCounters();
+
+	std::cout << "Frames: " << frames << std::endl
+			  << "CPU frame time: mean " << total / frames << " ms, median "
+			  << frameTimes[frameTimes.size() / 2] << " ms, max " << frameTimes.back() << " ms"
+			  << std::endl
+			  << "Draw calls per frame: " << stats.drawCalls / frames << std::endl
+			  << "Vertices per frame: " << counters.vertices / frames << std::endl
+			  << "Vertex bytes per frame: " << stats.bytesUploaded / frames << std::endl
+			  << "Texture binds per frame: " << counters.textureBinds / frames << std::endl
+			  << "State changes per frame: " << counters.stateChanges / frames << std::endl
+			  << "Texture uploads: " << counters.textureUploads << " ( "
+			  << counters.textureBytesUploaded << " bytes )" << std::endl;
+}
+
+EE_MAIN_FUNC int main( int argc, char* argv[] ) {
+	bool headless = argc > 1 && std::string( argv[1] ) == "--headless";
+	int headlessFrames = 300;
+
+	if ( headless && argc > 2 )
+		String::fromString( headlessFrames, std::string( argv[2] ) );
+
+	win = Engine::instance()->createWindow(
+		WindowSettings( 1024, 768, "eepp - UI Perf Test" ),
+		ContextSettings( true, headless ? GLv_Null : GLv_default ) );
 
 	if ( win->isOpen() ) {
 		FileSystem::changeWorkingDirectory( Sys::getProcessPath() );
@@ -362,7 +418,11 @@ EE_MAIN_FUNC int main( int, char*[] ) {
 		drop->getListBox()->setSelected( 0 );
 		wind->show();*/
 
-		win->runMainLoop( &mainLoop );
+		if ( headless ) {
+			runHeadless( headlessFrames );
+		} else {
+			win->runMainLoop( &mainLoop );
+		}
 	}
 
 	Engine::destroySingleton();
@@ -71,6 +71,7 @@ void AppConfig::load( const std::string& confPath, std::string& keybindingsPath,
 	editor.highlightCurrentLine = ini.getValueB( "editor", "highlight_current_line", true );
 	editor.verticalScrollbar = ini.getValueB( "editor", "vertical_scrollbar", true );
 	editor.horizontalScrollbar = ini.getValueB( "editor", "horizontal_scrollbar", true );
+	editor.softWrap = ini.getValueB( "editor", "soft_wrap", false );
 	ui.fontSize = ini.getValue( "ui", "font_size", "11dp" );
 	ui.showSidePanel = ini.getValueB( "ui", "show_side_panel", true );
 	ui.panelPosition = panelPositionFromString( ini.getValue( "ui", "panel_position", "left" ) );
@@ -175,6 +176,7 @@ void AppConfig::save( const std::vector<std::string>& recentFiles,
 	ini.setValueB( "editor", "highlight_current_line", editor.highlightCurrentLine );
 	ini.setValueB( "editor", "vertical_scrollbar", editor.verticalScrollbar );
 	ini.setValueB( "editor", "horizontal_scrollbar", editor.horizontalScrollbar );
+	ini.setValueB( "editor", "soft_wrap", editor.softWrap );
 	ini.setValue( "editor", "font_size", editor.fontSize.toString() );
 	ini.setValue( "ui", "font_size", ui.fontSize.toString() );
 	ini.setValueB( "ui", "show_side_panel", ui.showSidePanel );
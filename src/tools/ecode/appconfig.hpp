@@ -52,6 +52,7 @@ struct CodeEditorConfig {
 	bool highlightMatchingBracket{ true };
 	bool verticalScrollbar{ true };
 	bool horizontalScrollbar{ true };
+	bool softWrap{ false };
 	bool highlightCurrentLine{ true };
 	bool highlightSelectionMatch{ true };
 	bool colorPickerSelection{ false };
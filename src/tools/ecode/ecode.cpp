@@ -387,6 +387,7 @@ void App::loadConfig( const LogLevel& logLevel ) {
 	if ( !FileSystem::fileExists( mPluginsPath ) )
 		FileSystem::makeDir( mPluginsPath );
 	FileSystem::dirAddSlashAtEnd( mPluginsPath );
+	CSS::StyleSheetParser::setCachePath( mConfigPath + "csscache" );
 #ifndef EE_DEBUG
 	Log::create( mConfigPath + "ecode.log", logLevel, false, true );
 #else
@@ -470,7 +471,16 @@ void App::mainLoop() {
 		}
 	} else {
 #if EE_PLATFORM != EE_PLATFORM_EMSCRIPTEN
-		mWindow->getInput()->waitEvent( Milliseconds( mWindow->hasFocus() ? 16 : 100 ) );
+		// Sleep until the next event, the next scheduled work or a wake up from other thread.
+		// Nodes that still need to poll report a zero idle time and keep the polling rate.
+		Time idle( SceneManager::instance()->getIdleTime() );
+		if ( idle == Time::Zero ) {
+			mWindow->getInput()->waitEvent( Milliseconds( mWindow->hasFocus() ? 16 : 100 ) );
+		} else if ( idle != Time::Infinity ) {
+			mWindow->getInput()->waitEvent( idle );
+		} else {
+			mWindow->getInput()->waitEvent();
+		}
 #endif
 	}
 
@@ -1035,6 +1045,12 @@ UIMenu* App::createViewMenu() {
 	mViewMenu->addCheckBox( i18n( "enable_horizontal_scrollbar", "Enable Horizontal ScrollBar" ) )
 		->setActive( mConfig.editor.horizontalScrollbar )
 		->setId( "enable-horizontal-scrollbar" );
+	mViewMenu->addCheckBox( i18n( "soft_wrap", "Soft Wrap" ) )
+		->setActive( mConfig.editor.softWrap )
+		->setTooltipText( i18n( "soft_wrap_tooltip",
+								"Wraps the lines longer than the editor width into\n"
+								"several rows instead of scrolling horizontally." ) )
+		->setId( "soft-wrap" );
 	mViewMenu->addCheckBox( i18n( "enable_color_preview", "Enable Color Preview" ) )
 		->setActive( mConfig.editor.colorPreview )
 		->setTooltipText( i18n( "enable_color_preview_tooltip",
@@ -1117,6 +1133,10 @@ UIMenu* App::createViewMenu() {
 			mSplitter->forEachEditor( [&]( UICodeEditor* editor ) {
 				editor->setHorizontalScrollBarEnabled( mConfig.editor.horizontalScrollbar );
 			} );
+		} else if ( item->getId() == "soft-wrap" ) {
+			mConfig.editor.softWrap = item->asType<UIMenuCheckBox>()->isActive();
+			mSplitter->forEachEditor(
+				[&]( UICodeEditor* editor ) { editor->setSoftWrap( mConfig.editor.softWrap ); } );
 		} else if ( item->getId() == "enable-color-preview" ) {
 			mConfig.editor.colorPreview = item->asType<UIMenuCheckBox>()->isActive();
 			mSplitter->forEachEditor( [&]( UICodeEditor* editor ) {
@@ -2495,6 +2515,7 @@ void App::onCodeEditorCreated( UICodeEditor* editor, TextDocument& doc ) {
 	editor->setHighlightMatchingBracket( config.highlightMatchingBracket );
 	editor->setVerticalScrollBarEnabled( config.verticalScrollbar );
 	editor->setHorizontalScrollBarEnabled( config.horizontalScrollbar );
+	editor->setSoftWrap( config.softWrap );
 	editor->setHighlightCurrentLine( config.highlightCurrentLine );
 	editor->setTabWidth( docc.tabWidth );
 	editor->setLineBreakingColumn( docc.lineBreakingColumn );
@@ -3555,6 +3576,13 @@ void App::init( const LogLevel& logLevel, std::string file, const Float& pidelDe
 			eemax( mWindow->getScale(), mConfig.windowState.pixelDensity ) );
 
 		mUISceneNode = UISceneNode::New();
+
+		// Only the damaged regions of the scene are redrawn when nothing else changes
+		if ( mUseFrameBuffer ) {
+			mUISceneNode->enableFrameBuffer();
+			mUISceneNode->enableDrawInvalidation();
+		}
+
 		mUIColorScheme = mConfig.ui.colorScheme;
 		if ( !colorScheme.empty() ) {
 			mUIColorScheme =
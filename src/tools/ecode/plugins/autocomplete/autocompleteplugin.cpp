@@ -3,9 +3,9 @@
 #include <eepp/graphics/primitives.hpp>
 #include <eepp/graphics/text.hpp>
 #include <eepp/system/lock.hpp>
-#include <eepp/system/luapattern.hpp>
 #include <eepp/ui/uiscenenode.hpp>
 #include <nlohmann/json.hpp>
+#include <unordered_set>
 using namespace EE::Graphics;
 using namespace EE::System;
 using json = nlohmann::json;
@@ -38,23 +38,30 @@ static json getURIAndPositionJSON( UICodeEditor* editor ) {
 }
 
 static AutoCompletePlugin::SymbolsList
-fuzzyMatchSymbols( const std::vector<const AutoCompletePlugin::SymbolsList*>& symbolsVec,
-				   const std::string& match, const size_t& max ) {
+fuzzyMatchSymbols( const AutoCompletePlugin::SymbolsList& suggestions,
+				   const std::shared_ptr<SymbolDictionary>& dictionary, const std::string& match,
+				   const size_t& max ) {
 	AutoCompletePlugin::SymbolsList matches;
+	std::unordered_set<std::string> found;
 	matches.reserve( max );
 	int score;
-	for ( const auto& symbols : symbolsVec ) {
-		for ( const auto& symbol : *symbols ) {
-			if ( ( score = String::fuzzyMatch( symbol.text, match ) ) > 0 ) {
-				if ( std::find( matches.begin(), matches.end(), symbol ) == matches.end() ) {
-					symbol.setScore( score );
-					matches.push_back( symbol );
-				}
+	for ( const auto& symbol : suggestions ) {
+		if ( ( score = String::fuzzyMatch( symbol.text, match ) ) > 0 ) {
+			if ( found.insert( symbol.text ).second ) {
+				symbol.setScore( score );
+				matches.push_back( symbol );
 			}
 		}
+	}
 
-		if ( matches.size() > max )
-			break;
+	if ( matches.size() <= max && dictionary ) {
+		dictionary->fuzzyMatch( match, [&]( const std::string& symbol, const int& score ) {
+			if ( found.find( symbol ) == found.end() ) {
+				AutoCompletePlugin::Suggestion suggestion( symbol );
+				suggestion.setScore( score );
+				matches.push_back( std::move( suggestion ) );
+			}
+		} );
 	}
 
 	std::sort( matches.begin(), matches.end(),
@@ -92,6 +99,8 @@ AutoCompletePlugin::~AutoCompletePlugin() {
 			editor.first->removeEventListener( listener );
 		editor.first->unregisterPlugin( this );
 	}
+	mDocs.clear();
+	mClosedDocs.clear();
 }
 
 void AutoCompletePlugin::onRegister( UICodeEditor* editor ) {
@@ -107,9 +116,7 @@ void AutoCompletePlugin::onRegister( UICodeEditor* editor ) {
 		editor->addEventListener( Event::OnDocumentClosed, [&]( const Event* event ) {
 			Lock l( mDocMutex );
 			const DocEvent* docEvent = static_cast<const DocEvent*>( event );
-			TextDocument* doc = docEvent->getDoc();
-			mDocs.erase( doc );
-			mDocCache.erase( doc );
+			removeDocument( docEvent->getDoc(), true );
 			mDirty = true;
 		} ) );
 
@@ -118,8 +125,8 @@ void AutoCompletePlugin::onRegister( UICodeEditor* editor ) {
 			TextDocument* oldDoc = mEditorDocs[editor];
 			TextDocument* newDoc = editor->getDocumentRef().get();
 			Lock l( mDocMutex );
-			mDocs.erase( oldDoc );
-			mDocCache.erase( oldDoc );
+			removeDocument( oldDoc );
+			addDocument( newDoc );
 			mEditorDocs[editor] = newDoc;
 			mDirty = true;
 		} ) );
@@ -138,24 +145,18 @@ void AutoCompletePlugin::onRegister( UICodeEditor* editor ) {
 
 	listeners.push_back(
 		editor->addEventListener( Event::OnDocumentSyntaxDefinitionChange, [&]( const Event* ev ) {
-			const DocSyntaxDefEvent* event = static_cast<const DocSyntaxDefEvent*>( ev );
-			std::string oldLang = event->getOldLang();
-			std::string newLang = event->getNewLang();
-#if AUTO_COMPLETE_THREADED
-			mPool->run(
-				[&, oldLang, newLang] {
-					updateLangCache( oldLang );
-					updateLangCache( newLang );
-				},
-				[] {} );
-#else
-			updateLangCache( oldLang );
-			updateLangCache( newLang );
-#endif
+			// The document symbols are moved to the dictionary of the new language on the next
+			// update
+			const DocEvent* docEvent = static_cast<const DocEvent*>( ev );
+			Lock l( mDocMutex );
+			auto docSymbols = mDocs.find( docEvent->getDoc() );
+			if ( docSymbols != mDocs.end() )
+				docSymbols->second->invalidate();
+			mDirty = true;
 		} ) );
 
 	mEditors.insert( { editor, listeners } );
-	mDocs.insert( editor->getDocumentRef().get() );
+	addDocument( editor->getDocumentRef().get() );
 	mEditorDocs[editor] = editor->getDocumentRef().get();
 	mDirty = true;
 }
@@ -177,11 +178,41 @@ void AutoCompletePlugin::onUnregister( UICodeEditor* editor ) {
 	for ( auto editor : mEditorDocs )
 		if ( editor.second == doc )
 			return;
-	mDocs.erase( doc );
-	mDocCache.erase( doc );
+	removeDocument( doc );
 	mDirty = true;
 }
 
+void AutoCompletePlugin::addDocument( TextDocument* doc ) {
+	Lock l( mDocMutex );
+	if ( mDocs.find( doc ) == mDocs.end() )
+		mDocs[doc] = std::make_shared<DocumentSymbols>( doc );
+}
+
+void AutoCompletePlugin::removeDocument( TextDocument* doc, bool closing ) {
+	Lock l( mDocMutex );
+	auto docSymbols = mDocs.find( doc );
+	if ( docSymbols == mDocs.end() )
+		return;
+	// The document notifies its clients while it's being closed, so the client can't be released
+	// until the next update.
+	if ( closing )
+		mClosedDocs.push_back( docSymbols->second );
+	mDocs.erase( docSymbols );
+}
+
+std::shared_ptr<SymbolDictionary>
+AutoCompletePlugin::getLangDictionary( const std::string& langName, bool create ) {
+	Lock l( mLangSymbolsMutex );
+	auto dictionary = mLangDictionaries.find( langName );
+	if ( dictionary != mLangDictionaries.end() )
+		return dictionary->second;
+	if ( !create )
+		return {};
+	auto newDictionary = std::make_shared<SymbolDictionary>();
+	mLangDictionaries[langName] = newDictionary;
+	return newDictionary;
+}
+
 bool AutoCompletePlugin::onKeyDown( UICodeEditor* editor, const KeyEvent& event ) {
 	bool ret = false;
 	if ( mSignatureHelpVisible ) {
@@ -389,60 +420,29 @@ void AutoCompletePlugin::updateDocCache( TextDocument* doc ) {
 		mDocsUpdating[doc] = true;
 	}
 	Clock clock;
-	std::unordered_map<TextDocument*, DocCache>::iterator docCache;
+	std::shared_ptr<DocumentSymbols> docSymbols;
 	{
 		Lock l( mDocMutex );
-		docCache = mDocCache.find( doc );
-		if ( docCache == mDocCache.end() || mClosing )
-			return;
+		auto found = mDocs.find( doc );
+		if ( found != mDocs.end() && !mClosing )
+			docSymbols = found->second;
 	}
 
-	auto changeId = doc->getCurrentChangeId();
-	auto symbols = getDocumentSymbols( doc );
-
-	{
-		Lock l( mDocMutex );
-		docCache = mDocCache.find( doc );
-		if ( docCache == mDocCache.end() || mClosing )
-			return;
-		auto& cache = docCache->second;
-		cache.changeId = changeId;
-		cache.symbols = std::move( symbols );
+	if ( docSymbols ) {
+		// Only the lines modified since the last update are extracted again
+		docSymbols->update(
+			getLangDictionary( doc->getSyntaxDefinition().getLanguageName(), true ),
+			mSymbolPattern, mClosing );
+		Log::debug( "Dictionary for %s updated in: %.2fms", doc->getFilename().c_str(),
+					clock.getElapsedTime().asMilliseconds() );
 	}
 
-	std::string langName( doc->getSyntaxDefinition().getLanguageName() );
-	{
-		Lock l( mLangSymbolsMutex );
-		auto& lang = mLangCache[langName];
-		lang.clear();
-		Lock l2( mDocMutex );
-		for ( const auto& d : mDocCache ) {
-			if ( d.first->getSyntaxDefinition().getLanguageName() == langName )
-				lang.insert( lang.end(), d.second.symbols.begin(), d.second.symbols.end() );
-		}
-	}
-	Log::debug( "Dictionary for %s updated in: %.2fms", doc->getFilename().c_str(),
-				clock.getElapsedTime().asMilliseconds() );
 	{
 		Lock lu( mDocsUpdatingMutex );
 		mDocsUpdating[doc] = false;
 	}
 }
 
-void AutoCompletePlugin::updateLangCache( const std::string& langName ) {
-	Clock clock;
-	Lock l( mLangSymbolsMutex );
-	Lock l2( mDocMutex );
-	auto& lang = mLangCache[langName];
-	lang.clear();
-	for ( const auto& d : mDocCache ) {
-		if ( d.first->getSyntaxDefinition().getLanguageName() == langName )
-			lang.insert( lang.end(), d.second.symbols.begin(), d.second.symbols.end() );
-	}
-	Log::debug( "Lang dictionary for %s updated in: %.2fms", langName.c_str(),
-				clock.getElapsedTime().asMilliseconds() );
-}
-
 void AutoCompletePlugin::pickSuggestion( UICodeEditor* editor ) {
 	mReplacing = true;
 	std::string symbol( getPartialSymbol( editor->getDocumentRef().get() ) );
@@ -478,25 +478,15 @@ AutoCompletePlugin::processCodeCompletion( const LSPCompletionList& completion )
 		return {};
 	std::string symbol( getPartialSymbol( editor->getDocumentRef().get() ) );
 	const std::string& lang = editor->getDocument().getSyntaxDefinition().getLanguageName();
-	bool hasLangSuggestions = false;
-	{
-		Lock l2( mLangSymbolsMutex );
-		auto langSuggestions = mLangCache.find( lang );
-		hasLangSuggestions = langSuggestions != mLangCache.end();
-	}
-	if ( symbol.empty() || !hasLangSuggestions ) {
+	auto dictionary = getLangDictionary( lang );
+	if ( symbol.empty() || !dictionary ) {
 		Lock l( mSuggestionsMutex );
 		mSuggestions = suggestions;
 	} else {
-		SymbolsList fuzzySuggestions;
-		{
-			Lock l2( mLangSymbolsMutex );
-			auto& symbols = mLangCache[lang];
-			fuzzySuggestions = fuzzyMatchSymbols( { &suggestions, &symbols }, symbol,
-												  eemax<size_t>( 100UL, suggestions.size() ) );
-		}
+		SymbolsList fuzzySuggestions = fuzzyMatchSymbols(
+			suggestions, dictionary, symbol, eemax<size_t>( 100UL, suggestions.size() ) );
 		Lock l( mSuggestionsMutex );
-		mSuggestions = fuzzySuggestions;
+		mSuggestions = std::move( fuzzySuggestions );
 	}
 
 	editor->runOnMainThread( [editor] { editor->invalidateDraw(); } );
@@ -574,13 +564,34 @@ std::string AutoCompletePlugin::getPartialSymbol( TextDocument* doc ) {
 	return doc->getText( { start, end } ).toUtf8();
 }
 
+Time AutoCompletePlugin::getIdleTime( UICodeEditor* ) {
+	if ( mDirty )
+		return Time::Zero;
+
+	Lock l( mDocMutex );
+
+	// The symbols are only updated when a document changed
+	for ( auto& docSymbols : mDocs ) {
+		TextDocument* doc = docSymbols.first;
+		if ( !doc->isLoading() && docSymbols.second->getChangeId() != doc->getCurrentChangeId() ) {
+			Time elapsed( mClock.getElapsedTime() );
+			return elapsed < mUpdateFreq ? mUpdateFreq - elapsed : Time::Zero;
+		}
+	}
+
+	return Time::Infinity;
+}
+
 void AutoCompletePlugin::update( UICodeEditor* ) {
 	if ( mClock.getElapsedTime() >= mUpdateFreq || mDirty ) {
 		mClock.restart();
 		mDirty = false;
 		Lock l( mDocMutex );
-		for ( auto& doc : mDocs ) {
-			if ( !doc->isLoading() && mDocCache[doc].changeId != doc->getCurrentChangeId() ) {
+		mClosedDocs.clear();
+		for ( auto& docSymbols : mDocs ) {
+			TextDocument* doc = docSymbols.first;
+			if ( !doc->isLoading() &&
+				 docSymbols.second->getChangeId() != doc->getCurrentChangeId() ) {
 				{
 					Lock lu( mDocsUpdatingMutex );
 					auto du = mDocsUpdating.find( doc );
@@ -599,7 +610,7 @@ void AutoCompletePlugin::update( UICodeEditor* ) {
 }
 
 void AutoCompletePlugin::drawSignatureHelp( UICodeEditor* editor, const Vector2f& startScroll,
-											const Float& lineHeight, bool drawUp ) {
+											const Float& /*lineHeight*/, bool drawUp ) {
 
 	TextDocument& doc = editor->getDocument();
 	Primitives primitives;
@@ -614,8 +625,8 @@ void AutoCompletePlugin::drawSignatureHelp( UICodeEditor* editor, const Vector2f
 		return;
 	auto curSig = mSignatureHelp.signatures[curSigIdx];
 	Float vdiff = drawUp ? -mRowHeight : mRowHeight;
-	Vector2f pos( startScroll.x + editor->getXOffsetCol( mSignatureHelpPosition ),
-				  startScroll.y + mSignatureHelpPosition.line() * lineHeight + vdiff );
+	Vector2f offset( editor->getTextPositionOffset( mSignatureHelpPosition ) );
+	Vector2f pos( startScroll.x + offset.x, startScroll.y + offset.y + vdiff );
 	primitives.setColor( Color( selectedStyle.background ).blendAlpha( editor->getAlpha() ) );
 	String str;
 	if ( mSignatureHelp.signatures.size() > 1 ) {
@@ -655,9 +666,8 @@ void AutoCompletePlugin::drawSignatureHelp( UICodeEditor* editor, const Vector2f
 							  ( curParam.end - curParam.start ) * editor->getGlyphWidth(),
 						  curParamRect.getPosition().y },
 						curParamRect.getSize() } ) ) {
-			pos = { startScroll.x - curParam.start * editor->getGlyphWidth() +
-						editor->getXOffsetCol( mSignatureHelpPosition ),
-					startScroll.y + mSignatureHelpPosition.line() * lineHeight + vdiff };
+			pos = { startScroll.x - curParam.start * editor->getGlyphWidth() + offset.x,
+					startScroll.y + offset.y + vdiff };
 
 			boxRect.setPosition( pos );
 
@@ -712,8 +722,10 @@ void AutoCompletePlugin::postDraw( UICodeEditor* editor, const Vector2f& startSc
 		suggestions = mSuggestions;
 	}
 
-	Vector2f cursorPos( startScroll.x + editor->getXOffsetCol( start ),
-						startScroll.y + cursor.line() * lineHeight + lineHeight );
+	// The suggestions are displayed below the row of the cursor ( the line can be soft wrapped )
+	Vector2f startOffset( editor->getTextPositionOffset( start ) );
+	Vector2f cursorPos( startScroll.x + startOffset.x,
+						startScroll.y + editor->getTextPositionOffset( cursor ).y + lineHeight );
 	size_t largestString = 0;
 	size_t max = eemin<size_t>( mSuggestionsMaxVisible, suggestions.size() );
 	mRowHeight = lineHeight + mBoxPadding.Top + mBoxPadding.Bottom;
@@ -925,35 +937,9 @@ void AutoCompletePlugin::resetSignatureHelp() {
 	mSignatureHelpEditor = nullptr;
 }
 
-AutoCompletePlugin::SymbolsList AutoCompletePlugin::getDocumentSymbols( TextDocument* doc ) {
-	LuaPattern pattern( mSymbolPattern );
-	AutoCompletePlugin::SymbolsList symbols;
-	Int64 lc = doc->linesCount();
-	if ( lc == 0 || lc > 50000 || mClosing )
-		return symbols;
-	std::string current( getPartialSymbol( doc ) );
-	TextPosition end = doc->getSelection().end();
-	for ( Int64 i = 0; i < lc; i++ ) {
-		const auto& string = doc->line( i ).getText().toUtf8();
-		for ( auto& match : pattern.gmatch( string ) ) {
-			std::string matchStr( match[0] );
-			// Ignore the symbol if is actually the current symbol being written
-			if ( matchStr.size() < 3 || ( end.line() == i && current == matchStr ) )
-				continue;
-			if ( std::none_of( symbols.begin(), symbols.end(),
-							   [matchStr]( const Suggestion& suggestion ) {
-								   return suggestion.text == matchStr;
-							   } ) )
-				symbols.push_back( std::move( matchStr ) );
-		}
-		if ( mClosing )
-			break;
-	}
-	return symbols;
-}
-
 void AutoCompletePlugin::runUpdateSuggestions( const std::string& symbol,
-											   const SymbolsList& symbols, UICodeEditor* editor ) {
+											   const std::shared_ptr<SymbolDictionary>& dictionary,
+											   UICodeEditor* editor ) {
 	{
 		{
 			Lock l( mSuggestionsEditorMutex );
@@ -963,29 +949,26 @@ void AutoCompletePlugin::runUpdateSuggestions( const std::string& symbol,
 			requestCodeCompletion( editor );
 		if ( symbol.empty() )
 			return;
-		Lock l( mLangSymbolsMutex );
-		Lock l2( mSuggestionsMutex );
-		mSuggestions = fuzzyMatchSymbols( { &symbols }, symbol, mSuggestionsMaxVisible );
+		SymbolsList suggestions =
+			fuzzyMatchSymbols( {}, dictionary, symbol, mSuggestionsMaxVisible );
+		Lock l( mSuggestionsMutex );
+		mSuggestions = std::move( suggestions );
 	}
 	editor->runOnMainThread( [editor] { editor->invalidateDraw(); } );
 }
 
 void AutoCompletePlugin::updateSuggestions( const std::string& symbol, UICodeEditor* editor ) {
 	const std::string& lang = editor->getDocument().getSyntaxDefinition().getLanguageName();
-	Lock l( mLangSymbolsMutex );
-	auto langSuggestions = mLangCache.find( lang );
-	if ( langSuggestions == mLangCache.end() )
+	auto dictionary = getLangDictionary( lang );
+	if ( !dictionary )
 		return;
-	auto& symbols = langSuggestions->second;
-	{
 #if AUTO_COMPLETE_THREADED
-		mPool->run(
-			[this, symbol, symbols, editor] { runUpdateSuggestions( symbol, symbols, editor ); },
-			[] {} );
+	mPool->run(
+		[this, symbol, dictionary, editor] { runUpdateSuggestions( symbol, dictionary, editor ); },
+		[] {} );
 #else
-		runUpdateSuggestions( symbol, symbols, editor );
+	runUpdateSuggestions( symbol, dictionary, editor );
 #endif
-	}
 }
 
 } // namespace ecode
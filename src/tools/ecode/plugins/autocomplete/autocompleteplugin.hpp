@@ -3,6 +3,7 @@
 
 #include "../lsp/lspprotocol.hpp"
 #include "../pluginmanager.hpp"
+#include "symboldictionary.hpp"
 #include <eepp/config.hpp>
 #include <eepp/system/clock.hpp>
 #include <eepp/system/mutex.hpp>
@@ -77,6 +78,7 @@ class AutoCompletePlugin : public UICodeEditorPlugin {
 	bool onKeyDown( UICodeEditor*, const KeyEvent& );
 	bool onTextInput( UICodeEditor*, const TextInputEvent& );
 	void update( UICodeEditor* );
+	Time getIdleTime( UICodeEditor* );
 	void postDraw( UICodeEditor*, const Vector2f& startScroll, const Float& lineHeight,
 				   const TextPosition& cursor );
 	bool onMouseDown( UICodeEditor*, const Vector2i&, const Uint32& );
@@ -115,19 +117,14 @@ class AutoCompletePlugin : public UICodeEditorPlugin {
 	Mutex mDocMutex;
 	Time mUpdateFreq{ Seconds( 5 ) };
 	std::unordered_map<UICodeEditor*, std::vector<Uint32>> mEditors;
-	std::set<TextDocument*> mDocs;
+	std::unordered_map<TextDocument*, std::shared_ptr<DocumentSymbols>> mDocs;
+	std::vector<std::shared_ptr<DocumentSymbols>> mClosedDocs;
 	std::unordered_map<UICodeEditor*, TextDocument*> mEditorDocs;
 	bool mDirty{ false };
 	bool mClosing{ false };
 	bool mReplacing{ false };
 	bool mSignatureHelpVisible{ false };
-	struct DocCache {
-		Uint64 changeId{ static_cast<Uint64>( -1 ) };
-		SymbolsList symbols;
-	};
-	std::unordered_map<TextDocument*, DocCache> mDocCache;
-	std::unordered_map<std::string, SymbolsList> mLangCache;
-	SymbolsList mLangDirty;
+	std::unordered_map<std::string, std::shared_ptr<SymbolDictionary>> mLangDictionaries;
 
 	std::vector<Suggestion> mSuggestions;
 	Mutex mSuggestionsEditorMutex;
@@ -157,17 +154,21 @@ class AutoCompletePlugin : public UICodeEditorPlugin {
 
 	void updateSuggestions( const std::string& symbol, UICodeEditor* editor );
 
-	SymbolsList getDocumentSymbols( TextDocument* );
+	void addDocument( TextDocument* doc );
+
+	void removeDocument( TextDocument* doc, bool closing = false );
+
+	std::shared_ptr<SymbolDictionary> getLangDictionary( const std::string& langName,
+														 bool create = false );
 
 	void updateDocCache( TextDocument* doc );
 
 	std::string getPartialSymbol( TextDocument* doc );
 
-	void runUpdateSuggestions( const std::string& symbol, const SymbolsList& symbols,
+	void runUpdateSuggestions( const std::string& symbol,
+							   const std::shared_ptr<SymbolDictionary>& dictionary,
 							   UICodeEditor* editor );
 
-	void updateLangCache( const std::string& langName );
-
 	void pickSuggestion( UICodeEditor* editor );
 
 	PluginRequestHandle processResponse( const PluginMessage& msg );
@@ -0,0 +1,349 @@
+#include "symboldictionary.hpp"
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <eepp/system/lock.hpp>
+#include <eepp/system/luapattern.hpp>
+
+namespace ecode {
+
+// Documents with more lines than this are not indexed
+static constexpr Int64 MAX_DOCUMENT_LINES = 50000;
+
+// Symbols shorter than this are not indexed
+static constexpr size_t MIN_SYMBOL_LENGTH = 3;
+
+Uint64 SymbolDictionary::charMask( const std::string& str ) {
+	Uint64 mask = 0;
+
+	for ( const char& ch : str ) {
+		// Same case folding and space skipping than String::fuzzyMatch
+		if ( ch == ' ' )
+			continue;
+
+		int lower = std::tolower( ch );
+		int bit;
+
+		if ( lower >= 'a' && lower <= 'z' ) {
+			bit = lower - 'a';
+		} else if ( lower >= '0' && lower <= '9' ) {
+			bit = 26 + lower - '0';
+		} else {
+			bit = 36 + static_cast<unsigned char>( lower ) % 28;
+		}
+
+		mask |= static_cast<Uint64>( 1 ) << bit;
+	}
+
+	return mask;
+}
+
+// Index of the position of a mask bit in the bucket positions of a symbol
+static size_t bucketRank( const Uint64& mask, const size_t& bit ) {
+	return std::bitset<64>( mask & ( ( static_cast<Uint64>( 1 ) << bit ) - 1 ) ).count();
+}
+
+void SymbolDictionary::indexSymbol( const Uint32& id ) {
+	std::vector<Uint32>& positions = mBucketPositions[id];
+	positions.clear();
+
+	for ( size_t bit = 0; bit < mBuckets.size(); bit++ ) {
+		if ( mMasks[id] & ( static_cast<Uint64>( 1 ) << bit ) ) {
+			positions.push_back( static_cast<Uint32>( mBuckets[bit].size() ) );
+			mBuckets[bit].push_back( id );
+		}
+	}
+}
+
+void SymbolDictionary::unindexSymbol( const Uint32& id ) {
+	size_t rank = 0;
+
+	for ( size_t bit = 0; bit < mBuckets.size(); bit++ ) {
+		if ( !( mMasks[id] & ( static_cast<Uint64>( 1 ) << bit ) ) )
+			continue;
+
+		// Swap with the last symbol of the bucket and update its position
+		std::vector<Uint32>& bucket = mBuckets[bit];
+		Uint32 pos = mBucketPositions[id][rank++];
+		Uint32 moved = bucket.back();
+		bucket[pos] = moved;
+		mBucketPositions[moved][bucketRank( mMasks[moved], bit )] = pos;
+		bucket.pop_back();
+	}
+
+	mBucketPositions[id].clear();
+}
+
+void SymbolDictionary::acquire( const std::vector<std::string>& symbols,
+								std::vector<Uint32>& ids ) {
+	Lock l( mMutex );
+
+	ids.reserve( ids.size() + symbols.size() );
+
+	for ( const auto& symbol : symbols ) {
+		auto it = mIds.find( symbol );
+
+		if ( it != mIds.end() ) {
+			mRefs[it->second]++;
+			ids.push_back( it->second );
+			continue;
+		}
+
+		Uint32 id;
+
+		if ( !mFreeIds.empty() ) {
+			id = mFreeIds.back();
+			mFreeIds.pop_back();
+			mSymbols[id] = symbol;
+			mRefs[id] = 1;
+			mMasks[id] = charMask( symbol );
+		} else {
+			id = static_cast<Uint32>( mSymbols.size() );
+			mSymbols.push_back( symbol );
+			mRefs.push_back( 1 );
+			mMasks.push_back( charMask( symbol ) );
+			mBucketPositions.emplace_back();
+		}
+
+		indexSymbol( id );
+		mIds[symbol] = id;
+		ids.push_back( id );
+	}
+}
+
+void SymbolDictionary::release( const std::vector<Uint32>& ids ) {
+	Lock l( mMutex );
+
+	for ( const auto& id : ids ) {
+		if ( id >= mRefs.size() || mRefs[id] == 0 || --mRefs[id] > 0 )
+			continue;
+
+		unindexSymbol( id );
+		mIds.erase( mSymbols[id] );
+		mSymbols[id].clear();
+		mMasks[id] = 0;
+		mFreeIds.push_back( id );
+	}
+}
+
+void SymbolDictionary::fuzzyMatch( const std::string& pattern, const MatchCb& onMatch ) const {
+	Uint64 patternMask = charMask( pattern );
+	int score;
+
+	// An empty pattern doesn't match any symbol
+	if ( 0 == patternMask )
+		return;
+
+	Lock l( mMutex );
+
+	// Every match contains all the pattern characters, only the smallest bucket is scanned
+	const std::vector<Uint32>* candidates = nullptr;
+
+	for ( size_t bit = 0; bit < mBuckets.size(); bit++ ) {
+		if ( ( patternMask & ( static_cast<Uint64>( 1 ) << bit ) ) &&
+			 ( nullptr == candidates || mBuckets[bit].size() < candidates->size() ) )
+			candidates = &mBuckets[bit];
+	}
+
+	for ( const auto& id : *candidates ) {
+		if ( ( mMasks[id] & patternMask ) != patternMask )
+			continue;
+
+		const std::string& symbol = mSymbols[id];
+
+		if ( symbol != pattern && ( score = String::fuzzyMatch( symbol, pattern ) ) > 0 )
+			onMatch( symbol, score );
+	}
+}
+
+size_t SymbolDictionary::size() const {
+	Lock l( mMutex );
+	return mIds.size();
+}
+
+DocumentSymbols::DocumentSymbols( TextDocument* doc ) : mDoc( doc ) {
+	mDoc->registerClient( this );
+}
+
+DocumentSymbols::~DocumentSymbols() {
+	if ( !mClosed )
+		mDoc->unregisterClient( this );
+
+	if ( mDictionary ) {
+		std::vector<Uint32> released;
+		releaseAll( released );
+		mDictionary->release( released );
+	}
+}
+
+void DocumentSymbols::update( const std::shared_ptr<SymbolDictionary>& dictionary,
+							  const std::string& pattern, const bool& cancel ) {
+	Lock l( mUpdateMutex );
+
+	if ( mClosed )
+		return;
+
+	Uint64 changeId = mDoc->getCurrentChangeId();
+	std::vector<LineEdit> edits;
+	std::vector<Uint32> released;
+	bool fullUpdate;
+
+	{
+		Lock lp( mPendingMutex );
+		edits.swap( mPending );
+		fullUpdate = mFullUpdate;
+		mFullUpdate = false;
+	}
+
+	if ( dictionary != mDictionary ) {
+		if ( mDictionary ) {
+			releaseAll( released );
+			mDictionary->release( released );
+			released.clear();
+		}
+
+		mDictionary = dictionary;
+		fullUpdate = true;
+	}
+
+	Int64 linesCount = mDoc->linesCount();
+
+	if ( !fullUpdate ) {
+		for ( const auto& edit : edits ) {
+			Int64 start = eemax<Int64>( 0, edit.start );
+
+			if ( start > static_cast<Int64>( mLines.size() ) ) {
+				fullUpdate = true;
+				break;
+			}
+
+			Int64 oldEnd = eemin<Int64>( edit.oldEnd, static_cast<Int64>( mLines.size() ) - 1 );
+
+			if ( oldEnd >= start ) {
+				for ( Int64 i = start; i <= oldEnd; i++ )
+					released.insert( released.end(), mLines[i].ids.begin(), mLines[i].ids.end() );
+
+				mLines.erase( mLines.begin() + start, mLines.begin() + oldEnd + 1 );
+			}
+
+			mLines.insert( mLines.begin() + start, edit.newEnd - edit.start + 1, LineSymbols() );
+		}
+
+		// The document and the lines tracked diverged, start again
+		if ( static_cast<Int64>( mLines.size() ) != linesCount )
+			fullUpdate = true;
+	}
+
+	if ( fullUpdate || linesCount > MAX_DOCUMENT_LINES ) {
+		releaseAll( released );
+
+		if ( linesCount <= MAX_DOCUMENT_LINES )
+			mLines.resize( linesCount );
+	}
+
+	// Extract the symbols of all the modified lines and intern them with a single lock
+	LuaPattern luaPattern( pattern );
+	std::vector<std::string> symbols;
+	std::vector<std::pair<Int64, size_t>> extracted;
+	bool completed = true;
+
+	for ( Int64 i = 0; i < static_cast<Int64>( mLines.size() ); i++ ) {
+		if ( !mLines[i].dirty )
+			continue;
+
+		if ( cancel || mClosed || i >= static_cast<Int64>( mDoc->linesCount() ) ) {
+			completed = false;
+			break;
+		}
+
+		const auto& string = mDoc->line( i ).getText().toUtf8();
+		size_t first = symbols.size();
+
+		for ( auto& match : luaPattern.gmatch( string ) ) {
+			std::string matchStr( match[0] );
+
+			if ( matchStr.size() < MIN_SYMBOL_LENGTH ||
+				 std::find( symbols.begin() + first, symbols.end(), matchStr ) != symbols.end() )
+				continue;
+
+			symbols.push_back( std::move( matchStr ) );
+		}
+
+		extracted.emplace_back( i, symbols.size() - first );
+	}
+
+	std::vector<Uint32> ids;
+	mDictionary->acquire( symbols, ids );
+
+	size_t pos = 0;
+
+	for ( const auto& line : extracted ) {
+		LineSymbols& lineSymbols = mLines[line.first];
+		lineSymbols.ids.assign( ids.begin() + pos, ids.begin() + pos + line.second );
+		lineSymbols.dirty = false;
+		pos += line.second;
+	}
+
+	// Released after acquiring the new symbols, so unchanged symbols of the modified lines are not
+	// removed and interned again
+	mDictionary->release( released );
+
+	if ( completed )
+		mChangeId = changeId;
+}
+
+void DocumentSymbols::invalidate() {
+	{
+		Lock l( mPendingMutex );
+		mPending.clear();
+		mFullUpdate = true;
+	}
+
+	mChangeId = static_cast<Uint64>( -1 );
+}
+
+TextDocument* DocumentSymbols::getDoc() const {
+	return mDoc;
+}
+
+Uint64 DocumentSymbols::getChangeId() const {
+	return mChangeId;
+}
+
+bool DocumentSymbols::isClosed() const {
+	return mClosed;
+}
+
+void DocumentSymbols::onDocumentLoaded( TextDocument* ) {
+	invalidate();
+}
+
+void DocumentSymbols::onDocumentTextChanged( const DocumentContentChange& change ) {
+	TextRange range( change.range.normalized() );
+	LineEdit edit;
+	edit.start = range.start().line();
+	edit.oldEnd = range.end().line();
+	edit.newEnd = edit.start + std::count( change.text.begin(), change.text.end(), '\n' );
+
+	Lock l( mPendingMutex );
+
+	if ( !mFullUpdate )
+		mPending.push_back( edit );
+}
+
+void DocumentSymbols::onDocumentClosed( TextDocument* ) {
+	mClosed = true;
+}
+
+void DocumentSymbols::onDocumentReloaded( TextDocument* ) {
+	invalidate();
+}
+
+void DocumentSymbols::releaseAll( std::vector<Uint32>& released ) {
+	for ( const auto& line : mLines )
+		released.insert( released.end(), line.ids.begin(), line.ids.end() );
+
+	mLines.clear();
+}
+
+} // namespace ecode
@@ -0,0 +1,122 @@
+#ifndef ECODE_SYMBOLDICTIONARY_HPP
+#define ECODE_SYMBOLDICTIONARY_HPP
+
+#include <array>
+#include <atomic>
+#include <eepp/system/mutex.hpp>
+#include <eepp/ui/doc/textdocument.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace EE;
+using namespace EE::System;
+using namespace EE::UI::Doc;
+
+namespace ecode {
+
+/** Interned and reference counted set of symbols shared by all the documents of a language.
+ * Every symbol keeps a bitmask of the characters it contains, a pattern can only fuzzy match a
+ * symbol if the symbol contains all its characters. The symbols are indexed in a bucket for each
+ * character ( each bit of the mask ) they contain, a match only scans the smallest bucket of the
+ * pattern characters and discards the rest of its symbols by comparing masks before running the
+ * fuzzy match. */
+class SymbolDictionary {
+  public:
+	typedef std::function<void( const std::string& symbol, const int& score )> MatchCb;
+
+	static Uint64 charMask( const std::string& str );
+
+	/** Interns the symbols, returning their ids. */
+	void acquire( const std::vector<std::string>& symbols, std::vector<Uint32>& ids );
+
+	/** Releases a reference of each symbol id, the symbols with no references are removed. */
+	void release( const std::vector<Uint32>& ids );
+
+	/** Calls onMatch for every symbol that fuzzy matches the pattern ( except the pattern
+	 * itself ). */
+	void fuzzyMatch( const std::string& pattern, const MatchCb& onMatch ) const;
+
+	size_t size() const;
+
+  protected:
+	mutable Mutex mMutex;
+	std::unordered_map<std::string, Uint32> mIds;
+	std::vector<std::string> mSymbols;
+	std::vector<Uint32> mRefs;
+	std::vector<Uint64> mMasks;
+	std::vector<Uint32> mFreeIds;
+	/** Ids of the symbols that contain each character of the mask. */
+	std::array<std::vector<Uint32>, 64> mBuckets;
+	/** Position of each symbol in its buckets, ordered by character bit. */
+	std::vector<std::vector<Uint32>> mBucketPositions;
+
+	void indexSymbol( const Uint32& id );
+
+	void unindexSymbol( const Uint32& id );
+};
+
+/** Keeps the symbols of each line of a document. The text changes of the document are queued
+ * as line edits and only the modified lines are extracted again when the symbols are updated,
+ * which is done from a worker thread. */
+class DocumentSymbols : public TextDocument::Client {
+  public:
+	explicit DocumentSymbols( TextDocument* doc );
+
+	virtual ~DocumentSymbols();
+
+	/** Applies the queued edits and extracts the symbols of the modified lines. */
+	void update( const std::shared_ptr<SymbolDictionary>& dictionary, const std::string& pattern,
+				 const bool& cancel );
+
+	/** Forces a full update of the document symbols. */
+	void invalidate();
+
+	TextDocument* getDoc() const;
+
+	Uint64 getChangeId() const;
+
+	bool isClosed() const;
+
+	virtual void onDocumentLoaded( TextDocument* );
+	virtual void onDocumentTextChanged( const DocumentContentChange& change );
+	virtual void onDocumentUndoRedo( const TextDocument::UndoRedo& ) {}
+	virtual void onDocumentCursorChange( const TextPosition& ) {}
+	virtual void onDocumentSelectionChange( const TextRange& ) {}
+	virtual void onDocumentLineCountChange( const size_t&, const size_t& ) {}
+	virtual void onDocumentLineChanged( const Int64& ) {}
+	virtual void onDocumentSaved( TextDocument* ) {}
+	virtual void onDocumentClosed( TextDocument* );
+	virtual void onDocumentDirtyOnFileSystem( TextDocument* ) {}
+	virtual void onDocumentMoved( TextDocument* ) {}
+	virtual void onDocumentReloaded( TextDocument* );
+
+  protected:
+	struct LineEdit {
+		Int64 start;
+		Int64 oldEnd;
+		Int64 newEnd;
+	};
+
+	struct LineSymbols {
+		std::vector<Uint32> ids;
+		bool dirty{ true };
+	};
+
+	TextDocument* mDoc;
+	Mutex mPendingMutex;
+	std::vector<LineEdit> mPending;
+	bool mFullUpdate{ true };
+	Mutex mUpdateMutex;
+	std::shared_ptr<SymbolDictionary> mDictionary;
+	std::vector<LineSymbols> mLines;
+	std::atomic<Uint64> mChangeId{ static_cast<Uint64>( -1 ) };
+	std::atomic<bool> mClosed{ false };
+
+	void releaseAll( std::vector<Uint32>& released );
+};
+
+} // namespace ecode
+
+#endif // ECODE_SYMBOLDICTIONARY_HPP
@@ -43,6 +43,8 @@ class FormatterPlugin : public UICodeEditorPlugin {
 
 	void onUnregister( UICodeEditor* );
 
+	Time getIdleTime( UICodeEditor* ) { return Time::Infinity; }
+
 	bool isReady() const { return mReady; }
 
 	bool getAutoFormatOnSave() const;
@@ -404,6 +404,14 @@ void LinterPlugin::update( UICodeEditor* editor ) {
 	}
 }
 
+Time LinterPlugin::getIdleTime( UICodeEditor* editor ) {
+	auto it = mDirtyDoc.find( editor->getDocumentRef().get() );
+	if ( it == mDirtyDoc.end() )
+		return Time::Infinity;
+	Time elapsed( it->second->getElapsedTime() );
+	return elapsed < mDelayTime ? mDelayTime - elapsed : Time::Zero;
+}
+
 const Time& LinterPlugin::getDelayTime() const {
 	return mDelayTime;
 }
@@ -670,19 +678,40 @@ void LinterPlugin::drawAfterLineText( UICodeEditor* editor, const Int64& index,
 		line.setColor(
 			editor->getColorScheme().getEditorSyntaxStyle( getMatchString( match.type ) ).color );
 
-		Int64 strSize = match.range.end().column() - match.range.start().column();
-		Vector2f pos = { position.x + editor->getXOffsetCol( match.range.start() ), position.y };
-		if ( strSize <= 0 ) {
-			strSize = 1;
-			pos = { position.x, position.y };
+		Int64 startCol = match.range.start().column();
+		Int64 endCol = match.range.end().column();
+		if ( endCol - startCol <= 0 ) {
+			startCol = 0;
+			endCol = 1;
 		}
 
-		std::string str( strSize, '~' );
-		String string( str );
-		line.setString( string );
-		Rectf box( pos - editor->getScreenPos(), { editor->getTextWidth( string ), lineHeight } );
-		match.box[editor] = box;
-		line.draw( pos.x, pos.y + lineHeight * 0.5f );
+		// The position is the start of the first row of the line, a soft wrapped match is
+		// underlined on every row it spans
+		Float lineTop = editor->getTextPositionOffset( { index, 0 } ).y;
+		const std::vector<Int64>& wrapColumns = editor->getLineWrapColumns( index );
+		auto wrapIt = std::upper_bound( wrapColumns.begin(), wrapColumns.end(), startCol );
+		bool firstRow = true;
+
+		while ( startCol < endCol ) {
+			Int64 rowEnd = wrapIt == wrapColumns.end() ? endCol : eemin( endCol, *wrapIt );
+			Vector2f offset( editor->getTextPositionOffset( { index, startCol } ) );
+			Vector2f pos = { position.x + offset.x, position.y + offset.y - lineTop };
+
+			std::string str( rowEnd - startCol, '~' );
+			String string( str );
+			line.setString( string );
+			if ( firstRow ) {
+				Rectf box( pos - editor->getScreenPos(),
+						   { editor->getTextWidth( string ), lineHeight } );
+				match.box[editor] = box;
+				firstRow = false;
+			}
+			line.draw( pos.x, pos.y + lineHeight * 0.5f );
+
+			startCol = rowEnd;
+			if ( wrapIt != wrapColumns.end() )
+				++wrapIt;
+		}
 	}
 }
 
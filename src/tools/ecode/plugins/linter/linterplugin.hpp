@@ -83,6 +83,8 @@ class LinterPlugin : public UICodeEditorPlugin {
 
 	void update( UICodeEditor* );
 
+	Time getIdleTime( UICodeEditor* );
+
 	bool onMouseMove( UICodeEditor*, const Vector2i&, const Uint32& flags );
 
 	bool onMouseLeave( UICodeEditor*, const Vector2i&, const Uint32& );
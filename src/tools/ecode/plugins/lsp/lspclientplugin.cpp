@@ -53,6 +53,10 @@ struct LSPPositionAndServer {
 	LSPClientServer* server{ nullptr };
 };
 
+Time LSPClientPlugin::getIdleTime( UICodeEditor* ) {
+	return mClientManager.getIdleTime();
+}
+
 LSPClientServer* getServerURIFromURI( LSPClientServerManager& manager, const json& data ) {
 	URI uri( data["uri"] );
 	return manager.getOneLSPClientServer( uri );
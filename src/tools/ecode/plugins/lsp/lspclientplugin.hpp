@@ -35,6 +35,8 @@ class LSPClientPlugin : public UICodeEditorPlugin {
 
 	virtual void update( UICodeEditor* );
 
+	virtual Time getIdleTime( UICodeEditor* );
+
 	std::string getId() { return Definition().id; }
 
 	std::string getTitle() { return Definition().name; }
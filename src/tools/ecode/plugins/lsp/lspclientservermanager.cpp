@@ -200,6 +200,26 @@ void LSPClientServerManager::updateDirty() {
 	}
 }
 
+Time LSPClientServerManager::getIdleTime() {
+	bool pending = !mLSPsToClose.empty();
+
+	if ( !pending ) {
+		Lock l( mClientsMutex );
+		for ( auto& server : mClients ) {
+			if ( !server.second->hasDocuments() ) {
+				pending = true;
+				break;
+			}
+		}
+	}
+
+	if ( !pending )
+		return Time::Infinity;
+
+	Time elapsed( mUpdateClock.getElapsedTime() );
+	return elapsed < Seconds( 1 ) ? Seconds( 1 ) - elapsed : Time::Zero;
+}
+
 void LSPClientServerManager::getAndGoToLocation( const std::shared_ptr<TextDocument>& doc,
 												 const std::string& search ) {
 	auto* server = getOneLSPClientServer( doc );
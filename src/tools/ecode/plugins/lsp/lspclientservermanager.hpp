@@ -32,6 +32,10 @@ class LSPClientServerManager {
 
 	void updateDirty();
 
+	/** @return The time until the next check of the servers to close, Time::Infinity if all
+	 * the servers have documents open. */
+	Time getIdleTime();
+
 	void didChangeWorkspaceFolders( const std::string& folder );
 
 	const LSPWorkspaceFolder& getLSPWorkspaceFolder() const;